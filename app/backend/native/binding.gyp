@@ -0,0 +1,15 @@
+{
+  "targets": [
+    {
+      "target_name": "gps_natif",
+      "sources": [
+        "gps_natif.c",
+        "../../../data/Part_Bonus/main.c"
+      ],
+      "include_dirs": ["../../../data/Part_Bonus"],
+      "defines": ["GPS_BIBLIOTHEQUE", "NAPI_VERSION=8"],
+      "cflags_c": ["-O2", "-std=gnu11", "-fvisibility=hidden", "-Wno-unused-result"],
+      "libraries": ["-lpthread"]
+    }
+  ]
+}
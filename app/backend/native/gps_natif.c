@@ -0,0 +1,697 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <limits.h>
+#include <math.h>
+#include <node_api.h>
+
+#include "gps.h"
+
+// ---------------------------------------------------------------------
+// Module natif Node-API : le solveur GPS (libgps) dans le processus Node
+// ---------------------------------------------------------------------
+// solve(texte, options) et verify(texte, plans) renvoient une promesse.
+// Le texte et les options sont lus dans le fil JavaScript ; le chargement
+// du problème, la recherche et la vérification tournent dans un fil de
+// libuv (UV_THREADPOOL_SIZE, 4 par défaut), puis le résultat est construit
+// dans le fil JavaScript. La promesse de solve() porte une fonction
+// cancel() qui lève le jeton d'annulation de sa recherche (GpsAnnuler).
+// Les options onPlan (plans intermédiaires, GPS_ANYTIME) et onProgress
+// (avancement, toutes les progressIntervalMs) passent par des fonctions
+// thread-safe : les données sont recopiées dans le fil de la recherche.
+// L'interface JavaScript (noms des stratégies, AbortSignal) est dans index.js.
+
+#define MAX_CHEMIN 256
+
+// Appel Node-API : en cas d'échec, lève une exception JavaScript et sort
+#define NAPI_APPEL(env, appel)                                              \
+    do {                                                                    \
+        if ((appel) != napi_ok) {                                           \
+            LeverErreurNapi(env);                                           \
+            return NULL;                                                    \
+        }                                                                   \
+    } while (0)
+
+static void LeverErreurNapi(napi_env env) {
+    const napi_extended_error_info* info = NULL;
+    bool enAttente = false;
+    napi_is_exception_pending(env, &enAttente);
+    if (enAttente) return;
+    napi_get_last_error_info(env, &info);
+    napi_throw_error(env, NULL, info && info->error_message ? info->error_message : "erreur Node-API");
+}
+
+static napi_value CreerNombre(napi_env env, double x) {
+    napi_value v;
+    napi_create_double(env, x, &v);
+    return v;
+}
+
+static napi_value CreerChaine(napi_env env, const char* texte, size_t longueur) {
+    napi_value v;
+    napi_create_string_utf8(env, texte, longueur, &v);
+    return v;
+}
+
+// ---------------------------------------------------------------------
+// Lecture des arguments
+// ---------------------------------------------------------------------
+
+// Propriété 'cle' de 'objet' si elle existe et n'est pas undefined / null
+static bool LirePropriete(napi_env env, napi_value objet, const char* cle, napi_value* valeur) {
+    bool presente = false;
+    if (!objet || napi_has_named_property(env, objet, cle, &presente) != napi_ok || !presente) return false;
+    if (napi_get_named_property(env, objet, cle, valeur) != napi_ok) return false;
+    napi_valuetype type;
+    napi_typeof(env, *valeur, &type);
+    return type != napi_undefined && type != napi_null;
+}
+
+static bool LireNombre(napi_env env, napi_value objet, const char* cle, double* nombre) {
+    napi_value valeur;
+    if (!LirePropriete(env, objet, cle, &valeur)) return true;
+    if (napi_get_value_double(env, valeur, nombre) == napi_ok) return true;
+    char message[96];
+    snprintf(message, sizeof(message), "options.%s doit être un nombre", cle);
+    napi_throw_type_error(env, NULL, message);
+    return false;
+}
+
+// Plus grand entier que le double représente exactement (2^53 - 1)
+#define ENTIER_EXACT 9007199254740991.0
+
+// Nombre fini ramené dans [min, max] avant sa conversion en entier : NaN
+// et les infinis sont refusés (RangeError), leur conversion n'étant pas
+// définie en C
+static bool LireNombreBorne(napi_env env, napi_value objet, const char* cle, double min, double max, double* nombre) {
+    if (!LireNombre(env, objet, cle, nombre)) return false;
+    if (!isfinite(*nombre)) {
+        char message[96];
+        snprintf(message, sizeof(message), "options.%s doit être un nombre fini", cle);
+        napi_throw_range_error(env, NULL, message);
+        return false;
+    }
+    if (*nombre < min) *nombre = min;
+    else if (*nombre > max) *nombre = max;
+    return true;
+}
+
+static bool LireBooleen(napi_env env, napi_value objet, const char* cle, int* booleen) {
+    napi_value valeur;
+    if (!LirePropriete(env, objet, cle, &valeur)) return true;
+    bool b;
+    if (napi_coerce_to_bool(env, valeur, &valeur) != napi_ok || napi_get_value_bool(env, valeur, &b) != napi_ok) return false;
+    *booleen = b;
+    return true;
+}
+
+// Texte UTF-8 alloué par malloc (terminé par '\0')
+static char* LireTexte(napi_env env, napi_value valeur, size_t* taille) {
+    size_t n = 0;
+    if (napi_get_value_string_utf8(env, valeur, NULL, 0, &n) != napi_ok) return NULL;
+    char* texte = malloc(n + 1);
+    if (!texte) return NULL;
+    napi_get_value_string_utf8(env, valeur, texte, n + 1, &n);
+    if (taille) *taille = n;
+    return texte;
+}
+
+// Graine : nombre, BigInt ou chaîne décimale (les graines dépassent 2^53)
+static bool LireGraine(napi_env env, napi_value objet, unsigned long long* graine) {
+    napi_value valeur;
+    if (!LirePropriete(env, objet, "seed", &valeur)) return true;
+    napi_valuetype type;
+    napi_typeof(env, valeur, &type);
+    if (type == napi_bigint) {
+        uint64_t g;
+        bool exact;
+        if (napi_get_value_bigint_uint64(env, valeur, &g, &exact) == napi_ok && exact) {
+            *graine = g;
+            return true;
+        }
+    } else if (type == napi_number) {
+        double g;
+        napi_get_value_double(env, valeur, &g);
+        if (g >= 0 && g < 18446744073709551616.0) {
+            *graine = (unsigned long long)g;
+            return true;
+        }
+    } else if (type == napi_string) {
+        char tampon[32];
+        size_t n;
+        napi_get_value_string_utf8(env, valeur, tampon, sizeof(tampon), &n);
+        char* fin;
+        *graine = strtoull(tampon, &fin, 10);
+        if (n > 0 && *fin == '\0' && tampon[0] != '-') return true;
+    }
+    napi_throw_type_error(env, NULL, "options.seed doit être un entier positif (nombre, BigInt ou chaîne)");
+    return false;
+}
+
+// options JavaScript -> GpsOptions ; faux si une exception a été levée
+static bool LireOptions(napi_env env, napi_value objet, GpsOptions* options, char* repertoire) {
+    GpsOptionsParDefaut(options);
+    double strategie = options->strategie, delai = 0, maxNoeuds = 0, maxOctets = 0, fils = options->nbFils;
+    double optimiser = 0, periode = 0;
+    const double longMax = (double)LONG_MAX < ENTIER_EXACT ? (double)LONG_MAX : ENTIER_EXACT;
+    const double tailleMax = (double)SIZE_MAX < ENTIER_EXACT ? (double)SIZE_MAX : ENTIER_EXACT;
+    if (!LireNombreBorne(env, objet, "strategy", INT_MIN, INT_MAX, &strategie)
+        || !LireNombreBorne(env, objet, "timeoutMs", 0, ENTIER_EXACT, &delai)
+        || !LireNombreBorne(env, objet, "maxNodes", 0, longMax, &maxNoeuds)
+        || !LireNombreBorne(env, objet, "maxBytes", 0, tailleMax, &maxOctets)
+        || !LireNombreBorne(env, objet, "threads", 1, INT_MAX, &fils)
+        || !LireNombreBorne(env, objet, "optimize", 0, 2, &optimiser)
+        || !LireNombreBorne(env, objet, "progressIntervalMs", 0, ENTIER_EXACT, &periode)
+        || !LireBooleen(env, objet, "partialOrder", &options->ordrePartiel)
+        || !LireBooleen(env, objet, "symmetries", &options->symetries)
+        || !LireGraine(env, objet, &options->graine)) {
+        return false;
+    }
+    options->strategie = (int)strategie;
+    options->delaiMs = delai;
+    options->maxNoeuds = (long)maxNoeuds;
+    options->maxOctets = (size_t)maxOctets;
+    options->nbFils = (int)fils;
+    options->optimiserPlan = (int)optimiser;
+    options->periodeProgressionMs = periode;
+
+    napi_value valeur;
+    if (LirePropriete(env, objet, "prioritiesDir", &valeur)) {
+        size_t n;
+        if (napi_get_value_string_utf8(env, valeur, repertoire, MAX_CHEMIN, &n) != napi_ok) {
+            napi_throw_type_error(env, NULL, "options.prioritiesDir doit être une chaîne");
+            return false;
+        }
+        options->repertoirePriorites = repertoire;
+    }
+    return true;
+}
+
+// ---------------------------------------------------------------------
+// solve(texte, options)
+// ---------------------------------------------------------------------
+
+// Partagé entre la fonction cancel() et le travail : libéré par le
+// dernier des deux (toujours dans le fil JavaScript)
+typedef struct {
+    int references;
+    GpsRecherche* recherche;        // NULL une fois la recherche rendue
+} Jeton;
+
+typedef struct {
+    napi_async_work travail;
+    napi_deferred promesse;
+    char* texte;
+    size_t taille;
+    GpsOptions options;
+    char repertoire[MAX_CHEMIN];
+    GpsRecherche* recherche;
+    Jeton* jeton;
+    GpsProbleme* probleme;          // chargé dans le fil de libuv
+    GpsErreur erreur;
+    int issue;
+    napi_threadsafe_function rappel; // options.onPlan, NULL si absente
+    napi_threadsafe_function rappelProgression; // options.onProgress, NULL si absente
+} TravailResolution;
+
+// Plan intermédiaire en route vers le fil JavaScript : noms séparés par '\n'
+typedef struct {
+    int longueur;
+    double tempsMs;
+    char noms[];
+} PlanIntermediaire;
+
+static void RelacherJeton(Jeton* jeton) {
+    if (--jeton->references == 0) free(jeton);
+}
+
+static void FinaliserJeton(napi_env env, void* donnees, void* indice) {
+    (void)env;
+    (void)indice;
+    RelacherJeton(donnees);
+}
+
+static napi_value Annuler(napi_env env, napi_callback_info info) {
+    void* donnees;
+    NAPI_APPEL(env, napi_get_cb_info(env, info, NULL, NULL, NULL, &donnees));
+    Jeton* jeton = donnees;
+    if (jeton->recherche) GpsAnnuler(jeton->recherche);
+    napi_value resultat;
+    NAPI_APPEL(env, napi_get_boolean(env, jeton->recherche != NULL, &resultat));
+    return resultat;
+}
+
+// Fil de la recherche : seul napi_call_threadsafe_function est permis ici
+static void TransmettrePlan(const int* plan, int longueur, double tempsMs, void* contexte) {
+    TravailResolution* t = contexte;
+    size_t taille = 0;
+    for (int k = 0; k < longueur; k++) {
+        int n = 0;
+        GpsNomAction(t->probleme, plan[k], &n);
+        taille += (size_t)n + 1;
+    }
+    PlanIntermediaire* p = malloc(sizeof(PlanIntermediaire) + taille + 1);
+    if (!p) return;                         // plan perdu, le suivant passera
+    p->longueur = longueur;
+    p->tempsMs = tempsMs;
+    char* fin = p->noms;
+    for (int k = 0; k < longueur; k++) {
+        int n = 0;
+        const char* nom = GpsNomAction(t->probleme, plan[k], &n);
+        memcpy(fin, nom, n);
+        fin += n;
+        *fin++ = '\n';
+    }
+    *fin = '\0';
+    if (napi_call_threadsafe_function(t->rappel, p, napi_tsfn_nonblocking) != napi_ok) free(p);
+}
+
+// Fil JavaScript : onPlan(plan, { length, timeMs }) ; env est NULL si la
+// fonction est détruite avant l'appel. Une exception de onPlan est ignorée.
+static void AppelerRappelPlan(napi_env env, napi_value rappel, void* contexte, void* donnees) {
+    (void)contexte;
+    PlanIntermediaire* p = donnees;
+    if (env && rappel) {
+        napi_value plan, infos, arguments[2], indefini, resultat;
+        napi_create_array_with_length(env, p->longueur, &plan);
+        const char* debut = p->noms;
+        for (int k = 0; k < p->longueur; k++) {
+            const char* fin = strchr(debut, '\n');
+            napi_set_element(env, plan, k, CreerChaine(env, debut, fin - debut));
+            debut = fin + 1;
+        }
+        napi_create_object(env, &infos);
+        napi_set_named_property(env, infos, "length", CreerNombre(env, p->longueur));
+        napi_set_named_property(env, infos, "timeMs", CreerNombre(env, p->tempsMs));
+        arguments[0] = plan;
+        arguments[1] = infos;
+        napi_get_undefined(env, &indefini);
+        if (napi_call_function(env, indefini, rappel, 2, arguments, &resultat) == napi_pending_exception) {
+            napi_value exception;
+            napi_get_and_clear_last_exception(env, &exception);
+        }
+    }
+    free(p);
+}
+
+// Fil de la recherche : l'instantané est recopié
+static void TransmettreProgression(const GpsProgression* progression, void* contexte) {
+    TravailResolution* t = contexte;
+    GpsProgression* copie = malloc(sizeof(GpsProgression));
+    if (!copie) return;
+    *copie = *progression;
+    if (napi_call_threadsafe_function(t->rappelProgression, copie, napi_tsfn_nonblocking) != napi_ok) free(copie);
+}
+
+// -1 (sans objet) devient null
+static napi_value CreerNombreOuNull(napi_env env, double x) {
+    napi_value v;
+    if (x < 0) napi_get_null(env, &v);
+    else napi_create_double(env, x, &v);
+    return v;
+}
+
+// Fil JavaScript : onProgress({ timeMs, expanded, generated, depth, bestH,
+// nodesPerSec, bytes }) ; une exception de onProgress est ignorée
+static void AppelerRappelProgression(napi_env env, napi_value rappel, void* contexte, void* donnees) {
+    (void)contexte;
+    GpsProgression* p = donnees;
+    if (env && rappel) {
+        napi_value instantane, indefini, resultat;
+        napi_create_object(env, &instantane);
+        napi_set_named_property(env, instantane, "timeMs", CreerNombre(env, p->tempsMs));
+        napi_set_named_property(env, instantane, "expanded", CreerNombre(env, (double)p->developpes));
+        napi_set_named_property(env, instantane, "generated", CreerNombreOuNull(env, (double)p->generes));
+        napi_set_named_property(env, instantane, "depth", CreerNombreOuNull(env, p->profondeur));
+        napi_set_named_property(env, instantane, "bestH", CreerNombreOuNull(env, p->meilleurH));
+        napi_set_named_property(env, instantane, "nodesPerSec", CreerNombre(env, p->noeudsParSeconde));
+        napi_set_named_property(env, instantane, "bytes", CreerNombre(env, (double)p->octets));
+        napi_get_undefined(env, &indefini);
+        if (napi_call_function(env, indefini, rappel, 1, &instantane, &resultat) == napi_pending_exception) {
+            napi_value exception;
+            napi_get_and_clear_last_exception(env, &exception);
+        }
+    }
+    free(p);
+}
+
+// Fonction thread-safe pour l'option 'cle' si elle est présente ; faux si
+// une exception a été levée
+static bool CreerRappel(napi_env env, napi_value options, const char* cle, napi_threadsafe_function_call_js appel,
+                        napi_threadsafe_function* rappel) {
+    napi_value fonction, nom;
+    if (!LirePropriete(env, options, cle, &fonction)) return true;
+    napi_valuetype type;
+    napi_typeof(env, fonction, &type);
+    if (type != napi_function) {
+        char message[96];
+        snprintf(message, sizeof(message), "options.%s doit être une fonction", cle);
+        napi_throw_type_error(env, NULL, message);
+        return false;
+    }
+    if (napi_create_string_utf8(env, cle, NAPI_AUTO_LENGTH, &nom) != napi_ok
+        || napi_create_threadsafe_function(env, fonction, NULL, nom, 0, 1, NULL, NULL, NULL, appel, rappel) != napi_ok) {
+        LeverErreurNapi(env);
+        return false;
+    }
+    return true;
+}
+
+// Fil de libuv : pas d'appel à Node-API ici
+static void ExecuterResolution(napi_env env, void* donnees) {
+    (void)env;
+    TravailResolution* t = donnees;
+    t->probleme = GpsChargerTexte(t->texte, t->taille, &t->erreur);
+    if (t->rappel) {
+        t->options.rappelPlan = TransmettrePlan;
+        t->options.contexteRappel = t;
+    }
+    if (t->rappelProgression) {
+        t->options.rappelProgression = TransmettreProgression;
+        t->options.contexteProgression = t;
+    }
+    if (t->probleme) t->issue = GpsResoudre(t->recherche, t->probleme, &t->options);
+}
+
+// { issue, message, plan: [noms], actions: [numéros], stats: {...} }
+static napi_value ConstruireResultat(napi_env env, TravailResolution* t) {
+    GpsStatistiques stats;
+    GpsStatistiquesRecherche(t->recherche, &stats);
+    napi_value resultat, plan, actions, statistiques;
+    NAPI_APPEL(env, napi_create_object(env, &resultat));
+    NAPI_APPEL(env, napi_set_named_property(env, resultat, "issue", CreerNombre(env, t->issue)));
+    NAPI_APPEL(env, napi_set_named_property(env, resultat, "message", CreerChaine(env, GpsNomIssue(t->issue), NAPI_AUTO_LENGTH)));
+
+    int longueur = GpsLongueurPlan(t->recherche);
+    if (longueur >= 0) {
+        NAPI_APPEL(env, napi_create_array_with_length(env, longueur, &plan));
+        NAPI_APPEL(env, napi_create_array_with_length(env, longueur, &actions));
+        for (int k = 0; k < longueur; k++) {
+            int a = GpsEtapePlan(t->recherche, k), n = 0;
+            const char* nom = GpsNomAction(t->probleme, a, &n);
+            NAPI_APPEL(env, napi_set_element(env, plan, k, CreerChaine(env, nom, n)));
+            NAPI_APPEL(env, napi_set_element(env, actions, k, CreerNombre(env, a)));
+        }
+    } else {
+        NAPI_APPEL(env, napi_get_null(env, &plan));
+        NAPI_APPEL(env, napi_get_null(env, &actions));
+    }
+    NAPI_APPEL(env, napi_set_named_property(env, resultat, "plan", plan));
+    NAPI_APPEL(env, napi_set_named_property(env, resultat, "actions", actions));
+
+    char graine[24];
+    snprintf(graine, sizeof(graine), "%llu", stats.graine);
+    NAPI_APPEL(env, napi_create_object(env, &statistiques));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "length", CreerNombre(env, stats.longueur)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "rawLength", CreerNombre(env, stats.longueurBrute)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "nodes", CreerNombre(env, (double)stats.noeuds)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "successors", CreerNombre(env, (double)stats.successeurs)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "timeMs", CreerNombre(env, stats.tempsMs)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "peakBytes", CreerNombre(env, (double)stats.octetsMax)));
+    NAPI_APPEL(env, napi_set_named_property(env, statistiques, "seed", CreerChaine(env, graine, NAPI_AUTO_LENGTH)));
+    NAPI_APPEL(env, napi_set_named_property(env, resultat, "stats", statistiques));
+    return resultat;
+}
+
+// Erreur de chargement : Error avec code 'GPS_PARSE', line et column
+static napi_value ConstruireErreurChargement(napi_env env, const GpsErreur* erreur) {
+    char message[320];
+    if (erreur->ligne > 0) snprintf(message, sizeof(message), "%d:%d: %s", erreur->ligne, erreur->colonne, erreur->message);
+    else snprintf(message, sizeof(message), "%s", erreur->message);
+    napi_value objet;
+    NAPI_APPEL(env, napi_create_error(env, CreerChaine(env, "GPS_PARSE", NAPI_AUTO_LENGTH),
+                                      CreerChaine(env, message, NAPI_AUTO_LENGTH), &objet));
+    NAPI_APPEL(env, napi_set_named_property(env, objet, "line", CreerNombre(env, erreur->ligne)));
+    NAPI_APPEL(env, napi_set_named_property(env, objet, "column", CreerNombre(env, erreur->colonne)));
+    return objet;
+}
+
+static void LibererTravailResolution(napi_env env, TravailResolution* t) {
+    if (t->travail) napi_delete_async_work(env, t->travail);
+    // Les plans déjà en file sont encore livrés (noms recopiés)
+    if (t->rappel) napi_release_threadsafe_function(t->rappel, napi_tsfn_release);
+    if (t->rappelProgression) napi_release_threadsafe_function(t->rappelProgression, napi_tsfn_release);
+    t->jeton->recherche = NULL;
+    RelacherJeton(t->jeton);
+    GpsLibererRecherche(t->recherche);
+    GpsLibererProbleme(t->probleme);
+    free(t->texte);
+    free(t);
+}
+
+// Fil JavaScript : la promesse est tenue ou rompue
+static void TerminerResolution(napi_env env, napi_status statut, void* donnees) {
+    TravailResolution* t = donnees;
+    napi_value valeur = NULL;
+    bool tenue = false;
+    if (statut == napi_ok && t->probleme) {
+        valeur = ConstruireResultat(env, t);
+        tenue = valeur != NULL;
+    } else if (statut == napi_ok) {
+        valeur = ConstruireErreurChargement(env, &t->erreur);
+    }
+    if (!valeur) {
+        bool enAttente = false;
+        napi_is_exception_pending(env, &enAttente);
+        if (enAttente) napi_get_and_clear_last_exception(env, &valeur);
+        else napi_create_error(env, NULL, CreerChaine(env, "recherche interrompue", NAPI_AUTO_LENGTH), &valeur);
+    }
+    if (tenue) napi_resolve_deferred(env, t->promesse, valeur);
+    else napi_reject_deferred(env, t->promesse, valeur);
+    LibererTravailResolution(env, t);
+}
+
+static napi_value Resoudre(napi_env env, napi_callback_info info) {
+    size_t nbArguments = 2;
+    napi_value arguments[2];
+    NAPI_APPEL(env, napi_get_cb_info(env, info, &nbArguments, arguments, NULL, NULL));
+    napi_valuetype type = napi_undefined;
+    if (nbArguments >= 1) napi_typeof(env, arguments[0], &type);
+    if (type != napi_string) {
+        napi_throw_type_error(env, NULL, "solve(texte, options) : le problème doit être une chaîne");
+        return NULL;
+    }
+
+    TravailResolution* t = calloc(1, sizeof(TravailResolution));
+    Jeton* jeton = calloc(1, sizeof(Jeton));
+    if (t) t->texte = LireTexte(env, arguments[0], &t->taille);
+    if (t) t->recherche = GpsCreerRecherche();
+    if (!t || !jeton || !t->texte || !t->recherche) {
+        if (t) {
+            free(t->texte);
+            GpsLibererRecherche(t->recherche);
+        }
+        free(t);
+        free(jeton);
+        napi_throw_error(env, NULL, "mémoire insuffisante");
+        return NULL;
+    }
+    jeton->references = 1;
+    jeton->recherche = t->recherche;
+    t->jeton = jeton;
+    napi_value options = nbArguments >= 2 ? arguments[1] : NULL;
+    if (!LireOptions(env, options, &t->options, t->repertoire)) {
+        LibererTravailResolution(env, t);
+        return NULL;
+    }
+    if (!CreerRappel(env, options, "onPlan", AppelerRappelPlan, &t->rappel)
+        || !CreerRappel(env, options, "onProgress", AppelerRappelProgression, &t->rappelProgression)) {
+        LibererTravailResolution(env, t);
+        return NULL;
+    }
+
+    napi_value promesse, nom, annuler;
+    if (napi_create_promise(env, &t->promesse, &promesse) != napi_ok
+        || napi_create_string_utf8(env, "gps.solve", NAPI_AUTO_LENGTH, &nom) != napi_ok
+        || napi_create_async_work(env, NULL, nom, ExecuterResolution, TerminerResolution, t, &t->travail) != napi_ok
+        || napi_create_function(env, "cancel", NAPI_AUTO_LENGTH, Annuler, jeton, &annuler) != napi_ok) {
+        LibererTravailResolution(env, t);
+        LeverErreurNapi(env);
+        return NULL;
+    }
+    // cancel() garde le jeton jusqu'à ce qu'elle soit ramassée
+    jeton->references++;
+    if (napi_add_finalizer(env, annuler, jeton, FinaliserJeton, NULL, NULL) != napi_ok) jeton->references--;
+    NAPI_APPEL(env, napi_set_named_property(env, promesse, "cancel", annuler));
+    NAPI_APPEL(env, napi_queue_async_work(env, t->travail));
+    return promesse;
+}
+
+// ---------------------------------------------------------------------
+// verify(texte, plans) : plans est un tableau de plans, chacun un tableau
+// de lignes ; la promesse donne un tableau de { correct, steps, detail }
+// ---------------------------------------------------------------------
+
+typedef struct {
+    napi_async_work travail;
+    napi_deferred promesse;
+    char* texte;
+    size_t taille;
+    int nbPlans;
+    int* nbEtapes;                  // étapes du plan p
+    char*** etapes;                 // lignes du plan p
+    GpsVerification* verifications;
+    GpsProbleme* probleme;
+    GpsErreur erreur;
+} TravailVerification;
+
+static void LibererTravailVerification(napi_env env, TravailVerification* t) {
+    if (t->travail) napi_delete_async_work(env, t->travail);
+    for (int p = 0; t->etapes && p < t->nbPlans; p++) {
+        for (int k = 0; t->etapes[p] && k < t->nbEtapes[p]; k++) free(t->etapes[p][k]);
+        free(t->etapes[p]);
+    }
+    free(t->etapes);
+    free(t->nbEtapes);
+    free(t->verifications);
+    GpsLibererProbleme(t->probleme);
+    free(t->texte);
+    free(t);
+}
+
+static void ExecuterVerification(napi_env env, void* donnees) {
+    (void)env;
+    TravailVerification* t = donnees;
+    t->probleme = GpsChargerTexte(t->texte, t->taille, &t->erreur);
+    for (int p = 0; t->probleme && p < t->nbPlans; p++) {
+        GpsVerifierPlanNoms(t->probleme, (const char* const*)t->etapes[p], t->nbEtapes[p], &t->verifications[p]);
+    }
+}
+
+static napi_value ConstruireVerifications(napi_env env, TravailVerification* t) {
+    napi_value resultats;
+    NAPI_APPEL(env, napi_create_array_with_length(env, t->nbPlans, &resultats));
+    for (int p = 0; p < t->nbPlans; p++) {
+        const GpsVerification* v = &t->verifications[p];
+        napi_value r, correct;
+        NAPI_APPEL(env, napi_create_object(env, &r));
+        NAPI_APPEL(env, napi_get_boolean(env, v->correct, &correct));
+        NAPI_APPEL(env, napi_set_named_property(env, r, "correct", correct));
+        NAPI_APPEL(env, napi_set_named_property(env, r, "steps", CreerNombre(env, v->etapes)));
+        NAPI_APPEL(env, napi_set_named_property(env, r, "detail", CreerChaine(env, v->message, NAPI_AUTO_LENGTH)));
+        NAPI_APPEL(env, napi_set_element(env, resultats, p, r));
+    }
+    return resultats;
+}
+
+static void TerminerVerification(napi_env env, napi_status statut, void* donnees) {
+    TravailVerification* t = donnees;
+    napi_value valeur = NULL;
+    bool tenue = false;
+    if (statut == napi_ok && t->probleme) {
+        valeur = ConstruireVerifications(env, t);
+        tenue = valeur != NULL;
+    } else if (statut == napi_ok) {
+        valeur = ConstruireErreurChargement(env, &t->erreur);
+    }
+    if (!valeur) {
+        bool enAttente = false;
+        napi_is_exception_pending(env, &enAttente);
+        if (enAttente) napi_get_and_clear_last_exception(env, &valeur);
+        else napi_create_error(env, NULL, CreerChaine(env, "vérification interrompue", NAPI_AUTO_LENGTH), &valeur);
+    }
+    if (tenue) napi_resolve_deferred(env, t->promesse, valeur);
+    else napi_reject_deferred(env, t->promesse, valeur);
+    LibererTravailVerification(env, t);
+}
+
+// Recopie les lignes des plans : le fil de libuv ne touche pas aux valeurs JavaScript
+static bool LirePlans(napi_env env, napi_value plans, TravailVerification* t) {
+    uint32_t nbPlans = 0;
+    bool tableau = false;
+    napi_is_array(env, plans, &tableau);
+    if (!tableau || napi_get_array_length(env, plans, &nbPlans) != napi_ok) {
+        napi_throw_type_error(env, NULL, "verify(texte, plans) : plans doit être un tableau de tableaux de chaînes");
+        return false;
+    }
+    t->nbPlans = (int)nbPlans;
+    t->nbEtapes = calloc(nbPlans + 1, sizeof(int));
+    t->etapes = calloc(nbPlans + 1, sizeof(char**));
+    t->verifications = calloc(nbPlans + 1, sizeof(GpsVerification));
+    if (!t->nbEtapes || !t->etapes || !t->verifications) {
+        napi_throw_error(env, NULL, "mémoire insuffisante");
+        return false;
+    }
+    for (uint32_t p = 0; p < nbPlans; p++) {
+        napi_value plan;
+        uint32_t nbEtapes = 0;
+        napi_get_element(env, plans, p, &plan);
+        napi_is_array(env, plan, &tableau);
+        if (!tableau || napi_get_array_length(env, plan, &nbEtapes) != napi_ok) {
+            napi_throw_type_error(env, NULL, "verify(texte, plans) : chaque plan doit être un tableau de chaînes");
+            return false;
+        }
+        t->etapes[p] = calloc(nbEtapes + 1, sizeof(char*));
+        if (!t->etapes[p]) {
+            napi_throw_error(env, NULL, "mémoire insuffisante");
+            return false;
+        }
+        for (uint32_t k = 0; k < nbEtapes; k++) {
+            napi_value etape;
+            napi_get_element(env, plan, k, &etape);
+            t->nbEtapes[p] = (int)k + 1;
+            t->etapes[p][k] = LireTexte(env, etape, NULL);
+            if (!t->etapes[p][k]) {
+                napi_throw_type_error(env, NULL, "verify(texte, plans) : chaque étape doit être une chaîne");
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static napi_value Verifier(napi_env env, napi_callback_info info) {
+    size_t nbArguments = 2;
+    napi_value arguments[2];
+    NAPI_APPEL(env, napi_get_cb_info(env, info, &nbArguments, arguments, NULL, NULL));
+    napi_valuetype type = napi_undefined;
+    if (nbArguments >= 1) napi_typeof(env, arguments[0], &type);
+    if (type != napi_string || nbArguments < 2) {
+        napi_throw_type_error(env, NULL, "verify(texte, plans) : le problème doit être une chaîne");
+        return NULL;
+    }
+
+    TravailVerification* t = calloc(1, sizeof(TravailVerification));
+    if (!t) {
+        napi_throw_error(env, NULL, "mémoire insuffisante");
+        return NULL;
+    }
+    t->texte = LireTexte(env, arguments[0], &t->taille);
+    if (!t->texte) {
+        LibererTravailVerification(env, t);
+        napi_throw_error(env, NULL, "mémoire insuffisante");
+        return NULL;
+    }
+    if (!LirePlans(env, arguments[1], t)) {
+        LibererTravailVerification(env, t);
+        return NULL;
+    }
+
+    napi_value promesse, nom;
+    if (napi_create_promise(env, &t->promesse, &promesse) != napi_ok
+        || napi_create_string_utf8(env, "gps.verify", NAPI_AUTO_LENGTH, &nom) != napi_ok
+        || napi_create_async_work(env, NULL, nom, ExecuterVerification, TerminerVerification, t, &t->travail) != napi_ok
+        || napi_queue_async_work(env, t->travail) != napi_ok) {
+        LibererTravailVerification(env, t);
+        LeverErreurNapi(env);
+        return NULL;
+    }
+    return promesse;
+}
+
+// ---------------------------------------------------------------------
+// Module
+// ---------------------------------------------------------------------
+static napi_value Initialiser(napi_env env, napi_value exports) {
+    napi_property_descriptor proprietes[] = {
+        { "solve", NULL, Resoudre, NULL, NULL, NULL, napi_enumerable, NULL },
+        { "verify", NULL, Verifier, NULL, NULL, NULL, napi_enumerable, NULL },
+    };
+    NAPI_APPEL(env, napi_define_properties(env, exports, sizeof(proprietes) / sizeof(proprietes[0]), proprietes));
+    NAPI_APPEL(env, napi_set_named_property(env, exports, "version", CreerNombre(env, GpsVersion())));
+    return exports;
+}
+
+NAPI_MODULE(NODE_GYP_MODULE_NAME, Initialiser)
@@ -0,0 +1,105 @@
+const path = require('path');
+
+// Solveur GPS dans le processus Node (libgps, voir gps_natif.c).
+// Compilé par `npm run build:natif` ; les recherches et les vérifications
+// tournent dans les fils de libuv, l'event loop n'est jamais bloquée.
+const natif = require(path.join(__dirname, 'build/Release/gps_natif.node'));
+
+// Stratégies de libgps (gps.h)
+const STRATEGIES = {
+    normal: 0,
+    melange: 1,
+    aleatoire: 2,
+    priorite: 3,
+    'fin-moyens': 4,
+    anytime: 5,
+    glouton: 8
+};
+
+// Issues des recherches, dans l'ordre de gps.h
+const ISSUES = ['resolu', 'sans_solution', 'incomplet', 'budget_noeuds', 'budget_memoire', 'delai', 'annule'];
+
+const erreurAnnulation = (signal) =>
+    signal.reason instanceof Error ? signal.reason : new DOMException('Recherche annulée', 'AbortError');
+
+// Résout un problème donné par son texte (format des fichiers du solveur).
+// options : strategy (nom ou numéro), timeoutMs, maxNodes, maxBytes, seed,
+// threads, partialOrder, symmetries, optimize (0, 1 ou 2), prioritiesDir,
+// signal (AbortSignal) pour annuler la recherche, onPlan(plan, { length,
+// timeMs }), appelée à chaque plan amélioré (stratégie anytime), et
+// onProgress({ timeMs, expanded, generated, depth, bestH, nodesPerSec,
+// bytes }), appelée toutes les progressIntervalMs (1000 par défaut, 50 au
+// moins) ; generated, depth et bestH valent null si la stratégie ne les
+// suit pas. Les rappels cessent dès que la promesse est réglée.
+// Renvoie { issue, message, plan, actions, stats } ; plan est null si
+// aucun plan n'a été trouvé. Une erreur de chargement rejette la promesse
+// avec code 'GPS_PARSE', line et column ; une option numérique NaN ou
+// infinie, avec RangeError (les autres sont ramenées dans leurs bornes).
+function solve(problemText, options = {}) {
+    const { signal, strategy = 'normal', onPlan, onProgress, ...reglages } = options;
+    const numero = typeof strategy === 'number' ? strategy : STRATEGIES[strategy];
+    if (numero === undefined) {
+        return Promise.reject(new TypeError(`Stratégie inconnue : ${strategy}`));
+    }
+    for (const [cle, rappel] of [['onPlan', onPlan], ['onProgress', onProgress]]) {
+        if (rappel !== undefined && typeof rappel !== 'function') {
+            return Promise.reject(new TypeError(`options.${cle} doit être une fonction`));
+        }
+    }
+    if (signal && signal.aborted) {
+        return Promise.reject(erreurAnnulation(signal));
+    }
+
+    let recherche;
+    let reglee = false;
+    const tantQueNonReglee = (rappel) => (rappel ? (...args) => { if (!reglee) rappel(...args); } : undefined);
+    reglages.onPlan = tantQueNonReglee(onPlan);
+    reglages.onProgress = tantQueNonReglee(onProgress);
+    if (reglages.progressIntervalMs !== undefined) {
+        reglages.progressIntervalMs = Math.max(50, Number(reglages.progressIntervalMs) || 1000);
+    }
+    try {
+        recherche = natif.solve(problemText, { ...reglages, strategy: numero });
+    } catch (error) {
+        return Promise.reject(error);
+    }
+    const annuler = () => recherche.cancel();
+    if (signal) signal.addEventListener('abort', annuler, { once: true });
+
+    return recherche
+        .then(resultat => {
+            if (resultat.issue < 0) throw new TypeError(`Stratégie non disponible : ${strategy}`);
+            if (ISSUES[resultat.issue] === 'annule' && signal && signal.aborted) throw erreurAnnulation(signal);
+            return { ...resultat, issue: ISSUES[resultat.issue] };
+        })
+        .finally(() => {
+            reglee = true;
+            if (signal) signal.removeEventListener('abort', annuler);
+        });
+}
+
+// Un plan : tableau de noms d'actions, ou texte (une action par ligne ;
+// les lignes affichées par le solveur, "|  Etape 3: grasp bananas,", sont acceptées)
+const lignesDuPlan = (plan) => (Array.isArray(plan) ? plan.map(String) : String(plan).split('\n'));
+
+const statutVerification = ({ correct, steps, detail }) =>
+    correct
+        ? { status: 'Correct', steps, detail: `${steps} étape(s)` }
+        : { status: 'Incorrect', steps, detail };
+
+// Rejoue un plan sur un problème (même sémantique que verify.c) :
+// { status: 'Correct' | 'Incorrect', steps, detail }
+async function validate(problem, plan) {
+    const [resultat] = await natif.verify(problem, [lignesDuPlan(plan)]);
+    return statutVerification(resultat);
+}
+
+// Plusieurs plans contre le même problème, chargé une seule fois. Chaque
+// plan est un tableau de noms, ou une ligne d'actions séparées par ';'
+async function validateBatch(problem, plans) {
+    const lots = plans.map(plan => (Array.isArray(plan) ? plan.map(String) : String(plan).split(';')));
+    const resultats = await natif.verify(problem, lots);
+    return resultats.map(statutVerification);
+}
+
+module.exports = { solve, validate, validateBatch, STRATEGIES, ISSUES, version: natif.version };
@@ -2,8 +2,6 @@ const express = require('express');
 const cors = require('cors');
 const multer = require('multer');
 const { createClient } = require('redis');
-const { exec } = require('child_process');
-const path = require('path');
 const fs = require('fs').promises;
 const winston = require('winston');
 const rateLimit = require('express-rate-limit');
@@ -13,6 +11,11 @@ const morgan = require('morgan');
 const { v4: uuidv4 } = require('uuid');
 const chalk = require('chalk');
 const turnstileService = require('./services/turnstile');
+const PoolSolveurs = require('./services/poolSolveurs');
+const { creerTravail, lireTravail, annulerTravail, compterTravaux } = require('./services/travauxRedis');
+const { MetriquesSolveur, servirMetriques } = require('./services/metriques');
+const { erreurSolveur: erreurSolveurHttp } = require('./services/erreursSolveur');
+const SuiviTravaux = require('./services/suiviTravaux');
 require('dotenv').config();
 
 // Configuration du logger Winston
@@ -35,14 +38,36 @@ const logger = winston.createLogger({
 const app = express();
 const upload = multer({ dest: 'uploads/' });
 
+// Pool de processus solveurs, lancés dès le démarrage (voir services/poolSolveurs.js)
+const metriques = new MetriquesSolveur({ logger });
+const pool = new PoolSolveurs({ logger, metriques });
+metriques.suivrePool(pool);
+
 // Configuration Redis
 const redisClient = createClient({
-    url: process.env.REDIS_URL
+    url: process.env.REDIS_URL,
+    password: process.env.REDIS_PASSWORD
 });
 
 redisClient.on('error', err => logger.error('Redis Client Error:', err));
 redisClient.connect();
 
+// Lecteurs partagés des flux de suivi des travaux (/jobs/:id/events)
+const suiviTravaux = new SuiviTravaux({ lire: id => lireTravail(redisClient, id), logger });
+
+// Route de healthcheck (avant le rate limiting) : état du pool de solveurs,
+// 503 si aucun processus n'est prêt
+app.get('/health', (req, res) => {
+    const etat = pool.etat();
+    res.status(etat.ok ? 200 : 503).json({ status: etat.ok ? 'ok' : 'degraded', solveurs: etat });
+});
+
+// Métriques Prometheus : recherches de /content, pool de solveurs et
+// travaux asynchrones en attente ou en cours, servies sur METRICS_PORT
+// (voir le démarrage) et non par l'API ; les recherches des travaux sont
+// comptées par les solveurs (solveurTravaux.js)
+metriques.suivreTravaux(() => compterTravaux(redisClient));
+
 // Middleware de sécurité
 app.use(helmet());
 app.use(compression());
@@ -82,76 +107,295 @@ app.use((err, req, res, next) => {
 });
 
 // Routes
+
+// Annule la recherche si le client ferme la connexion avant la réponse
+const annulerSiDeconnexion = (res) => {
+    const controleur = new AbortController();
+    res.on('close', () => {
+        if (!res.writableEnded) controleur.abort();
+    });
+    return controleur.signal;
+};
+
+// Voir services/erreursSolveur.js
+const erreurSolveur = (error, contexte) => erreurSolveurHttp(error, contexte, logger);
+
+const repondreErreurSolveur = (res, error, contexte) => {
+    const erreur = erreurSolveur(error, contexte);
+    if (!erreur) return;
+    if (erreur.retryAfter) res.set('Retry-After', String(erreur.retryAfter));
+    res.status(erreur.status).json(erreur.body);
+};
+
+// Server-Sent Events : le client le demande par "Accept: text/event-stream"
+// ou ?stream=1
+const veutFlux = (req) => req.query.stream === '1' || (req.get('Accept') || '').includes('text/event-stream');
+
+// Ouvre un flux SSE sur la réponse ; envoyer(evenement, donnees) écrit un
+// événement tout de suite (compression met sinon en tampon), un commentaire
+// toutes les 15s garde la connexion ouverte à travers les proxys
+const ouvrirFlux = (res) => {
+    res.status(200).set({
+        'Content-Type': 'text/event-stream; charset=utf-8',
+        'Cache-Control': 'no-cache',
+        'Connection': 'keep-alive',
+        'X-Accel-Buffering': 'no'
+    });
+    res.flushHeaders();
+    const ecrire = (texte) => {
+        if (res.writableEnded) return;
+        res.write(texte);
+        if (res.flush) res.flush();
+    };
+    const entretien = setInterval(() => ecrire(': ping\n\n'), 15000);
+    res.on('close', () => clearInterval(entretien));
+    return {
+        envoyer: (evenement, donnees) => ecrire(`event: ${evenement}\ndata: ${JSON.stringify(donnees)}\n\n`),
+        fermer: () => {
+            clearInterval(entretien);
+            if (!res.writableEnded) res.end();
+        }
+    };
+};
+
+// Problème d'une requête : fichier "file" ou champ JSON "content" (null si absent)
+const lireProbleme = async (req) => {
+    let problemText = req.body && req.body.content;
+    if (req.file) {
+        logger.info(`${chalk.blue('Processing file:')} ${req.file.originalname}`);
+        problemText = await fs.readFile(req.file.path, 'utf8');
+        await fs.unlink(req.file.path);
+    }
+    return typeof problemText === 'string' && problemText.length > 0 ? problemText : null;
+};
+
+// Options de recherche facultatives : strategy, timeoutMs, maxNodes, seed et optimize
+const optionsRecherche = (body, timeoutParDefaut) => {
+    const { strategy, timeoutMs, maxNodes, seed, optimize } = body || {};
+    const nombre = (v) => (v === undefined || v === '' ? undefined : Number(v));
+    return {
+        strategy: strategy === undefined || strategy === '' ? 'normal' : (isNaN(strategy) ? strategy : Number(strategy)),
+        timeoutMs: nombre(timeoutMs) ?? timeoutParDefaut,
+        maxNodes: nombre(maxNodes),
+        seed: seed === '' ? undefined : seed,
+        optimize: nombre(optimize) ?? 1
+    };
+};
+
+// Résout un problème : fichier "file" ou champ JSON "content" et options
+// de recherche. La recherche tourne dans un processus du pool de solveurs.
+// En flux SSE (voir veutFlux), la réponse envoie des événements progress
+// (avancement, environ chaque seconde) et plan (plans intermédiaires d'une
+// recherche anytime), puis result ou error ; fermer la connexion annule.
 app.post('/content', upload.single('file'), async (req, res) => {
     const startTime = Date.now();
+    let flux = null;
     try {
-        if (!req.file) {
-            logger.warn(`${chalk.yellow('Warning:')} Aucun fichier fourni pour /content`);
+        const problemText = await lireProbleme(req);
+        if (!problemText) {
+            logger.warn(`${chalk.yellow('Warning:')} Aucun problème fourni pour /content`);
             return res.status(400).json({ error: 'Aucun fichier fourni' });
         }
 
-        logger.info(`${chalk.blue('Processing file:')} ${req.file.originalname}`);
-        const fileContent = await fs.readFile(req.file.path, 'utf8');
-        const scriptPath = path.join(__dirname, '../src/scripts/main.c');
-        
-        exec(`gcc ${scriptPath} -o main && ./main "${fileContent}"`, async (error, stdout, stderr) => {
-            const duration = Date.now() - startTime;
-            
-            if (error) {
-                logger.error(`${chalk.red('Error:')} Erreur lors de l'exécution du script: ${error.message}`);
-                return res.status(500).json({ error: 'Erreur lors de l\'exécution du script' });
-            }
+        const options = optionsRecherche(req.body, 30000);
+        const rappels = { signal: annulerSiDeconnexion(res) };
+        // Pool saturé : 503 ordinaire plutôt qu'un flux aussitôt fermé
+        if (veutFlux(req) && !pool.sature()) {
+            flux = ouvrirFlux(res);
+            rappels.surProgression = (instantane) => flux.envoyer('progress', instantane);
+            rappels.surPlan = (plan, infos) => flux.envoyer('plan', { plan, ...infos });
+        }
+        const result = await pool.soumettre('solve', [problemText, options], rappels);
 
-            await fs.unlink(req.file.path);
-            logger.info(`${chalk.green('Success:')} Fichier traité en ${duration}ms`);
+        const duration = Date.now() - startTime;
+        logger.info(`${chalk.green('Success:')} Problème résolu en ${duration}ms (${result.message})`);
+        const lignes = result.plan
+            ? result.plan.map((action, index) => `Etape ${index + 1}: ${action}`)
+            : [`Aucune solution trouvée : ${result.message}`];
+        if (flux) {
+            flux.envoyer('result', { ...result, result: lignes.join('\n') });
+            return flux.fermer();
+        }
+        res.json({ ...result, result: lignes.join('\n') });
+    } catch (error) {
+        if (!flux) return repondreErreurSolveur(res, error, '/content');
+        const erreur = erreurSolveur(error, '/content');
+        if (erreur) flux.envoyer('error', { status: erreur.status, ...erreur.body });
+        flux.fermer();
+    }
+});
 
-            const actions = stdout.trim().split('\n').reduce((acc, line, index) => {
-                acc[index + 1] = line;
-                return acc;
-            }, {});
+// Travaux asynchrones pour les recherches longues (voir services/travauxRedis.js) :
+// mêmes entrées que /content, timeoutMs par défaut JOBS_MAX_TIMEOUT_MS.
+// La réponse 202 donne l'identifiant à suivre avec GET /jobs/:id (ou /jobs/:id/events).
+app.post('/jobs', upload.single('file'), async (req, res) => {
+    try {
+        const problemText = await lireProbleme(req);
+        if (!problemText) {
+            logger.warn(`${chalk.yellow('Warning:')} Aucun problème fourni pour /jobs`);
+            return res.status(400).json({ error: 'Aucun fichier fourni' });
+        }
+        const jobId = await creerTravail(redisClient, problemText, optionsRecherche(req.body, 0));
+        logger.info(`${chalk.green('Success:')} Travail ${chalk.yellow(jobId)} en file`);
+        res.set('Location', `/jobs/${jobId}`);
+        res.status(202).json({ jobId, status: 'queued' });
+    } catch (error) {
+        repondreErreurSolveur(res, error, '/jobs');
+    }
+});
 
-            res.json(actions);
-        });
+// État d'un travail : status, progress (temps écoulé, plans trouvés), best
+// (meilleur plan jusqu'ici), puis result ou error ; 404 s'il a expiré
+app.get('/jobs/:id', async (req, res) => {
+    try {
+        const travail = await lireTravail(redisClient, req.params.id);
+        if (!travail) return res.status(404).json({ error: 'Travail inconnu ou expiré' });
+        res.json(travail);
     } catch (error) {
-        logger.error(`${chalk.red('Error:')} ${error.message}`);
-        res.status(500).json({ error: 'Erreur serveur' });
+        repondreErreurSolveur(res, error, '/jobs/:id');
     }
 });
 
-app.post('/verify', upload.single('file'), async (req, res) => {
-    const startTime = Date.now();
+// Suivi d'un travail en flux SSE : événements status, progress et plan à
+// chaque changement (Redis lu chaque seconde, une seule fois pour tous les
+// flux du même travail), puis result, ou error avec le statut final
+// (failed, cancelled) ; 404 s'il a expiré, 503 au-delà de JOBS_EVENTS_MAX flux
+app.get('/jobs/:id/events', async (req, res) => {
+    const id = req.params.id;
     try {
-        if (!req.file) {
-            logger.warn(`${chalk.yellow('Warning:')} Aucun fichier fourni pour /verify`);
-            return res.status(400).json({ error: 'Aucun fichier fourni' });
+        if (suiviTravaux.plein()) {
+            logger.warn(`${chalk.yellow('Warning:')} Trop de flux de suivi ouverts (/jobs/:id/events)`);
+            res.set('Retry-After', '5');
+            return res.status(503).json({ error: 'Serveur surchargé, veuillez réessayer plus tard.' });
         }
+        const travail = await lireTravail(redisClient, id);
+        if (!travail) return res.status(404).json({ error: 'Travail inconnu ou expiré' });
 
-        logger.info(`${chalk.blue('Verifying file:')} ${req.file.originalname}`);
-        const fileContent = await fs.readFile(req.file.path, 'utf8');
-        const verifyScriptPath = path.join(__dirname, '../src/scripts/verify.c');
-        
-        exec(`gcc ${verifyScriptPath} -o verify && ./verify "${fileContent}"`, async (error, stdout, stderr) => {
-            const duration = Date.now() - startTime;
-            
-            if (error) {
-                logger.error(`${chalk.red('Error:')} Erreur lors de la vérification: ${error.message}`);
-                return res.status(500).json({ error: 'Something went wrong' });
+        const flux = ouvrirFlux(res);
+        const dernier = {};
+        const publier = (evenement, valeur) => {
+            const texte = JSON.stringify(valeur);
+            if (valeur === null || dernier[evenement] === texte) return;
+            dernier[evenement] = texte;
+            flux.envoyer(evenement, valeur);
+        };
+        // Publie l'état lu ; vrai si le flux est terminé
+        const suivre = (etat) => {
+            if (!etat) {
+                flux.envoyer('error', { status: 'expired', error: 'Travail inconnu ou expiré' });
+                return true;
             }
-
-            await fs.unlink(req.file.path);
-            const result = stdout.trim();
-            
-            if (result === 'Correct') {
-                logger.info(`${chalk.green('Success:')} Vérification réussie en ${duration}ms`);
-                res.status(200).json({ status: 'Correct' });
-            } else {
-                logger.warn(`${chalk.yellow('Warning:')} Vérification échouée en ${duration}ms`);
-                res.status(401).json({ status: 'Incorrect' });
+            publier('status', { status: etat.status, attempts: etat.attempts });
+            publier('progress', etat.progress);
+            publier('plan', etat.best);
+            if (etat.status === 'done') {
+                flux.envoyer('result', etat.result);
+                return true;
+            }
+            if (etat.status === 'failed' || etat.status === 'cancelled') {
+                flux.envoyer('error', { status: etat.status, ...etat.error });
+                return true;
             }
+            return false;
+        };
+        if (suivre(travail)) return flux.fermer();
+
+        const desabonner = suiviTravaux.abonner(id, (etat) => {
+            if (!suivre(etat)) return;
+            desabonner();
+            flux.fermer();
+        }, (error) => {
+            logger.error(`${chalk.red('Error:')} Suivi du travail ${id}: ${error.message}`);
+            desabonner();
+            flux.fermer();
         });
+        res.on('close', desabonner);
     } catch (error) {
-        logger.error(`${chalk.red('Error:')} ${error.message}`);
-        res.status(500).json({ error: 'Something went wrong' });
+        logger.error(`${chalk.red('Error:')} Suivi du travail ${id}: ${error.message}`);
+        if (res.headersSent) res.end();
+        else res.status(500).json({ error: 'Erreur serveur' });
+    }
+});
+
+app.delete('/jobs/:id', async (req, res) => {
+    try {
+        const status = await annulerTravail(redisClient, req.params.id);
+        if (!status) return res.status(404).json({ error: 'Travail inconnu ou expiré' });
+        logger.info(`${chalk.blue('Cancel requested:')} travail ${chalk.yellow(req.params.id)} (${status})`);
+        res.json({ jobId: req.params.id, status });
+    } catch (error) {
+        repondreErreurSolveur(res, error, '/jobs/:id');
+    }
+});
+
+const uploadVerification = upload.fields([
+    { name: 'problem', maxCount: 1 },
+    { name: 'plan', maxCount: 1 },
+    { name: 'plans', maxCount: 1 }
+]);
+
+const supprimerFichiers = async (files) => {
+    const chemins = Object.values(files || {}).flat().map(f => f.path);
+    await Promise.all(chemins.map(p => fs.unlink(p).catch(() => {})));
+};
+
+// Vérifie un plan : champs "problem" (fichier du problème) et "plan"
+// (une action par ligne). Le plan est rejoué étape par étape.
+app.post('/verify', uploadVerification, async (req, res) => {
+    const startTime = Date.now();
+    const problem = req.files && req.files.problem && req.files.problem[0];
+    const plan = req.files && req.files.plan && req.files.plan[0];
+    if (!problem || !plan) {
+        logger.warn(`${chalk.yellow('Warning:')} Fichiers 'problem' et 'plan' requis pour /verify`);
+        await supprimerFichiers(req.files);
+        return res.status(400).json({ error: 'Fichiers problem et plan requis' });
+    }
+
+    logger.info(`${chalk.blue('Verifying plan:')} ${plan.originalname} (${problem.originalname})`);
+    try {
+        const [problemText, planText] = await Promise.all([fs.readFile(problem.path, 'utf8'), fs.readFile(plan.path, 'utf8')]);
+        const { status, detail } = await pool.soumettre('validate', [problemText, planText]);
+        const duration = Date.now() - startTime;
+
+        if (status === 'Correct') {
+            logger.info(`${chalk.green('Success:')} Vérification réussie en ${duration}ms`);
+            res.status(200).json({ status, detail });
+        } else {
+            logger.warn(`${chalk.yellow('Warning:')} Vérification échouée en ${duration}ms: ${detail}`);
+            res.status(401).json({ status, detail });
+        }
+    } catch (error) {
+        repondreErreurSolveur(res, error, '/verify');
+    } finally {
+        await supprimerFichiers(req.files);
+    }
+});
+
+// Vérifie un lot de plans contre un même problème : champs "problem" et
+// "plans" (un plan par ligne, actions séparées par ';')
+app.post('/verify-batch', uploadVerification, async (req, res) => {
+    const startTime = Date.now();
+    const problem = req.files && req.files.problem && req.files.problem[0];
+    const plans = req.files && req.files.plans && req.files.plans[0];
+    if (!problem || !plans) {
+        logger.warn(`${chalk.yellow('Warning:')} Fichiers 'problem' et 'plans' requis pour /verify-batch`);
+        await supprimerFichiers(req.files);
+        return res.status(400).json({ error: 'Fichiers problem et plans requis' });
+    }
+
+    try {
+        const [problemText, plansText] = await Promise.all([fs.readFile(problem.path, 'utf8'), fs.readFile(plans.path, 'utf8')]);
+        const lignes = plansText.length > 0 ? plansText.replace(/\n$/, '').split('\n') : [];
+        const results = (await pool.soumettre('validateBatch', [problemText, lignes])).map(({ status, steps, detail }) =>
+            status === 'Correct' ? { status, steps } : { status, detail });
+        const duration = Date.now() - startTime;
+        const valid = results.filter(r => r.status === 'Correct').length;
+        logger.info(`${chalk.green('Success:')} ${results.length} plans vérifiés (${valid} corrects) en ${duration}ms`);
+        res.json({ total: results.length, valid, results });
+    } catch (error) {
+        repondreErreurSolveur(res, error, '/verify-batch');
+    } finally {
+        await supprimerFichiers(req.files);
     }
 });
 
@@ -223,6 +467,19 @@ app.post('/check', async (req, res) => {
 
 // Démarrage du serveur
 const PORT = process.env.PORT || 4000;
-app.listen(PORT, () => {
+const server = app.listen(PORT, () => {
     logger.info(`${chalk.green('Server started on port')} ${chalk.blue(PORT)}`);
-}); 
\ No newline at end of file
+});
+const serveurMetriques = process.env.METRICS_PORT
+    ? servirMetriques(metriques, Number(process.env.METRICS_PORT), logger)
+    : null;
+
+// Arrêt propre : plus de nouvelles requêtes, les recherches en cours se terminent
+const arreter = (signal) => {
+    logger.info(`${chalk.yellow(signal)} reçu, arrêt du serveur`);
+    server.close();
+    if (serveurMetriques) serveurMetriques.close();
+    pool.fermer().then(() => process.exit(0));
+};
+process.on('SIGTERM', () => arreter('SIGTERM'));
+process.on('SIGINT', () => arreter('SIGINT')); 
\ No newline at end of file
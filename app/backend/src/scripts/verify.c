@@ -1,24 +1,189 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <time.h>
 
-int is_terminable(const char* content) {
-    // Implémentez ici votre logique de vérification
-    // Pour l'exemple, on vérifie simplement si le contenu n'est pas vide
-    return strlen(content) > 0;
+#include "gps.h"
+
+// ---------------------------------------------------------------------
+// Validateur de plans GPS
+// ---------------------------------------------------------------------
+// Charge un problème avec le lecteur du solveur (libgps, data/Part_Bonus)
+// puis rejoue un plan avec GpsVerifierPlanNoms : même format accepté, mêmes
+// erreurs de chargement (ligne:colonne) et même sémantique que CanApply /
+// ApplyAction. La première étape fautive est signalée.
+//
+// Compilation :
+//   gcc -O2 -DGPS_BIBLIOTHEQUE -I../../data/Part_Bonus src/scripts/verify.c
+//       ../../data/Part_Bonus/main.c -o verify -lm -lpthread
+//
+// Utilisation :
+//   verify <probleme.txt> <plan.txt>
+//       Un plan : une action par ligne. Les lignes affichées par le
+//       solveur ("|  Etape 3: grasp bananas,") sont acceptées telles quelles.
+//       Affiche "Correct" ou "Incorrect" suivi de la raison.
+//   verify --batch <probleme.txt> [plans.txt]
+//       Un plan par ligne (actions séparées par ';'), lus dans plans.txt ou
+//       sur l'entrée standard. Une réponse par ligne, dans le même ordre.
+
+// Découpe texte[0..taille) en étapes terminées par separateur ; les
+// séparateurs sont remplacés par '\0'. Renvoie le nombre d'étapes, -1 si la
+// mémoire manque (*etapes à libérer par l'appelant)
+static int DecouperEtapes(char* texte, size_t taille, char separateur, const char*** etapes) {
+    int nb = 1;
+    for (size_t i = 0; i < taille; i++) {
+        if (texte[i] == separateur) nb++;
+    }
+    *etapes = malloc(sizeof(const char*) * nb);
+    if (!*etapes) return -1;
+
+    int k = 0;
+    (*etapes)[k++] = texte;
+    for (size_t i = 0; i < taille; i++) {
+        if (texte[i] == separateur) {
+            texte[i] = '\0';
+            (*etapes)[k++] = texte + i + 1;
+        }
+    }
+    texte[taille] = '\0';
+    return nb;
+}
+
+static char* LireFichierComplet(const char* nomFichier, size_t* taille) {
+    FILE* fichier = fopen(nomFichier, "rb");
+    if (!fichier) return NULL;
+    fseek(fichier, 0, SEEK_END);
+    long longueur = ftell(fichier);
+    fseek(fichier, 0, SEEK_SET);
+    char* texte = longueur >= 0 ? malloc((size_t)longueur + 1) : NULL;
+    if (!texte) {
+        fclose(fichier);
+        return NULL;
+    }
+    *taille = fread(texte, 1, (size_t)longueur, fichier);
+    texte[*taille] = '\0';
+    fclose(fichier);
+    return texte;
+}
+
+static int VerifierPlan(const GpsProbleme* pb, const char* nomPlan) {
+    size_t taille;
+    char* texte = LireFichierComplet(nomPlan, &taille);
+    if (!texte) {
+        printf("Erreur: impossible de lire '%s'\n", nomPlan);
+        return 2;
+    }
+
+    const char** etapes;
+    int nbEtapes = DecouperEtapes(texte, taille, '\n', &etapes);
+    if (nbEtapes < 0) {
+        printf("Erreur: mémoire insuffisante\n");
+        free(texte);
+        return 2;
+    }
+
+    GpsVerification v;
+    if (GpsVerifierPlanNoms(pb, etapes, nbEtapes, &v)) {
+        printf("Correct\n%d étape(s)\n", v.etapes);
+    } else {
+        printf("Incorrect\n%s\n", v.message);
+    }
+    free(etapes);
+    free(texte);
+    return 0;
+}
+
+// Mode batch : un plan par ligne, actions séparées par ';'
+static int VerifierLot(const GpsProbleme* pb, FILE* entree) {
+    size_t capacite = 65536;
+    char* ligne = malloc(capacite);
+    if (!ligne) {
+        printf("Erreur: mémoire insuffisante\n");
+        return 2;
+    }
+
+    long nbPlans = 0, nbCorrects = 0;
+    clock_t debut = clock();
+    for (;;) {
+        // Lecture d'une ligne complète, quelle que soit sa longueur
+        size_t lu = 0;
+        int c = EOF;
+        while ((c = getc(entree)) != EOF && c != '\n') {
+            if (lu + 1 == capacite) {
+                char* plusGrand = realloc(ligne, capacite * 2);
+                if (!plusGrand) {
+                    printf("Erreur: mémoire insuffisante\n");
+                    free(ligne);
+                    return 2;
+                }
+                ligne = plusGrand;
+                capacite *= 2;
+            }
+            ligne[lu++] = (char)c;
+        }
+        if (c == EOF && lu == 0) break;
+
+        const char** etapes;
+        int nbEtapes = DecouperEtapes(ligne, lu, ';', &etapes);
+        if (nbEtapes < 0) {
+            printf("Erreur: mémoire insuffisante\n");
+            free(ligne);
+            return 2;
+        }
+        GpsVerification v;
+        nbPlans++;
+        if (GpsVerifierPlanNoms(pb, etapes, nbEtapes, &v)) {
+            nbCorrects++;
+            printf("Correct %d\n", v.etapes);
+        } else {
+            printf("Incorrect %s\n", v.message);
+        }
+        free(etapes);
+        if (c == EOF) break;
+    }
+
+    double ms = (double)(clock() - debut) * 1000.0 / CLOCKS_PER_SEC;
+    fprintf(stderr, "%ld plan(s) vérifié(s), %ld correct(s), %.2f ms\n", nbPlans, nbCorrects, ms);
+    free(ligne);
+    return 0;
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 2) {
+    bool lot = argc >= 3 && strcmp(argv[1], "--batch") == 0;
+    if (!(lot && argc <= 4) && !(!lot && argc == 3)) {
         printf("Something went wrong\n");
+        fprintf(stderr, "Usage: %s <probleme.txt> <plan.txt>\n", argv[0]);
+        fprintf(stderr, "       %s --batch <probleme.txt> [plans.txt]\n", argv[0]);
         return 1;
     }
 
-    if (is_terminable(argv[1])) {
-        printf("Correct\n");
+    const char* nomProbleme = lot ? argv[2] : argv[1];
+    GpsErreur erreur;
+    GpsProbleme* pb = GpsChargerFichier(nomProbleme, &erreur);
+    if (!pb) {
+        if (erreur.ligne > 0) {
+            printf("Erreur: %s:%d:%d: %s\n", nomProbleme, erreur.ligne, erreur.colonne, erreur.message);
+        } else {
+            printf("Erreur: %s: %s\n", nomProbleme, erreur.message);
+        }
+        return 2;
+    }
+
+    int code;
+    if (lot) {
+        FILE* entree = argc == 4 ? fopen(argv[3], "r") : stdin;
+        if (!entree) {
+            printf("Erreur: impossible de lire '%s'\n", argv[3]);
+            code = 2;
+        } else {
+            code = VerifierLot(pb, entree);
+            if (entree != stdin) fclose(entree);
+        }
     } else {
-        printf("Incorrect\n");
+        code = VerifierPlan(pb, argv[2]);
     }
 
-    return 0;
-} 
\ No newline at end of file
+    GpsLibererProbleme(pb);
+    return code;
+}
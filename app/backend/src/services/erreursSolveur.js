@@ -0,0 +1,31 @@
+const chalk = require('chalk');
+
+// Réponse HTTP d'une erreur du solveur : erreur de chargement du problème
+// (ligne et colonne), pool saturé, file des travaux pleine ou échéance
+// dépassée, ou autre erreur : { status, body, retryAfter }, null si la
+// recherche a été annulée par le client
+const erreurSolveur = (error, contexte, logger) => {
+    if (error.code === 'POOL_SATURE' || error.code === 'POOL_FERME' || error.code === 'FILE_PLEINE') {
+        logger.warn(`${chalk.yellow('Warning:')} Solveurs indisponibles (${contexte}): ${error.message}`);
+        return { status: 503, body: { error: 'Serveur surchargé, veuillez réessayer plus tard.' }, retryAfter: error.retryAfter || 5 };
+    }
+    if (error.code === 'DELAI_DEPASSE') {
+        logger.warn(`${chalk.yellow('Warning:')} Échéance dépassée (${contexte})`);
+        return { status: 504, body: { error: 'Délai de résolution dépassé' } };
+    }
+    if (error.code === 'GPS_PARSE') {
+        logger.warn(`${chalk.yellow('Warning:')} Problème invalide (${contexte}): ${error.message}`);
+        return { status: 400, body: { error: 'Problème invalide', detail: error.message, line: error.line, column: error.column } };
+    }
+    if (error.name === 'AbortError') {
+        logger.warn(`${chalk.yellow('Warning:')} Recherche annulée (${contexte}), client déconnecté`);
+        return null;
+    }
+    if (error instanceof TypeError || error instanceof RangeError) {
+        return { status: 400, body: { error: error.message } };
+    }
+    logger.error(`${chalk.red('Error:')} ${error.message}`);
+    return { status: 500, body: { error: 'Erreur serveur' } };
+};
+
+module.exports = { erreurSolveur };
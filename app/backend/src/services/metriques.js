@@ -0,0 +1,240 @@
+// Métriques du solveur au format texte de Prometheus (version 0.0.4),
+// servies par GET /metrics sur un port interne (voir servirMetriques) :
+// histogrammes des recherches (durée, noeuds développés, longueur du plan,
+// pic de mémoire) par stratégie et par issue, et jauges du pool de
+// solveurs lues au moment de la collecte.
+const http = require('http');
+
+const TYPE_CONTENU = 'text/plain; version=0.0.4; charset=utf-8';
+
+// Stratégies de native/index.js, par nom et par numéro : toute autre valeur
+// est comptée sous "inconnue", pour borner le nombre de séries
+const STRATEGIES = ['normal', 'melange', 'aleatoire', 'priorite', 'fin-moyens', 'anytime', null, null, 'glouton'];
+
+const strategieMetrique = (strategie) => {
+    if (strategie === undefined) return 'normal';
+    if (typeof strategie === 'number') return STRATEGIES[strategie] || 'inconnue';
+    return STRATEGIES.includes(strategie) ? strategie : 'inconnue';
+};
+
+// Issue d'une recherche terminée : un plan rendu compte comme résolu, même
+// si la recherche anytime s'est arrêtée sur son délai
+const issueMetrique = (erreur, valeur) => {
+    if (erreur) {
+        if (erreur.code === 'DELAI_DEPASSE') return 'timeout';
+        if (erreur.name === 'AbortError') return 'cancelled';
+        if (erreur.code === 'GPS_PARSE' || erreur instanceof TypeError || erreur instanceof RangeError) return 'invalid';
+        return 'error';
+    }
+    if (valeur.plan) return 'solved';
+    switch (valeur.issue) {
+        case 'sans_solution': return 'unsolvable';
+        case 'delai': return 'timeout';
+        case 'budget_noeuds':
+        case 'budget_memoire': return 'budget_exhausted';
+        case 'annule': return 'cancelled';
+        default: return 'incomplete';
+    }
+};
+
+const echapper = (valeur) => String(valeur).replace(/\\/g, '\\\\').replace(/\n/g, '\\n').replace(/"/g, '\\"');
+
+const etiquettesTexte = (etiquettes) => {
+    const paires = Object.entries(etiquettes).map(([cle, valeur]) => `${cle}="${echapper(valeur)}"`);
+    return paires.length > 0 ? `{${paires.join(',')}}` : '';
+};
+
+const nombreTexte = (n) => (n === Infinity ? '+Inf' : n === -Infinity ? '-Inf' : String(n));
+
+// Seuils géométriques : debut, debut * facteur, ... (nb seuils)
+const seuilsGeometriques = (debut, facteur, nb) => Array.from({ length: nb }, (_, i) => debut * facteur ** i);
+
+// 1) Types de métriques
+
+class Histogramme {
+    constructor(nom, aide, seuils) {
+        this.nom = nom;
+        this.aide = aide;
+        this.seuils = seuils;
+        this.series = new Map();
+    }
+
+    observer(etiquettes, valeur) {
+        const cle = etiquettesTexte(etiquettes);
+        let serie = this.series.get(cle);
+        if (!serie) {
+            serie = { etiquettes, compteurs: new Array(this.seuils.length).fill(0), somme: 0, nombre: 0 };
+            this.series.set(cle, serie);
+        }
+        const index = this.seuils.findIndex(seuil => valeur <= seuil);
+        if (index !== -1) serie.compteurs[index]++;
+        serie.somme += valeur;
+        serie.nombre++;
+    }
+
+    lignes() {
+        const lignes = [`# HELP ${this.nom} ${this.aide}`, `# TYPE ${this.nom} histogram`];
+        for (const { etiquettes, compteurs, somme, nombre } of this.series.values()) {
+            let cumul = 0;
+            this.seuils.forEach((seuil, i) => {
+                cumul += compteurs[i];
+                lignes.push(`${this.nom}_bucket${etiquettesTexte({ ...etiquettes, le: nombreTexte(seuil) })} ${cumul}`);
+            });
+            lignes.push(`${this.nom}_bucket${etiquettesTexte({ ...etiquettes, le: '+Inf' })} ${nombre}`);
+            lignes.push(`${this.nom}_sum${etiquettesTexte(etiquettes)} ${somme}`);
+            lignes.push(`${this.nom}_count${etiquettesTexte(etiquettes)} ${nombre}`);
+        }
+        return lignes;
+    }
+}
+
+// Jauge ou compteur dont la valeur est lue à la collecte : lire() rend un
+// nombre ou une liste de { etiquettes, valeur } (éventuellement une promesse)
+class MetriqueLue {
+    constructor(nom, aide, type, lire) {
+        this.nom = nom;
+        this.aide = aide;
+        this.type = type;
+        this.lire = lire;
+    }
+
+    async lignes() {
+        const lu = await this.lire();
+        const series = typeof lu === 'number' ? [{ etiquettes: {}, valeur: lu }] : lu;
+        return [
+            `# HELP ${this.nom} ${this.aide}`,
+            `# TYPE ${this.nom} ${this.type}`,
+            ...series.map(({ etiquettes, valeur }) => `${this.nom}${etiquettesTexte(etiquettes)} ${nombreTexte(valeur)}`)
+        ];
+    }
+}
+
+// 2) Métriques du solveur
+
+class MetriquesSolveur {
+    constructor({ logger } = {}) {
+        this.logger = logger || console;
+        this.metriques = [];
+        // Numéro de la collecte en cours (voir parCollecte)
+        this.collectes = 0;
+        this.duree = this.ajouter(new Histogramme('gps_solve_duration_seconds',
+            'Durée des recherches, attente dans la file comprise',
+            [0.005, 0.01, 0.025, 0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300, 600]));
+        this.noeuds = this.ajouter(new Histogramme('gps_solve_expanded_nodes',
+            'Noeuds développés par recherche', seuilsGeometriques(10, 10, 8)));
+        this.longueur = this.ajouter(new Histogramme('gps_solve_plan_length',
+            'Longueur des plans trouvés (après optimisation)', [1, 2, 5, 10, 20, 50, 100, 200, 500, 1000]));
+        this.memoire = this.ajouter(new Histogramme('gps_solve_peak_bytes',
+            'Pic de mémoire des états d\'une recherche', seuilsGeometriques(1024, 4, 12)));
+    }
+
+    ajouter(metrique) {
+        this.metriques.push(metrique);
+        return metrique;
+    }
+
+    // Jauge ou compteur lu à la collecte (voir MetriqueLue)
+    jauge(nom, aide, lire) {
+        return this.ajouter(new MetriqueLue(nom, aide, 'gauge', lire));
+    }
+
+    compteur(nom, aide, lire) {
+        return this.ajouter(new MetriqueLue(nom, aide, 'counter', lire));
+    }
+
+    // Lecture partagée par plusieurs métriques : faite une seule fois par
+    // collecte, à la première métrique qui la demande
+    parCollecte(lire) {
+        let collecte = -1;
+        let lu = null;
+        return () => {
+            if (collecte !== this.collectes) {
+                collecte = this.collectes;
+                lu = Promise.resolve().then(lire);
+            }
+            return lu;
+        };
+    }
+
+    // Recherche terminée (appelée par le pool) : options de la recherche,
+    // erreur ou résultat de native/index.js, durée depuis la soumission
+    observerRecherche(options, erreur, valeur, dureeMs) {
+        // Tâche rejetée à l'arrêt du pool : aucune recherche n'a eu lieu
+        if (erreur && erreur.code === 'POOL_FERME') return;
+        const etiquettes = {
+            strategy: strategieMetrique(options && options.strategy),
+            outcome: issueMetrique(erreur, valeur)
+        };
+        this.duree.observer(etiquettes, dureeMs / 1000);
+        if (!valeur || !valeur.stats) return;
+        this.noeuds.observer(etiquettes, valeur.stats.nodes);
+        if (valeur.stats.peakBytes > 0) this.memoire.observer(etiquettes, valeur.stats.peakBytes);
+        if (valeur.plan) this.longueur.observer(etiquettes, valeur.plan.length);
+    }
+
+    // Jauges et compteurs du pool de solveurs
+    suivrePool(pool) {
+        this.jauge('gps_pool_workers', 'Processus solveurs prévus', () => pool.taille);
+        this.jauge('gps_pool_workers_ready', 'Processus solveurs prêts', () => pool.etat().prets);
+        this.jauge('gps_pool_workers_busy', 'Processus solveurs occupés par une tâche', () => pool.etat().occupes);
+        this.jauge('gps_pool_utilization_ratio', 'Part des processus occupés', () => pool.etat().occupes / pool.taille);
+        this.compteur('gps_pool_busy_seconds_total', 'Temps passé par les processus sur des tâches',
+            () => pool.occupeMs / 1000);
+        this.jauge('gps_pool_queue_depth', 'Tâches en attente d\'un processus', () => pool.file.length);
+        this.jauge('gps_pool_queue_capacity', 'Tâches en attente au plus', () => pool.fileMax);
+        this.compteur('gps_pool_tasks_total', 'Tâches du pool par devenir', () => [
+            { etiquettes: { result: 'done' }, valeur: pool.compteurs.traitees },
+            { etiquettes: { result: 'rejected' }, valeur: pool.compteurs.rejetees },
+            { etiquettes: { result: 'expired' }, valeur: pool.compteurs.expirees }
+        ]);
+        this.compteur('gps_pool_worker_recycles_total', 'Processus recyclés', () => pool.compteurs.recyclages);
+        this.compteur('gps_pool_worker_losses_total', 'Processus arrêtés de façon inattendue', () => pool.compteurs.pertes);
+    }
+
+    // Jauges des travaux asynchrones : compter() rend { enAttente, enCours }
+    // (compterTravaux de travauxRedis.js), lu une fois par collecte
+    suivreTravaux(compter) {
+        const lire = this.parCollecte(compter);
+        this.jauge('gps_jobs_queued', 'Travaux asynchrones en attente', async () => (await lire()).enAttente);
+        this.jauge('gps_jobs_running', 'Travaux asynchrones pris par un solveur', async () => (await lire()).enCours);
+    }
+
+    // Texte de la réponse ; une métrique illisible (Redis absent...) est omise
+    async exposer() {
+        this.collectes++;
+        const lignes = [];
+        for (const metrique of this.metriques) {
+            try {
+                lignes.push(...await metrique.lignes());
+            } catch (error) {
+                this.logger.warn(`Métrique ${metrique.nom} omise: ${error.message}`);
+            }
+        }
+        return `${lignes.join('\n')}\n`;
+    }
+}
+
+// 3) Exposition
+
+// Serveur HTTP à part qui ne sert que GET /metrics, sur un port interne
+// (METRICS_PORT du serveur, SOLVER_METRICS_PORT des solveurs) : ni publié
+// sur l'hôte, ni derrière le rate limiting de l'API
+const servirMetriques = (metriques, port, logger = console) => {
+    const serveur = http.createServer(async (req, res) => {
+        if (req.method !== 'GET' || req.url !== '/metrics') {
+            res.writeHead(404).end();
+            return;
+        }
+        try {
+            const texte = await metriques.exposer();
+            res.writeHead(200, { 'Content-Type': TYPE_CONTENU }).end(texte);
+        } catch (error) {
+            logger.error(`Métriques: ${error.message}`);
+            res.writeHead(500).end();
+        }
+    });
+    serveur.on('error', error => logger.error(`Métriques (port ${port}): ${error.message}`));
+    return serveur.listen(port);
+};
+
+module.exports = { MetriquesSolveur, TYPE_CONTENU, issueMetrique, strategieMetrique, servirMetriques };
@@ -0,0 +1,341 @@
+const { fork } = require('child_process');
+const os = require('os');
+const path = require('path');
+
+// Pool de solveurs : un nombre fixe de processus (travailleurSolveur.js),
+// lancés au démarrage et qui gardent le module natif chargé, alimentés par
+// une file d'attente bornée. Chaque processus traite une tâche à la fois :
+// le nombre de recherches simultanées ne dépasse jamais la taille du pool,
+// et une recherche qui épuise la mémoire ou plante n'emporte pas le serveur.
+//
+// Réglages (variables d'environnement, sinon valeurs par défaut) :
+//   SOLVER_WORKERS            processus du pool (nombre de coeurs)
+//   SOLVER_QUEUE_MAX          tâches en attente au plus (4 par processus)
+//   SOLVER_JOB_DEADLINE_MS    échéance d'une tâche, attente comprise (60000)
+//   SOLVER_WORKER_MAX_JOBS    tâches avant recyclage d'un processus (200)
+//   SOLVER_WORKER_MAX_RSS_MB  mémoire résidente avant recyclage (512)
+
+const SCRIPT_TRAVAILLEUR = path.join(__dirname, 'travailleurSolveur.js');
+
+// Délai laissé au solveur après l'échéance pour rendre son issue 'delai'
+// avant que son processus ne soit tué
+const GRACE_MS = 2000;
+// Un processus mort moins d'une seconde après son lancement est relancé
+// avec ce délai, pour ne pas boucler sur un plantage au démarrage
+const RELANCE_MS = 1000;
+
+const entier = (valeur, defaut) => {
+    const n = parseInt(valeur, 10);
+    return Number.isInteger(n) && n > 0 ? n : defaut;
+};
+
+const erreurPool = (code, message) => Object.assign(new Error(message), { code });
+
+const erreurAnnulation = (signal) =>
+    signal.reason instanceof Error ? signal.reason : new DOMException('Recherche annulée', 'AbortError');
+
+// Reconstruit une erreur reçue d'un processus (voir serialiserErreur)
+const erreurRecue = ({ name, message, code, line, column }) => {
+    if (name === 'TypeError') return new TypeError(message);
+    if (name === 'RangeError') return new RangeError(message);
+    if (name === 'AbortError') return new DOMException(message, 'AbortError');
+    const error = Object.assign(new Error(message), { name });
+    if (code !== undefined) Object.assign(error, { code, line, column });
+    return error;
+};
+
+class PoolSolveurs {
+    constructor(options = {}) {
+        const coeurs = typeof os.availableParallelism === 'function' ? os.availableParallelism() : os.cpus().length;
+        this.taille = options.taille || entier(process.env.SOLVER_WORKERS, coeurs);
+        this.fileMax = options.fileMax || entier(process.env.SOLVER_QUEUE_MAX, 4 * this.taille);
+        this.delaiMs = options.delaiMs || entier(process.env.SOLVER_JOB_DEADLINE_MS, 60000);
+        this.tachesMax = options.tachesMax || entier(process.env.SOLVER_WORKER_MAX_JOBS, 200);
+        this.rssMax = (options.rssMaxMo || entier(process.env.SOLVER_WORKER_MAX_RSS_MB, 512)) * 1024 * 1024;
+        this.logger = options.logger || console;
+        // Script des processus (les tests y substituent un faux solveur)
+        this.script = options.script || SCRIPT_TRAVAILLEUR;
+        // MetriquesSolveur (services/metriques.js) qui reçoit chaque recherche terminée
+        this.metriques = options.metriques || null;
+
+        this.travailleurs = [];
+        this.file = [];
+        this.prochainId = 1;
+        this.ferme = false;
+        // Durée moyenne d'une tâche (moyenne glissante), pour Retry-After
+        this.dureeMoyenneMs = 1000;
+        this.compteurs = { traitees: 0, rejetees: 0, expirees: 0, recyclages: 0, pertes: 0 };
+        // Temps cumulé des processus sur leurs tâches (taux d'occupation)
+        this.occupeMs = 0;
+
+        for (let i = 0; i < this.taille; i++) this.demarrerTravailleur();
+    }
+
+    // Soumet une tâche ('solve', 'validate' ou 'validateBatch', mêmes
+    // arguments que native/index.js). options : signal (AbortSignal),
+    // delaiMs (échéance, attente dans la file comprise), surPlan(plan,
+    // infos) pour les plans intermédiaires d'une recherche anytime et
+    // surProgression(instantane) pour son avancement (onProgress).
+    // Rejette avec code 'POOL_SATURE' (et retryAfter, en secondes) si la
+    // file est pleine, 'DELAI_DEPASSE' si l'échéance passe, 'POOL_FERME'
+    // pendant l'arrêt et 'TRAVAILLEUR_PERDU' si le processus meurt.
+    soumettre(nature, args, { signal, delaiMs, surPlan, surProgression } = {}) {
+        if (this.ferme) return Promise.reject(erreurPool('POOL_FERME', 'Pool de solveurs arrêté'));
+        if (signal && signal.aborted) return Promise.reject(erreurAnnulation(signal));
+        if (this.file.length >= this.fileMax) {
+            this.compteurs.rejetees++;
+            const error = erreurPool('POOL_SATURE', 'Trop de recherches en attente');
+            error.retryAfter = this.estimerAttente();
+            return Promise.reject(error);
+        }
+
+        return new Promise((resolve, reject) => {
+            const tache = {
+                id: this.prochainId++,
+                nature,
+                args,
+                resolve,
+                reject,
+                signal,
+                surPlan,
+                surProgression,
+                soumise: Date.now(),
+                echeance: Date.now() + (delaiMs || this.delaiMs),
+                travailleur: null,
+                minuteur: null
+            };
+            tache.minuteur = setTimeout(() => this.echeanceAtteinte(tache), tache.echeance - Date.now());
+            if (signal) {
+                tache.surAbandon = () => this.abandonner(tache);
+                signal.addEventListener('abort', tache.surAbandon, { once: true });
+            }
+            this.file.push(tache);
+            this.distribuer();
+        });
+    }
+
+    // Vrai si une nouvelle tâche serait refusée (file pleine ou pool arrêté)
+    sature() {
+        return this.ferme || this.file.length >= this.fileMax;
+    }
+
+    // État du pool pour /health
+    etat() {
+        const travailleurs = this.travailleurs.map(t => ({
+            pid: t.processus.pid,
+            pret: t.pret,
+            occupe: t.tache !== null,
+            taches: t.taches,
+            rssMo: Math.round(t.rss / (1024 * 1024))
+        }));
+        const prets = travailleurs.filter(t => t.pret).length;
+        return {
+            ok: !this.ferme && prets > 0,
+            taille: this.taille,
+            prets,
+            occupes: travailleurs.filter(t => t.occupe).length,
+            file: this.file.length,
+            fileMax: this.fileMax,
+            ...this.compteurs,
+            travailleurs
+        };
+    }
+
+    // Arrêt : les tâches en attente sont rejetées, les processus terminent
+    // leur tâche en cours puis s'arrêtent (tués au bout de delaiMs)
+    fermer(delaiMs = 5000) {
+        this.ferme = true;
+        for (const tache of this.file.splice(0)) {
+            this.conclure(tache, erreurPool('POOL_FERME', 'Pool de solveurs arrêté'));
+        }
+        return Promise.all(this.travailleurs.map(t => this.arreterTravailleur(t, delaiMs)));
+    }
+
+    // 1) Processus
+
+    demarrerTravailleur() {
+        const processus = fork(this.script, [], { stdio: ['ignore', 'inherit', 'inherit', 'ipc'] });
+        const travailleur = { processus, pret: false, arret: false, tache: null, taches: 0, rss: 0, depart: Date.now() };
+        this.travailleurs.push(travailleur);
+
+        processus.on('message', (message) => {
+            if (message.type === 'pret') {
+                travailleur.pret = true;
+                this.distribuer();
+            } else if (message.type === 'plan') {
+                const tache = travailleur.tache;
+                if (tache && tache.id === message.id && tache.surPlan) tache.surPlan(message.plan, message.infos);
+            } else if (message.type === 'progression') {
+                const tache = travailleur.tache;
+                if (tache && tache.id === message.id && tache.surProgression) tache.surProgression(message.instantane);
+            } else if (message.type === 'resultat') {
+                this.tacheTerminee(travailleur, message);
+            }
+        });
+        processus.on('error', (error) => {
+            this.logger.error(`Pool de solveurs : processus ${processus.pid} : ${error.message}`);
+        });
+        processus.on('exit', (code, signal) => this.travailleurArrete(travailleur, code, signal));
+    }
+
+    travailleurArrete(travailleur, code, signal) {
+        const index = this.travailleurs.indexOf(travailleur);
+        if (index !== -1) this.travailleurs.splice(index, 1);
+        if (travailleur.tache) {
+            const tache = travailleur.tache;
+            travailleur.tache = null;
+            this.conclure(tache, erreurPool('TRAVAILLEUR_PERDU', 'Le processus du solveur s\'est arrêté'));
+        }
+        if (travailleur.arret) return; // recyclé ou arrêt du pool
+
+        this.compteurs.pertes++;
+        this.logger.warn(`Pool de solveurs : processus ${travailleur.processus.pid} arrêté (${signal || code})`);
+        if (this.ferme) return;
+        const vecu = Date.now() - travailleur.depart;
+        setTimeout(() => {
+            if (!this.ferme) this.demarrerTravailleur();
+        }, vecu < RELANCE_MS ? RELANCE_MS : 0);
+    }
+
+    // Remplace un processus qui a trop servi ou trop grossi
+    recycler(travailleur, raison) {
+        this.travailleurs.splice(this.travailleurs.indexOf(travailleur), 1);
+        this.compteurs.recyclages++;
+        this.logger.info(`Pool de solveurs : recyclage du processus ${travailleur.processus.pid} (${raison})`);
+        this.arreterTravailleur(travailleur, this.delaiMs);
+        this.demarrerTravailleur();
+    }
+
+    // Le processus s'arrête de lui-même à la déconnexion du canal, après
+    // sa tâche en cours (voir tacheTerminee) ; il est tué au bout de delaiMs
+    arreterTravailleur(travailleur, delaiMs) {
+        const { processus } = travailleur;
+        travailleur.arret = true;
+        if (processus.exitCode !== null || processus.signalCode !== null) return Promise.resolve();
+        return new Promise((resolve) => {
+            const tuer = setTimeout(() => processus.kill('SIGKILL'), delaiMs);
+            processus.once('exit', () => {
+                clearTimeout(tuer);
+                resolve();
+            });
+            if (travailleur.tache === null && processus.connected) processus.disconnect();
+        });
+    }
+
+    // 2) Tâches
+
+    distribuer() {
+        while (this.file.length > 0) {
+            const travailleur = this.travailleurs.find(t => t.pret && t.tache === null);
+            if (!travailleur) return;
+            const tache = this.file.shift();
+            const restant = tache.echeance - Date.now();
+            if (restant <= 0) {
+                this.expirer(tache);
+                continue;
+            }
+
+            // Le délai de la recherche ne dépasse pas celui de la tâche
+            let args = tache.args;
+            if (tache.nature === 'solve') {
+                const options = args[1] || {};
+                const demande = options.timeoutMs > 0 ? options.timeoutMs : Infinity;
+                args = [args[0], { ...options, timeoutMs: Math.min(demande, restant) }];
+            }
+            tache.travailleur = travailleur;
+            tache.debut = Date.now();
+            travailleur.tache = tache;
+            travailleur.processus.send({
+                type: 'tache',
+                id: tache.id,
+                nature: tache.nature,
+                args,
+                plans: Boolean(tache.surPlan),
+                progression: Boolean(tache.surProgression)
+            });
+        }
+    }
+
+    tacheTerminee(travailleur, message) {
+        const tache = travailleur.tache;
+        if (!tache || tache.id !== message.id) return;
+        travailleur.tache = null;
+        travailleur.taches++;
+        travailleur.rss = message.rss;
+        this.compteurs.traitees++;
+        this.dureeMoyenneMs = 0.8 * this.dureeMoyenneMs + 0.2 * (Date.now() - tache.debut);
+
+        this.conclure(tache, message.ok ? null : erreurRecue(message.erreur), message.valeur);
+
+        if (travailleur.arret) {
+            if (travailleur.processus.connected) travailleur.processus.disconnect();
+        } else if (travailleur.taches >= this.tachesMax) {
+            this.recycler(travailleur, `${travailleur.taches} tâches`);
+        } else if (travailleur.rss > this.rssMax) {
+            this.recycler(travailleur, `${Math.round(travailleur.rss / (1024 * 1024))} Mo`);
+        }
+        this.distribuer();
+    }
+
+    // Échéance d'une tâche : en attente, elle est rejetée ; en cours, le
+    // solveur a reçu le même délai et doit rendre la main, sinon son
+    // processus est tué après GRACE_MS
+    echeanceAtteinte(tache) {
+        const index = this.file.indexOf(tache);
+        if (index !== -1) {
+            this.file.splice(index, 1);
+            this.expirer(tache);
+            return;
+        }
+        const travailleur = tache.travailleur;
+        if (!travailleur || travailleur.tache !== tache) return;
+        tache.minuteur = setTimeout(() => {
+            if (travailleur.tache !== tache) return;
+            // Retiré du pool avant d'être tué : aucune tâche ne lui est plus
+            // confiée d'ici son 'exit', qui ne compte pas comme une perte
+            this.travailleurs.splice(this.travailleurs.indexOf(travailleur), 1);
+            travailleur.pret = false;
+            travailleur.arret = true;
+            travailleur.tache = null;
+            this.logger.warn(`Pool de solveurs : processus ${travailleur.processus.pid} tué (échéance dépassée)`);
+            travailleur.processus.kill('SIGKILL');
+            if (!this.ferme) this.demarrerTravailleur();
+            this.expirer(tache);
+        }, GRACE_MS);
+    }
+
+    expirer(tache) {
+        this.compteurs.expirees++;
+        this.conclure(tache, erreurPool('DELAI_DEPASSE', 'Échéance de la tâche dépassée'));
+    }
+
+    // Annulation par le client : retirée de la file, ou annulée dans son processus
+    abandonner(tache) {
+        const index = this.file.indexOf(tache);
+        if (index !== -1) {
+            this.file.splice(index, 1);
+            this.conclure(tache, erreurAnnulation(tache.signal));
+        } else if (tache.travailleur && tache.travailleur.tache === tache) {
+            tache.travailleur.processus.send({ type: 'annuler', id: tache.id });
+        }
+    }
+
+    conclure(tache, erreur, valeur) {
+        clearTimeout(tache.minuteur);
+        if (tache.signal) tache.signal.removeEventListener('abort', tache.surAbandon);
+        const fin = Date.now();
+        if (tache.debut) this.occupeMs += fin - tache.debut;
+        if (this.metriques && tache.nature === 'solve') {
+            this.metriques.observerRecherche(tache.args[1], erreur, valeur, fin - tache.soumise);
+        }
+        if (erreur) tache.reject(erreur);
+        else tache.resolve(valeur);
+    }
+
+    // Secondes avant qu'une place se libère dans la file, à peu près
+    estimerAttente() {
+        return Math.max(1, Math.ceil((this.dureeMoyenneMs * (this.file.length + 1)) / (this.taille * 1000)));
+    }
+}
+
+module.exports = PoolSolveurs;
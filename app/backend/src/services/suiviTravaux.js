@@ -0,0 +1,70 @@
+// Suivi des travaux pour les flux SSE de /jobs/:id/events : un seul
+// lecteur par travail suivi, qui lit Redis toutes les periodeMs et
+// transmet l'état à tous les flux ouverts sur ce travail. Le nombre de
+// flux ouverts est borné par JOBS_EVENTS_MAX (500).
+
+const entier = (valeur, defaut) => {
+    const n = parseInt(valeur, 10);
+    return Number.isInteger(n) && n > 0 ? n : defaut;
+};
+
+class SuiviTravaux {
+    // lire(id) : promesse de l'état du travail (lireTravail), null s'il a expiré
+    constructor({ lire, periodeMs = 1000, fluxMax, logger } = {}) {
+        this.lire = lire;
+        this.periodeMs = periodeMs;
+        this.fluxMax = fluxMax || entier(process.env.JOBS_EVENTS_MAX, 500);
+        this.logger = logger || console;
+        // id -> { abonnes: Set de { surEtat, surErreur }, minuteur }
+        this.suivis = new Map();
+        this.nbFlux = 0;
+    }
+
+    // Vrai si un flux de plus dépasserait JOBS_EVENTS_MAX
+    plein() {
+        return this.nbFlux >= this.fluxMax;
+    }
+
+    // surEtat(travail) à chaque lecture, surErreur(error) si Redis échoue ;
+    // renvoie la fonction de désabonnement (sans effet la seconde fois)
+    abonner(id, surEtat, surErreur) {
+        let suivi = this.suivis.get(id);
+        if (!suivi) {
+            suivi = { abonnes: new Set(), minuteur: null };
+            this.suivis.set(id, suivi);
+            this.planifier(id, suivi);
+        }
+        const abonne = { surEtat, surErreur };
+        suivi.abonnes.add(abonne);
+        this.nbFlux++;
+        return () => {
+            if (!suivi.abonnes.delete(abonne)) return;
+            this.nbFlux--;
+            if (suivi.abonnes.size === 0) {
+                clearTimeout(suivi.minuteur);
+                this.suivis.delete(id);
+            }
+        };
+    }
+
+    planifier(id, suivi) {
+        suivi.minuteur = setTimeout(async () => {
+            let travail;
+            try {
+                travail = await this.lire(id);
+            } catch (error) {
+                for (const abonne of [...suivi.abonnes]) abonne.surErreur(error);
+                return this.relancer(id, suivi);
+            }
+            for (const abonne of [...suivi.abonnes]) abonne.surEtat(travail);
+            this.relancer(id, suivi);
+        }, this.periodeMs);
+    }
+
+    // Lecture suivante tant que quelqu'un suit encore ce travail
+    relancer(id, suivi) {
+        if (this.suivis.get(id) === suivi && suivi.abonnes.size > 0) this.planifier(id, suivi);
+    }
+}
+
+module.exports = SuiviTravaux;
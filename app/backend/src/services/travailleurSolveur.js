@@ -0,0 +1,84 @@
+// Travailleur du pool de solveurs (voir poolSolveurs.js) : processus lancé
+// par child_process.fork, qui charge le module natif une seule fois puis
+// traite les tâches du processus principal, une à la fois.
+//
+// Messages reçus   : { type: 'tache', id, nature, args, plans, progression }
+//                    et { type: 'annuler', id }
+// Messages envoyés : { type: 'pret' } au démarrage, puis pour chaque tâche
+//                    { type: 'plan', id, plan, infos } (plans intermédiaires,
+//                    si la tâche a demandé plans: true),
+//                    { type: 'progression', id, instantane } (avancement, si
+//                    progression: true) et
+//                    { type: 'resultat', id, ok, valeur | erreur, rss }
+const fs = require('fs');
+const gps = require('../../native');
+
+// Priorités apprises de la stratégie priorite (un fichier par domaine) :
+// gardées dans SOLVER_PRIORITIES_DIR s'il est donné, tant que ce répertoire
+// compte moins de SOLVER_PRIORITIES_MAX_FILES fichiers (500) ; sinon la
+// recherche n'apprend que pour elle-même
+const REPERTOIRE_PRIORITES = process.env.SOLVER_PRIORITIES_DIR || null;
+const FICHIERS_PRIORITES_MAX = parseInt(process.env.SOLVER_PRIORITIES_MAX_FILES, 10) || 500;
+
+const repertoirePriorites = () => {
+    if (!REPERTOIRE_PRIORITES) return undefined;
+    try {
+        return fs.readdirSync(REPERTOIRE_PRIORITES).length < FICHIERS_PRIORITES_MAX ? REPERTOIRE_PRIORITES : undefined;
+    } catch (error) {
+        return undefined;
+    }
+};
+
+const natures = {
+    solve: (problemText, options, rappels) => {
+        const reglages = { ...options, ...rappels, prioritiesDir: undefined };
+        if (options.strategy === 'priorite' || options.strategy === 3) reglages.prioritiesDir = repertoirePriorites();
+        return gps.solve(problemText, reglages);
+    },
+    validate: (problem, plan) => gps.validate(problem, plan),
+    validateBatch: (problem, plans) => gps.validateBatch(problem, plans)
+};
+
+// Les erreurs traversent le canal IPC en objets simples
+const serialiserErreur = (error) => ({
+    name: error.name,
+    message: error.message,
+    code: error.code,
+    line: error.line,
+    column: error.column
+});
+
+let enCours = null;
+
+process.on('message', async (message) => {
+    if (message.type === 'annuler') {
+        if (enCours && enCours.id === message.id) enCours.controleur.abort();
+        return;
+    }
+    if (message.type !== 'tache') return;
+
+    const { id, nature, args, plans, progression } = message;
+    const controleur = new AbortController();
+    enCours = { id, controleur };
+    let reponse;
+    try {
+        const executer = natures[nature];
+        if (!executer) throw new TypeError(`Tâche inconnue : ${nature}`);
+        const rappels = {
+            signal: controleur.signal,
+            onPlan: plans ? (plan, infos) => process.send({ type: 'plan', id, plan, infos }) : undefined,
+            onProgress: progression ? (instantane) => process.send({ type: 'progression', id, instantane }) : undefined
+        };
+        const valeur = nature === 'solve' ? await executer(args[0], args[1], rappels) : await executer(...args);
+        reponse = { type: 'resultat', id, ok: true, valeur };
+    } catch (error) {
+        reponse = { type: 'resultat', id, ok: false, erreur: serialiserErreur(error) };
+    }
+    enCours = null;
+    process.send({ ...reponse, rss: process.memoryUsage().rss });
+});
+
+// Le processus principal a disparu : inutile de continuer
+process.on('disconnect', () => process.exit(0));
+
+process.send({ type: 'pret' });
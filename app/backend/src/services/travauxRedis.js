@@ -0,0 +1,311 @@
+const os = require('os');
+const { v4: uuidv4 } = require('uuid');
+
+// Travaux de résolution asynchrones, dans Redis : POST /jobs dépose le
+// problème et renvoie un identifiant, les solveurs (solveurTravaux.js,
+// autant de conteneurs que voulu) consomment la file et écrivent
+// l'avancement, le meilleur plan trouvé et le résultat dans le travail.
+//
+//   gps:travaux:file      liste des travaux en attente (LPUSH / BLMOVE)
+//   gps:travaux:encours   travaux pris par un solveur, jusqu'à leur fin
+//   gps:travail:<id>      hash du travail : status (queued, running, done,
+//                         failed, cancelled), submittedAt, startedAt,
+//                         finishedAt, heartbeat, attempts, worker, options,
+//                         problem, progress, best, result, error, cancel
+//                         (progress : durée, plans trouvés et, dans search,
+//                         le dernier avancement de la recherche)
+//
+// Réglages (variables d'environnement, sinon valeurs par défaut) :
+//   JOBS_TTL_S            durée de vie d'un travail et de son résultat (3600)
+//   JOBS_QUEUE_MAX        travaux en attente au plus (1000)
+//   JOBS_MAX_TIMEOUT_MS   délai maximal d'une recherche (600000)
+
+const FILE = 'gps:travaux:file';
+const EN_COURS = 'gps:travaux:encours';
+const cleTravail = (id) => `gps:travail:${id}`;
+
+// Un solveur signale qu'il est vivant (et lit l'annulation) à ce rythme ;
+// un travail en cours sans signe de vie depuis PERIME_MS est repris
+const BATTEMENT_MS = 2000;
+const PERIME_MS = 30000;
+const RECUPERATION_MS = 15000;
+const TENTATIVES_MAX = 3;
+// Marge de l'échéance du pool au-delà du délai de la recherche
+const MARGE_MS = 5000;
+
+const entier = (valeur, defaut) => {
+    const n = parseInt(valeur, 10);
+    return Number.isInteger(n) && n > 0 ? n : defaut;
+};
+
+const dureeVie = () => entier(process.env.JOBS_TTL_S, 3600);
+const delaiMax = () => entier(process.env.JOBS_MAX_TIMEOUT_MS, 600000);
+
+const json = (texte) => (texte ? JSON.parse(texte) : null);
+const nombre = (texte) => (texte ? Number(texte) : null);
+
+// 1) Côté serveur : dépôt, lecture et annulation
+
+// Dépose un travail ; options comme pour /content (timeoutMs borné par
+// JOBS_MAX_TIMEOUT_MS). Rejette avec code 'FILE_PLEINE' si la file est pleine.
+async function creerTravail(redis, problemText, options) {
+    if (await redis.lLen(FILE) >= entier(process.env.JOBS_QUEUE_MAX, 1000)) {
+        throw Object.assign(new Error('Trop de travaux en attente'), { code: 'FILE_PLEINE', retryAfter: 30 });
+    }
+    const id = uuidv4();
+    const cle = cleTravail(id);
+    const timeoutMs = options.timeoutMs > 0 ? Math.min(options.timeoutMs, delaiMax()) : delaiMax();
+    await redis.multi()
+        .hSet(cle, {
+            status: 'queued',
+            submittedAt: Date.now(),
+            attempts: 0,
+            options: JSON.stringify({ ...options, timeoutMs }),
+            problem: problemText
+        })
+        .expire(cle, dureeVie())
+        .lPush(FILE, id)
+        .exec();
+    return id;
+}
+
+// État d'un travail, null s'il n'existe pas ou a expiré
+async function lireTravail(redis, id) {
+    const t = await redis.hGetAll(cleTravail(id));
+    if (!t || !t.status) return null;
+    return {
+        id,
+        status: t.status,
+        submittedAt: nombre(t.submittedAt),
+        startedAt: nombre(t.startedAt),
+        finishedAt: nombre(t.finishedAt),
+        attempts: nombre(t.attempts),
+        worker: t.worker || null,
+        progress: json(t.progress),
+        best: json(t.best),
+        result: json(t.result),
+        error: json(t.error)
+    };
+}
+
+// Annule un travail : retiré de la file s'il attend encore, sinon son
+// solveur l'arrête au prochain battement. Renvoie le statut, null si inconnu.
+async function annulerTravail(redis, id) {
+    const cle = cleTravail(id);
+    const status = await redis.hGet(cle, 'status');
+    if (!status) return null;
+    if (status === 'queued' && await redis.lRem(FILE, 1, id) === 1) {
+        await terminer(redis, id, { status: 'cancelled' });
+        return 'cancelled';
+    }
+    if (status === 'queued' || status === 'running') {
+        await redis.hSet(cle, 'cancel', '1');
+    }
+    return status;
+}
+
+// Travaux en attente et en cours, pour les métriques
+async function compterTravaux(redis) {
+    const [enAttente, enCours] = await Promise.all([redis.lLen(FILE), redis.lLen(EN_COURS)]);
+    return { enAttente, enCours };
+}
+
+// Statut final : le problème est effacé et le travail expire après JOBS_TTL_S
+function terminer(redis, id, champs) {
+    const cle = cleTravail(id);
+    return redis.multi()
+        .hSet(cle, { ...champs, finishedAt: Date.now() })
+        .hDel(cle, ['problem', 'cancel'])
+        .expire(cle, dureeVie())
+        .lRem(EN_COURS, 1, id)
+        .exec();
+}
+
+// 2) Côté solveur : consommation de la file
+
+class ConsommateurTravaux {
+    // redis : client connecté ; pool : PoolSolveurs ; un travail par
+    // processus du pool au plus
+    constructor({ redis, pool, logger }) {
+        this.redis = redis;
+        this.pool = pool;
+        this.logger = logger || console;
+        this.concurrence = pool.taille;
+        this.actifs = new Set();
+        this.sansBattement = new Map();
+        this.arrete = false;
+        this.reveil = null;
+    }
+
+    async demarrer() {
+        // BLMOVE bloque sa connexion : une connexion à part
+        this.bloquant = this.redis.duplicate();
+        this.bloquant.on('error', err => this.logger.error(`Redis (file des travaux): ${err.message}`));
+        await this.bloquant.connect();
+        this.recuperation = setInterval(() => {
+            this.recupererTravaux().catch(err => this.logger.error(`Reprise des travaux: ${err.message}`));
+        }, RECUPERATION_MS);
+        this.boucle = this.consommer();
+    }
+
+    // Arrêt : plus de nouveau travail, ceux en cours vont à leur terme
+    async arreter() {
+        this.arrete = true;
+        clearInterval(this.recuperation);
+        if (this.reveil) this.reveil();
+        await this.boucle;
+        await this.bloquant.quit();
+    }
+
+    async consommer() {
+        while (!this.arrete) {
+            if (this.actifs.size >= this.concurrence) {
+                await new Promise(resolve => { this.reveil = resolve; });
+                this.reveil = null;
+                continue;
+            }
+            let id;
+            try {
+                id = await this.bloquant.blMove(FILE, EN_COURS, 'RIGHT', 'LEFT', 5);
+            } catch (error) {
+                if (this.arrete) break;
+                this.logger.error(`Lecture de la file des travaux: ${error.message}`);
+                await new Promise(resolve => setTimeout(resolve, 1000));
+                continue;
+            }
+            if (!id) continue;
+            const travail = this.traiter(id)
+                .catch(error => this.logger.error(`Travail ${id}: ${error.message}`))
+                .finally(() => {
+                    this.actifs.delete(travail);
+                    if (this.reveil) this.reveil();
+                });
+            this.actifs.add(travail);
+        }
+        await Promise.all(this.actifs);
+    }
+
+    async traiter(id) {
+        const redis = this.redis;
+        const cle = cleTravail(id);
+        const travail = await redis.hGetAll(cle);
+        if (!travail.status || travail.status !== 'queued') {
+            // expiré, ou déjà terminé par une reprise concurrente
+            await redis.lRem(EN_COURS, 1, id);
+            return;
+        }
+        if (travail.cancel === '1') {
+            await terminer(redis, id, { status: 'cancelled' });
+            return;
+        }
+
+        const options = JSON.parse(travail.options);
+        const debut = Date.now();
+        const avancement = { elapsedMs: 0, plans: 0, bestLength: null, search: null };
+        const ecrireAvancement = () => {
+            avancement.elapsedMs = Date.now() - debut;
+            return JSON.stringify(avancement);
+        };
+        await redis.hSet(cle, {
+            status: 'running',
+            startedAt: debut,
+            heartbeat: debut,
+            worker: os.hostname(),
+            attempts: Number(travail.attempts || 0) + 1,
+            progress: ecrireAvancement()
+        });
+        this.logger.info(`Travail ${id} pris (${options.strategy || 'normal'})`);
+
+        const controleur = new AbortController();
+        const battement = setInterval(async () => {
+            try {
+                if (await redis.hGet(cle, 'cancel') === '1') controleur.abort();
+                await redis.hSet(cle, { heartbeat: Date.now(), progress: ecrireAvancement() });
+            } catch (error) {
+                this.logger.warn(`Battement du travail ${id}: ${error.message}`);
+            }
+        }, BATTEMENT_MS);
+
+        // Meilleur plan trouvé jusqu'ici (recherche anytime)
+        const surPlan = (plan, infos) => {
+            avancement.plans++;
+            avancement.bestLength = infos.length;
+            redis.hSet(cle, {
+                best: JSON.stringify({ plan, length: infos.length, timeMs: infos.timeMs }),
+                progress: ecrireAvancement()
+            }).catch(error => this.logger.warn(`Plan intermédiaire du travail ${id}: ${error.message}`));
+        };
+
+        // Avancement de la recherche : écrit au prochain battement
+        const surProgression = (instantane) => {
+            avancement.search = instantane;
+        };
+
+        let fin;
+        try {
+            const resultat = await this.pool.soumettre('solve', [travail.problem, options], {
+                signal: controleur.signal,
+                delaiMs: options.timeoutMs + MARGE_MS,
+                surPlan,
+                surProgression
+            });
+            fin = { status: 'done', result: JSON.stringify(resultat) };
+        } catch (error) {
+            if (error.name === 'AbortError') {
+                fin = { status: 'cancelled' };
+            } else if (error.code === 'POOL_SATURE' || error.code === 'POOL_FERME') {
+                // Rendu à la file pour un autre solveur
+                await redis.multi().hSet(cle, 'status', 'queued').lRem(EN_COURS, 1, id).rPush(FILE, id).exec();
+                return;
+            } else {
+                const { message, code, line, column } = error;
+                fin = { status: 'failed', error: JSON.stringify({ message, code, line, column }) };
+            }
+        } finally {
+            clearInterval(battement);
+        }
+        await terminer(redis, id, { ...fin, progress: ecrireAvancement() });
+        this.logger.info(`Travail ${id} terminé (${fin.status}) en ${Date.now() - debut}ms`);
+    }
+
+    // Reprend les travaux d'un solveur disparu (plus de battement) : remis
+    // en file, ou en échec après TENTATIVES_MAX tentatives. LREM décide
+    // entre plusieurs solveurs qui tenteraient la même reprise.
+    async recupererTravaux() {
+        const redis = this.redis;
+        const maintenant = Date.now();
+        const ids = await redis.lRange(EN_COURS, 0, -1);
+        for (const id of ids) {
+            const [status, heartbeat, attempts] = await redis.hmGet(cleTravail(id), ['status', 'heartbeat', 'attempts']);
+            if (!status) {
+                await redis.lRem(EN_COURS, 1, id);
+                continue;
+            }
+            // Pris mais pas encore démarré : le délai court depuis la première fois qu'on le voit
+            let dernier = Number(heartbeat);
+            if (!heartbeat) {
+                if (!this.sansBattement.has(id)) this.sansBattement.set(id, maintenant);
+                dernier = this.sansBattement.get(id);
+            }
+            if (maintenant - dernier < PERIME_MS) continue;
+            this.sansBattement.delete(id);
+            if (await redis.lRem(EN_COURS, 1, id) !== 1) continue;
+
+            if (Number(attempts || 0) >= TENTATIVES_MAX) {
+                this.logger.warn(`Travail ${id} abandonné après ${attempts} tentatives`);
+                await terminer(redis, id, {
+                    status: 'failed',
+                    error: JSON.stringify({ message: `Solveur perdu ${attempts} fois`, code: 'TRAVAIL_ABANDONNE' })
+                });
+            } else {
+                this.logger.warn(`Travail ${id} repris (solveur sans signe de vie)`);
+                await redis.multi().hSet(cleTravail(id), 'status', 'queued').hDel(cleTravail(id), 'heartbeat').rPush(FILE, id).exec();
+            }
+        }
+        for (const id of this.sansBattement.keys()) {
+            if (!ids.includes(id)) this.sansBattement.delete(id);
+        }
+    }
+}
+
+module.exports = { creerTravail, lireTravail, annulerTravail, compterTravaux, ConsommateurTravaux };
@@ -0,0 +1,60 @@
+const { createClient } = require('redis');
+const winston = require('winston');
+const chalk = require('chalk');
+const PoolSolveurs = require('./services/poolSolveurs');
+const { ConsommateurTravaux } = require('./services/travauxRedis');
+const { MetriquesSolveur, servirMetriques } = require('./services/metriques');
+require('dotenv').config();
+
+// Solveur de travaux asynchrones (POST /jobs) : consomme la file Redis avec
+// son propre pool de processus. Lancé par `npm run solveur`, ou en autant
+// de conteneurs que voulu (service "solver" de docker-compose.yml).
+// Avec SOLVER_METRICS_PORT, ses métriques Prometheus sont servies sur ce
+// port (GET /metrics), comme celles du serveur sur METRICS_PORT.
+
+const logger = winston.createLogger({
+    level: 'info',
+    format: winston.format.combine(
+        winston.format.timestamp(),
+        winston.format.colorize(),
+        winston.format.printf(({ timestamp, level, message }) => {
+            return `${chalk.gray(timestamp)} ${level} ${message}`;
+        })
+    ),
+    transports: [new winston.transports.Console()]
+});
+
+const redisClient = createClient({
+    url: process.env.REDIS_URL,
+    password: process.env.REDIS_PASSWORD
+});
+redisClient.on('error', err => logger.error('Redis Client Error:', err));
+
+const metriques = new MetriquesSolveur({ logger });
+const pool = new PoolSolveurs({ logger, metriques });
+metriques.suivrePool(pool);
+const consommateur = new ConsommateurTravaux({ redis: redisClient, pool, logger });
+
+const demarrer = async () => {
+    await redisClient.connect();
+    await consommateur.demarrer();
+    if (process.env.SOLVER_METRICS_PORT) {
+        servirMetriques(metriques, Number(process.env.SOLVER_METRICS_PORT), logger);
+    }
+    logger.info(`${chalk.green('Solveur de travaux démarré')} (${chalk.blue(pool.taille)} processus)`);
+};
+
+const arreter = async (signal) => {
+    logger.info(`${chalk.yellow(signal)} reçu, fin des travaux en cours`);
+    await consommateur.arreter();
+    await pool.fermer();
+    await redisClient.quit();
+    process.exit(0);
+};
+process.on('SIGTERM', () => arreter('SIGTERM'));
+process.on('SIGINT', () => arreter('SIGINT'));
+
+demarrer().catch(error => {
+    logger.error(`${chalk.red('Error:')} ${error.message}`);
+    process.exit(1);
+});
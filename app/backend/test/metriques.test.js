@@ -0,0 +1,60 @@
+// Métriques (src/services/metriques.js) : lectures par collecte et serveur interne
+const test = require('node:test');
+const assert = require('node:assert');
+const http = require('http');
+const { MetriquesSolveur, servirMetriques } = require('../src/services/metriques');
+
+const silencieux = { info() {}, warn() {}, error() {} };
+
+const lireHttp = (port, chemin) => new Promise((resolve, reject) => {
+    http.get({ port, path: chemin }, (res) => {
+        let texte = '';
+        res.on('data', morceau => { texte += morceau; });
+        res.on('end', () => resolve({ status: res.statusCode, type: res.headers['content-type'], texte }));
+    }).on('error', reject);
+});
+
+test('les jauges des travaux ne lisent Redis qu\'une fois par collecte', async () => {
+    const metriques = new MetriquesSolveur({ logger: silencieux });
+    let lectures = 0;
+    metriques.suivreTravaux(async () => {
+        lectures++;
+        return { enAttente: 3, enCours: 1 };
+    });
+
+    const texte = await metriques.exposer();
+    assert.match(texte, /^gps_jobs_queued 3$/m);
+    assert.match(texte, /^gps_jobs_running 1$/m);
+    assert.strictEqual(lectures, 1);
+    await metriques.exposer();
+    assert.strictEqual(lectures, 2);
+});
+
+test('une lecture en échec omet les deux jauges', async () => {
+    const metriques = new MetriquesSolveur({ logger: silencieux });
+    let lectures = 0;
+    metriques.suivreTravaux(() => {
+        lectures++;
+        throw new Error('Redis absent');
+    });
+    const texte = await metriques.exposer();
+    assert.doesNotMatch(texte, /gps_jobs_/);
+    assert.match(texte, /gps_solve_duration_seconds/);
+    assert.strictEqual(lectures, 1);
+});
+
+test('le serveur interne ne sert que GET /metrics', async () => {
+    const metriques = new MetriquesSolveur({ logger: silencieux });
+    const serveur = servirMetriques(metriques, 0, silencieux);
+    try {
+        await new Promise(resolve => serveur.once('listening', resolve));
+        const { port } = serveur.address();
+        const reponse = await lireHttp(port, '/metrics');
+        assert.strictEqual(reponse.status, 200);
+        assert.match(reponse.type, /^text\/plain; version=0\.0\.4/);
+        assert.match(reponse.texte, /# TYPE gps_solve_duration_seconds histogram/);
+        assert.strictEqual((await lireHttp(port, '/content')).status, 404);
+    } finally {
+        serveur.close();
+    }
+});
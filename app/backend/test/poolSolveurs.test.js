@@ -0,0 +1,59 @@
+// Pool de solveurs (src/services/poolSolveurs.js) avec un faux travailleur
+const test = require('node:test');
+const assert = require('node:assert');
+const path = require('path');
+const PoolSolveurs = require('../src/services/poolSolveurs');
+
+const silencieux = { info() {}, warn() {}, error() {} };
+
+const creerPool = (options = {}) => new PoolSolveurs({
+    taille: 1,
+    script: path.join(__dirname, 'travailleurFactice.js'),
+    logger: silencieux,
+    ...options
+});
+
+// Attend que tous les processus aient annoncé 'pret'
+const pret = async (pool) => {
+    while (pool.etat().prets < pool.taille) await new Promise(resolve => setTimeout(resolve, 10));
+};
+
+test('un processus tué à l\'échéance ne reçoit plus de tâche', async () => {
+    const pool = creerPool();
+    try {
+        await pret(pool);
+        const bloquee = pool.soumettre('bloquer', [], { delaiMs: 100 });
+        const enAttente = pool.soumettre('echo', ['attente'], { delaiMs: 10000 });
+
+        // Soumise juste après la mise à mort : distribuer() passe avant
+        // l'arrêt effectif du processus tué
+        const apres = await bloquee.then(
+            () => assert.fail('la tâche bloquée aurait dû expirer'),
+            (error) => {
+                assert.strictEqual(error.code, 'DELAI_DEPASSE');
+                return pool.soumettre('echo', ['apres'], { delaiMs: 10000 });
+            });
+
+        assert.deepStrictEqual(await enAttente, ['attente']);
+        assert.deepStrictEqual(apres, ['apres']);
+        assert.strictEqual(pool.compteurs.expirees, 1);
+        assert.strictEqual(pool.compteurs.pertes, 0);
+        assert.strictEqual(pool.travailleurs.length, 1);
+    } finally {
+        await pool.fermer(1000);
+    }
+});
+
+test('la file pleine rejette avec POOL_SATURE', async () => {
+    const pool = creerPool({ fileMax: 1 });
+    try {
+        await pret(pool);
+        const bloquee = pool.soumettre('bloquer', [], { delaiMs: 100 }).catch(error => error);
+        const enAttente = pool.soumettre('echo', ['attente']);
+        await assert.rejects(pool.soumettre('echo', ['refusee']), { code: 'POOL_SATURE' });
+        assert.strictEqual((await bloquee).code, 'DELAI_DEPASSE');
+        assert.deepStrictEqual(await enAttente, ['attente']);
+    } finally {
+        await pool.fermer(1000);
+    }
+});
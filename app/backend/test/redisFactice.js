@@ -0,0 +1,106 @@
+// Faux client Redis en mémoire pour les tests : les commandes (client
+// node-redis v4) dont se sert services/travauxRedis.js, avec des valeurs
+// rangées en chaînes comme dans Redis. duplicate() partage les données.
+const EventEmitter = require('events');
+
+const creerRedis = (donnees = new Map(), attentes = []) => {
+    const liste = (cle) => {
+        if (!donnees.has(cle)) donnees.set(cle, []);
+        return donnees.get(cle);
+    };
+    const hash = (cle) => {
+        if (!donnees.has(cle)) donnees.set(cle, {});
+        return donnees.get(cle);
+    };
+    const reveiller = () => {
+        for (const reveil of attentes.splice(0)) reveil();
+    };
+
+    const commandes = {
+        connect: async () => {},
+        quit: async () => {},
+        duplicate: () => creerRedis(donnees, attentes),
+        expire: async (cle) => (donnees.has(cle) ? 1 : 0),
+        lPush: async (cle, valeur) => {
+            liste(cle).unshift(String(valeur));
+            reveiller();
+            return liste(cle).length;
+        },
+        rPush: async (cle, valeur) => {
+            liste(cle).push(String(valeur));
+            reveiller();
+            return liste(cle).length;
+        },
+        lLen: async (cle) => (donnees.get(cle) || []).length,
+        lRange: async (cle) => [...(donnees.get(cle) || [])],
+        lRem: async (cle, nombre, valeur) => {
+            const l = donnees.get(cle) || [];
+            const index = l.indexOf(String(valeur));
+            if (index === -1) return 0;
+            l.splice(index, 1);
+            return 1;
+        },
+        blMove: async (source, destination, de, vers, delaiS) => {
+            const fin = Date.now() + delaiS * 1000;
+            for (;;) {
+                const l = donnees.get(source) || [];
+                if (l.length > 0) {
+                    const valeur = de === 'RIGHT' ? l.pop() : l.shift();
+                    if (vers === 'LEFT') liste(destination).unshift(valeur);
+                    else liste(destination).push(valeur);
+                    return valeur;
+                }
+                const restant = fin - Date.now();
+                if (restant <= 0) return null;
+                await new Promise(resolve => {
+                    attentes.push(resolve);
+                    setTimeout(resolve, restant);
+                });
+            }
+        },
+        hSet: async (cle, champ, valeur) => {
+            const h = hash(cle);
+            const champs = typeof champ === 'object' ? champ : { [champ]: valeur };
+            for (const [nom, v] of Object.entries(champs)) h[nom] = String(v);
+            return Object.keys(champs).length;
+        },
+        hGet: async (cle, champ) => (donnees.get(cle) || {})[champ] ?? null,
+        hGetAll: async (cle) => ({ ...(donnees.get(cle) || {}) }),
+        hmGet: async (cle, champs) => champs.map(champ => (donnees.get(cle) || {})[champ] ?? null),
+        hDel: async (cle, champs) => {
+            const h = donnees.get(cle) || {};
+            let n = 0;
+            for (const champ of [].concat(champs)) {
+                if (champ in h) n++;
+                delete h[champ];
+            }
+            return n;
+        }
+    };
+
+    const client = Object.assign(new EventEmitter(), commandes);
+    // MULTI : commandes enchaînées, exécutées dans l'ordre par exec()
+    client.multi = () => {
+        const operations = [];
+        const transaction = new Proxy({}, {
+            get: (cible, nom) => {
+                if (nom === 'exec') {
+                    return async () => {
+                        const reponses = [];
+                        for (const [commande, args] of operations) reponses.push(await commandes[commande](...args));
+                        return reponses;
+                    };
+                }
+                return (...args) => {
+                    operations.push([nom, args]);
+                    return transaction;
+                };
+            }
+        });
+        return transaction;
+    };
+    client.donnees = donnees;
+    return client;
+};
+
+module.exports = { creerRedis };
@@ -0,0 +1,62 @@
+// Suivi partagé des travaux (src/services/suiviTravaux.js)
+const test = require('node:test');
+const assert = require('node:assert');
+const SuiviTravaux = require('../src/services/suiviTravaux');
+
+const silencieux = { info() {}, warn() {}, error() {} };
+const attendre = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+test('un seul lecteur par travail, quel que soit le nombre de flux', async () => {
+    const lectures = new Map();
+    const suivi = new SuiviTravaux({
+        periodeMs: 20,
+        logger: silencieux,
+        lire: async (id) => {
+            lectures.set(id, (lectures.get(id) || 0) + 1);
+            return { status: 'running' };
+        }
+    });
+    const recus = [0, 0, 0];
+    const desabonner = recus.map((_, i) => suivi.abonner('a', () => recus[i]++, assert.fail));
+    const autre = suivi.abonner('b', () => {}, assert.fail);
+
+    await attendre(110);
+    desabonner.forEach(d => d());
+    autre();
+    const parA = lectures.get('a');
+    assert.ok(parA >= 2 && parA <= 6, `${parA} lectures`);
+    assert.deepStrictEqual(recus, [parA, parA, parA]);
+    assert.strictEqual(suivi.nbFlux, 0);
+    assert.strictEqual(suivi.suivis.size, 0);
+
+    // Plus aucun abonné : plus de lecture
+    await attendre(60);
+    assert.strictEqual(lectures.get('a'), parA);
+});
+
+test('JOBS_EVENTS_MAX borne les flux ouverts', () => {
+    const suivi = new SuiviTravaux({ lire: async () => null, fluxMax: 2, logger: silencieux });
+    const d1 = suivi.abonner('a', () => {}, () => {});
+    assert.strictEqual(suivi.plein(), false);
+    const d2 = suivi.abonner('b', () => {}, () => {});
+    assert.strictEqual(suivi.plein(), true);
+    d1();
+    d1();
+    assert.strictEqual(suivi.plein(), false);
+    d2();
+    assert.strictEqual(suivi.nbFlux, 0);
+});
+
+test('une erreur de lecture est transmise à chaque flux', async () => {
+    const suivi = new SuiviTravaux({
+        periodeMs: 10,
+        logger: silencieux,
+        lire: async () => { throw new Error('Redis absent'); }
+    });
+    const erreurs = [];
+    const d1 = suivi.abonner('a', assert.fail, (error) => { erreurs.push(error.message); d1(); });
+    const d2 = suivi.abonner('a', assert.fail, (error) => { erreurs.push(error.message); d2(); });
+    await attendre(40);
+    assert.deepStrictEqual(erreurs, ['Redis absent', 'Redis absent']);
+    assert.strictEqual(suivi.suivis.size, 0);
+});
@@ -0,0 +1,14 @@
+// Faux travailleur du pool de solveurs pour les tests (même protocole que
+// src/services/travailleurSolveur.js, sans le module natif) :
+// 'echo' rend ses arguments, 'bloquer' ne répond jamais et ignore
+// l'annulation, comme une recherche qui ne rend plus la main.
+process.on('message', (message) => {
+    if (message.type !== 'tache') return;
+    const { id, nature, args } = message;
+    if (nature === 'bloquer') return;
+    process.send({ type: 'resultat', id, ok: true, valeur: args, rss: process.memoryUsage().rss });
+});
+
+process.on('disconnect', () => process.exit(0));
+
+process.send({ type: 'pret' });
@@ -0,0 +1,120 @@
+// Travaux asynchrones (src/services/travauxRedis.js) sur un faux Redis
+const test = require('node:test');
+const assert = require('node:assert');
+const { creerTravail, lireTravail, annulerTravail, ConsommateurTravaux } = require('../src/services/travauxRedis');
+const { erreurSolveur } = require('../src/services/erreursSolveur');
+const { creerRedis } = require('./redisFactice');
+
+const FILE = 'gps:travaux:file';
+const EN_COURS = 'gps:travaux:encours';
+const PROBLEME = 'Initial: a\nGoal: b\nAction: aller\nPreconditions: a\nAdd: b\nDelete: a\n';
+
+const silencieux = { info() {}, warn() {}, error() {} };
+const attendre = (ms) => new Promise(resolve => setTimeout(resolve, ms));
+
+// Attend que le travail atteigne le statut voulu (ou échoue au bout de delaiMs)
+const statut = async (redis, id, voulu, delaiMs = 8000) => {
+    const fin = Date.now() + delaiMs;
+    for (;;) {
+        const travail = await lireTravail(redis, id);
+        if (travail && travail.status === voulu) return travail;
+        if (Date.now() > fin) assert.fail(`travail ${id} : ${travail && travail.status} au lieu de ${voulu}`);
+        await attendre(20);
+    }
+};
+
+// Travail pris par un solveur qui s'est arrêté sans le terminer : dans
+// gps:travaux:encours, dernier battement il y a plus de 30 s
+const travailOrphelin = async (redis, tentatives) => {
+    const id = await creerTravail(redis, PROBLEME, {});
+    assert.strictEqual(await redis.blMove(FILE, EN_COURS, 'RIGHT', 'LEFT', 1), id);
+    await redis.hSet(`gps:travail:${id}`, {
+        status: 'running',
+        startedAt: Date.now() - 60000,
+        heartbeat: Date.now() - 31000,
+        attempts: tentatives
+    });
+    return id;
+};
+
+// Pool qui résout tout de suite, ou attend l'annulation
+const poolImmediat = { taille: 1, soumettre: async () => ({ plan: ['aller'], stats: { nodes: 1 } }) };
+const poolBloque = {
+    taille: 1,
+    soumettre: (nature, args, { signal }) => new Promise((resolve, reject) => {
+        signal.addEventListener('abort', () => reject(new DOMException('annulée', 'AbortError')), { once: true });
+    })
+};
+
+test('un travail d\'un solveur disparu est remis en file puis résolu', async () => {
+    const redis = creerRedis();
+    const id = await travailOrphelin(redis, 1);
+    const consommateur = new ConsommateurTravaux({ redis, pool: poolImmediat, logger: silencieux });
+
+    await consommateur.recupererTravaux();
+    assert.deepStrictEqual(await redis.lRange(EN_COURS, 0, -1), []);
+    assert.deepStrictEqual(await redis.lRange(FILE, 0, -1), [id]);
+    const repris = await lireTravail(redis, id);
+    assert.strictEqual(repris.status, 'queued');
+    assert.strictEqual(await redis.hGet(`gps:travail:${id}`, 'heartbeat'), null);
+
+    await consommateur.demarrer();
+    try {
+        const travail = await statut(redis, id, 'done');
+        assert.strictEqual(travail.attempts, 2);
+        assert.deepStrictEqual(travail.result.plan, ['aller']);
+    } finally {
+        await consommateur.arreter();
+    }
+});
+
+test('un travail perdu TENTATIVES_MAX fois finit en échec', async () => {
+    const redis = creerRedis();
+    const id = await travailOrphelin(redis, 3);
+    const consommateur = new ConsommateurTravaux({ redis, pool: poolImmediat, logger: silencieux });
+
+    await consommateur.recupererTravaux();
+    const travail = await lireTravail(redis, id);
+    assert.strictEqual(travail.status, 'failed');
+    assert.strictEqual(travail.error.code, 'TRAVAIL_ABANDONNE');
+    assert.deepStrictEqual(await redis.lRange(FILE, 0, -1), []);
+    assert.deepStrictEqual(await redis.lRange(EN_COURS, 0, -1), []);
+});
+
+test('un travail annulé pendant la recherche finit annulé', async () => {
+    const redis = creerRedis();
+    const consommateur = new ConsommateurTravaux({ redis, pool: poolBloque, logger: silencieux });
+    await consommateur.demarrer();
+    try {
+        const id = await creerTravail(redis, PROBLEME, { strategy: 'anytime' });
+        await statut(redis, id, 'running');
+        assert.strictEqual(await annulerTravail(redis, id), 'running');
+        // Lu par le solveur au battement suivant (BATTEMENT_MS)
+        const travail = await statut(redis, id, 'cancelled');
+        assert.ok(travail.finishedAt);
+        assert.deepStrictEqual(await redis.lRange(EN_COURS, 0, -1), []);
+        assert.strictEqual(await redis.hGet(`gps:travail:${id}`, 'problem'), null);
+    } finally {
+        await consommateur.arreter();
+    }
+});
+
+test('JOBS_QUEUE_MAX atteint : dépôt refusé, réponse 503', async () => {
+    const redis = creerRedis();
+    const avant = process.env.JOBS_QUEUE_MAX;
+    process.env.JOBS_QUEUE_MAX = '2';
+    try {
+        await creerTravail(redis, PROBLEME, {});
+        await creerTravail(redis, PROBLEME, {});
+        const error = await creerTravail(redis, PROBLEME, {}).then(() => assert.fail('dépôt accepté'), e => e);
+        assert.strictEqual(error.code, 'FILE_PLEINE');
+        assert.strictEqual(await redis.lLen(FILE), 2);
+
+        const reponse = erreurSolveur(error, '/jobs', silencieux);
+        assert.strictEqual(reponse.status, 503);
+        assert.strictEqual(reponse.retryAfter, 30);
+    } finally {
+        if (avant === undefined) delete process.env.JOBS_QUEUE_MAX;
+        else process.env.JOBS_QUEUE_MAX = avant;
+    }
+});
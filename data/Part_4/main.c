@@ -1,13 +1,21 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <signal.h>
 #include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
 
 #define MAX_LIGNE 256
 #define MAX_MOTS 50
 #define MAX_REGLES 100
 #define MAX_ETATS 1000
 #define MAX_CHEMIN 100
+#define MAX_PROFONDEUR 100     // Au-delà, on revient en arrière (évite les boucles infinies)
+#define MAX_NOEUDS 1000000     // Budget de noeuds développés par recherche
+#define DELAI_MAX_MS 10000.0   // Délai maximal d'une recherche
+#define PERIODE_CONTROLE 64    // Noeuds entre deux lectures de l'horloge et du jeton
 
 typedef char string[50];
 
@@ -35,6 +43,58 @@ typedef struct {
     int parent;           // Indice de l'état parent
 } Etat;
 
+/**
+ * Issue d'une recherche : on distingue "aucun plan n'existe" de "abandonnée"
+ */
+typedef enum {
+    ISSUE_RESOLU,           // plan trouvé
+    ISSUE_SANS_SOLUTION,    // tout a été exploré : aucun plan n'existe
+    ISSUE_INCOMPLET,        // des branches ont été coupées à MAX_PROFONDEUR : pas de preuve
+    ISSUE_BUDGET_NOEUDS,    // MAX_NOEUDS atteint
+    ISSUE_BUDGET_MEMOIRE,   // tableau des états plein (MAX_ETATS)
+    ISSUE_DELAI,            // DELAI_MAX_MS écoulé
+    ISSUE_ANNULE            // jeton d'annulation levé (Ctrl+C)
+} IssueRecherche;
+
+/**
+ * Jeton d'annulation : levé par Ctrl+C pendant une recherche
+ */
+volatile sig_atomic_t annulationRecherche = 0;
+
+void interrompreRecherche(int signal) {
+    (void)signal;
+    annulationRecherche = 1;
+}
+
+const char *nomIssue(IssueRecherche issue) {
+    switch(issue) {
+        case ISSUE_RESOLU:         return "plan trouvé";
+        case ISSUE_SANS_SOLUTION:  return "prouvé sans solution";
+        case ISSUE_INCOMPLET:      return "profondeur maximale atteinte, pas de preuve";
+        case ISSUE_BUDGET_NOEUDS:  return "budget de noeuds atteint";
+        case ISSUE_BUDGET_MEMOIRE: return "limite du nombre d'états atteinte";
+        case ISSUE_DELAI:          return "délai écoulé";
+        case ISSUE_ANNULE:         return "annulée";
+    }
+    return "?";
+}
+
+/**
+ * Horloge monotone en millisecondes (insensible aux changements d'heure)
+ */
+double horlogeMs() {
+#ifdef _WIN32
+    LARGE_INTEGER frequence, compteur;
+    QueryPerformanceFrequency(&frequence);
+    QueryPerformanceCounter(&compteur);
+    return (double)compteur.QuadPart * 1000.0 / (double)frequence.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+#endif
+}
+
 /**
  * Vérifie si un fait existe dans un état
  */
@@ -96,27 +156,55 @@ int butsAtteints(Etat *etat, string buts[], int nb_buts) {
 }
 
 /**
- * Recherche avec backtracking pour trouver une solution
+ * Recherche avec backtracking pour trouver une solution.
+ * *issue indique pourquoi la recherche s'est arrêtée. Le budget de noeuds
+ * est testé à chaque tour ; le délai et le jeton d'annulation toutes les
+ * PERIODE_CONTROLE itérations seulement.
  */
 int rechercheSolutionBacktrack(Etat etats[], int *nb_etats, Regle regles[], int nb_regles, 
-                             string buts[], int nb_buts) {
+                             string buts[], int nb_buts, IssueRecherche *issue) {
     int possible = 1;
     int IR = 0;  // Indice à partir duquel on cherche une règle applicable
     int etat_courant = 0;
-    int max_profondeur = 100; // Limite de profondeur pour éviter les boucles infinies
     int profondeur_actuelle = 0;
+    int branche_coupee = 0;  // Vrai si une branche a été abandonnée à MAX_PROFONDEUR
+    long noeuds = 0;
+    double debut = horlogeMs();
     
-    while(possible && !butsAtteints(&etats[etat_courant], buts, nb_buts) && profondeur_actuelle < max_profondeur) {
+    while(possible && !butsAtteints(&etats[etat_courant], buts, nb_buts)) {
         int regle_trouvee = 0;
         
+        // Budget de noeuds, puis délai et annulation de temps en temps
+        if(++noeuds > MAX_NOEUDS) {
+            *issue = ISSUE_BUDGET_NOEUDS;
+            return -1;
+        }
+        if(noeuds % PERIODE_CONTROLE == 1) {
+            if(annulationRecherche) {
+                *issue = ISSUE_ANNULE;
+                return -1;
+            }
+            if(horlogeMs() - debut >= DELAI_MAX_MS) {
+                *issue = ISSUE_DELAI;
+                return -1;
+            }
+        }
+        
         // Sécurité : vérifier si on a atteint la limite du tableau des états
         if(*nb_etats >= MAX_ETATS - 1) {
-            printf("\nATTENTION: Limite du nombre d'états atteinte (%d). Arrêt de la recherche.\n", MAX_ETATS);
+            *issue = ISSUE_BUDGET_MEMOIRE;
             return -1;
         }
         
+        // Trop profond : on n'essaie aucune règle, ce qui provoque un retour arrière
+        int premiere_regle = IR;
+        if(profondeur_actuelle >= MAX_PROFONDEUR) {
+            premiere_regle = nb_regles;
+            branche_coupee = 1;
+        }
+        
         // Cherche une règle applicable d'indice > IR
-        for(int i = IR; i < nb_regles; i++) {
+        for(int i = premiere_regle; i < nb_regles; i++) {
             if(preconditionsSatisfaites(&regles[i], &etats[etat_courant])) {
                 // Applique la règle pour créer un nouvel état
                 etats[*nb_etats].parent = etat_courant;
@@ -174,12 +262,13 @@ int rechercheSolutionBacktrack(Etat etats[], int *nb_etats, Regle regles[], int
         }
     }
     
-    if(profondeur_actuelle >= max_profondeur) {
-        printf("\nATTENTION: Profondeur maximale atteinte (%d). La recherche a été arrêtée.\n", max_profondeur);
+    if(!possible) {
+        *issue = branche_coupee ? ISSUE_INCOMPLET : ISSUE_SANS_SOLUTION;
         return -1;
     }
     
-    return possible ? etat_courant : -1;
+    *issue = ISSUE_RESOLU;
+    return etat_courant;
 }
 
 /**
@@ -475,8 +564,12 @@ void analyseFichier(const char *nomFichier) {
     // Mesure du temps d'exécution
     clock_t debut = clock();
     
-    // Recherche d'une solution avec backtracking
-    int solution = rechercheSolutionBacktrack(etats, &nb_etats, regles, nb_regles, buts, nb_buts);
+    // Recherche d'une solution avec backtracking (Ctrl+C l'interrompt)
+    IssueRecherche issue;
+    annulationRecherche = 0;
+    signal(SIGINT, interrompreRecherche);
+    int solution = rechercheSolutionBacktrack(etats, &nb_etats, regles, nb_regles, buts, nb_buts, &issue);
+    signal(SIGINT, SIG_DFL);
     
     // Calcul du temps d'exécution
     clock_t fin = clock();
@@ -486,6 +579,7 @@ void analyseFichier(const char *nomFichier) {
     afficherSolution(etats, regles, solution);
     
     printf("\n+----------STATISTIQUES----------+\n");
+    printf("| Issue de la recherche: %s\n", nomIssue(issue));
     printf("| Nombre d'états explorés: %d\n", nb_etats);
     printf("| Temps d'exécution: %.2f ms\n", temps_ms);
     printf("+--------------------------------+\n");
@@ -0,0 +1,184 @@
+#ifndef GPS_H
+#define GPS_H
+
+// ---------------------------------------------------------------------
+// libgps : le solveur GPS (data/Part_Bonus/main.c) comme bibliothèque
+// ---------------------------------------------------------------------
+// Construction, depuis data/Part_Bonus :
+//   gcc -O2 -fPIC -fvisibility=hidden -DGPS_BIBLIOTHEQUE -c main.c -o gps.o
+//   objcopy --localize-hidden gps.o && ar rcs libgps.a gps.o    (statique)
+//   gcc -shared -o libgps.so gps.o -lpthread                    (partagée)
+// Seules les fonctions de ce fichier sont exportées. La bibliothèque
+// n'écrit jamais sur la sortie standard : les erreurs sont rendues par
+// les valeurs de retour, GpsErreur et l'issue des recherches.
+//
+// Les types sont opaques et ce fichier ne dépend d'aucun en-tête interne.
+// Depuis la version 6, GpsOptions et GpsStatistiques commencent par leur
+// taille (sizeof vu par le programme, rangée par GpsOptionsParDefaut et
+// GpsStatistiquesRecherche) et ne font que grandir (nouveaux champs à la
+// fin) : la bibliothèque ne lit ni n'écrit au-delà de cette taille, et
+// donne leur valeur par défaut aux champs qu'un programme plus ancien ne
+// connaît pas. Une version 6 ou suivante remplace donc la bibliothèque
+// sans recompiler ses programmes ; un programme construit avec une
+// version antérieure à 6 doit être recompilé.
+//
+// Fils d'exécution : un GpsProbleme chargé n'est plus jamais modifié et
+// peut servir à plusieurs recherches en même temps ; chaque GpsRecherche
+// ne sert qu'à une recherche à la fois. GpsAnnuler peut être appelée
+// depuis n'importe quel fil.
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPS_VERSION 6
+
+#if defined(__GNUC__)
+#define GPS_API __attribute__((visibility("default")))
+#else
+#define GPS_API
+#endif
+
+typedef struct GpsProbleme GpsProbleme;
+typedef struct GpsRecherche GpsRecherche;
+
+// Stratégies : mêmes numéros que les modes du programme (MODE_...)
+#define GPS_NORMAL     0   // BFS, plan le plus court
+#define GPS_MELANGE    1   // BFS, règles dans un ordre tiré au hasard
+#define GPS_ALEATOIRE  2   // marches aléatoires de Monte-Carlo
+#define GPS_PRIORITE   3   // BFS guidée par les priorités apprises
+#define GPS_FIN_MOYENS 4   // montée forcée
+#define GPS_ANYTIME    5   // A* pondéré à poids décroissants
+#define GPS_GLOUTON    8   // recherche gloutonne guidée par FF
+
+// Issues d'une recherche : mêmes numéros que IssueRecherche
+#define GPS_RESOLU           0   // plan trouvé
+#define GPS_SANS_SOLUTION    1   // prouvé sans solution
+#define GPS_INCOMPLET        2   // stratégie incomplète, pas de preuve
+#define GPS_BUDGET_NOEUDS    3
+#define GPS_BUDGET_MEMOIRE   4
+#define GPS_DELAI            5
+#define GPS_ANNULE           6
+#define GPS_ERREUR          -1   // arguments invalides ou stratégie inconnue
+
+// Plan intermédiaire (version 3) : appelé depuis le fil de la recherche à
+// chaque plan amélioré (GPS_ANYTIME) ; le tableau n'est valable que
+// pendant l'appel
+typedef void (*GpsRappelPlan)(const int* plan, int longueur, double tempsMs, void* contexte);
+
+// Avancement d'une recherche (version 4), publié périodiquement depuis le
+// fil de la recherche
+typedef struct {
+    double tempsMs;
+    long developpes;                // noeuds développés
+    long generes;                   // successeurs générés, -1 si la stratégie ne les compte pas
+    int profondeur;                 // profondeur (BFS, montée, marches) ou borne f (anytime), -1 sinon
+    int meilleurH;                  // meilleure heuristique atteinte, -1 sinon
+    double noeudsParSeconde;        // depuis l'instantané précédent
+    size_t octets;                  // mémoire de la recherche
+} GpsProgression;
+
+typedef void (*GpsRappelProgression)(const GpsProgression* progression, void* contexte);
+
+typedef struct {
+    size_t taille;                  // sizeof(GpsOptions), rangée par GpsOptionsParDefaut (version 6)
+    int strategie;                  // GPS_NORMAL...
+    double delaiMs;                 // 0 = pas de délai (GPS_ANYTIME : 1000 ms)
+    long maxNoeuds;                 // noeuds développés au maximum, 0 = pas de limite
+    size_t maxOctets;               // mémoire d'une recherche, 0 = pas de limite
+    unsigned long long graine;      // graine des tirages, 0 = tirée au hasard
+    int nbFils;                     // fils des marches aléatoires (1 par défaut)
+    int ordrePartiel;               // élagage des ordres équivalents
+    int symetries;                  // fusion des états symétriques
+    int optimiserPlan;              // 0 non, 1 boucles et actions inutiles, 2 et recherche locale
+    const char* repertoirePriorites; // priorités apprises (GPS_PRIORITE), NULL = aucun fichier écrit
+    GpsRappelPlan rappelPlan;       // plans intermédiaires, NULL = aucun (version 3)
+    void* contexteRappel;           // transmis à rappelPlan
+    GpsRappelProgression rappelProgression; // avancement, NULL = aucun (version 4)
+    void* contexteProgression;      // transmis à rappelProgression
+    double periodeProgressionMs;    // entre deux instantanés, 0 = 1000 ms
+} GpsOptions;
+
+typedef struct {
+    size_t taille;                  // sizeof(GpsStatistiques), rangée par GpsStatistiquesRecherche (version 6)
+    int issue;                      // GPS_RESOLU...
+    int longueur;                   // longueur du plan, -1 si aucun
+    int longueurBrute;              // avant optimisation
+    long noeuds;                    // noeuds développés
+    long successeurs;               // successeurs générés (BFS et marches)
+    double tempsMs;
+    unsigned long long graine;      // graine à redonner pour rejouer la recherche
+    unsigned long long octetsMax;   // pic de mémoire des états de la recherche (version 5)
+} GpsStatistiques;
+
+// Position d'une erreur de chargement (ligne et colonne à partir de 1)
+typedef struct {
+    int ligne;
+    int colonne;
+    char message[256];
+} GpsErreur;
+
+// Résultat d'une vérification de plan par noms (version 2)
+typedef struct {
+    int correct;                    // 1 si le plan atteint le but
+    int etapes;                     // étapes jouées, la fautive comprise
+    char message[512];              // raison de l'échec (textes affichés par verify.c)
+} GpsVerification;
+
+GPS_API int GpsVersion(void);
+// Valeurs par défaut des options->taille premiers octets (voir
+// GpsOptionsParDefaut, qui la range)
+GPS_API void GpsInitialiserOptions(GpsOptions* options);
+GPS_API const char* GpsNomIssue(int issue);
+
+// Problèmes : NULL en cas d'erreur (décrite dans *erreur si non NULL)
+GPS_API GpsProbleme* GpsChargerFichier(const char* chemin, GpsErreur* erreur);
+GPS_API GpsProbleme* GpsChargerTexte(const char* texte, size_t taille, GpsErreur* erreur);
+GPS_API void GpsLibererProbleme(GpsProbleme* pb);
+GPS_API int GpsNombreActions(const GpsProbleme* pb);
+// Nom de l'action (non terminé par '\0' : sa longueur est rangée dans *longueur)
+GPS_API const char* GpsNomAction(const GpsProbleme* pb, int action, int* longueur);
+// Rejoue un plan : 1 s'il atteint le but. Sinon 0, et *etapeFautive reçoit
+// la première étape inapplicable (à partir de 0), ou la longueur du plan
+// si toutes s'appliquent sans atteindre le but
+GPS_API int GpsVerifierPlan(const GpsProbleme* pb, const int* plan, int longueur, int* etapeFautive);
+// Rejoue un plan donné par les noms de ses actions, lignes affichées par le
+// programme acceptées ("|  Etape 3: grasp bananas,") et lignes sans nom
+// ignorées ; parmi des actions homonymes, la première applicable est jouée.
+// Renvoie v->correct
+GPS_API int GpsVerifierPlanNoms(const GpsProbleme* pb, const char* const* etapes, int nbEtapes, GpsVerification* v);
+
+// Recherches
+GPS_API GpsRecherche* GpsCreerRecherche(void);
+GPS_API void GpsLibererRecherche(GpsRecherche* r);
+// Renvoie l'issue (GPS_RESOLU si un plan a été trouvé ; en GPS_ANYTIME, un
+// plan peut exister avec GPS_DELAI) ; options NULL = valeurs par défaut,
+// GPS_ERREUR si options->taille est plus petite que celle de la version 6
+GPS_API int GpsResoudre(GpsRecherche* r, const GpsProbleme* pb, const GpsOptions* options);
+// Arrête la recherche en cours de r au plus vite (issue GPS_ANNULE) ; si
+// aucune n'est en cours, la prochaine s'arrête dès son début
+GPS_API void GpsAnnuler(GpsRecherche* r);
+// Plan de la dernière recherche : numéros des actions, valables jusqu'au GpsResoudre suivant
+GPS_API int GpsLongueurPlan(const GpsRecherche* r);
+GPS_API int GpsEtapePlan(const GpsRecherche* r, int etape);
+// Statistiques de la dernière recherche, dans les stats->taille premiers octets
+GPS_API void GpsLireStatistiques(const GpsRecherche* r, GpsStatistiques* stats);
+
+// Compilées dans le programme, pour que sizeof soit celui de son gps.h
+static inline void GpsOptionsParDefaut(GpsOptions* options) {
+    options->taille = sizeof(GpsOptions);
+    GpsInitialiserOptions(options);
+}
+
+static inline void GpsStatistiquesRecherche(const GpsRecherche* r, GpsStatistiques* stats) {
+    stats->taille = sizeof(GpsStatistiques);
+    GpsLireStatistiques(r, stats);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
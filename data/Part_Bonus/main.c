@@ -1,8 +1,17 @@
+// clock_gettime (CLOCK_MONOTONIC), mmap, pthread... : POSIX.1-2008, y compris en -std=c11
+#define _POSIX_C_SOURCE 200809L
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <signal.h>
 #include <time.h>
+#include <limits.h>
 
 // Gestion des mesures de temps pour portabilité Windows/Linux
 #ifdef _WIN32
@@ -32,59 +41,194 @@
     }
 #else
     #include <sys/time.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <pthread.h>
 #endif
 
+#include "gps.h"    // API de la bibliothèque libgps (partie 8)
+
 // ---------------------------------------------------------------------
 // Configuration / limites
 // ---------------------------------------------------------------------
-#define MAX_LEN      256   // Taille max d'une ligne
-#define MAX_FACTS    50    // Nombre max de "faits" qu'on stocke dans un état (augmenté pour les blocs)
-#define MAX_ACTIONS  100   // Nombre max d'actions (augmenté pour les blocs)
-#define MAX_STATES   5000  // Nombre max d'états visités lors du BFS (augmenté pour la complexité)
+#define MAX_LEN      256   // Taille max d'une ligne saisie au clavier
+#define CAPACITE_ETATS 4096 // Places au plus des tableaux de noeuds de la BFS à leur création (ils doublent ensuite)
 #define MAX_PRIORITY 10    // Priorité maximale d'une règle
+#define MAX_FILS_MARCHES 64 // Fils d'exécution au plus pour les marches aléatoires
+
+// Les fichiers de problèmes n'ont plus de limite de longueur de ligne, de
+// nombre de faits ou de nombre d'actions : tout est alloué dynamiquement.
 
 // ---------------------------------------------------------------------
 // Structures de base
 // ---------------------------------------------------------------------
 
-// Un état est un ensemble de faits
+// Un morceau de texte (non recopié) : pointeur de début + longueur.
+// Les noms des faits et des actions pointent directement dans le texte
+// du fichier chargé en mémoire.
+typedef struct {
+    const char* debut;
+    int longueur;
+} Tranche;
+
+// Chaque fait distinct reçoit un numéro (son indice dans la table des faits).
+// Un état est alors un ensemble de bits : le bit i est à 1 si le fait i est vrai.
+typedef uint64_t Mot;
+#define BITS_PAR_MOT 64
+#define TEST_BIT(etat, f)   (((etat)[(f) / BITS_PAR_MOT] >> ((f) % BITS_PAR_MOT)) & 1)
+#define METTRE_BIT(etat, f) ((etat)[(f) / BITS_PAR_MOT] |= (Mot)1 << ((f) % BITS_PAR_MOT))
+#define EFFACER_BIT(etat, f) ((etat)[(f) / BITS_PAR_MOT] &= ~((Mot)1 << ((f) % BITS_PAR_MOT)))
+
+// Une liste de faits (préconditions, ajouts, suppressions, but...)
 typedef struct {
     int factCount;
-    char facts[MAX_FACTS][MAX_LEN];
-} State;
+    int* facts;     // numéros des faits
+} ListeFaits;
 
-// L'objectif (finish) est un ensemble de faits (même structure que State)
-typedef State Goal;
+// L'objectif (finish) est une liste de faits
+typedef ListeFaits Goal;
 
 // Chaque action a un nom, des préconditions, une liste de faits ajoutés, une liste de faits supprimés
 // On ajoute une priorité pour la partie 5.5
 // On ajoute des préconditions négatives pour la partie 6
 typedef struct {
-    char name[MAX_LEN];
-    State preconds;
-    State neg_preconds;     // Préconditions négatives (partie 6)
-    State addList;
-    State delList;
+    Tranche name;
+    ListeFaits preconds;
+    ListeFaits neg_preconds;     // Préconditions négatives (partie 6)
+    ListeFaits addList;
+    ListeFaits delList;
     int priority;   // Priorité de la règle (1-10)
 } Action;
 
+// Table des faits : associe à chaque nom de fait un numéro unique
+// (table de hachage à adressage ouvert sur les tranches)
+typedef struct {
+    int nbFaits;
+    int capacite;
+    Tranche* noms;      // noms[i] = nom du fait numéro i
+    int* alveoles;      // indices dans noms[], -1 si vide
+    int nbAlveoles;     // puissance de 2
+} TableFaits;
+
+// Zone mémoire par blocs : toutes les listes de faits d'un problème y sont
+// rangées et libérées d'un coup avec le problème
+typedef struct BlocArene {
+    struct BlocArene* suivant;
+    size_t utilise;
+    size_t taille;
+    char donnees[];
+} BlocArene;
+
+// Un problème complet chargé en mémoire
+typedef struct {
+    char* texte;            // contenu du fichier (les tranches pointent dedans)
+    TableFaits faits;
+    ListeFaits initial;     // faits vrais au départ
+    Goal goal;              // faits à atteindre
+    Action* actions;
+    int actionCount;
+    int actionCapacite;
+    int nbMots;             // taille d'un état en mots de 64 bits
+    BlocArene* arene;
+} Probleme;
+
+// Erreur de chargement, avec sa position exacte dans le fichier
+typedef struct {
+    int ligne;
+    int colonne;
+    char message[MAX_LEN];
+} ErreurChargement;
+
 // Pour la BFS, on utilise un tableau "visited" : on stocke des "noeuds"
-// (un état + un lien vers le parent + l'action qui y mène)
+// (un lien vers le parent + l'action qui y mène). L'état du noeud i est
+// rangé dans etatsVisites, à la position i * nbMots.
 typedef struct {
-    State state;            
     int parent;             // index du noeud parent dans visited[]
     int actionFromParent;   // index de l'action utilisée pour arriver ici
 } Node;
 
+// Issue d'une recherche (partie 4.0) : on distingue "épuisé" de "abandonné"
+typedef enum {
+    ISSUE_RESOLU,           // plan trouvé
+    ISSUE_SANS_SOLUTION,    // espace d'états exploré en entier : aucun plan n'existe
+    ISSUE_INCOMPLET,        // stratégie incomplète arrivée au bout sans plan (pas de preuve)
+    ISSUE_BUDGET_NOEUDS,    // nombre maximal de noeuds développés atteint
+    ISSUE_BUDGET_MEMOIRE,   // plus de place pour les états (budget d'octets ou malloc)
+    ISSUE_DELAI,            // délai écoulé
+    ISSUE_ANNULE            // jeton d'annulation levé (Ctrl+C, service...)
+} IssueRecherche;
+
+// Avancement d'une recherche, publié périodiquement (partie 4.0)
+typedef struct {
+    double tempsMs;
+    long developpes;        // noeuds développés
+    long generes;           // successeurs générés, -1 si la stratégie ne les compte pas
+    int profondeur;         // profondeur de la BFS ou borne f (anytime), -1 sinon
+    int meilleurH;          // meilleure heuristique atteinte, -1 sinon
+    double noeudsParSeconde; // depuis l'instantané précédent
+    size_t octets;          // mémoire de la recherche
+} ProgressionRecherche;
+
+typedef void (*RappelProgression)(const ProgressionRecherche* p, void* contexte);
+
+// Limites communes à toutes les recherches ; 0 (ou NULL) = pas de limite
+typedef struct {
+    double delaiMs;         // délai en millisecondes (horloge monotone)
+    long maxNoeuds;         // noeuds développés au maximum
+    size_t maxOctets;       // mémoire maximale d'une recherche
+    atomic_int* annulation; // jeton d'annulation partagé, lu régulièrement
+    RappelProgression progression; // instantanés d'avancement, NULL = aucun
+    void* contexteProgression;
+    double periodeProgressionMs; // entre deux instantanés (0 = 1000 ms)
+} LimitesRecherche;
+
+// Générateur pseudo-aléatoire xoshiro256** d'une recherche (partie 4.3)
+typedef struct {
+    uint64_t s[4];
+} GenerateurAlea;
+
 // ---------------------------------------------------------------------
 // Variables globales (pour simplifier l'implémentation BFS)
 // ---------------------------------------------------------------------
-Node visited[MAX_STATES];  // Stocke tous les états "visités"
-int visitedCount = 0;      // Nombre d'états différents visités
-int queueArray[MAX_STATES];// File d'indices (vers visited[])
-int front = 0;             // Indice de lecture de la file
-int rear = 0;              // Indice d'écriture de la file
+// L'état des recherches BFS est dans un ContexteRecherche (partie 4) ;
+// ici ne restent que les réglages, lus sans être modifiés par les recherches
+#ifdef GPS_BIBLIOTHEQUE
+int DEBUG_MODE = 0;        // La bibliothèque n'écrit rien sur la sortie standard (partie 8)
+#else
 int DEBUG_MODE = 1;        // Mode débug activé par défaut
+#endif
+int REDUCTION_ORDRE_PARTIEL = 1; // Élagage des ordres équivalents (partie 4.1)
+int REDUCTION_SYMETRIES = 1;     // Fusion des états symétriques (partie 4.2)
+double DELAI_ANYTIME_MS = 1000; // Délai de la recherche anytime (partie 5.8)
+char REPERTOIRE_EXTERNE[MAX_LEN] = "."; // Fichiers de couches de la BFS externe (partie 4.7)
+int RECHERCHE_LOCALE_PLAN = 1;   // Recherche locale bornée pendant l'optimisation des plans (partie 5.7)
+int HEURISTIQUE_REPERES = 1;     // Compte de repères pour les recherches guidées (partie 5.10)
+int HEURISTIQUE_PDB = 0;         // Bases de motifs pour la recherche anytime (partie 5.11)
+char REPERTOIRE_PDB[MAX_LEN] = "."; // Cache des bases de motifs (partie 5.11)
+char REPERTOIRE_PRIORITES[MAX_LEN] = "."; // Priorités apprises de chaque domaine (partie 4.6)
+#ifdef GPS_BIBLIOTHEQUE
+int NB_FILS_MARCHES = 1;          // La bibliothèque tourne souvent dans un pool de processus : un fil par recherche
+#else
+int NB_FILS_MARCHES = 4;          // Fils d'exécution des marches aléatoires (partie 4.5)
+#endif
+unsigned long long GRAINE_RECHERCHE = 0; // Graine des stratégies aléatoires, 0 = tirée au hasard (partie 4.3)
+atomic_int annulationRecherche;  // Jeton d'annulation (levé par Ctrl+C pendant une recherche)
+LimitesRecherche limitesRecherche = { 0, 0, 0, &annulationRecherche, NULL, NULL, 0 }; // Limites des recherches (partie 4.0)
+
+// Erreurs des moteurs de recherche : affichées par le programme, tues par
+// la bibliothèque qui les rend par l'issue de la recherche (partie 8)
+#ifdef GPS_BIBLIOTHEQUE
+#define SIGNALER_ERREUR(...) ((void)0)
+#else
+#define SIGNALER_ERREUR(...) printf(__VA_ARGS__)
+#endif
+
+#define ETAT_VISITE(ctx, pb, i) ((ctx)->etatsVisites + (size_t)(i) * (pb)->nbMots)
+#define ETAT_CANONIQUE(ctx, pb, i) ((ctx)->etatsCanoniques + (size_t)(i) * (pb)->nbMots)
+// Ce qu'on compare pour repérer les doublons : l'état, ou le représentant de son orbite
+#define CLE_ETAT(ctx, pb, i) ((ctx)->canoniques ? ETAT_CANONIQUE(ctx, pb, i) : ETAT_VISITE(ctx, pb, i))
 
 // ---------------------------------------------------------------------
 // Définition de constantes pour les modes de recherche (partie 5)
@@ -94,41 +238,212 @@ int DEBUG_MODE = 1;        // Mode débug activé par défaut
 #define MODE_ALEATOIRE 2
 #define MODE_PRIORITE 3
 #define MODE_MEANS_END 4
+#define MODE_ANYTIME 5
+#define MODE_EXTERNE 6
+#define MODE_FRONTIERE 7
+#define MODE_GLOUTON 8
+#define NB_STRATEGIES 9      // choix proposés par AfficherMenuStrategies (mode = choix - 1)
+
+// Familles de problèmes générés en mémoire (partie 5.1)
+#define GEN_BLOCS      1
+#define GEN_HANOI      2
+#define GEN_GRIPPER    3
+#define GEN_LOGISTIQUE 4
+#define GEN_RIVIERE    5
+
+typedef struct {
+    int famille;        // GEN_...
+    int taille;         // nombre de blocs, disques, balles, colis ou passagers
+    int taille2;        // piquets, salles, villes ou places dans la barque (0 = valeur par défaut)
+    uint64_t graine;    // 0 = instance classique, sinon instance tirée au hasard
+} ParametresGeneration;
+
+// Recherche anytime (partie 5.8) : chaque plan amélioré est transmis à un rappel
+typedef void (*RappelPlan)(const Probleme* pb, const int* plan, int longueur, double tempsMs, void* contexte);
+
+typedef struct {
+    int meilleureLongueur;      // -1 si aucun plan trouvé
+    bool optimal;               // vrai si la recherche a prouvé l'optimalité
+    bool sansSolution;          // vrai si le problème est prouvé sans solution
+    int iterations;             // recherches pondérées lancées
+    long noeudsDeveloppes;
+    double tempsMs;
+    IssueRecherche issue;       // raison de l'arrêt (un plan peut exister même si DELAI)
+    size_t octetsMax;           // pic de mémoire de la recherche
+} ResultatAnytime;
+
+// BFS en mémoire externe (partie 4.7)
+typedef struct {
+    int longueur;               // -1 si aucun plan
+    int couches;                // couches écrites sur disque
+    long long etatsStockes;     // états distincts, toutes couches confondues
+    long long successeurs;      // successeurs générés (avant élimination des doublons)
+    long long octetsEcrits;
+    long noeudsDeveloppes;
+    double tempsMs;
+    IssueRecherche issue;
+} ResultatExterne;
+
+// Recherche de frontière (partie 4.8)
+typedef struct {
+    int longueur;               // -1 si aucun plan
+    bool reversible;            // toutes les actions ont une inverse (trois couches suffisent)
+    int largeurMax;             // nombre d'états de la couche la plus large
+    int passes;                 // recherches lancées, dichotomie comprise
+    long long etatsGeneres;
+    size_t octetsMax;           // pic de mémoire des couches
+    double tempsMs;
+    IssueRecherche issue;
+} ResultatFrontiere;
+
+// Repères (partie 5.10) : faits vrais à un moment de tout plan, avec leurs ordres
+typedef struct {
+    int nbReperes;
+    int nbMots;                 // taille d'un ensemble de repères en mots
+    int* fait;                  // fait du repère l
+    int* repereDuFait;          // repère du fait f, -1 si f n'en est pas un
+    int* debutAvant;            // repères ordonnés avant l : avant[debutAvant[l] .. debutAvant[l + 1][
+    int* avant;
+    int* debutApres;            // repères ordonnés après l
+    int* apres;
+    int nbOrdres;
+    int* debutProducteurs;      // premiers producteurs de l (repère d'actions disjonctif)
+    int* producteurs;
+    Mot* but;                   // repères qui sont des faits du but
+    int diviseur;               // nombre max de repères ajoutés par une action
+} Reperes;
+
+// Bases de motifs (partie 5.11) : distances au but exactes dans des
+// projections du problème, construites une fois puis projetées depuis le disque
+typedef struct {
+    uint64_t cle;               // hachage du domaine
+    int nbMotifs;
+    const int32_t* tailles;     // nombre de faits de chaque motif
+    const int32_t* faits;       // faits des motifs, les uns à la suite des autres
+    const uint8_t** tables;     // 2^taille distances par motif
+    uint8_t* donnees;           // bloc complet : en-tête, motifs, tables
+    size_t taille;
+    bool projete;               // bloc projeté depuis le fichier (sinon alloué)
+} BasesPdb;
+
+#define H_IMPASSE (INT_MAX / 4) // heuristique d'un état dont le but est inatteignable
+
+// Contexte d'une recherche BFS (partie 4) : noeuds visités, file, tampons
+// et générateur aléatoire, réutilisés d'une recherche à l'autre
+typedef struct ContexteRecherche ContexteRecherche;
+
+// Replanification incrémentale (partie 5.9) : la session garde le graphe
+// de recherche d'une requête à l'autre
+typedef struct SessionIncrementale SessionIncrementale;
+
+typedef struct {
+    int longueur;               // -1 si aucun plan
+    bool reconstruit;           // graphe refait de zéro (première requête, but ou faits changés)
+    bool departChange;
+    int reglesChangees;
+    long developpes;            // noeuds développés pour cette requête
+    int noeudsGraphe;           // états gardés dans le graphe
+    double tempsMs;
+    IssueRecherche issue;
+} ResultatIncremental;
+
+// Heuristique FF et recherche gloutonne à deux files (partie 5.12)
+typedef struct EvaluateurFF EvaluateurFF;
+
+typedef struct {
+    int longueur;               // -1 si aucun plan
+    long developpes;            // noeuds développés
+    long evaluations;           // appels à EvaluerFF
+    long preferes;              // noeuds sortis de la file des actions utiles
+    int noeuds;                 // états distincts rencontrés
+    double tempsMs;
+    IssueRecherche issue;
+    size_t octetsMax;           // pic de mémoire de la recherche
+} ResultatGlouton;
 
 // ---------------------------------------------------------------------
 // Prototypes des fonctions
 // ---------------------------------------------------------------------
 // Fonctions utilitaires
-void Trim(char* str);
-void SplitFacts(const char* line, State* state);
-int StateContainsAll(const State* st, const State* subset);
-int CanApply(const State* st, const Action* action);
-void ApplyAction(const State* st, const Action* action, State* newState);
-bool SameState(const State* a, const State* b);
-int IsGoalReached(const State* st, const Goal* goal);
-int ParseFile(const char* filename, State* initial, Goal* goal, Action* actions, int* actionCount);
-void ReconstructPlan(int solutionIndex, Action* actions);
+void* AreneAllouer(Probleme* pb, size_t taille);
+int TrouverOuAjouterFait(TableFaits* table, Tranche nom);
+int ChercherFait(const TableFaits* table, Tranche nom);
+void InitialiserProbleme(Probleme* pb);
+void LibererProbleme(Probleme* pb);
+void CalculerTailleEtat(Probleme* pb);
+Action* AjouterAction(Probleme* pb);
+void AfficherTranche(Tranche t);
+bool TrancheContient(Tranche t, const char* motif);
+Mot* NouvelEtat(const Probleme* pb);
+void EtatDepuisListe(const Probleme* pb, const ListeFaits* liste, Mot* etat);
+int StateContainsAll(const Mot* st, const ListeFaits* subset);
+int CanApply(const Mot* st, const Action* action);
+void ApplyAction(const Probleme* pb, const Mot* st, const Action* action, Mot* newState);
+bool SameState(const Probleme* pb, const Mot* a, const Mot* b);
+int IsGoalReached(const Mot* st, const Goal* goal);
+int ParseTexte(char* texte, size_t taille, Probleme* pb, ErreurChargement* erreur);
+int ParseFile(const char* filename, Probleme* pb);
+int ExtrairePlan(const ContexteRecherche* ctx, int solutionIndex, int** plan);
+void AfficherPlan(const Probleme* pb, const int* plan, int longueur);
+void ReconstructPlan(const ContexteRecherche* ctx, int solutionIndex, const Probleme* pb);
 void DemanderTexte(const char* question, char* buffer, int bufferSize);
 int CreerFichier(char* nomFichier);
 
+// Contrôle des recherches (partie 4.0)
+double HorlogeMs(void);
+const char* NomIssue(IssueRecherche issue);
+void ArmerInterruption(void);
+void DesarmerInterruption(void);
+
 // Fonctions pour la partie 5
-void GenererProblemeBlocs(int nblocs);
-void MelangerRegles(Action* actions, int actionCount);
-int* TrouverReglesApplicables(const State* state, Action* actions, int actionCount, int* nbApplicables);
-int* ConstuireTableauPriorite(const State* state, Action* actions, int actionCount, int* tailleTableau);
-int CalculerDistanceAuBut(const State* state, const Goal* goal);
-int ChoisirMeilleureRegle(const State* state, const Goal* goal, Action* actions, int actionCount);
-int BfsAmeliore(const State* start, const Goal* goal, Action* actions, int actionCount, int mode);
-void InitialiserPriorites(Action* actions, int actionCount);
+int GenererProbleme(const ParametresGeneration* params, Probleme* pb);
+int EcrireProbleme(const Probleme* pb, const char* nomFichier);
+void MelangerRegles(int* ordre, int actionCount, GenerateurAlea* alea);
+int* TrouverReglesApplicables(ContexteRecherche* ctx, const Mot* state, Action* actions, int actionCount, int* nbApplicables);
+int* ConstuireTableauPriorite(ContexteRecherche* ctx, const Mot* state, Action* actions, int actionCount, int* tailleTableau);
+int CalculerDistanceAuBut(const Mot* state, const Goal* goal);
+int ChoisirMeilleureRegle(const Probleme* pb, const Mot* state, const Goal* goal);
+int OptimiserPlan(const Probleme* pb, int* plan, int longueur, bool rechercheLocale);
+int OptimiserPlanLimite(const Probleme* pb, const LimitesRecherche* limites, int* plan, int longueur, bool rechercheLocale);
+int RechercheAnytime(const Probleme* pb, double delaiMs, RappelPlan rappel, void* contexte, ResultatAnytime* resultat);
+int RechercheAnytimeLimitee(const Probleme* pb, const LimitesRecherche* limites, double delaiMs, RappelPlan rappel,
+                            void* contexte, ResultatAnytime* resultat);
+void InitialiserContexteRecherche(ContexteRecherche* ctx);
+void FermerContexteRecherche(ContexteRecherche* ctx);
+int BfsAmeliore(ContexteRecherche* ctx, const Probleme* pb, int mode);
+int BfsExterne(const Probleme* pb, int** plan, ResultatExterne* resultat);
+int BfsFrontiere(const Probleme* pb, int** plan, ResultatFrontiere* resultat);
+bool CalculerReperes(const Probleme* pb, Reperes* r);
+void LibererReperes(Reperes* r);
+void ReperesInitiaux(const Reperes* r, const Mot* etat, Mot* acceptes);
+void AccepterReperes(const Reperes* r, const Mot* acceptesParent, const Mot* etat, Mot* acceptes);
+int CompterReperes(const Reperes* r, const Mot* etat, const Mot* acceptes);
+int HeuristiqueReperes(const Reperes* r, const Mot* etat, const Mot* acceptes);
+uint64_t HacherDomaine(const Probleme* pb);
+bool PreparerBasesPdb(const Probleme* pb, BasesPdb* bases);
+void LibererBasesPdb(BasesPdb* bases);
+int HeuristiquePdb(const BasesPdb* bases, const Mot* etat);
+EvaluateurFF* CreerEvaluateurFF(const Probleme* pb);
+void LibererEvaluateurFF(EvaluateurFF* ev);
+int EvaluerFF(EvaluateurFF* ev, const Mot* etat, int* utiles, int* nbUtiles);
+int RechercheGloutonne(const Probleme* pb, int** plan, ResultatGlouton* resultat);
+int RechercheGloutonneLimitee(const Probleme* pb, const LimitesRecherche* limites, int** plan, ResultatGlouton* resultat);
+void InitialiserSessionIncrementale(SessionIncrementale* s);
+void FermerSessionIncrementale(SessionIncrementale* s);
+int RequeteIncrementale(SessionIncrementale* s, Probleme* nouveau, int** plan, ResultatIncremental* resultat);
+void InitialiserPriorites(Probleme* pb);
 void AnalyseFichierAvecStrategie(const char *nomfile, int mode);
+void AnalyseProblemeAvecStrategie(Probleme* pb, int mode);
 
 // Fonctions pour les menus
 int AfficherMenu();
 int AfficherMenuPartie5();
 int AfficherMenuStrategies();
-void MenuGenerationBlocs();
+void MenuGenerationProblemes();
 void MenuRechercheProbleme();
 void MenuComparaison();
+void MenuLimitesRecherche();
+void MenuReplanification();
 void GestionPartie5();
 void ChoixFichierParDefaut();
 void viderbuffer();
@@ -181,9 +496,36 @@ int AfficherMenuPartie5() {
     printf("|                                                   |\n");
     printf("|           Partie 5: Gestion de la complexité      |\n");
     printf("|                                                   |\n");
-    printf("|  1) Générer un problème de blocs                  |\n");
+    printf("|  1) Générer un problème                           |\n");
     printf("|  2) Lancer une recherche sur un problème          |\n");
     printf("|  3) Comparer les différentes stratégies           |\n");
+    if (REDUCTION_ORDRE_PARTIEL) {
+        printf("|  4) Réduction d'ordre partiel : activée           |\n");
+    } else {
+        printf("|  4) Réduction d'ordre partiel : désactivée        |\n");
+    }
+    if (REDUCTION_SYMETRIES) {
+        printf("|  5) Fusion des états symétriques : activée        |\n");
+    } else {
+        printf("|  5) Fusion des états symétriques : désactivée     |\n");
+    }
+    if (RECHERCHE_LOCALE_PLAN) {
+        printf("|  6) Recherche locale sur les plans : activée      |\n");
+    } else {
+        printf("|  6) Recherche locale sur les plans : désactivée   |\n");
+    }
+    printf("|  7) Limites de recherche (délai, noeuds, mémoire) |\n");
+    printf("|  8) Replanification incrémentale                  |\n");
+    if (HEURISTIQUE_REPERES) {
+        printf("|  9) Heuristique des repères : activée             |\n");
+    } else {
+        printf("|  9) Heuristique des repères : désactivée          |\n");
+    }
+    if (HEURISTIQUE_PDB) {
+        printf("| 10) Bases de motifs (anytime) : activées          |\n");
+    } else {
+        printf("| 10) Bases de motifs (anytime) : désactivées       |\n");
+    }
     printf("|  0) Retour au menu principal                      |\n");
     printf("|                                                   |\n");
     printf("+---------------------------------------------------+\n");
@@ -201,14 +543,38 @@ int AfficherMenuStrategies() {
     printf("|                                                   |\n");
     printf("|  1) Normal (BFS standard)                         |\n");
     printf("|  2) Mélange des règles                            |\n");
-    printf("|  3) Choix aléatoire des règles                    |\n");
-    printf("|  4) Priorité des règles                           |\n");
+    printf("|  3) Marches aléatoires (Monte-Carlo)              |\n");
+    printf("|  4) Priorités des règles (apprises)               |\n");
     printf("|  5) Analyse fin-moyens                            |\n");
+    printf("|  6) Anytime (plans de plus en plus courts)        |\n");
+    printf("|  7) BFS en mémoire externe (grandes instances)    |\n");
+    printf("|  8) Recherche de frontière (peu de mémoire)       |\n");
+    printf("|  9) Gloutonne FF (actions utiles)                 |\n");
     printf("|                                                   |\n");
     printf("+---------------------------------------------------+\n");
     printf("Votre choix : ");
     int choix;
     scanf("%d", &choix);
+    if (choix >= 2 && choix <= 4) {
+        printf("Graine (0 = au hasard, ou celle d'une recherche à rejouer) : ");
+        if (scanf("%llu", &GRAINE_RECHERCHE) != 1) GRAINE_RECHERCHE = 0;
+    }
+    if (choix == 3) {
+        printf("Nombre de fils d'exécution (1 à %d) : ", MAX_FILS_MARCHES);
+        if (scanf("%d", &NB_FILS_MARCHES) != 1 || NB_FILS_MARCHES < 1 || NB_FILS_MARCHES > MAX_FILS_MARCHES) NB_FILS_MARCHES = 4;
+    }
+    if (choix == 4) {
+        printf("Répertoire des priorités apprises : ");
+        if (scanf("%255s", REPERTOIRE_PRIORITES) != 1) strcpy(REPERTOIRE_PRIORITES, ".");
+    }
+    if (choix == 6) {
+        printf("Délai maximal en millisecondes : ");
+        if (scanf("%lf", &DELAI_ANYTIME_MS) != 1 || DELAI_ANYTIME_MS <= 0) DELAI_ANYTIME_MS = 1000;
+    }
+    if (choix == 7) {
+        printf("Répertoire des fichiers temporaires (disque local) : ");
+        if (scanf("%255s", REPERTOIRE_EXTERNE) != 1) strcpy(REPERTOIRE_EXTERNE, ".");
+    }
     return choix;
 }
 
@@ -216,55 +582,162 @@ int AfficherMenuStrategies() {
 // Fonctions utilitaires pour la gestion des faits, de l'etat, etc.
 // ---------------------------------------------------------------------
 
-// Trim : retire les espaces en debut et en fin de chaine
-void Trim(char* str) {
-    // Enlever espaces en debut
-    while(*str == ' ' || *str == '\t') {
-        memmove(str, str+1, strlen(str));
+// Alloue 'taille' octets dans l'arène du problème (alignés sur 8 octets)
+void* AreneAllouer(Probleme* pb, size_t taille) {
+    taille = (taille + 7) & ~(size_t)7;
+    BlocArene* bloc = pb->arene;
+    if (bloc == NULL || bloc->utilise + taille > bloc->taille) {
+        size_t tailleBloc = taille > 65536 ? taille : 65536;
+        bloc = malloc(sizeof(BlocArene) + tailleBloc);
+        if (!bloc) return NULL;
+        bloc->suivant = pb->arene;
+        bloc->utilise = 0;
+        bloc->taille = tailleBloc;
+        pb->arene = bloc;
     }
-    // Enlever espaces en fin
-    char* end = str + strlen(str) - 1;
-    while(end > str && (*end == ' ' || *end == '\t')) {
-        *end = '\0';
-        end--;
+    void* ptr = bloc->donnees + bloc->utilise;
+    bloc->utilise += taille;
+    return ptr;
+}
+
+// Hachage FNV-1a d'une tranche de texte
+static uint32_t HacherTranche(Tranche t) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < t.longueur; i++) {
+        h ^= (unsigned char)t.debut[i];
+        h *= 16777619u;
     }
+    return h;
+}
+
+static bool TranchesEgales(Tranche a, Tranche b) {
+    return a.longueur == b.longueur && memcmp(a.debut, b.debut, a.longueur) == 0;
 }
 
-// Decoupe une ligne en morceaux separes par des virgules, stocke dans un State
-void SplitFacts(const char* line, State* state) {
-    state->factCount = 0;
-    char buffer[MAX_LEN];
-    strcpy(buffer, line);
+// Cherche un fait par son nom : renvoie son numéro ou -1
+int ChercherFait(const TableFaits* table, Tranche nom) {
+    if (table->nbAlveoles == 0) return -1;
+    uint32_t masque = table->nbAlveoles - 1;
+    for (uint32_t i = HacherTranche(nom) & masque; ; i = (i + 1) & masque) {
+        int idx = table->alveoles[i];
+        if (idx < 0) return -1;
+        if (TranchesEgales(table->noms[idx], nom)) return idx;
+    }
+}
 
-    char* token = strtok(buffer, ",");
-    while(token != NULL && state->factCount < MAX_FACTS) {
-        Trim(token);
-        if(strlen(token) > 0) {
-            strcpy(state->facts[state->factCount], token);
-            state->factCount++;
+// Renvoie le numéro du fait 'nom', en le créant s'il n'existe pas encore
+int TrouverOuAjouterFait(TableFaits* table, Tranche nom) {
+    // Agrandir la table de hachage si elle est remplie à plus de moitié
+    if (2 * (table->nbFaits + 1) > table->nbAlveoles) {
+        int nbAlveoles = table->nbAlveoles ? table->nbAlveoles * 2 : 64;
+        int* alveoles = malloc(sizeof(int) * nbAlveoles);
+        if (!alveoles) return -1;
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int f = 0; f < table->nbFaits; f++) {
+            uint32_t i = HacherTranche(table->noms[f]) & (nbAlveoles - 1);
+            while (alveoles[i] >= 0) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = f;
         }
-        token = strtok(NULL, ",");
+        free(table->alveoles);
+        table->alveoles = alveoles;
+        table->nbAlveoles = nbAlveoles;
+    }
+
+    uint32_t masque = table->nbAlveoles - 1;
+    uint32_t i = HacherTranche(nom) & masque;
+    while (table->alveoles[i] >= 0) {
+        if (TranchesEgales(table->noms[table->alveoles[i]], nom)) return table->alveoles[i];
+        i = (i + 1) & masque;
+    }
+
+    if (table->nbFaits == table->capacite) {
+        int capacite = table->capacite ? table->capacite * 2 : 64;
+        Tranche* noms = realloc(table->noms, sizeof(Tranche) * capacite);
+        if (!noms) return -1;
+        table->noms = noms;
+        table->capacite = capacite;
+    }
+    table->noms[table->nbFaits] = nom;
+    table->alveoles[i] = table->nbFaits;
+    return table->nbFaits++;
+}
+
+void InitialiserProbleme(Probleme* pb) {
+    memset(pb, 0, sizeof(Probleme));
+    pb->nbMots = 1;
+}
+
+void LibererProbleme(Probleme* pb) {
+    while (pb->arene) {
+        BlocArene* suivant = pb->arene->suivant;
+        free(pb->arene);
+        pb->arene = suivant;
+    }
+    free(pb->faits.noms);
+    free(pb->faits.alveoles);
+    free(pb->actions);
+    free(pb->texte);
+    InitialiserProbleme(pb);
+}
+
+// Calcule la taille d'un état une fois tous les faits connus
+void CalculerTailleEtat(Probleme* pb) {
+    pb->nbMots = (pb->faits.nbFaits + BITS_PAR_MOT - 1) / BITS_PAR_MOT;
+    if (pb->nbMots == 0) pb->nbMots = 1;
+}
+
+// Ajoute une action vide (priorité 1) à la fin du tableau d'actions
+Action* AjouterAction(Probleme* pb) {
+    if (pb->actionCount == pb->actionCapacite) {
+        int capacite = pb->actionCapacite ? pb->actionCapacite * 2 : 32;
+        Action* actions = realloc(pb->actions, sizeof(Action) * capacite);
+        if (!actions) return NULL;
+        pb->actions = actions;
+        pb->actionCapacite = capacite;
+    }
+    Action* action = &pb->actions[pb->actionCount++];
+    memset(action, 0, sizeof(Action));
+    action->priority = 1;  // Priorité par défaut
+    return action;
+}
+
+void AfficherTranche(Tranche t) {
+    printf("%.*s", t.longueur, t.debut);
+}
+
+// Equivalent de strstr pour une tranche
+bool TrancheContient(Tranche t, const char* motif) {
+    int n = (int)strlen(motif);
+    for (int i = 0; i + n <= t.longueur; i++) {
+        if (memcmp(t.debut + i, motif, n) == 0) return true;
+    }
+    return false;
+}
+
+// Alloue un état vide (tous les faits à faux)
+Mot* NouvelEtat(const Probleme* pb) {
+    return calloc(pb->nbMots, sizeof(Mot));
+}
+
+// Construit l'état dont les faits vrais sont ceux de 'liste'
+void EtatDepuisListe(const Probleme* pb, const ListeFaits* liste, Mot* etat) {
+    memset(etat, 0, sizeof(Mot) * pb->nbMots);
+    for (int i = 0; i < liste->factCount; i++) {
+        METTRE_BIT(etat, liste->facts[i]);
     }
 }
 
 // Verifie que subset est inclus dans st : tous les faits de subset doivent etre dans st
-int StateContainsAll(const State* st, const State* subset) {
+int StateContainsAll(const Mot* st, const ListeFaits* subset) {
     for(int i = 0; i < subset->factCount; i++) {
-        int found = 0;
-        for(int j = 0; j < st->factCount; j++) {
-            if(strcmp(st->facts[j], subset->facts[i]) == 0) {
-                found = 1;
-                break;
-            }
-        }
-        if(!found) return 0;
+        if(!TEST_BIT(st, subset->facts[i])) return 0;
     }
     return 1;
 }
 
 // Test si on peut appliquer l'action : toutes ses preconditions sont dans l'etat
 // Pour la partie 6: et aucune de ses préconditions négatives n'est dans l'état
-int CanApply(const State* st, const Action* action) {
+int CanApply(const Mot* st, const Action* action) {
     // Vérifier que toutes les préconditions positives sont dans l'état
     if (!StateContainsAll(st, &action->preconds)) {
         return 0;
@@ -272,828 +745,7185 @@ int CanApply(const State* st, const Action* action) {
     
     // Vérifier qu'aucune précondition négative n'est dans l'état (partie 6)
     for (int i = 0; i < action->neg_preconds.factCount; i++) {
-        for (int j = 0; j < st->factCount; j++) {
-            if (strcmp(st->facts[j], action->neg_preconds.facts[i]) == 0) {
-                // Si une précondition négative est présente, la règle n'est pas applicable
-                return 0;
-            }
+        if (TEST_BIT(st, action->neg_preconds.facts[i])) {
+            // Si une précondition négative est présente, la règle n'est pas applicable
+            return 0;
         }
     }
     
     return 1;
 }
 
-// Applique l'action : on supprime delList, puis on ajoute addList (sans doublons)
-void ApplyAction(const State* st, const Action* action, State* newState) {
+// Applique l'action : on supprime delList, puis on ajoute addList
+void ApplyAction(const Probleme* pb, const Mot* st, const Action* action, Mot* newState) {
     // Copie de l'etat actuel
-    *newState = *st;
+    memcpy(newState, st, sizeof(Mot) * pb->nbMots);
 
     // 1) Supprimer
     for(int d = 0; d < action->delList.factCount; d++) {
-        for(int i = 0; i < newState->factCount; i++) {
-            if(strcmp(newState->facts[i], action->delList.facts[d]) == 0) {
-                // On supprime le fait i en decalant
-                for(int k = i; k < newState->factCount - 1; k++) {
-                    strcpy(newState->facts[k], newState->facts[k+1]);
-                }
-                newState->factCount--;
-                i--; // pour re-verifier la meme position
-            }
-        }
+        EFFACER_BIT(newState, action->delList.facts[d]);
     }
 
     // 2) Ajouter
     for(int a = 0; a < action->addList.factCount; a++) {
-        int found = 0;
-        for(int i = 0; i < newState->factCount; i++) {
-            if(strcmp(newState->facts[i], action->addList.facts[a]) == 0) {
-                found = 1;
-                break;
-            }
-        }
-        if(!found && newState->factCount < MAX_FACTS) {
-            strcpy(newState->facts[newState->factCount], action->addList.facts[a]);
-            newState->factCount++;
-        }
+        METTRE_BIT(newState, action->addList.facts[a]);
     }
 }
 
 // Compare deux etats pour voir s'ils sont identiques (meme ensemble de faits)
-bool SameState(const State* a, const State* b) {
-    if(a->factCount != b->factCount) return false;
-    // Verifier que chaque fait de a est dans b
-    for(int i = 0; i < a->factCount; i++) {
-        int found = 0;
-        for(int j = 0; j < b->factCount; j++) {
-            if(strcmp(a->facts[i], b->facts[j]) == 0) {
-                found = 1;
-                break;
-            }
-        }
-        if(!found) return false;
-    }
-    return true;
+bool SameState(const Probleme* pb, const Mot* a, const Mot* b) {
+    return memcmp(a, b, sizeof(Mot) * pb->nbMots) == 0;
 }
 
 // Test si l'etat satisfait l'objectif (finish)
-int IsGoalReached(const State* st, const Goal* goal) {
+int IsGoalReached(const Mot* st, const Goal* goal) {
     return StateContainsAll(st, goal);
 }
 
 // ---------------------------------------------------------------------
 // 3) Parsing du fichier
 // ---------------------------------------------------------------------
-// Lecture en 1 passe : start / finish / **** / action:... / preconds:... / add:... / delete:...
-int ParseFile(const char* filename, State* initial, Goal* goal, Action* actions, int* actionCount) {
-    FILE* fp = fopen(filename, "r");
-    if(!fp) {
-        printf("Erreur: impossible d'ouvrir %s\n", filename);
-        return 0;
+// Le fichier est lu en entier en mémoire puis analysé en une seule passe,
+// caractère par caractère. Les faits ne sont pas recopiés : chaque nom de
+// fait est une tranche du texte, numérotée par la table des faits.
+//
+// start / finish / **** / action:... / preconds:... / neg_preconds:... / add:... / delete:...
+//
+// Les virgules à l'intérieur de parenthèses ne séparent pas les faits :
+// "sur(bloc_1,bloc_2)" est un seul fait.
+
+// Position courante dans le texte analysé
+typedef struct {
+    const char* pos;
+    const char* fin;
+    const char* debutLigne;
+    int ligne;
+    ErreurChargement* erreur;
+    int* tampon;            // numéros des faits de la liste en cours de lecture
+    int capaciteTampon;
+} Analyseur;
+
+// Clés reconnues dans un bloc d'action (pour détecter les doublons)
+#define CLE_ACTION       0x01
+#define CLE_PRECONDS     0x02
+#define CLE_NEG_PRECONDS 0x04
+#define CLE_ADD          0x08
+#define CLE_DELETE       0x10
+#define CLE_START        0x20
+#define CLE_FINISH       0x40
+
+// Enregistre une erreur à la position 'pos' (colonne comptée en caractères UTF-8)
+static int ErreurAnalyse(Analyseur* an, const char* pos, const char* message, Tranche detail) {
+    int colonne = 1;
+    for (const char* c = an->debutLigne; c < pos; c++) {
+        if (((unsigned char)*c & 0xC0) != 0x80) colonne++;
     }
+    an->erreur->ligne = an->ligne;
+    an->erreur->colonne = colonne;
+    if (detail.longueur > 0) {
+        snprintf(an->erreur->message, MAX_LEN, "%s '%.*s'", message, detail.longueur, detail.debut);
+    } else {
+        snprintf(an->erreur->message, MAX_LEN, "%s", message);
+    }
+    return 0;
+}
 
-    char line[MAX_LEN];
-    int readingActionIndex = -1;
-    *actionCount = 0;
+static bool EstBlanc(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+// Passe à la ligne suivante (la position doit être sur un '\n' ou en fin de texte)
+static void LigneSuivante(Analyseur* an) {
+    if (an->pos < an->fin) {
+        an->pos++;
+        an->ligne++;
+        an->debutLigne = an->pos;
+    }
+}
 
-    // Vider initial / goal
-    initial->factCount = 0;
-    goal->factCount = 0;
+// Lit le reste de la ligne sans les espaces aux extrémités
+static Tranche LireFinDeLigne(Analyseur* an) {
+    while (an->pos < an->fin && EstBlanc(*an->pos)) an->pos++;
+    const char* debut = an->pos;
+    const char* dernier = an->pos;
+    while (an->pos < an->fin && *an->pos != '\n') {
+        if (!EstBlanc(*an->pos)) dernier = an->pos + 1;
+        an->pos++;
+    }
+    Tranche t = { debut, (int)(dernier - debut) };
+    return t;
+}
 
-    while(fgets(line, sizeof(line), fp)) {
-        // enlever \n
-        line[strcspn(line, "\r\n")] = '\0';
+// Lit une liste de faits séparés par des virgules jusqu'à la fin de la ligne
+static int LireListeFaits(Analyseur* an, Probleme* pb, ListeFaits* liste) {
+    int nb = 0;
+    const char* debutFait = NULL;   // premier caractère non blanc du fait
+    const char* finFait = NULL;     // après le dernier caractère non blanc
+    const char* parenthese = NULL;  // première '(' non fermée
+    int profondeur = 0;
 
-        if(strncmp(line, "****", 4) == 0) {
-            readingActionIndex++;
-            (*actionCount)++;
-            
-            // Initialisation de la nouvelle action
-            memset(&actions[readingActionIndex], 0, sizeof(Action));
-            actions[readingActionIndex].priority = 1;  // Priorité par défaut
-            
-            continue;
-        }
+    for (;;) {
+        bool finDeLigne = an->pos >= an->fin || *an->pos == '\n';
+        char c = finDeLigne ? ',' : *an->pos;
 
-        if(readingActionIndex < 0) {
-            // On n'est pas dans un bloc action
-            if(strncmp(line, "start:", 6) == 0) {
-                SplitFacts(line + 6, initial);
-            }
-            else if(strncmp(line, "finish:", 7) == 0) {
-                SplitFacts(line + 7, goal);
-            }
-        } else {
-            // On est dans un bloc action
-            int idx = readingActionIndex;
-            if(strncmp(line, "action:", 7) == 0) {
-                strcpy(actions[idx].name, line + 7);
-            }
-            else if(strncmp(line, "preconds:", 9) == 0) {
-                SplitFacts(line + 9, &actions[idx].preconds);
-            }
-            else if(strncmp(line, "neg_preconds:", 13) == 0) {
-                SplitFacts(line + 13, &actions[idx].neg_preconds);
-            }
-            else if(strncmp(line, "add:", 4) == 0) {
-                SplitFacts(line + 4, &actions[idx].addList);
+        if (c == ',' && profondeur == 0) {
+            if (debutFait) {
+                Tranche nom = { debutFait, (int)(finFait - debutFait) };
+                int f = TrouverOuAjouterFait(&pb->faits, nom);
+                if (f < 0) return ErreurAnalyse(an, debutFait, "Mémoire insuffisante", (Tranche){0});
+                if (nb == an->capaciteTampon) {
+                    int capacite = an->capaciteTampon ? an->capaciteTampon * 2 : 64;
+                    int* tampon = realloc(an->tampon, sizeof(int) * capacite);
+                    if (!tampon) return ErreurAnalyse(an, debutFait, "Mémoire insuffisante", (Tranche){0});
+                    an->tampon = tampon;
+                    an->capaciteTampon = capacite;
+                }
+                an->tampon[nb++] = f;
             }
-            else if(strncmp(line, "delete:", 7) == 0) {
-                SplitFacts(line + 7, &actions[idx].delList);
+            debutFait = NULL;
+            if (finDeLigne) break;
+        } else if (finDeLigne) {
+            // Fin de ligne avec une parenthèse encore ouverte
+            return ErreurAnalyse(an, parenthese, "Parenthèse non fermée dans le fait",
+                                 (Tranche){ debutFait, (int)(finFait - debutFait) });
+        } else if (!EstBlanc(c)) {
+            if (!debutFait) debutFait = an->pos;
+            finFait = an->pos + 1;
+            if (c == '(') {
+                if (profondeur++ == 0) parenthese = an->pos;
+            } else if (c == ')') {
+                if (--profondeur < 0) {
+                    return ErreurAnalyse(an, an->pos, "Parenthèse fermante sans ouvrante", (Tranche){0});
+                }
             }
         }
+        an->pos++;
     }
 
-    fclose(fp);
+    liste->factCount = nb;
+    liste->facts = NULL;
+    if (nb > 0) {
+        liste->facts = AreneAllouer(pb, sizeof(int) * nb);
+        if (!liste->facts) return ErreurAnalyse(an, an->pos, "Mémoire insuffisante", (Tranche){0});
+        memcpy(liste->facts, an->tampon, sizeof(int) * nb);
+    }
     return 1;
 }
 
-// ---------------------------------------------------------------------
-// 4) BFS améliorée : avec support des différents modes de recherche
-// ---------------------------------------------------------------------
-int BfsAmeliore(const State* start, const Goal* goal, Action* actions, int actionCount, int mode) {
-    // Reinit
-    visitedCount = 0;
-    front = 0;
-    rear = 0;
-
-    // Mesure du temps
-    struct timeval debutRecherche, finRecherche;
-    gettimeofday(&debutRecherche, NULL);
-    
-    // Mélanger les règles au début si demandé
-    if (mode == MODE_MELANGE) {
-        if (DEBUG_MODE) printf("DEBUG: Mode MELANGE activé - mélange des règles...\n");
-        MelangerRegles(actions, actionCount);
+// Vérifie que le bloc d'action en cours est complet (un bloc vide est ignoré)
+static int TerminerBlocAction(Analyseur* an, Probleme* pb, int clesVues, int ligneBloc) {
+    if (pb->actionCount == 0 || (clesVues & CLE_ACTION)) return 1;
+    if (clesVues == 0) {
+        pb->actionCount--;
+        return 1;
     }
+    an->erreur->ligne = ligneBloc;
+    an->erreur->colonne = 1;
+    snprintf(an->erreur->message, MAX_LEN, "Bloc d'action sans ligne 'action:'");
+    return 0;
+}
 
-    // L'etat initial -> visited[0]
-    visited[0].state = *start;
-    visited[0].parent = -1;
-    visited[0].actionFromParent = -1;
-    visitedCount = 1;
+// Analyse le texte complet d'un problème. Le problème devient propriétaire
+// de 'texte' (alloué par malloc, de longueur 'taille').
+int ParseTexte(char* texte, size_t taille, Probleme* pb, ErreurChargement* erreur) {
+    InitialiserProbleme(pb);
+    pb->texte = texte;
 
-    // On push 0 dans la file
-    queueArray[rear++] = 0;
-    
-    int etatsExplores = 0;
+    Analyseur an = { texte, texte + taille, texte, 1, erreur, NULL, 0 };
+    int clesVues = 0;       // clés déjà lues dans le bloc courant
+    int clesEntete = 0;     // start / finish déjà lus
+    int ligneBloc = 0;      // ligne du dernier "****"
+    int ok = 1;
 
-    // Parcours
-    while(front < rear) {
-        int currentIndex = queueArray[front++];
-        Node currentNode = visited[currentIndex];
-        etatsExplores++;
-        
-        if (DEBUG_MODE && etatsExplores % 100 == 0) {
-            printf("DEBUG: %d états explorés...\n", etatsExplores);
+    while (ok && an.pos < an.fin) {
+        // Sauter les blancs en début de ligne
+        while (an.pos < an.fin && EstBlanc(*an.pos)) an.pos++;
+        if (an.pos >= an.fin || *an.pos == '\n') {
+            LigneSuivante(&an);
+            continue;
         }
 
-        // Test objectif
-        if(IsGoalReached(&currentNode.state, goal)) {
-            gettimeofday(&finRecherche, NULL);
-            double tempsRecherche = (finRecherche.tv_sec - debutRecherche.tv_sec) * 1000.0 + 
-                                   (finRecherche.tv_usec - debutRecherche.tv_usec) / 1000.0;
-            if (DEBUG_MODE) {
-                printf("DEBUG: Solution trouvée ! (%d états explorés, %.2f ms)\n", 
-                      etatsExplores, tempsRecherche);
-            }
-            return currentIndex; // On a trouve
+        // Séparateur d'actions
+        if (an.fin - an.pos >= 4 && memcmp(an.pos, "****", 4) == 0) {
+            ok = TerminerBlocAction(&an, pb, clesVues, ligneBloc);
+            if (ok && !AjouterAction(pb)) ok = ErreurAnalyse(&an, an.pos, "Mémoire insuffisante", (Tranche){0});
+            clesVues = 0;
+            ligneBloc = an.ligne;
+            while (an.pos < an.fin && *an.pos != '\n') an.pos++;
+            LigneSuivante(&an);
+            continue;
         }
 
-        // Selon le mode, on choisit différemment la prochaine règle à appliquer
-        switch(mode) {
-            case MODE_NORMAL: {
-                // Mode normal : on essaie toutes les actions en ordre
-                for(int a = 0; a < actionCount; a++) {
-                    if(CanApply(&currentNode.state, &actions[a])) {
-                        if (DEBUG_MODE) printf("DEBUG: Applique règle %d: %s\n", a, actions[a].name);
-                        
-                        // generer un nouvel etat
-                        State newState;
-                        ApplyAction(&currentNode.state, &actions[a], &newState);
-
-                        // verif si deja vu
-                        bool dejaVu = false;
-                        for(int i = 0; i < visitedCount; i++) {
-                            if(SameState(&newState, &visited[i].state)) {
-                                dejaVu = true;
-                                break;
-                            }
-                        }
-                        if(!dejaVu && visitedCount < MAX_STATES) {
-                            visited[visitedCount].state = newState;
-                            visited[visitedCount].parent = currentIndex;
-                            visited[visitedCount].actionFromParent = a;
-                            queueArray[rear++] = visitedCount;
-                            visitedCount++;
-                        }
-                    }
-                }
-                break;
-            }
-            
-            case MODE_ALEATOIRE: {
-                // Mode aléatoire : on choisit une règle au hasard parmi les applicables
-                int nbApplicables = 0;
-                int* applicables = TrouverReglesApplicables(&currentNode.state, actions, actionCount, &nbApplicables);
-                
-                if (nbApplicables > 0) {
-                    // Choisir une règle au hasard
-                    int indiceAleatoire = rand() % nbApplicables;
-                    int a = applicables[indiceAleatoire];
-                    
-                    if (DEBUG_MODE) printf("DEBUG: Applique règle aléatoire %d: %s\n", a, actions[a].name);
-                    
-                    // Génerer un nouvel état
-                    State newState;
-                    ApplyAction(&currentNode.state, &actions[a], &newState);
-                    
-                    // Verif si déjà vu
-                    bool dejaVu = false;
-                    for(int i = 0; i < visitedCount; i++) {
-                        if(SameState(&newState, &visited[i].state)) {
-                            dejaVu = true;
-                            break;
-                        }
-                    }
-                    if(!dejaVu && visitedCount < MAX_STATES) {
-                        visited[visitedCount].state = newState;
-                        visited[visitedCount].parent = currentIndex;
-                        visited[visitedCount].actionFromParent = a;
-                        queueArray[rear++] = visitedCount;
-                        visitedCount++;
-                    }
-                }
-                break;
-            }
-            
-            case MODE_PRIORITE: {
-                // Mode priorité : on utilise le tableau pondéré par les priorités
-                int taillePonderee = 0;
-                int* tableauPriorite = ConstuireTableauPriorite(&currentNode.state, actions, actionCount, &taillePonderee);
-                
-                if (taillePonderee > 0) {
-                    // Choisir une règle au hasard selon la pondération
-                    int indiceAleatoire = rand() % taillePonderee;
-                    int a = tableauPriorite[indiceAleatoire];
-                    
-                    if (DEBUG_MODE) printf("DEBUG: Applique règle par priorité %d: %s (priorité %d)\n", 
-                                          a, actions[a].name, actions[a].priority);
-                    
-                    // Génerer un nouvel état
-                    State newState;
-                    ApplyAction(&currentNode.state, &actions[a], &newState);
-                    
-                    // Verif si déjà vu
-                    bool dejaVu = false;
-                    for(int i = 0; i < visitedCount; i++) {
-                        if(SameState(&newState, &visited[i].state)) {
-                            dejaVu = true;
-                            break;
-                        }
-                    }
-                    if(!dejaVu && visitedCount < MAX_STATES) {
-                        visited[visitedCount].state = newState;
-                        visited[visitedCount].parent = currentIndex;
-                        visited[visitedCount].actionFromParent = a;
-                        queueArray[rear++] = visitedCount;
-                        visitedCount++;
-                    }
-                }
-                break;
-            }
-            
-            case MODE_MEANS_END: {
-                // Mode analyse fin-moyens : on choisit la règle qui nous rapproche le plus du but
-                int meilleureRegle = ChoisirMeilleureRegle(&currentNode.state, goal, actions, actionCount);
-                
-                if (meilleureRegle != -1) {
-                    if (DEBUG_MODE) printf("DEBUG: Applique meilleure règle %d: %s\n", 
-                                          meilleureRegle, actions[meilleureRegle].name);
-                    
-                    // Génerer un nouvel état
-                    State newState;
-                    ApplyAction(&currentNode.state, &actions[meilleureRegle], &newState);
-                    
-                    // Verif si déjà vu
-                    bool dejaVu = false;
-                    for(int i = 0; i < visitedCount; i++) {
-                        if(SameState(&newState, &visited[i].state)) {
-                            dejaVu = true;
-                            break;
-                        }
-                    }
-                    if(!dejaVu && visitedCount < MAX_STATES) {
-                        visited[visitedCount].state = newState;
-                        visited[visitedCount].parent = currentIndex;
-                        visited[visitedCount].actionFromParent = meilleureRegle;
-                        queueArray[rear++] = visitedCount;
-                        visitedCount++;
+        // Lire la clé jusqu'au ':'
+        const char* debutCle = an.pos;
+        const char* finCle = an.pos;
+        while (an.pos < an.fin && *an.pos != ':' && *an.pos != '\n') {
+            if (!EstBlanc(*an.pos)) finCle = an.pos + 1;
+            an.pos++;
+        }
+        Tranche cle = { debutCle, (int)(finCle - debutCle) };
+        if (an.pos >= an.fin || *an.pos != ':') {
+            ok = ErreurAnalyse(&an, an.pos, "':' attendu après", cle);
+            break;
+        }
+        an.pos++;
+
+        int code = 0;
+        if (cle.longueur == 5 && memcmp(cle.debut, "start", 5) == 0) code = CLE_START;
+        else if (cle.longueur == 6 && memcmp(cle.debut, "finish", 6) == 0) code = CLE_FINISH;
+        else if (cle.longueur == 6 && memcmp(cle.debut, "action", 6) == 0) code = CLE_ACTION;
+        else if (cle.longueur == 8 && memcmp(cle.debut, "preconds", 8) == 0) code = CLE_PRECONDS;
+        else if (cle.longueur == 12 && memcmp(cle.debut, "neg_preconds", 12) == 0) code = CLE_NEG_PRECONDS;
+        else if (cle.longueur == 3 && memcmp(cle.debut, "add", 3) == 0) code = CLE_ADD;
+        else if (cle.longueur == 6 && memcmp(cle.debut, "delete", 6) == 0) code = CLE_DELETE;
+
+        if (code == 0) {
+            ok = ErreurAnalyse(&an, debutCle, "Clé inconnue", cle);
+        } else if ((code == CLE_START || code == CLE_FINISH) && pb->actionCount > 0) {
+            ok = ErreurAnalyse(&an, debutCle, "Doit précéder le premier '****' :", cle);
+        } else if (!(code == CLE_START || code == CLE_FINISH) && pb->actionCount == 0) {
+            ok = ErreurAnalyse(&an, debutCle, "Clé hors d'un bloc d'action (ajouter '****' avant) :", cle);
+        } else if ((clesVues | clesEntete) & code) {
+            ok = ErreurAnalyse(&an, debutCle, "Clé en double", cle);
+        } else {
+            if (code == CLE_START || code == CLE_FINISH) clesEntete |= code;
+            else clesVues |= code;
+            Action* action = pb->actionCount > 0 ? &pb->actions[pb->actionCount - 1] : NULL;
+            switch (code) {
+                case CLE_START:        ok = LireListeFaits(&an, pb, &pb->initial); break;
+                case CLE_FINISH:       ok = LireListeFaits(&an, pb, &pb->goal); break;
+                case CLE_PRECONDS:     ok = LireListeFaits(&an, pb, &action->preconds); break;
+                case CLE_NEG_PRECONDS: ok = LireListeFaits(&an, pb, &action->neg_preconds); break;
+                case CLE_ADD:          ok = LireListeFaits(&an, pb, &action->addList); break;
+                case CLE_DELETE:       ok = LireListeFaits(&an, pb, &action->delList); break;
+                case CLE_ACTION: {
+                    const char* debutNom = an.pos;
+                    action->name = LireFinDeLigne(&an);
+                    if (action->name.longueur == 0) {
+                        ok = ErreurAnalyse(&an, debutNom, "Nom d'action vide", (Tranche){0});
                     }
+                    break;
                 }
-                break;
             }
         }
+        LigneSuivante(&an);
     }
 
-    // Pas trouve
-    gettimeofday(&finRecherche, NULL);
-    double tempsRecherche = (finRecherche.tv_sec - debutRecherche.tv_sec) * 1000.0 + 
-                           (finRecherche.tv_usec - debutRecherche.tv_usec) / 1000.0;
-    if (DEBUG_MODE) {
-        printf("DEBUG: Aucune solution trouvée. (%d états explorés, %.2f ms)\n", 
-              etatsExplores, tempsRecherche);
+    if (ok) ok = TerminerBlocAction(&an, pb, clesVues, ligneBloc);
+    free(an.tampon);
+
+    CalculerTailleEtat(pb);
+    return ok;
+}
+
+// Lit tout le contenu d'un fichier dans un tampon alloué (terminé par '\0')
+static char* LireFichierComplet(FILE* fp, size_t* taille) {
+    size_t capacite = 65536, lu = 0;
+    char* texte = malloc(capacite + 1);
+    if (!texte) return NULL;
+    for (;;) {
+        size_t n = fread(texte + lu, 1, capacite - lu, fp);
+        lu += n;
+        if (lu < capacite) break;
+        capacite *= 2;
+        char* plusGrand = realloc(texte, capacite + 1);
+        if (!plusGrand) { free(texte); return NULL; }
+        texte = plusGrand;
     }
-    return -1;
+    texte[lu] = '\0';
+    *taille = lu;
+    return texte;
 }
 
-// ---------------------------------------------------------------------
-// 5) Reconstruction du plan (liste d'actions) a partir de l'index solution
-// ---------------------------------------------------------------------
-void ReconstructPlan(int solutionIndex, Action* actions) {
-    int plan[MAX_STATES];
-    int length = 0;
+// Charge un fichier de problème. En cas d'erreur, affiche sa position
+// (fichier:ligne:colonne) et renvoie 0.
+int ParseFile(const char* filename, Probleme* pb) {
+    InitialiserProbleme(pb);
+    FILE* fp = fopen(filename, "rb");
+    if(!fp) {
+        printf("Erreur: impossible d'ouvrir %s\n", filename);
+        return 0;
+    }
 
-    int current = solutionIndex;
-    while(current != -1) {
-        plan[length] = visited[current].actionFromParent;
-        length++;
-        current = visited[current].parent;
+    size_t taille = 0;
+    char* texte = LireFichierComplet(fp, &taille);
+    fclose(fp);
+    if (!texte) {
+        printf("Erreur: mémoire insuffisante pour lire %s\n", filename);
+        return 0;
     }
-    // plan[length-1] doit etre -1 (et correspond a l'etat initial)
 
-    // Affiche en sens direct
-    printf("\n+------------------PLAN TROUVE------------------+\n|\n");
-    int step = 1;
-    // Saute le tout dernier -1
-    for(int i = length - 2; i >= 0; i--) {
-        int actionIndex = plan[i];
-        printf("|  Etape %d: %s \n", step, actions[actionIndex].name);
-        step++;
+    ErreurChargement erreur;
+    if (!ParseTexte(texte, taille, pb, &erreur)) {
+        printf("Erreur: %s:%d:%d: %s\n", filename, erreur.ligne, erreur.colonne, erreur.message);
+        LibererProbleme(pb);
+        return 0;
     }
-    printf("|\n+------------------FIN DU PLAN------------------+\n\n");
+    return 1;
 }
 
 // ---------------------------------------------------------------------
-// 6) Fonctions pour creation d'un fichier via l'utilisateur
+// 4.0 - Contrôle des recherches : délai, budgets, annulation
 // ---------------------------------------------------------------------
+// Chaque boucle de recherche appelle ControleArret() une fois par noeud
+// développé. Le budget de noeuds est testé à chaque appel ; le jeton
+// d'annulation et l'horloge seulement une fois toutes les
+// PERIODE_CONTROLE expansions, le contrôle reste donc négligeable.
+// L'horloge est monotone : un changement d'heure du système ne fausse pas
+// le délai.
+// Au même rythme, ControleArret publie l'avancement (rappel 'progression'
+// des limites) une fois par période : les moteurs tiennent à jour les
+// champs generes, profondeur, meilleurH et octets de leur contrôle. Les
+// fils d'exécution, qui n'appellent que ControleImmediat, ne publient rien.
 
-// Pose une question et recupere la reponse dans 'buffer'
-void DemanderTexte(const char* question, char* buffer, int bufferSize) {
-    printf("%s", question);
-    fgets(buffer, bufferSize, stdin);
-    // enlever \n
-    buffer[strcspn(buffer, "\r\n")] = '\0';
-}
-
-// Cree un fichier en format correct
-// start:...
-// finish:...
-// puis un certain nombre d'actions, chacune separee par ****
-int CreerFichier(char* nomFichier) {
+#define PERIODE_CONTROLE 16    // expansions entre deux lectures de l'horloge et du jeton
 
-    printf("Entrez le nom du fichier à créer (ex: monFichier.txt) : ");
-    fgets(nomFichier, 255, stdin);
+typedef struct {
+    LimitesRecherche limites;
+    double debutMs;
+    long noeuds;            // noeuds développés depuis le début
+    size_t octets;          // mémoire réservée par la recherche (ReserverMemoire)
+    size_t octetsMax;       // pic de cette mémoire
+    IssueRecherche issue;   // raison de l'arrêt (valable si ControleArret a renvoyé vrai)
 
-    size_t len = strlen(nomFichier);
-    if (len > 0 && nomFichier[len - 1] == '\n') {
-        nomFichier[len - 1] = '\0';
-    }
+    // Avancement, tenu par le moteur et publié par ControleArret
+    long generes;           // -1 si sans objet
+    int profondeur;         // -1 si sans objet
+    int meilleurH;          // -1 si sans objet
+    double prochainInstantaneMs;
+    double dernierInstantaneMs;
+    long noeudsDernierInstantane;
+} ControleRecherche;
 
-    char cheminComplet[512];
-    snprintf(cheminComplet, sizeof(cheminComplet), "assets/%s", nomFichier);
+double HorlogeMs(void) {
+#ifdef _WIN32
+    LARGE_INTEGER frequence, compteur;
+    QueryPerformanceFrequency(&frequence);
+    QueryPerformanceCounter(&compteur);
+    return (double)compteur.QuadPart * 1000.0 / (double)frequence.QuadPart;
+#else
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1000.0 + t.tv_nsec / 1000000.0;
+#endif
+}
 
-    FILE* fp = fopen(cheminComplet, "w");
-    if (!fp) {
-        printf("Impossible de créer le fichier '%s'.\n", cheminComplet);
-        return 0;
+const char* NomIssue(IssueRecherche issue) {
+    switch (issue) {
+        case ISSUE_RESOLU:         return "plan trouvé";
+        case ISSUE_SANS_SOLUTION:  return "prouvé sans solution";
+        case ISSUE_INCOMPLET:      return "stratégie incomplète, pas de preuve";
+        case ISSUE_BUDGET_NOEUDS:  return "budget de noeuds atteint";
+        case ISSUE_BUDGET_MEMOIRE: return "budget mémoire atteint";
+        case ISSUE_DELAI:          return "délai écoulé";
+        case ISSUE_ANNULE:         return "annulée";
     }
+    return "?";
+}
 
-    char buf[MAX_LEN];
-    DemanderTexte("Entrez les conditions initiales (séparées par des virgules):\n> ", buf, MAX_LEN);
-    fprintf(fp, "start:%s\n", buf);
+static void DemarrerControle(ControleRecherche* c, const LimitesRecherche* limites) {
+    c->limites = *limites;
+    c->debutMs = HorlogeMs();
+    c->noeuds = 0;
+    c->octets = 0;
+    c->octetsMax = 0;
+    c->issue = ISSUE_RESOLU;
+    c->generes = -1;
+    c->profondeur = -1;
+    c->meilleurH = -1;
+    c->dernierInstantaneMs = c->debutMs;
+    c->noeudsDernierInstantane = 0;
+    if (c->limites.periodeProgressionMs <= 0) c->limites.periodeProgressionMs = 1000;
+    c->prochainInstantaneMs = c->debutMs + c->limites.periodeProgressionMs;
+}
 
-    DemanderTexte("Entrez les conditions d'arrivée (finish), séparées par des virgules:\n> ", buf, MAX_LEN);
-    fprintf(fp, "finish:%s\n", buf);
+// Compte une allocation de la recherche ; faux si elle dépasse le budget mémoire
+static bool ReserverMemoire(ControleRecherche* c, size_t octets) {
+    if (c->limites.maxOctets > 0 && c->octets + octets > c->limites.maxOctets) return false;
+    c->octets += octets;
+    if (c->octets > c->octetsMax) c->octetsMax = c->octets;
+    return true;
+}
 
-    int nbActions = 0;
-    printf("Combien d'actions voulez-vous saisir ? ");
-    scanf("%d", &nbActions);
-    getchar();
+static void RendreMemoire(ControleRecherche* c, size_t octets) {
+    c->octets -= octets < c->octets ? octets : c->octets;
+}
 
-    for (int i = 0; i < nbActions; i++) {
-        fprintf(fp, "****\n");
-        // Action (nom)
-        DemanderTexte("\nNom de l'action : ", buf, MAX_LEN);
-        fprintf(fp, "action:%s\n", buf);
+static double DureeControleMs(const ControleRecherche* c) {
+    return HorlogeMs() - c->debutMs;
+}
 
-        // Préconditions
-        DemanderTexte("Préconditions (séparées par des virgules) : ", buf, MAX_LEN);
-        fprintf(fp, "preconds:%s\n", buf);
+// Jeton d'annulation et délai seulement, lus tout de suite (pour les
+// boucles dont une itération est longue, ou les fils d'exécution qui
+// travaillent sur leur propre copie du contrôle)
+static bool ControleImmediat(ControleRecherche* c) {
+    if (c->limites.annulation && atomic_load_explicit(c->limites.annulation, memory_order_relaxed)) {
+        c->issue = ISSUE_ANNULE;
+        return true;
+    }
+    if (c->limites.delaiMs > 0 && DureeControleMs(c) >= c->limites.delaiMs) {
+        c->issue = ISSUE_DELAI;
+        return true;
+    }
+    return false;
+}
 
-        // Préconditions négatives
-        DemanderTexte("Préconditions négatives (séparées par des virgules) : ", buf, MAX_LEN);
-        fprintf(fp, "neg_preconds:%s\n", buf);
+// Instantané d'avancement, si la période est écoulée
+static void PublierProgression(ControleRecherche* c) {
+    double maintenant = HorlogeMs();
+    if (maintenant < c->prochainInstantaneMs) return;
+    double ecoule = maintenant - c->dernierInstantaneMs;
+    ProgressionRecherche p = {
+        maintenant - c->debutMs,
+        c->noeuds,
+        c->generes,
+        c->profondeur,
+        c->meilleurH,
+        ecoule > 0 ? (c->noeuds - c->noeudsDernierInstantane) * 1000.0 / ecoule : 0,
+        c->octets
+    };
+    c->dernierInstantaneMs = maintenant;
+    c->noeudsDernierInstantane = c->noeuds;
+    c->prochainInstantaneMs = maintenant + c->limites.periodeProgressionMs;
+    c->limites.progression(&p, c->limites.contexteProgression);
+}
 
-        // Faits ajoutés
-        DemanderTexte("Faits ajoutés (séparés par des virgules) : ", buf, MAX_LEN);
-        fprintf(fp, "add:%s\n", buf);
+// Affichage de l'avancement en mode debug (BfsAmeliore)
+static void AfficherProgression(const ProgressionRecherche* p, void* contexte) {
+    (void)contexte;
+    printf("DEBUG: %.0f ms : %ld noeuds développés, %ld générés, profondeur %d, %.0f noeuds/s, %.1f Ko\n",
+           p->tempsMs, p->developpes, p->generes, p->profondeur, p->noeudsParSeconde, p->octets / 1024.0);
+}
 
-        // Faits supprimés
-        DemanderTexte("Faits supprimés (séparés par des virgules) : ", buf, MAX_LEN);
-        fprintf(fp, "delete:%s\n", buf);
+// Renvoie vrai si la recherche doit s'arrêter (c->issue dit pourquoi).
+// Le premier appel lit déjà le jeton : une recherche annulée d'avance
+// s'arrête tout de suite.
+static bool ControleArret(ControleRecherche* c) {
+    c->noeuds++;
+    if (c->limites.maxNoeuds > 0 && c->noeuds > c->limites.maxNoeuds) {
+        c->issue = ISSUE_BUDGET_NOEUDS;
+        return true;
     }
+    if (c->noeuds % PERIODE_CONTROLE != 1) return false;
+    if (ControleImmediat(c)) return true;
+    if (c->limites.progression) PublierProgression(c);
+    return false;
+}
 
-    fclose(fp);
-    printf("\nFichier '%s' créé avec succès dans le dossier 'assets'.\n", cheminComplet);
-    return 1;
+// Ctrl+C pendant une recherche lève le jeton au lieu de tuer le programme
+static void InterrompreRecherche(int signal) {
+    (void)signal;
+    atomic_store(&annulationRecherche, 1);
 }
 
-// Initialiser les priorités des règles (pour la partie 5.5)
-void InitialiserPriorites(Action* actions, int actionCount) {
-    // Par défaut, toutes les règles ont une priorité de 1
-    for (int i = 0; i < actionCount; i++) {
-        actions[i].priority = 1;
+void ArmerInterruption(void) {
+    atomic_store(&annulationRecherche, 0);
+    signal(SIGINT, InterrompreRecherche);
+}
+
+void DesarmerInterruption(void) {
+    signal(SIGINT, SIG_DFL);
+}
+
+// ---------------------------------------------------------------------
+// 4.1 - Réduction d'ordre partiel (ensembles têtus forts)
+// ---------------------------------------------------------------------
+// Beaucoup d'actions sont indépendantes : les appliquer dans un ordre ou
+// dans l'autre mène au même état, et la BFS génère alors toutes les
+// permutations. Dans chaque état, on calcule un "ensemble têtu" T
+// d'actions tel qu'il suffit d'appliquer les actions applicables de T
+// (la recherche reste complète et le plan trouvé reste le plus court) :
+//  - T contient tous les producteurs d'un fait du but encore faux ;
+//  - pour une action de T non applicable, T contient tous les moyens de
+//    lever une de ses conditions fausses ;
+//  - pour une action de T applicable, T contient toutes les actions qui
+//    interfèrent avec elle (l'une désactive l'autre, ou leurs effets se
+//    contredisent).
+
+// Index "fait -> actions" au format compact : les actions concernées par
+// le fait f sont valeurs[debut[f]] .. valeurs[debut[f+1] - 1]
+typedef struct {
+    int* debut;
+    int* valeurs;
+} IndexFaits;
+
+typedef struct {
+    IndexFaits producteurs;     // actions qui ajoutent f
+    IndexFaits destructeurs;    // actions qui suppriment f
+    IndexFaits utilisateurs;    // actions qui ont f en précondition
+    IndexFaits interdits;       // actions qui ont f en précondition négative
+    int* marque;                // marque[a] == tour : a est déjà dans T
+    int tour;
+    int* pile;
+} EnsemblesTetus;
+
+static bool ConstruireIndexFaits(const Probleme* pb, size_t champ, IndexFaits* index) {
+    int nbFaits = pb->faits.nbFaits;
+    index->debut = calloc(nbFaits + 1, sizeof(int));
+    if (!index->debut) return false;
+
+    for (int a = 0; a < pb->actionCount; a++) {
+        const ListeFaits* liste = (const ListeFaits*)((const char*)&pb->actions[a] + champ);
+        for (int i = 0; i < liste->factCount; i++) {
+            index->debut[liste->facts[i] + 1]++;
+        }
     }
-    
-    // Pour le problème des blocs, on peut mettre une priorité plus élevée 
-    // aux règles qui posent les blocs sur la table
-    for (int i = 0; i < actionCount; i++) {
-        if (strstr(actions[i].name, "sur la table") != NULL) {
-            actions[i].priority = 5;  // Priorité élevée
-            if (DEBUG_MODE) printf("DEBUG: Priorité 5 pour règle %d: %s\n", i, actions[i].name);
+    for (int f = 0; f < nbFaits; f++) {
+        index->debut[f + 1] += index->debut[f];
+    }
+
+    index->valeurs = malloc(sizeof(int) * (index->debut[nbFaits] + 1));
+    int* position = malloc(sizeof(int) * (nbFaits + 1));
+    if (!index->valeurs || !position) {
+        free(position);
+        return false;
+    }
+    memcpy(position, index->debut, sizeof(int) * nbFaits);
+    for (int a = 0; a < pb->actionCount; a++) {
+        const ListeFaits* liste = (const ListeFaits*)((const char*)&pb->actions[a] + champ);
+        for (int i = 0; i < liste->factCount; i++) {
+            index->valeurs[position[liste->facts[i]]++] = a;
         }
     }
+    free(position);
+    return true;
 }
 
-// Version améliorée pour la partie 5
-void AnalyseFichierAvecStrategie(const char *nomfile, int mode) {
-    State initial;
-    Goal goal;
-    Action actions[MAX_ACTIONS];
-    int actionCount = 0;
-    
-    if (DEBUG_MODE) printf("DEBUG: Analyse du fichier '%s' avec mode %d\n", nomfile, mode);
+static void LibererIndexFaits(IndexFaits* index) {
+    free(index->debut);
+    free(index->valeurs);
+    index->debut = NULL;
+    index->valeurs = NULL;
+}
 
-    if(!ParseFile(nomfile, &initial, &goal, actions, &actionCount)) {
-        printf("Erreur lors du chargement du fichier.\n");
-        return;
+void LibererEnsemblesTetus(EnsemblesTetus* et) {
+    LibererIndexFaits(&et->producteurs);
+    LibererIndexFaits(&et->destructeurs);
+    LibererIndexFaits(&et->utilisateurs);
+    LibererIndexFaits(&et->interdits);
+    free(et->marque);
+    free(et->pile);
+    et->marque = NULL;
+    et->pile = NULL;
+}
+
+// Construit les relations d'interférence du problème (une fois par recherche)
+bool PreparerEnsemblesTetus(const Probleme* pb, EnsemblesTetus* et) {
+    memset(et, 0, sizeof(*et));
+    et->marque = calloc(pb->actionCount + 1, sizeof(int));
+    et->pile = malloc(sizeof(int) * (pb->actionCount + 1));
+    if (!et->marque || !et->pile
+        || !ConstruireIndexFaits(pb, offsetof(Action, addList), &et->producteurs)
+        || !ConstruireIndexFaits(pb, offsetof(Action, delList), &et->destructeurs)
+        || !ConstruireIndexFaits(pb, offsetof(Action, preconds), &et->utilisateurs)
+        || !ConstruireIndexFaits(pb, offsetof(Action, neg_preconds), &et->interdits)) {
+        LibererEnsemblesTetus(et);
+        return false;
     }
-    
-    // Initialiser les priorités pour le mode priorité
-    if (mode == MODE_PRIORITE) {
-        InitialiserPriorites(actions, actionCount);
+    return true;
+}
+
+#define TAILLE_INDEX(index, f) ((index).debut[(f) + 1] - (index).debut[f])
+
+// Ajoute à T (et à la pile de travail) les actions de l'index pour le fait f
+static int AjouterActionsDuFait(EnsemblesTetus* et, const IndexFaits* index, int f, int nbPile) {
+    for (int i = index->debut[f]; i < index->debut[f + 1]; i++) {
+        int b = index->valeurs[i];
+        if (et->marque[b] != et->tour) {
+            et->marque[b] = et->tour;
+            et->pile[nbPile++] = b;
+        }
     }
+    return nbPile;
+}
 
-    // Affichage simple
-    printf("\n+----------ETAT INITIAL (START)----------+\n|\n");
-    printf("| Nombre de faits: %d\n", initial.factCount);
-    for(int i=0; i<initial.factCount; i++){
-        printf("| - %s\n", initial.facts[i]);
+static int ComparerEntiers(const void* a, const void* b) {
+    return *(const int*)a - *(const int*)b;
+}
+
+// Remplit 'applicables' avec les actions applicables de l'ensemble têtu
+// calculé pour 'etat' (dans l'ordre des règles) et renvoie leur nombre
+int CalculerEnsembleTetu(const Probleme* pb, EnsemblesTetus* et, const Mot* etat, int* applicables) {
+    const Action* actions = pb->actions;
+    int nbApplicables = 0;
+    int nbPile = 0;
+
+    // Nouveau tour : toutes les anciennes marques deviennent caduques
+    if (++et->tour == 0) {
+        memset(et->marque, 0, sizeof(int) * pb->actionCount);
+        et->tour = 1;
     }
-    printf("|\n+----------------------------------------+\n");
 
+    // Point de départ : le fait du but encore faux qui a le moins de producteurs
+    int faitBut = -1;
+    for (int i = 0; i < pb->goal.factCount; i++) {
+        int f = pb->goal.facts[i];
+        if (!TEST_BIT(etat, f)
+            && (faitBut == -1 || TAILLE_INDEX(et->producteurs, f) < TAILLE_INDEX(et->producteurs, faitBut))) {
+            faitBut = f;
+        }
+    }
+    if (faitBut == -1) return 0;
+    nbPile = AjouterActionsDuFait(et, &et->producteurs, faitBut, nbPile);
 
-    printf("\n+----------OBJECTIF (FINISH)----------+\n|\n");
-    printf("| Nombre de faits: %d\n", goal.factCount);
-    for(int i=0; i<goal.factCount; i++){
-        printf("| - %s\n", goal.facts[i]);
+    while (nbPile > 0) {
+        int a = et->pile[--nbPile];
+        const Action* action = &actions[a];
+
+        if (CanApply(etat, action)) {
+            applicables[nbApplicables++] = a;
+            // Actions qui désactivent a
+            for (int i = 0; i < action->preconds.factCount; i++)
+                nbPile = AjouterActionsDuFait(et, &et->destructeurs, action->preconds.facts[i], nbPile);
+            for (int i = 0; i < action->neg_preconds.factCount; i++)
+                nbPile = AjouterActionsDuFait(et, &et->producteurs, action->neg_preconds.facts[i], nbPile);
+            // Actions désactivées par a, ou dont les effets contredisent ceux de a
+            for (int i = 0; i < action->delList.factCount; i++) {
+                nbPile = AjouterActionsDuFait(et, &et->utilisateurs, action->delList.facts[i], nbPile);
+                nbPile = AjouterActionsDuFait(et, &et->producteurs, action->delList.facts[i], nbPile);
+            }
+            for (int i = 0; i < action->addList.factCount; i++) {
+                nbPile = AjouterActionsDuFait(et, &et->interdits, action->addList.facts[i], nbPile);
+                nbPile = AjouterActionsDuFait(et, &et->destructeurs, action->addList.facts[i], nbPile);
+            }
+        } else {
+            // On choisit la condition fausse la moins coûteuse à rendre vraie :
+            // une précondition absente (ses producteurs) ou une précondition
+            // négative présente (ses destructeurs)
+            const IndexFaits* meilleurIndex = NULL;
+            int meilleurFait = -1;
+            for (int i = 0; i < action->preconds.factCount; i++) {
+                int f = action->preconds.facts[i];
+                if (!TEST_BIT(etat, f)
+                    && (!meilleurIndex || TAILLE_INDEX(et->producteurs, f) < TAILLE_INDEX(*meilleurIndex, meilleurFait))) {
+                    meilleurIndex = &et->producteurs;
+                    meilleurFait = f;
+                }
+            }
+            for (int i = 0; i < action->neg_preconds.factCount; i++) {
+                int f = action->neg_preconds.facts[i];
+                if (TEST_BIT(etat, f)
+                    && (!meilleurIndex || TAILLE_INDEX(et->destructeurs, f) < TAILLE_INDEX(*meilleurIndex, meilleurFait))) {
+                    meilleurIndex = &et->destructeurs;
+                    meilleurFait = f;
+                }
+            }
+            if (meilleurIndex) {
+                nbPile = AjouterActionsDuFait(et, meilleurIndex, meilleurFait, nbPile);
+            }
+        }
     }
-    printf("|\n+-------------------------------------+\n");
 
+    // Même ordre d'expansion que sans réduction
+    qsort(applicables, nbApplicables, sizeof(int), ComparerEntiers);
+    return nbApplicables;
+}
 
-    printf("\n+----------ACTIONS DISPONIBLES (%d)----------+\n|\n", actionCount);
-    for(int i=0; i<actionCount; i++){
-        printf("| - %s", actions[i].name);
-        if (mode == MODE_PRIORITE) {
-            printf(" (priorité: %d)", actions[i].priority);
+// ---------------------------------------------------------------------
+// 4.2 - Symétries du problème
+// ---------------------------------------------------------------------
+// Beaucoup de problèmes générés contiennent des objets interchangeables
+// (balles du gripper, groupes de la rivière, colis de même destination...).
+// Permuter leurs noms donne des états "isomorphes" que SameState ne voit
+// pas. On construit le graphe de description du problème (un sommet par
+// fait, un par action, une arête typée par précondition / précondition
+// négative / ajout / suppression ; les faits du but ont leur propre
+// couleur) puis on cherche ses automorphismes par raffinement de
+// partition et individualisation (comme nauty, en plus simple).
+// Chaque automorphisme trouvé est vérifié arête par arête : il permute
+// les faits en conservant les actions et le but.
+// Pendant la recherche, un état est ensuite comparé aux autres par un
+// représentant canonique de son orbite.
+
+#define ARETE_PRECOND 0
+#define ARETE_NEG     1
+#define ARETE_AJOUT   2
+#define ARETE_SUPPR   3
+
+#define MAX_TRAVAIL_SYMETRIES 10000000LL  // budget (arêtes parcourues) de la recherche d'automorphismes
+
+typedef struct {
+    int nbSommets;          // faits puis actions
+    int* debut;             // voisins de v : voisins[debut[v]] .. voisins[debut[v+1] - 1]
+    int64_t* voisins;       // voisin * 4 + type d'arête, triés
+} GrapheDescription;
+
+typedef struct {
+    int nbGenerateurs;
+    int capacite;
+    int** generateurs;      // generateurs[k][f] = image du fait f
+    Mot* tampon;            // états de travail pour la canonisation
+    Mot* candidat;
+} Symetries;
+
+typedef struct {
+    uint64_t hache;
+    int sommet;
+} SommetHache;
+
+// Recherche des automorphismes : partitions ordonnées (une couleur par cellule)
+typedef struct {
+    const GrapheDescription* g;
+    int* premiereFeuille;   // ordre des sommets à la première feuille
+    int* cellules;          // cellule individualisée à chaque niveau du premier chemin
+    uint64_t* signatures;   // invariant de la partition à chaque niveau du premier chemin
+    int profondeur;
+    int* orbites;           // union-find sur les sommets
+    int* image;
+    uint64_t* hache;
+    int* ordre;
+    SommetHache* tri;       // tampon du tri de RenumeroterCouleurs
+    long long travail;      // arêtes parcourues par les raffinements
+    Symetries* sym;
+    int nbFaits;
+} RechercheAutomorphismes;
+
+static int CompareArete(const void* a, const void* b) {
+    int64_t x = *(const int64_t*)a, y = *(const int64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void AjouterAretes(GrapheDescription* g, int* position, int action, const ListeFaits* liste, int type) {
+    for (int i = 0; i < liste->factCount; i++) {
+        int f = liste->facts[i];
+        if (position) {
+            g->voisins[position[f]++] = (int64_t)action * 4 + type;
+            g->voisins[position[action]++] = (int64_t)f * 4 + type;
+        } else {
+            g->debut[f + 1]++;
+            g->debut[action + 1]++;
         }
-        printf("\n");
     }
-    printf("|\n+-------------------------------------------+\n");
-    
-    // Affichage du mode de recherche
-    printf("\n+----------STRATEGIE DE RECHERCHE----------+\n|\n");
-    switch(mode) {
-        case MODE_NORMAL:
-            printf("| Mode: NORMAL (BFS standard)\n");
-            break;
-        case MODE_MELANGE:
-            printf("| Mode: MELANGE DES REGLES\n");
-            break;
-        case MODE_ALEATOIRE:
-            printf("| Mode: CHOIX ALEATOIRE\n");
-            break;
-        case MODE_PRIORITE:
-            printf("| Mode: PRIORITE DES REGLES\n");
-            break;
-        case MODE_MEANS_END:
-            printf("| Mode: ANALYSE FIN-MOYENS\n");
-            break;
+}
+
+static bool ConstruireGrapheDescription(const Probleme* pb, GrapheDescription* g) {
+    int nbFaits = pb->faits.nbFaits;
+    g->nbSommets = nbFaits + pb->actionCount;
+    g->debut = calloc(g->nbSommets + 1, sizeof(int));
+    g->voisins = NULL;
+    int* position = malloc(sizeof(int) * (g->nbSommets + 1));
+    if (!g->debut || !position) {
+        free(position);
+        return false;
     }
-    printf("|\n+------------------------------------------+\n");
 
-    // Mesure du temps d'exécution
-    struct timeval debut, fin;
-    gettimeofday(&debut, NULL);
-    
-    // Lancement BFS amélioré
-    int solIndex = BfsAmeliore(&initial, &goal, actions, actionCount, mode);
-    
-    gettimeofday(&fin, NULL);
-    double temps_ms = (fin.tv_sec - debut.tv_sec) * 1000.0 + (fin.tv_usec - debut.tv_usec) / 1000.0;
-    
-    if(solIndex == -1) {
-        printf("\n+===========================================================+\n");
-        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
-        printf("+===========================================================+\n");
-    } else {
-        ReconstructPlan(solIndex, actions);
+    // Deux passes : on compte les degrés puis on range les arêtes
+    for (int passe = 0; passe < 2; passe++) {
+        for (int a = 0; a < pb->actionCount; a++) {
+            const Action* action = &pb->actions[a];
+            int* pos = passe ? position : NULL;
+            AjouterAretes(g, pos, nbFaits + a, &action->preconds, ARETE_PRECOND);
+            AjouterAretes(g, pos, nbFaits + a, &action->neg_preconds, ARETE_NEG);
+            AjouterAretes(g, pos, nbFaits + a, &action->addList, ARETE_AJOUT);
+            AjouterAretes(g, pos, nbFaits + a, &action->delList, ARETE_SUPPR);
+        }
+        if (passe == 0) {
+            for (int v = 0; v < g->nbSommets; v++) g->debut[v + 1] += g->debut[v];
+            g->voisins = malloc(sizeof(int64_t) * (g->debut[g->nbSommets] + 1));
+            if (!g->voisins) {
+                free(position);
+                return false;
+            }
+            memcpy(position, g->debut, sizeof(int) * g->nbSommets);
+        }
     }
-    
-    printf("\n+----------STATISTIQUES----------+\n");
-    printf("| Nombre d'états générés: %d\n", visitedCount);
-    printf("| Temps d'exécution: %.2f ms\n", temps_ms);
-    printf("+--------------------------------+\n");
+    free(position);
+
+    for (int v = 0; v < g->nbSommets; v++) {
+        qsort(g->voisins + g->debut[v], g->debut[v + 1] - g->debut[v], sizeof(int64_t), CompareArete);
+    }
+    return true;
 }
 
-void ChoixFichierParDefaut(){
-    // Fichier par defaut : monkey.txt
-    const char* defaultFile = "assets/monkey.txt";
+static void LibererGrapheDescription(GrapheDescription* g) {
+    free(g->debut);
+    free(g->voisins);
+}
 
-    // Appele de fonction
-    AnalyseFichierAvecStrategie(defaultFile, MODE_NORMAL);
+static uint64_t Melanger64(uint64_t z) {
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
 }
 
-void viderbuffer()
-{
-    int c;
-    while ((c=getchar())!=EOF && c!='\n');
+static uint64_t HacherEtat(const Probleme* pb, const Mot* etat) {
+    uint64_t h = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < pb->nbMots; i++) h = Melanger64(h ^ etat[i]);
+    return h;
 }
 
-void ChoixFichierUtilisateur(){
-    char * nomFichier = malloc (sizeof(char)*255);
-    if (nomFichier==NULL){
-        fprintf(stderr, "Erreur  d'initialisation du nom de ficher\n" );
-        return;
+// qsort n'a pas de contexte : chaque sommet est trié avec sa valeur
+static int CompareSommets(const void* a, const void* b) {
+    const SommetHache* u = a;
+    const SommetHache* v = b;
+    if (u->hache != v->hache) return (u->hache > v->hache) - (u->hache < v->hache);
+    return (u->sommet > v->sommet) - (u->sommet < v->sommet);
+}
+
+// Renumérote les couleurs de 0 à k-1 dans l'ordre de hache[]
+static int RenumeroterCouleurs(RechercheAutomorphismes* r, int* couleur) {
+    int n = r->g->nbSommets;
+    for (int v = 0; v < n; v++) {
+        r->tri[v].hache = r->hache[v];
+        r->tri[v].sommet = v;
+    }
+    qsort(r->tri, n, sizeof(SommetHache), CompareSommets);
+    for (int i = 0; i < n; i++) r->ordre[i] = r->tri[i].sommet;
+    int nbCouleurs = 0;
+    for (int i = 0; i < n; i++) {
+        if (i > 0 && r->hache[r->ordre[i]] != r->hache[r->ordre[i - 1]]) nbCouleurs++;
+        couleur[r->ordre[i]] = nbCouleurs;
     }
+    return nbCouleurs + 1;
+}
 
-    char chemin[512];
+// Raffinement : deux sommets de même couleur dont les voisinages (types
+// d'arêtes et couleurs des voisins) diffèrent sont séparés, jusqu'à stabilité.
+// Les couleurs ne dépendent pas de la numérotation des sommets.
+static int RaffinerPartition(RechercheAutomorphismes* r, int* couleur, int nbCouleurs) {
+    const GrapheDescription* g = r->g;
+    while (true) {
+        r->travail += g->debut[g->nbSommets] + g->nbSommets;
+        for (int v = 0; v < g->nbSommets; v++) {
+            uint64_t somme = 0;
+            for (int i = g->debut[v]; i < g->debut[v + 1]; i++) {
+                int64_t arete = g->voisins[i];
+                somme += Melanger64((uint64_t)couleur[arete / 4] * 4 + (uint64_t)(arete % 4) + 1);
+            }
+            // La couleur actuelle reste le critère principal
+            r->hache[v] = ((uint64_t)couleur[v] << 32) | (Melanger64(somme) >> 32);
+        }
+        int nouveau = RenumeroterCouleurs(r, couleur);
+        if (nouveau == nbCouleurs) return nbCouleurs;
+        nbCouleurs = nouveau;
+    }
+}
 
-    printf("Entrez le nom du fichier a utiliser : ");
-    viderbuffer();
-    scanf("%254s", nomFichier);
+// Donne une couleur propre au sommet v (placé juste avant le reste de sa cellule)
+static int Individualiser(RechercheAutomorphismes* r, int* couleur, int v) {
+    for (int u = 0; u < r->g->nbSommets; u++) {
+        r->hache[u] = ((uint64_t)couleur[u] << 1) | (u != v);
+    }
+    return RaffinerPartition(r, couleur, RenumeroterCouleurs(r, couleur));
+}
 
-    strcpy(chemin, "assets/");
-    strcat(chemin, nomFichier);
+// Invariant d'une partition : nombre et taille des cellules dans l'ordre
+static uint64_t SignaturePartition(RechercheAutomorphismes* r, const int* couleur, int nbCouleurs) {
+    int* tailles = r->image;
+    memset(tailles, 0, sizeof(int) * nbCouleurs);
+    for (int v = 0; v < r->g->nbSommets; v++) tailles[couleur[v]]++;
+    uint64_t s = (uint64_t)nbCouleurs;
+    for (int c = 0; c < nbCouleurs; c++) s = Melanger64(s ^ (uint64_t)tailles[c]);
+    return s;
+}
 
+// Première cellule non réduite à un sommet (-1 si la partition est discrète)
+static int PremiereCellule(RechercheAutomorphismes* r, const int* couleur, int nbCouleurs) {
+    if (nbCouleurs == r->g->nbSommets) return -1;
+    int* tailles = r->image;
+    memset(tailles, 0, sizeof(int) * nbCouleurs);
+    for (int v = 0; v < r->g->nbSommets; v++) tailles[couleur[v]]++;
+    for (int c = 0; c < nbCouleurs; c++) {
+        if (tailles[c] > 1) return c;
+    }
+    return -1;
+}
 
-    printf("Nom du fichier saisi : %s\n", chemin);
+static bool AreteExiste(const GrapheDescription* g, int u, int64_t arete) {
+    int bas = g->debut[u], haut = g->debut[u + 1] - 1;
+    while (bas <= haut) {
+        int milieu = (bas + haut) / 2;
+        if (g->voisins[milieu] == arete) return true;
+        if (g->voisins[milieu] < arete) bas = milieu + 1;
+        else haut = milieu - 1;
+    }
+    return false;
+}
 
-    FILE *file = fopen(chemin, "r");
-    if (file == NULL) {
-        printf("Erreur : Le fichier %s n'existe pas ou n'est pas accessible.\n", chemin);
-        free(nomFichier);
-        return;
+static int RacineOrbite(int* orbites, int v) {
+    while (orbites[v] != v) {
+        orbites[v] = orbites[orbites[v]];
+        v = orbites[v];
     }
-    fclose(file);
+    return v;
+}
 
-    AnalyseFichierAvecStrategie(chemin, MODE_NORMAL);
+// Feuille atteinte : la permutation "premiere feuille -> cette feuille"
+// est-elle un automorphisme ? Si oui on la garde comme générateur.
+static bool EssayerFeuille(RechercheAutomorphismes* r, const int* couleur) {
+    const GrapheDescription* g = r->g;
+    int n = g->nbSommets;
+    for (int v = 0; v < n; v++) r->ordre[couleur[v]] = v;
+    for (int p = 0; p < n; p++) r->image[r->premiereFeuille[p]] = r->ordre[p];
 
-    free(nomFichier);
+    for (int u = 0; u < n; u++) {
+        for (int i = g->debut[u]; i < g->debut[u + 1]; i++) {
+            int64_t arete = g->voisins[i];
+            if (!AreteExiste(g, r->image[u], (int64_t)r->image[arete / 4] * 4 + arete % 4)) return false;
+        }
+    }
+
+    Symetries* sym = r->sym;
+    if (sym->nbGenerateurs == sym->capacite) {
+        int capacite = sym->capacite ? sym->capacite * 2 : 8;
+        int** generateurs = realloc(sym->generateurs, sizeof(int*) * capacite);
+        if (!generateurs) return true;
+        sym->generateurs = generateurs;
+        sym->capacite = capacite;
+    }
+    int* perm = malloc(sizeof(int) * (r->nbFaits + 1));
+    if (!perm) return true;
+    for (int f = 0; f < r->nbFaits; f++) perm[f] = r->image[f];
+    sym->generateurs[sym->nbGenerateurs++] = perm;
+
+    for (int v = 0; v < n; v++) {
+        int a = RacineOrbite(r->orbites, v), b = RacineOrbite(r->orbites, r->image[v]);
+        if (a != b) r->orbites[a] = b;
+    }
+    return true;
 }
 
+// Descend sous la partition 'couleur' (niveau 'niveau') en suivant les
+// mêmes cellules que le premier chemin ; vrai si un automorphisme est trouvé
+static bool ChercherAutomorphisme(RechercheAutomorphismes* r, const int* couleur, int niveau) {
+    if (niveau == r->profondeur) return EssayerFeuille(r, couleur);
 
-void ChoixCréationFichierUtilisateur(){
-    // Creer un nouveau fichier
-    char *nomFichier = malloc(sizeof(char) * 255);
+    int n = r->g->nbSommets;
+    int* copie = malloc(sizeof(int) * n);
+    if (!copie) return false;
+    bool trouve = false;
+    for (int w = 0; w < n && !trouve && r->travail <= MAX_TRAVAIL_SYMETRIES; w++) {
+        if (couleur[w] != r->cellules[niveau]) continue;
+        memcpy(copie, couleur, sizeof(int) * n);
+        int k = Individualiser(r, copie, w);
+        if (SignaturePartition(r, copie, k) != r->signatures[niveau + 1]) continue;
+        trouve = ChercherAutomorphisme(r, copie, niveau + 1);
+    }
+    free(copie);
+    return trouve;
+}
 
-    // Demander le nom du fichier
-    printf("Nom du fichier à créer : ");
-    fgets(nomFichier, 255, stdin);
+void LibererSymetries(Symetries* sym) {
+    for (int k = 0; k < sym->nbGenerateurs; k++) free(sym->generateurs[k]);
+    free(sym->generateurs);
+    free(sym->tampon);
+    free(sym->candidat);
+    memset(sym, 0, sizeof(*sym));
+}
 
-    // Supprimer le \n de la fin de la chaîne si présent
-    size_t len = strlen(nomFichier);
-    if (len > 0 && nomFichier[len - 1] == '\n') {
-        nomFichier[len - 1] = '\0';
+// Cherche un ensemble de générateurs du groupe des symétries du problème
+bool DetecterSymetries(const Probleme* pb, Symetries* sym) {
+    memset(sym, 0, sizeof(*sym));
+    sym->tampon = NouvelEtat(pb);
+    sym->candidat = NouvelEtat(pb);
+    if (!sym->tampon || !sym->candidat) {
+        LibererSymetries(sym);
+        return false;
     }
 
-    // Créer le fichier
-    CreerFichier(nomFichier);
+    GrapheDescription g;
+    if (!ConstruireGrapheDescription(pb, &g)) {
+        LibererGrapheDescription(&g);
+        LibererSymetries(sym);
+        return false;
+    }
 
-    // Proposition de vérification immédiate
-    printf("Voulez-vous tester la résolution sur ce fichier ? (o/n) ");
-    char rep[10];
-    fgets(rep, 10, stdin);
+    int n = g.nbSommets;
+    RechercheAutomorphismes r = {0};
+    r.g = &g;
+    r.sym = sym;
+    r.nbFaits = pb->faits.nbFaits;
+    r.premiereFeuille = malloc(sizeof(int) * (n + 1));
+    r.cellules = malloc(sizeof(int) * (n + 1));
+    r.signatures = malloc(sizeof(uint64_t) * (n + 1));
+    r.orbites = malloc(sizeof(int) * (n + 1));
+    r.image = malloc(sizeof(int) * (n + 1));
+    r.hache = malloc(sizeof(uint64_t) * (n + 1));
+    r.ordre = malloc(sizeof(int) * (n + 1));
+    r.tri = malloc(sizeof(SommetHache) * (n + 1));
+    int niveauxAlloues = 8;    // partitions du premier chemin, niveau par niveau
+    int* chemin = malloc(sizeof(int) * ((size_t)niveauxAlloues * n + 1));
+    int* sommets = malloc(sizeof(int) * (n + 1));
+    bool ok = r.premiereFeuille && r.cellules && r.signatures && r.orbites && r.image
+              && r.hache && r.ordre && r.tri && chemin && sommets;
 
-    if (rep[0] == 'o' || rep[0] == 'O') {
-        // On parse & BFS
-        State initial;
-        Goal goal;
-        Action actions[MAX_ACTIONS];
-        int actionCount = 0;
+    if (ok) {
+        for (int v = 0; v < n; v++) r.orbites[v] = v;
 
-        if (!ParseFile(nomFichier, &initial, &goal, actions, &actionCount)) {
-            printf("Erreur lors du parsing. Abandon.\n");
-        } else {
-            // Même affichage
-            printf("\n=== ETAT INITIAL (START) ===\n");
-            printf("Nombre de faits: %d\n", initial.factCount);
-            for (int i = 0; i < initial.factCount; i++) {
-                printf(" - %s\n", initial.facts[i]);
-            }
+        // Couleurs de départ : faits du but, autres faits, actions
+        int* couleur = chemin;
+        for (int v = 0; v < n; v++) couleur[v] = v < r.nbFaits ? 1 : 2;
+        for (int i = 0; i < pb->goal.factCount; i++) couleur[pb->goal.facts[i]] = 0;
+        int nbCouleurs = RaffinerPartition(&r, couleur, 0);
 
-            printf("\n=== OBJECTIF (FINISH) ===\n");
-            printf("Nombre de faits: %d\n", goal.factCount);
-            for (int i = 0; i < goal.factCount; i++) {
-                printf(" - %s\n", goal.facts[i]);
+        // Premier chemin : on individualise toujours le premier sommet de la
+        // première cellule non triviale, jusqu'à une partition discrète
+        r.signatures[0] = SignaturePartition(&r, couleur, nbCouleurs);
+        while (ok && r.travail <= MAX_TRAVAIL_SYMETRIES) {
+            int* courant = chemin + (size_t)r.profondeur * n;
+            int cellule = PremiereCellule(&r, courant, nbCouleurs);
+            if (cellule == -1) break;
+            int v = 0;
+            while (courant[v] != cellule) v++;
+            r.cellules[r.profondeur] = cellule;
+            sommets[r.profondeur] = v;
+            if (r.profondeur + 1 == niveauxAlloues) {
+                int* plusGrand = realloc(chemin, sizeof(int) * ((size_t)niveauxAlloues * 2 * n + 1));
+                if (!plusGrand) {
+                    ok = false;
+                    break;
+                }
+                chemin = plusGrand;
+                niveauxAlloues *= 2;
+                courant = chemin + (size_t)r.profondeur * n;
             }
+            int* suivant = courant + n;
+            memcpy(suivant, courant, sizeof(int) * n);
+            nbCouleurs = Individualiser(&r, suivant, v);
+            r.profondeur++;
+            r.signatures[r.profondeur] = SignaturePartition(&r, suivant, nbCouleurs);
+        }
+    }
 
-            printf("\n=== ACTIONS DISPONIBLES (%d) ===\n", actionCount);
-            for (int i = 0; i < actionCount; i++) {
-                printf(" - %s\n", actions[i].name);
-            }
+    // Premier chemin trop long : on renonce aux symétries
+    if (ok && r.travail <= MAX_TRAVAIL_SYMETRIES) {
+        const int* feuille = chemin + (size_t)r.profondeur * n;
+        for (int v = 0; v < n; v++) r.premiereFeuille[feuille[v]] = v;
 
-            int solIndex = BfsAmeliore(&initial, &goal, actions, actionCount, MODE_NORMAL);
-            if (solIndex == -1) {
-                printf("\nAucune solution trouvée pour ce fichier.\n\n");
-            } else {
-                ReconstructPlan(solIndex, actions);
+        // Du niveau le plus profond vers la racine : pour chaque autre sommet
+        // de la cellule individualisée, pas encore dans l'orbite du sommet
+        // choisi, on cherche un automorphisme qui l'y envoie
+        for (int niveau = r.profondeur - 1; niveau >= 0 && r.travail <= MAX_TRAVAIL_SYMETRIES; niveau--) {
+            const int* partition = chemin + (size_t)niveau * n;
+            int v = sommets[niveau];
+            int* copie = malloc(sizeof(int) * n);
+            if (!copie) break;
+            for (int w = 0; w < n && r.travail <= MAX_TRAVAIL_SYMETRIES; w++) {
+                if (w == v || partition[w] != r.cellules[niveau]) continue;
+                if (RacineOrbite(r.orbites, w) == RacineOrbite(r.orbites, v)) continue;
+                memcpy(copie, partition, sizeof(int) * n);
+                int k = Individualiser(&r, copie, w);
+                if (SignaturePartition(&r, copie, k) != r.signatures[niveau + 1]) continue;
+                ChercherAutomorphisme(&r, copie, niveau + 1);
             }
+            free(copie);
         }
-    } else {
-        printf("Ok, fichier créé, pas de vérification. Retour au menu.\n");
     }
 
-    free(nomFichier);  // Ne pas oublier de libérer la mémoire allouée
+    if (DEBUG_MODE && ok) {
+        printf("DEBUG: %d symétrie(s) génératrice(s) trouvée(s)%s\n", sym->nbGenerateurs,
+               r.travail > MAX_TRAVAIL_SYMETRIES ? " (recherche interrompue)" : "");
+    }
+
+    free(r.premiereFeuille);
+    free(r.cellules);
+    free(r.signatures);
+    free(r.orbites);
+    free(r.image);
+    free(r.hache);
+    free(r.ordre);
+    free(r.tri);
+    free(chemin);
+    free(sommets);
+    LibererGrapheDescription(&g);
+    if (!ok) LibererSymetries(sym);
+    return ok;
+}
+
+// Image d'un état par une permutation des faits
+static void PermuterEtat(const Probleme* pb, const int* perm, const Mot* etat, Mot* image) {
+    memset(image, 0, sizeof(Mot) * pb->nbMots);
+    for (int f = 0; f < pb->faits.nbFaits; f++) {
+        if (TEST_BIT(etat, f)) METTRE_BIT(image, perm[f]);
+    }
+}
+
+// Représentant de l'orbite de 'etat' : on applique les générateurs tant
+// qu'ils font diminuer l'état (ordre de memcmp). Deux états symétriques
+// ne donnent pas toujours le même représentant, mais deux états qui ont
+// le même représentant sont toujours symétriques.
+void CanoniserEtat(const Probleme* pb, Symetries* sym, const Mot* etat, Mot* canonique) {
+    memcpy(canonique, etat, sizeof(Mot) * pb->nbMots);
+    bool ameliore = sym->nbGenerateurs > 0;
+    while (ameliore) {
+        ameliore = false;
+        for (int k = 0; k < sym->nbGenerateurs; k++) {
+            PermuterEtat(pb, sym->generateurs[k], canonique, sym->candidat);
+            if (memcmp(sym->candidat, canonique, sizeof(Mot) * pb->nbMots) < 0) {
+                memcpy(canonique, sym->candidat, sizeof(Mot) * pb->nbMots);
+                ameliore = true;
+            }
+        }
+    }
 }
 
 // ---------------------------------------------------------------------
-// Fonctions pour la partie 5
-// ---------------------------------------------------------------------
+// 4) BFS améliorée : avec support des différents modes de recherche
+// ---------------------------------------------------------------------
+// Tout ce qu'une recherche modifie est rangé dans un ContexteRecherche :
+// l'appelant l'initialise une fois, le passe à chaque BfsAmeliore puis le
+// ferme. Les tableaux des noeuds sont taillés d'après les limites de la
+// première recherche (maxNoeuds, maxOctets), doublent à la demande sans
+// sortir du budget d'octets et sont gardés d'une recherche à l'autre ; une
+// table de hachage sur les états visités repère les doublons. Les réglages
+// globaux sont copiés dans le contexte par InitialiserContexteRecherche et
+// le problème n'est jamais modifié (MODE_MELANGE mélange un tableau
+// d'ordre du contexte) : plusieurs recherches peuvent donc tourner en même
+// temps dans des fils différents, chacune avec son contexte, sur des
+// problèmes différents ou sur le même.
 
-// 5.1 - Génère un fichier avec des règles pour déplacer n blocs empilés
-void GenererProblemeBlocs(int nblocs) {
-    if (DEBUG_MODE) printf("DEBUG: Génération d'un problème à %d blocs...\n", nblocs);
-    
-    char filename[MAX_LEN];
-    sprintf(filename, "assets/blocs_%d.txt", nblocs);
-    
-    FILE* fp = fopen(filename, "w");
-    if (!fp) {
-        printf("Erreur: impossible de créer le fichier %s\n", filename);
+struct ContexteRecherche {
+    Node* visited;              // noeuds visités : capaciteEtats places
+    Mot* etatsVisites;          // leurs états (visitedCount * nbMots mots)
+    Mot* etatsCanoniques;       // représentants de leurs orbites (si symétries, partie 4.2)
+    int capaciteEtats;          // places de visited[], etatsVisites (et etatsCanoniques)
+    int motsAlloues;            // nbMots pour lequel les tableaux d'états sont alloués
+    int visitedCount;           // nombre d'états différents visités
+    size_t octetsParEtat;       // mémoire d'un noeud visité, comptée dans le budget d'octets
+    int* alveoles;              // table de hachage des noeuds de visited[] (-1 : libre)
+    int nbAlveoles;
+    int* queueArray;            // file d'indices (vers visited[])
+    int capaciteFile;
+    int front;                  // indice de lecture de la file
+    int rear;                   // indice d'écriture de la file
+    Symetries symetries;        // symétries du problème en cours de recherche
+    bool canoniques;            // la recherche en cours compare les représentants des orbites
+    bool limiteEtatsAtteinte;   // un état nouveau a été perdu faute de place
+    int* applicables;           // tampon de TrouverReglesApplicables
+    int capaciteApplicables;
+    int* tableauPondere;        // tampon de ConstuireTableauPriorite
+    int capacitePondere;
+    int* ordre;                 // ordre des règles de MODE_MELANGE (partie 5.3)
+    int* rang;                  // rang[a] = position de la règle a dans ordre[]
+    int capaciteOrdre;
+    GenerateurAlea alea;        // générateur aléatoire de la recherche, semé par BfsAmeliore
+
+    // Réglages : copiés des globales par InitialiserContexteRecherche
+    int debug;                  // affichages "DEBUG:" de la recherche
+    LimitesRecherche limites;   // délai, budgets et jeton d'annulation (partie 4.0)
+    unsigned long long graine;  // graine des tirages, 0 = nouvelle graine à chaque recherche
+    bool reductionOrdrePartiel; // élagage des ordres équivalents (partie 4.1)
+    bool reductionSymetries;    // fusion des états symétriques (partie 4.2)
+    bool compterEcartes;        // compter les successeurs écartés (un test de plus par action et par noeud)
+    int nbFilsMarches;          // fils d'exécution des marches aléatoires (partie 4.5)
+    char repertoirePriorites[MAX_LEN]; // priorités apprises de chaque domaine (partie 4.6)
+
+    // Résultats de la dernière recherche
+    IssueRecherche issue;
+    unsigned long long graineUtilisee; // graine à donner pour rejouer la recherche
+    bool rejeu;                 // priorités reprises au début de la recherche rejouée (partie 4.6)
+    int reglesAppliquees;       // successeurs générés
+    long noeuds;                // noeuds développés
+    long successeursEcartes;    // actions applicables hors de l'ensemble têtu (si compterEcartes ou debug)
+    size_t octetsMax;           // mémoire des états visités à la fin de la recherche
+    int nbSymetries;            // générateurs de symétries utilisés
+    int paliersMontee;          // améliorations strictes de h (montée forcée, partie 4.4)
+    bool repliMontee;           // la montée a fini par la recherche gloutonne
+    int paliersMarches;         // baisses du meilleur h (marches aléatoires, partie 4.5)
+    int reprisesMarches;        // retours à l'état initial
+    long pasMarches;            // pas de marche effectués, tous fils confondus
+};
+
+void InitialiserContexteRecherche(ContexteRecherche* ctx) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->debug = DEBUG_MODE;
+    ctx->limites = limitesRecherche;
+    ctx->graine = GRAINE_RECHERCHE;
+    ctx->reductionOrdrePartiel = REDUCTION_ORDRE_PARTIEL;
+    ctx->reductionSymetries = REDUCTION_SYMETRIES;
+    ctx->nbFilsMarches = NB_FILS_MARCHES;
+    snprintf(ctx->repertoirePriorites, sizeof(ctx->repertoirePriorites), "%s", REPERTOIRE_PRIORITES);
+    ctx->issue = ISSUE_SANS_SOLUTION;
+}
+
+void FermerContexteRecherche(ContexteRecherche* ctx) {
+    free(ctx->visited);
+    free(ctx->etatsVisites);
+    free(ctx->etatsCanoniques);
+    free(ctx->alveoles);
+    free(ctx->queueArray);
+    free(ctx->applicables);
+    free(ctx->tableauPondere);
+    free(ctx->ordre);
+    free(ctx->rang);
+    LibererSymetries(&ctx->symetries);
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+// Donne 'capacite' places aux tableaux des noeuds, pour des états de nbMots
+// mots ; les états canoniques suivent dès qu'ils ont été alloués une fois
+static bool RedimensionnerEtats(ContexteRecherche* ctx, int capacite, int nbMots, bool canoniques) {
+    Node* visited = realloc(ctx->visited, sizeof(Node) * capacite);
+    if (visited) ctx->visited = visited;
+    Mot* etats = realloc(ctx->etatsVisites, sizeof(Mot) * nbMots * (size_t)capacite);
+    if (etats) ctx->etatsVisites = etats;
+    bool ok = visited && etats;
+    if (ok && (canoniques || ctx->etatsCanoniques)) {
+        Mot* etatsCanoniques = realloc(ctx->etatsCanoniques, sizeof(Mot) * nbMots * (size_t)capacite);
+        if (etatsCanoniques) ctx->etatsCanoniques = etatsCanoniques;
+        ok = etatsCanoniques != NULL;
+    }
+    if (ok) {
+        ctx->capaciteEtats = capacite;
+        ctx->motsAlloues = nbMots;
+    }
+    return ok;
+}
+
+// Noeuds que le budget d'octets des limites laisse ranger (octetsParEtat
+// doit être connu)
+static int NoeudsPermis(const ContexteRecherche* ctx) {
+    if (ctx->limites.maxOctets == 0 || ctx->octetsParEtat == 0) return INT_MAX / 2;
+    size_t permis = ctx->limites.maxOctets / ctx->octetsParEtat;
+    return permis < INT_MAX / 2 ? (int)permis : INT_MAX / 2;
+}
+
+// Places des tableaux à leur création : CAPACITE_ETATS au plus, moins si
+// les limites ne permettent pas d'en remplir autant (budget d'octets, ou
+// maxNoeuds expansions d'au plus actionCount fils chacune)
+static int PlacesInitiales(const ContexteRecherche* ctx, const Probleme* pb) {
+    int places = CAPACITE_ETATS;
+    int permis = NoeudsPermis(ctx);
+    if (permis < places) places = permis;
+    long parNoeud = pb->actionCount > 0 ? pb->actionCount : 1;
+    if (ctx->limites.maxNoeuds > 0 && ctx->limites.maxNoeuds < places / parNoeud) {
+        places = (int)(ctx->limites.maxNoeuds * parNoeud);
+    }
+    return places > 16 ? places : 16;
+}
+
+// Tableaux de la recherche pour des états de pb->nbMots mots et table de
+// hachage vide ; les états canoniques ne sont alloués que si on en a
+// besoin. À la première recherche, ils sont taillés d'après ses limites.
+static bool PreparerContexte(ContexteRecherche* ctx, const Probleme* pb, bool canoniques) {
+    int places = PlacesInitiales(ctx, pb);
+    if (ctx->capaciteEtats == 0 || pb->nbMots > ctx->motsAlloues) {
+        int capacite = ctx->capaciteEtats > 0 ? ctx->capaciteEtats : places;
+        if (!RedimensionnerEtats(ctx, capacite, pb->nbMots, false)) return false;
+    }
+    if (canoniques && !ctx->etatsCanoniques) {
+        RedimensionnerEtats(ctx, ctx->capaciteEtats, ctx->motsAlloues, true);
+    }
+    if (!ctx->queueArray) {
+        ctx->queueArray = malloc(sizeof(int) * places);
+        ctx->capaciteFile = ctx->queueArray ? places : 0;
+    }
+    if (!ctx->alveoles) {
+        int nbAlveoles = 1;
+        while (nbAlveoles < 2 * places) nbAlveoles *= 2;
+        ctx->alveoles = malloc(sizeof(int) * nbAlveoles);
+        ctx->nbAlveoles = ctx->alveoles ? nbAlveoles : 0;
+    }
+    if (!ctx->queueArray || !ctx->alveoles) return false;
+    memset(ctx->alveoles, -1, sizeof(int) * ctx->nbAlveoles);
+    return true;
+}
+
+// Place pour le noeud visited[n] : les tableaux doublent au besoin, sans
+// dépasser ce que permet le budget d'octets. Faux si ce budget est
+// dépassé ou si la mémoire manque.
+static bool PlacerNoeud(ContexteRecherche* ctx, int n) {
+    int permis = NoeudsPermis(ctx);
+    if (n >= permis) return false;
+    if (n < ctx->capaciteEtats) return true;
+    int capacite = ctx->capaciteEtats;
+    while (capacite <= n) capacite = capacite < permis / 2 ? capacite * 2 : permis;
+    return RedimensionnerEtats(ctx, capacite, ctx->motsAlloues, false);
+}
+
+// Met le noeud n au bout de la file (doublée quand elle est pleine)
+static bool EnfilerNoeud(ContexteRecherche* ctx, int n) {
+    if (ctx->rear == ctx->capaciteFile) {
+        if (ctx->capaciteFile >= INT_MAX / 2) return false;
+        int* file = realloc(ctx->queueArray, sizeof(int) * ctx->capaciteFile * 2);
+        if (!file) return false;
+        ctx->queueArray = file;
+        ctx->capaciteFile *= 2;
+    }
+    ctx->queueArray[ctx->rear++] = n;
+    return true;
+}
+
+// La table de hachage (sur les clés CLE_ETAT) doit rester à moitié vide :
+// on la double (et on y range à nouveau visited[0 .. visitedCount[) avant
+// d'ajouter un noeud
+static bool AgrandirTableEtats(ContexteRecherche* ctx, const Probleme* pb) {
+    if ((ctx->visitedCount + 1) * 2 <= ctx->nbAlveoles) return true;
+    if (ctx->nbAlveoles >= INT_MAX / 2) return false;
+    int nbAlveoles = ctx->nbAlveoles * 2;
+    int* alveoles = malloc(sizeof(int) * nbAlveoles);
+    if (!alveoles) return false;
+    memset(alveoles, -1, sizeof(int) * nbAlveoles);
+    for (int n = 0; n < ctx->visitedCount; n++) {
+        uint64_t i = HacherEtat(pb, CLE_ETAT(ctx, pb, n)) & (nbAlveoles - 1);
+        while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+        alveoles[i] = n;
+    }
+    free(ctx->alveoles);
+    ctx->alveoles = alveoles;
+    ctx->nbAlveoles = nbAlveoles;
+    return true;
+}
+
+// Alvéole de la table où est rangé un noeud de clé 'cle', sinon
+// l'alvéole libre où le ranger
+static uint64_t ChercherEtat(const ContexteRecherche* ctx, const Probleme* pb, const Mot* cle) {
+    uint64_t i = HacherEtat(pb, cle) & (ctx->nbAlveoles - 1);
+    while (ctx->alveoles[i] != -1 && !SameState(pb, CLE_ETAT(ctx, pb, ctx->alveoles[i]), cle)) {
+        i = (i + 1) & (ctx->nbAlveoles - 1);
+    }
+    return i;
+}
+
+// 4.3 - Graines et rejeu des stratégies aléatoires
+// Tous les tirages d'une recherche (mélange des règles, marches, tirage
+// des priorités) viennent du générateur xoshiro256** de son contexte,
+// semé au début de BfsAmeliore à partir d'une seule graine de 64 bits.
+// La graine est affichée dans les statistiques : la redonner (réglage
+// GRAINE_RECHERCHE ou ctx->graine) refait exactement les mêmes tirages,
+// donc la même recherche. Les marches aléatoires sèment le générateur de
+// chaque fil depuis celui du contexte : le rejeu suppose le même nombre de fils.
+
+// Les quatre mots d'état viennent de splitmix64 : jamais tous nuls
+static void SemerAlea(GenerateurAlea* g, uint64_t graine) {
+    for (int i = 0; i < 4; i++) {
+        graine += 0x9E3779B97F4A7C15ULL;
+        g->s[i] = Melanger64(graine);
+    }
+}
+
+static uint64_t RotationAlea(uint64_t x, int k) {
+    return (x << k) | (x >> (64 - k));
+}
+
+// xoshiro256** : un par contexte, et un par fil des marches aléatoires
+static uint64_t TirageRecherche(GenerateurAlea* g) {
+    uint64_t* s = g->s;
+    uint64_t resultat = RotationAlea(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = RotationAlea(s[3], 45);
+    return resultat;
+}
+
+// Graine de la recherche : celle du contexte, sinon une nouvelle (horloge,
+// adresse du contexte et graine précédente : deux contextes ne tirent pas la même)
+static void SemerRecherche(ContexteRecherche* ctx) {
+    uint64_t graine = ctx->graine;
+    while (graine == 0) {
+        graine = Melanger64((uint64_t)time(NULL) ^ ((uint64_t)(HorlogeMs() * 1000.0) << 20)
+                            ^ (uint64_t)(uintptr_t)ctx ^ ctx->graineUtilisee);
+        ctx->graineUtilisee++;
+    }
+    ctx->graineUtilisee = graine;
+    ctx->rejeu = false;
+    SemerAlea(&ctx->alea, graine);
+}
+
+// Ajoute newState comme fils de 'parent' s'il n'a jamais été visité.
+// Avec les symétries, on compare les représentants des orbites : l'état
+// gardé reste l'état réellement atteint, le plan garde donc les vrais noms.
+static void AjouterSiNouveau(ContexteRecherche* ctx, const Probleme* pb, const Mot* newState, int parent, int action) {
+    ctx->reglesAppliquees++;
+    const Mot* cle = newState;
+    if (ctx->canoniques) {
+        CanoniserEtat(pb, &ctx->symetries, newState, ctx->symetries.tampon);
+        cle = ctx->symetries.tampon;
+    }
+
+    // Verif si déjà vu
+    if (!AgrandirTableEtats(ctx, pb)) {
+        ctx->limiteEtatsAtteinte = true;
         return;
     }
-    
-    // État initial : tous les blocs sont empilés dans l'ordre (bloc_1 est au sommet)
-    fprintf(fp, "start:");
-    for (int i = 1; i <= nblocs; i++) {
-        if (i > 1) {
-            fprintf(fp, "sur(bloc_%d,bloc_%d)", i-1, i);
-            if (i < nblocs) fprintf(fp, ",");
+    uint64_t alveole = ChercherEtat(ctx, pb, cle);
+    if (ctx->alveoles[alveole] != -1) return;
+    int n = ctx->visitedCount;
+    if (!PlacerNoeud(ctx, n) || !EnfilerNoeud(ctx, n)) {
+        ctx->limiteEtatsAtteinte = true;
+        return;
+    }
+    memcpy(ETAT_VISITE(ctx, pb, n), newState, sizeof(Mot) * pb->nbMots);
+    if (ctx->canoniques) {
+        memcpy(ETAT_CANONIQUE(ctx, pb, n), cle, sizeof(Mot) * pb->nbMots);
+    }
+    ctx->visited[n].parent = parent;
+    ctx->visited[n].actionFromParent = action;
+    ctx->alveoles[alveole] = n;
+    ctx->visitedCount++;
+}
+
+// 4.4 - Analyse fin-moyens par montée forcée (enforced hill-climbing)
+// Depuis l'état courant, on lance une BFS locale jusqu'au premier état
+// dont l'heuristique FF (partie 5.12) est strictement meilleure ; on s'y
+// engage et on recommence. La BFS locale n'essaie d'abord que les actions
+// utiles, puis toutes les actions si cela ne suffit pas. Si même ainsi
+// aucun état meilleur n'est accessible (impasse), on repart du début avec
+// la recherche gloutonne complète de la partie 5.12.
+// Le chemin engagé occupe visited[0 .. courant] ; la BFS locale range ses
+// noeuds à la suite (dans la table de hachage du contexte), et seul le
+// chemin vers l'état meilleur est gardé.
+
+typedef struct {
+    ContexteRecherche* ctx;
+    const Probleme* pb;
+    EvaluateurFF* ev;
+    int capacite;               // places de debutUtiles, nbUtiles et chemin
+    int* debutUtiles;           // actions utiles du noeud i : utiles[debutUtiles[i] .. + nbUtiles[i][
+    int* nbUtiles;              // -1 : impasse, le noeud n'est pas développé
+    int* utiles;
+    int tailleUtiles;
+    int capaciteUtiles;
+    int* utilesFils;
+    int* chemin;
+} Montee;
+
+// Range visited[n] dans la table ; faux si un état égal y est déjà
+static bool RangerNoeudMontee(Montee* mt, int n) {
+    ContexteRecherche* ctx = mt->ctx;
+    uint64_t i = ChercherEtat(ctx, mt->pb, ETAT_VISITE(ctx, mt->pb, n));
+    if (ctx->alveoles[i] != -1) return false;
+    ctx->alveoles[i] = n;
+    return true;
+}
+
+// Place pour le noeud n dans visited[] et dans les tableaux de la montée
+static bool PlacerNoeudMontee(Montee* mt, int n) {
+    if (!PlacerNoeud(mt->ctx, n)) return false;
+    if (n < mt->capacite) return true;
+    int capacite = mt->capacite;
+    while (capacite <= n) capacite *= 2;
+    int* debutUtiles = realloc(mt->debutUtiles, sizeof(int) * capacite);
+    if (debutUtiles) mt->debutUtiles = debutUtiles;
+    int* nbUtiles = realloc(mt->nbUtiles, sizeof(int) * capacite);
+    if (nbUtiles) mt->nbUtiles = nbUtiles;
+    int* chemin = realloc(mt->chemin, sizeof(int) * capacite);
+    if (chemin) mt->chemin = chemin;
+    if (!debutUtiles || !nbUtiles || !chemin) return false;
+    mt->capacite = capacite;
+    return true;
+}
+
+// Range les actions utiles (mt->utilesFils) du noeud n
+static bool AjouterUtilesMontee(Montee* mt, int n, int nb) {
+    if (mt->tailleUtiles + nb > mt->capaciteUtiles) {
+        int capacite = mt->capaciteUtiles * 2 + nb;
+        int* utiles = realloc(mt->utiles, sizeof(int) * capacite);
+        if (!utiles) return false;
+        mt->utiles = utiles;
+        mt->capaciteUtiles = capacite;
+    }
+    if (nb > 0) memcpy(mt->utiles + mt->tailleUtiles, mt->utilesFils, sizeof(int) * nb);
+    mt->debutUtiles[n] = mt->tailleUtiles;
+    mt->nbUtiles[n] = nb;
+    mt->tailleUtiles += nb;
+    return true;
+}
+
+// BFS locale depuis visited[courant] (actions utiles seulement ou toutes).
+// Renvoie l'indice du premier noeud de h < hCourant (dans *h), -1 si la
+// BFS s'épuise, -2 si la recherche doit s'arrêter.
+static int RechercheLocaleMontee(Montee* mt, int courant, int hCourant, bool toutes,
+                                 ControleRecherche* controle, int* h) {
+    ContexteRecherche* ctx = mt->ctx;
+    const Probleme* pb = mt->pb;
+    memset(ctx->alveoles, -1, sizeof(int) * ctx->nbAlveoles);
+    for (int n = 0; n <= courant; n++) RangerNoeudMontee(mt, n);
+    ctx->visitedCount = courant + 1;
+    mt->tailleUtiles = mt->debutUtiles[courant] + mt->nbUtiles[courant];
+
+    for (int n = courant; n < ctx->visitedCount; n++) {
+        if (mt->nbUtiles[n] < 0) continue;
+        if (ControleArret(controle)) return -2;
+        int nbEssais = toutes ? pb->actionCount : mt->nbUtiles[n];
+        for (int k = 0; k < nbEssais; k++) {
+            int a = toutes ? k : mt->utiles[mt->debutUtiles[n] + k];
+            if (toutes && !CanApply(ETAT_VISITE(ctx, pb, n), &pb->actions[a])) continue;
+            int fils = ctx->visitedCount;
+            // Plus de place pour la BFS locale
+            if (!PlacerNoeudMontee(mt, fils) || !AgrandirTableEtats(ctx, pb)) return -1;
+            ctx->reglesAppliquees++;
+            ApplyAction(pb, ETAT_VISITE(ctx, pb, n), &pb->actions[a], ETAT_VISITE(ctx, pb, fils));
+            if (!RangerNoeudMontee(mt, fils)) continue;
+            ctx->visited[fils].parent = n;
+            ctx->visited[fils].actionFromParent = a;
+            ctx->visitedCount++;
+
+            int nb = 0;
+            int hFils = EvaluerFF(mt->ev, ETAT_VISITE(ctx, pb, fils), mt->utilesFils, &nb);
+            if (hFils >= H_IMPASSE) {
+                mt->nbUtiles[fils] = -1;
+                continue;
+            }
+            if (!AjouterUtilesMontee(mt, fils, nb)) return -1;
+            if (hFils < hCourant) {
+                *h = hFils;
+                return fils;
+            }
+        }
+    }
+    return -1;
+}
+
+// Garde dans visited[] le chemin engagé suivi du chemin de la BFS locale
+// vers 'meilleur' ; renvoie le nouvel état courant
+static int EngagerMontee(Montee* mt, int courant, int meilleur) {
+    ContexteRecherche* ctx = mt->ctx;
+    const Probleme* pb = mt->pb;
+    Node* visited = ctx->visited;
+    int longueur = 0;
+    for (int n = meilleur; n != courant; n = visited[n].parent) mt->chemin[longueur++] = n;
+    // Les indices croissent le long du chemin : on recopie vers le bas sans rien écraser
+    for (int k = 0; k < longueur; k++) {
+        int source = mt->chemin[longueur - 1 - k];
+        int cible = courant + 1 + k;
+        if (source != cible) {
+            memcpy(ETAT_VISITE(ctx, pb, cible), ETAT_VISITE(ctx, pb, source), sizeof(Mot) * pb->nbMots);
+            visited[cible].actionFromParent = visited[source].actionFromParent;
+        }
+        visited[cible].parent = cible - 1;
+    }
+    int nouveau = courant + longueur;
+    // Les actions utiles du nouvel état passent en tête du tableau
+    if (mt->nbUtiles[meilleur] > 0) {
+        memmove(mt->utiles, mt->utiles + mt->debutUtiles[meilleur], sizeof(int) * mt->nbUtiles[meilleur]);
+    }
+    mt->debutUtiles[nouveau] = 0;
+    mt->nbUtiles[nouveau] = mt->nbUtiles[meilleur];
+    ctx->visitedCount = nouveau + 1;
+    return nouveau;
+}
+
+// Recherche gloutonne complète depuis l'état initial, dans ce qui reste
+// des limites ; son plan est recopié dans visited[]
+static int RepliMontee(ContexteRecherche* ctx, const Probleme* pb, ControleRecherche* controle) {
+    LimitesRecherche limites = controle->limites;
+    if (limites.delaiMs > 0) {
+        double reste = limites.delaiMs - DureeControleMs(controle);
+        limites.delaiMs = reste > 1 ? reste : 1;
+    }
+    if (limites.maxNoeuds > 0) {
+        long reste = limites.maxNoeuds - controle->noeuds;
+        limites.maxNoeuds = reste > 1 ? reste : 1;
+    }
+    int* plan = NULL;
+    ResultatGlouton resultat;
+    RechercheGloutonneLimitee(pb, &limites, &plan, &resultat);
+    controle->noeuds += resultat.developpes;
+    ctx->issue = resultat.issue;
+
+    int solution = -1;
+    if (resultat.longueur >= 0 && !PlacerNoeud(ctx, resultat.longueur)) {
+        ctx->issue = ISSUE_BUDGET_MEMOIRE;
+    } else if (resultat.longueur >= 0) {
+        for (int k = 0; k < resultat.longueur; k++) {
+            ApplyAction(pb, ETAT_VISITE(ctx, pb, k), &pb->actions[plan[k]], ETAT_VISITE(ctx, pb, k + 1));
+            ctx->visited[k + 1].parent = k;
+            ctx->visited[k + 1].actionFromParent = plan[k];
+        }
+        ctx->visitedCount = resultat.longueur + 1;
+        solution = resultat.longueur;
+    }
+    free(plan);
+    return solution;
+}
+
+// Mode MEANS_END de BfsAmeliore : visited[0] contient l'état initial
+static int MonteeForcee(ContexteRecherche* ctx, const Probleme* pb, ControleRecherche* controle) {
+    ctx->paliersMontee = 0;
+    ctx->repliMontee = false;
+    ctx->issue = ISSUE_BUDGET_MEMOIRE;
+
+    Montee mt;
+    memset(&mt, 0, sizeof(mt));
+    mt.ctx = ctx;
+    mt.pb = pb;
+    mt.capacite = ctx->capaciteEtats;
+    int nbActions = pb->actionCount > 0 ? pb->actionCount : 1;
+    mt.ev = CreerEvaluateurFF(pb);
+    mt.debutUtiles = malloc(sizeof(int) * mt.capacite);
+    mt.nbUtiles = malloc(sizeof(int) * mt.capacite);
+    mt.utilesFils = malloc(sizeof(int) * nbActions);
+    mt.chemin = malloc(sizeof(int) * mt.capacite);
+    int solution = -1;
+    if (!mt.ev || !mt.debutUtiles || !mt.nbUtiles || !mt.utilesFils || !mt.chemin) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la montée forcée\n");
+        goto fin;
+    }
+
+    int courant = 0;
+    int nb = 0;
+    int h = EvaluerFF(mt.ev, ETAT_VISITE(ctx, pb, 0), mt.utilesFils, &nb);
+    if (h >= H_IMPASSE) {
+        // But inatteignable même sans suppressions : aucun plan n'existe
+        ctx->issue = ISSUE_SANS_SOLUTION;
+        goto fin;
+    }
+    if (!AjouterUtilesMontee(&mt, 0, nb)) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la montée forcée\n");
+        goto fin;
+    }
+    controle->meilleurH = h;
+    controle->profondeur = 0;
+    while (!IsGoalReached(ETAT_VISITE(ctx, pb, courant), &pb->goal)) {
+        int hMeilleur = h;
+        int meilleur = RechercheLocaleMontee(&mt, courant, h, false, controle, &hMeilleur);
+        if (meilleur == -1) {
+            meilleur = RechercheLocaleMontee(&mt, courant, h, true, controle, &hMeilleur);
+        }
+        if (meilleur == -2) {
+            ctx->issue = controle->issue;
+            goto fin;
+        }
+        if (meilleur == -1) {
+            if (ctx->debug) printf("DEBUG: Montée forcée bloquée à h = %d, repli sur la recherche gloutonne\n", h);
+            ctx->repliMontee = true;
+            ctx->visitedCount = 1;
+            solution = RepliMontee(ctx, pb, controle);
+            goto fin;
+        }
+        courant = EngagerMontee(&mt, courant, meilleur);
+        h = hMeilleur;
+        ctx->paliersMontee++;
+        controle->meilleurH = h;
+        controle->profondeur = courant;
+        if (ctx->debug) printf("DEBUG: Palier %d : h = %d après %d actions\n", ctx->paliersMontee, h, courant);
+    }
+    ctx->visitedCount = courant + 1;
+    solution = courant;
+    ctx->issue = ISSUE_RESOLU;
+
+fin:
+    LibererEvaluateurFF(mt.ev);
+    free(mt.debutUtiles);
+    free(mt.nbUtiles);
+    free(mt.utiles);
+    free(mt.utilesFils);
+    free(mt.chemin);
+    return solution;
+}
+
+// 4.5 - Marches aléatoires de Monte-Carlo avec reprises
+// Depuis le meilleur état connu, on lance un lot de marches purement
+// aléatoires de longueur bornée (à chaque pas, une action applicable tirée
+// au hasard, sans mémoriser les états). Seul l'état au bout de chaque
+// marche est évalué (heuristique FF, partie 5.12) : un pas de marche ne
+// coûte donc presque rien. On saute au bout de la meilleure marche du lot
+// et on recommence. Si le meilleur h ne baisse plus, les marches
+// s'allongent ; après MAX_STAGNATION lots sans progrès, on repart de
+// l'état initial. Les marches d'un lot sont réparties entre NB_FILS_MARCHES
+// fils d'exécution, chacun avec son générateur et son évaluateur. Les fils
+// sont créés une fois par recherche et reçoivent ensuite les lots un à un.
+// La stratégie reste incomplète : elle s'arrête sans preuve après
+// MAX_REPRISES reprises.
+
+#define MARCHES_PAR_LOT      512    // marches lancées avant chaque saut
+#define LONGUEUR_MARCHE      10     // longueur des marches après un progrès
+#define LONGUEUR_MARCHE_MAX  640
+#define MAX_STAGNATION       7      // lots sans progrès avant une reprise
+#define MAX_REPRISES         100
+
+// Travail d'un fil pour un lot de marches
+// Actions rangées sous une seule de leurs préconditions (la moins
+// partagée) : à chaque pas, on n'essaie que les actions rangées sous un
+// fait vrai, plus celles qui n'ont aucune précondition
+typedef struct {
+    int* debut;                     // actions du fait f : liste[debut[f] .. debut[f + 1][
+    int* liste;
+    int* sansPrecondition;
+    int nbSansPrecondition;
+} SuccesseursMarches;
+
+static bool IndexerSuccesseursMarches(const Probleme* pb, SuccesseursMarches* sm) {
+    int nbFaits = pb->faits.nbFaits;
+    int* partage = calloc(nbFaits + 1, sizeof(int));
+    int* cle = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    sm->debut = calloc(nbFaits + 1, sizeof(int));
+    sm->liste = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    sm->sansPrecondition = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    sm->nbSansPrecondition = 0;
+    bool ok = partage && cle && sm->debut && sm->liste && sm->sansPrecondition;
+    if (ok) {
+        for (int a = 0; a < pb->actionCount; a++) {
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            for (int i = 0; i < pre->factCount; i++) partage[pre->facts[i]]++;
+        }
+        for (int a = 0; a < pb->actionCount; a++) {
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            cle[a] = -1;
+            for (int i = 0; i < pre->factCount; i++) {
+                if (cle[a] < 0 || partage[pre->facts[i]] < partage[cle[a]]) cle[a] = pre->facts[i];
+            }
+            if (cle[a] < 0) {
+                sm->sansPrecondition[sm->nbSansPrecondition++] = a;
+            } else {
+                sm->debut[cle[a] + 1]++;
+            }
+        }
+        for (int f = 0; f < nbFaits; f++) sm->debut[f + 1] += sm->debut[f];
+        memcpy(partage, sm->debut, sizeof(int) * (nbFaits + 1));
+        for (int a = 0; a < pb->actionCount; a++) {
+            if (cle[a] >= 0) sm->liste[partage[cle[a]]++] = a;
+        }
+    }
+    free(partage);
+    free(cle);
+    return ok;
+}
+
+static void LibererSuccesseursMarches(SuccesseursMarches* sm) {
+    free(sm->debut);
+    free(sm->liste);
+    free(sm->sansPrecondition);
+}
+
+typedef struct {
+    const Probleme* pb;
+    const SuccesseursMarches* successeurs;
+    EvaluateurFF* ev;
+    ControleRecherche controle;     // copie : seuls le délai et l'annulation sont lus
+    GenerateurAlea alea;            // générateur propre au fil
+    const Mot* depart;
+    int longueur;
+    int nbMarches;
+    Mot* etat;
+    Mot* suivant;
+    int* applicables;
+    int* marche;
+    int* meilleure;                 // actions de la meilleure marche du lot
+    int longueurMeilleure;
+    int hMeilleur;                  // INT_MAX : aucune marche utilisable
+    long pas;
+    long evaluations;
+    bool arrete;
+    struct EquipeMarches* equipe;   // fils créés pour la recherche
+} FilMarches;
+
+// Fils des marches d'une recherche : le fil appelant publie un numéro de
+// lot et fait la part de fils[0] ; les autres attendent un nouveau
+// numéro, font leur part, et le dernier qui finit réveille l'appelant
+typedef struct EquipeMarches {
+    FilMarches* fils;
+    int nbFils;
+    int lot;                        // numéro du dernier lot publié
+    int restants;                   // fils qui n'ont pas fini ce lot
+    bool fin;                       // les fils doivent se terminer
+    bool synchronise;               // verrou et conditions créés
+#ifdef _WIN32
+    SRWLOCK verrou;
+    CONDITION_VARIABLE travail;     // lot publié ou fin
+    CONDITION_VARIABLE termine;     // le dernier fil a fini le lot
+    HANDLE poignees[MAX_FILS_MARCHES];
+#else
+    pthread_mutex_t verrou;
+    pthread_cond_t travail;
+    pthread_cond_t termine;
+    pthread_t identifiants[MAX_FILS_MARCHES];
+#endif
+    bool lance[MAX_FILS_MARCHES];   // fil créé (sinon l'appelant fait sa part)
+} EquipeMarches;
+
+static void ExecuterMarches(FilMarches* f) {
+    const Probleme* pb = f->pb;
+    f->hMeilleur = INT_MAX;
+    f->longueurMeilleure = 0;
+    f->pas = 0;
+    f->evaluations = 0;
+    f->arrete = false;
+    for (int w = 0; w < f->nbMarches; w++) {
+        if (w % 16 == 0 && ControleImmediat(&f->controle)) {
+            f->arrete = true;
+            return;
+        }
+        memcpy(f->etat, f->depart, sizeof(Mot) * pb->nbMots);
+        int longueur = 0;
+        bool but = false;
+        while (longueur < f->longueur) {
+            int nb = 0;
+            const SuccesseursMarches* sm = f->successeurs;
+            for (int k = 0; k < sm->nbSansPrecondition; k++) {
+                int a = sm->sansPrecondition[k];
+                if (CanApply(f->etat, &pb->actions[a])) f->applicables[nb++] = a;
+            }
+            for (int fait = 0; fait < pb->faits.nbFaits; fait++) {
+                if (!TEST_BIT(f->etat, fait)) continue;
+                for (int k = sm->debut[fait]; k < sm->debut[fait + 1]; k++) {
+                    int a = sm->liste[k];
+                    if (CanApply(f->etat, &pb->actions[a])) f->applicables[nb++] = a;
+                }
+            }
+            if (nb == 0) break;                 // impasse : la marche s'arrête là
+            int a = f->applicables[TirageRecherche(&f->alea) % (uint64_t)nb];
+            ApplyAction(pb, f->etat, &pb->actions[a], f->suivant);
+            Mot* echange = f->etat;
+            f->etat = f->suivant;
+            f->suivant = echange;
+            f->marche[longueur++] = a;
+            if (IsGoalReached(f->etat, &pb->goal)) {
+                but = true;
+                break;
+            }
+        }
+        f->pas += longueur;
+        if (longueur == 0) continue;
+        int h = 0;
+        if (!but) {
+            h = EvaluerFF(f->ev, f->etat, NULL, NULL);
+            f->evaluations++;
+        }
+        if (h < f->hMeilleur && h < H_IMPASSE) {
+            f->hMeilleur = h;
+            f->longueurMeilleure = longueur;
+            memcpy(f->meilleure, f->marche, sizeof(int) * longueur);
+            if (but) return;
+        }
+    }
+}
+
+#ifdef _WIN32
+static void VerrouillerEquipe(EquipeMarches* e) { AcquireSRWLockExclusive(&e->verrou); }
+static void DeverrouillerEquipe(EquipeMarches* e) { ReleaseSRWLockExclusive(&e->verrou); }
+static void AttendreEquipe(EquipeMarches* e, CONDITION_VARIABLE* c) { SleepConditionVariableSRW(c, &e->verrou, INFINITE, 0); }
+static void ReveillerEquipe(CONDITION_VARIABLE* c) { WakeAllConditionVariable(c); }
+#else
+static void VerrouillerEquipe(EquipeMarches* e) { pthread_mutex_lock(&e->verrou); }
+static void DeverrouillerEquipe(EquipeMarches* e) { pthread_mutex_unlock(&e->verrou); }
+static void AttendreEquipe(EquipeMarches* e, pthread_cond_t* c) { pthread_cond_wait(c, &e->verrou); }
+static void ReveillerEquipe(pthread_cond_t* c) { pthread_cond_broadcast(c); }
+#endif
+
+// Boucle d'un fil : un lot par numéro publié, jusqu'à la fin de l'équipe
+static void TravaillerFilMarches(FilMarches* f) {
+    EquipeMarches* e = f->equipe;
+    int vu = 0;
+    VerrouillerEquipe(e);
+    for (;;) {
+        while (!e->fin && e->lot == vu) AttendreEquipe(e, &e->travail);
+        if (e->fin) break;
+        vu = e->lot;
+        DeverrouillerEquipe(e);
+        ExecuterMarches(f);
+        VerrouillerEquipe(e);
+        if (--e->restants == 0) ReveillerEquipe(&e->termine);
+    }
+    DeverrouillerEquipe(e);
+}
+
+#ifdef _WIN32
+static DWORD WINAPI LancerFilMarches(LPVOID arg) {
+    TravaillerFilMarches(arg);
+    return 0;
+}
+#else
+static void* LancerFilMarches(void* arg) {
+    TravaillerFilMarches(arg);
+    return NULL;
+}
+#endif
+
+// Crée les fils 1 .. nbFils - 1 ; ceux qui ne peuvent pas l'être (ou tous,
+// sans verrou) verront leur part faite par le fil appelant
+static void DemarrerEquipe(EquipeMarches* e, FilMarches* fils, int nbFils) {
+    memset(e, 0, sizeof(*e));
+    e->fils = fils;
+    e->nbFils = nbFils;
+    if (nbFils < 2) return;
+#ifdef _WIN32
+    InitializeSRWLock(&e->verrou);
+    InitializeConditionVariable(&e->travail);
+    InitializeConditionVariable(&e->termine);
+    e->synchronise = true;
+#else
+    bool verrou = pthread_mutex_init(&e->verrou, NULL) == 0;
+    bool travail = pthread_cond_init(&e->travail, NULL) == 0;
+    bool termine = pthread_cond_init(&e->termine, NULL) == 0;
+    e->synchronise = verrou && travail && termine;
+    if (!e->synchronise) {
+        if (verrou) pthread_mutex_destroy(&e->verrou);
+        if (travail) pthread_cond_destroy(&e->travail);
+        if (termine) pthread_cond_destroy(&e->termine);
+        return;
+    }
+#endif
+    for (int t = 1; t < nbFils; t++) {
+        fils[t].equipe = e;
+#ifdef _WIN32
+        e->poignees[t] = CreateThread(NULL, 0, LancerFilMarches, &fils[t], 0, NULL);
+        e->lance[t] = e->poignees[t] != NULL;
+#else
+        e->lance[t] = pthread_create(&e->identifiants[t], NULL, LancerFilMarches, &fils[t]) == 0;
+#endif
+    }
+}
+
+// Fait un lot : chaque fil sa part, le fil appelant celle de fils[0] (et
+// des fils qui n'ont pas pu être créés)
+static void LotDeMarches(EquipeMarches* e) {
+    int nbLances = 0;
+    for (int t = 1; t < e->nbFils; t++) nbLances += e->lance[t];
+    if (nbLances > 0) {
+        VerrouillerEquipe(e);
+        e->lot++;
+        e->restants = nbLances;
+        ReveillerEquipe(&e->travail);
+        DeverrouillerEquipe(e);
+    }
+    ExecuterMarches(&e->fils[0]);
+    for (int t = 1; t < e->nbFils; t++) {
+        if (!e->lance[t]) ExecuterMarches(&e->fils[t]);     // fil refusé : le travail est fait ici
+    }
+    if (nbLances > 0) {
+        VerrouillerEquipe(e);
+        while (e->restants > 0) AttendreEquipe(e, &e->termine);
+        DeverrouillerEquipe(e);
+    }
+}
+
+static void ArreterEquipe(EquipeMarches* e) {
+    if (!e->synchronise) return;
+    VerrouillerEquipe(e);
+    e->fin = true;
+    ReveillerEquipe(&e->travail);
+    DeverrouillerEquipe(e);
+    for (int t = 1; t < e->nbFils; t++) {
+        if (!e->lance[t]) continue;
+#ifdef _WIN32
+        WaitForSingleObject(e->poignees[t], INFINITE);
+        CloseHandle(e->poignees[t]);
+#else
+        pthread_join(e->identifiants[t], NULL);
+#endif
+    }
+#ifndef _WIN32
+    pthread_mutex_destroy(&e->verrou);
+    pthread_cond_destroy(&e->travail);
+    pthread_cond_destroy(&e->termine);
+#endif
+}
+
+// Mode ALEATOIRE de BfsAmeliore : visited[0] contient l'état initial
+static int MarchesAleatoires(ContexteRecherche* ctx, const Probleme* pb, ControleRecherche* controle) {
+    ctx->paliersMarches = 0;
+    ctx->reprisesMarches = 0;
+    ctx->pasMarches = 0;
+    ctx->issue = ISSUE_BUDGET_MEMOIRE;
+
+    int nbFils = ctx->nbFilsMarches < 1 ? 1 : ctx->nbFilsMarches > MAX_FILS_MARCHES ? MAX_FILS_MARCHES : ctx->nbFilsMarches;
+    int nbActions = pb->actionCount > 0 ? pb->actionCount : 1;
+    FilMarches fils[MAX_FILS_MARCHES];
+    memset(fils, 0, sizeof(fils));
+    EquipeMarches equipe;
+    memset(&equipe, 0, sizeof(equipe));
+    uint64_t graine = TirageRecherche(&ctx->alea);
+    Mot* courant = NouvelEtat(pb);
+    SuccesseursMarches successeurs;
+    bool indexe = IndexerSuccesseursMarches(pb, &successeurs);
+    int* chemin = NULL;
+    int longueurChemin = 0, capaciteChemin = 0;
+    int solution = -1;
+    bool pret = courant && indexe;
+    for (int t = 0; t < nbFils && pret; t++) {
+        FilMarches* f = &fils[t];
+        f->pb = pb;
+        f->successeurs = &successeurs;
+        f->ev = CreerEvaluateurFF(pb);
+        SemerAlea(&f->alea, graine + (uint64_t)t);
+        f->depart = courant;
+        f->etat = NouvelEtat(pb);
+        f->suivant = NouvelEtat(pb);
+        f->applicables = malloc(sizeof(int) * nbActions);
+        f->marche = malloc(sizeof(int) * LONGUEUR_MARCHE_MAX);
+        f->meilleure = malloc(sizeof(int) * LONGUEUR_MARCHE_MAX);
+        f->nbMarches = (MARCHES_PAR_LOT + nbFils - 1) / nbFils;
+        pret = f->ev && f->etat && f->suivant && f->applicables && f->marche && f->meilleure;
+    }
+    if (!pret) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour les marches aléatoires\n");
+        goto fin;
+    }
+    DemarrerEquipe(&equipe, fils, nbFils);
+
+    int hInitial = EvaluerFF(fils[0].ev, ETAT_VISITE(ctx, pb, 0), NULL, NULL);
+    if (hInitial >= H_IMPASSE) {
+        // But inatteignable même sans suppressions : aucun plan n'existe
+        ctx->issue = ISSUE_SANS_SOLUTION;
+        goto fin;
+    }
+    memcpy(courant, ETAT_VISITE(ctx, pb, 0), sizeof(Mot) * pb->nbMots);
+    int hCourant = hInitial;
+    int stagnation = 0;
+    int longueur = LONGUEUR_MARCHE;
+    while (!IsGoalReached(courant, &pb->goal)) {
+        if (ControleArret(controle)) {
+            ctx->issue = controle->issue;
+            goto fin;
+        }
+        for (int t = 0; t < nbFils; t++) {
+            fils[t].controle = *controle;
+            fils[t].longueur = longueur;
+        }
+        LotDeMarches(&equipe);
+
+        FilMarches* meilleur = NULL;
+        for (int t = 0; t < nbFils; t++) {
+            ctx->pasMarches += fils[t].pas;
+            controle->noeuds += fils[t].evaluations;
+            if (fils[t].hMeilleur != INT_MAX && (!meilleur || fils[t].hMeilleur < meilleur->hMeilleur)) meilleur = &fils[t];
+        }
+        for (int t = 0; t < nbFils; t++) {
+            if (fils[t].arrete && ControleImmediat(controle)) {
+                ctx->issue = controle->issue;
+                goto fin;
+            }
+        }
+
+        // Saut au bout de la meilleure marche, sauf si elle remonte
+        if (meilleur && meilleur->hMeilleur > hCourant) meilleur = NULL;
+        bool progres = meilleur && meilleur->hMeilleur < hCourant;
+        if (meilleur) {
+            if (longueurChemin + meilleur->longueurMeilleure > capaciteChemin) {
+                int capacite = capaciteChemin * 2 + LONGUEUR_MARCHE_MAX;
+                int* agrandi = realloc(chemin, sizeof(int) * capacite);
+                if (!agrandi) goto fin;
+                chemin = agrandi;
+                capaciteChemin = capacite;
+            }
+            for (int k = 0; k < meilleur->longueurMeilleure; k++) {
+                int a = meilleur->meilleure[k];
+                ApplyAction(pb, courant, &pb->actions[a], fils[0].suivant);
+                memcpy(courant, fils[0].suivant, sizeof(Mot) * pb->nbMots);
+                chemin[longueurChemin++] = a;
+            }
+            hCourant = meilleur->hMeilleur;
+        }
+        if (progres) {
+            stagnation = 0;
+            longueur = LONGUEUR_MARCHE;
+            ctx->paliersMarches++;
+            if (controle->meilleurH < 0 || hCourant < controle->meilleurH) controle->meilleurH = hCourant;
+            controle->profondeur = longueurChemin;
+            if (ctx->debug) printf("DEBUG: Marches : h = %d après %d actions\n", hCourant, longueurChemin);
+            continue;
+        }
+        if (longueur * 2 <= LONGUEUR_MARCHE_MAX) longueur *= 2;
+        if (++stagnation < MAX_STAGNATION) continue;
+
+        // Reprise depuis l'état initial
+        if (++ctx->reprisesMarches > MAX_REPRISES) {
+            ctx->issue = ISSUE_INCOMPLET;
+            goto fin;
+        }
+        if (ctx->debug) printf("DEBUG: Marches : reprise %d (bloqué à h = %d)\n", ctx->reprisesMarches, hCourant);
+        memcpy(courant, ETAT_VISITE(ctx, pb, 0), sizeof(Mot) * pb->nbMots);
+        longueurChemin = 0;
+        hCourant = hInitial;
+        stagnation = 0;
+        longueur = LONGUEUR_MARCHE;
+    }
+
+    // Le chemin passe dans visited[] (raccourci d'abord s'il ne tient pas
+    // dans le budget d'octets)
+    if (!PlacerNoeud(ctx, longueurChemin)) longueurChemin = OptimiserPlan(pb, chemin, longueurChemin, false);
+    if (!PlacerNoeud(ctx, longueurChemin)) {
+        ctx->issue = ISSUE_BUDGET_MEMOIRE;
+        goto fin;
+    }
+    for (int k = 0; k < longueurChemin; k++) {
+        ApplyAction(pb, ETAT_VISITE(ctx, pb, k), &pb->actions[chemin[k]], ETAT_VISITE(ctx, pb, k + 1));
+        ctx->visited[k + 1].parent = k;
+        ctx->visited[k + 1].actionFromParent = chemin[k];
+    }
+    ctx->visitedCount = longueurChemin + 1;
+    solution = longueurChemin;
+    ctx->issue = ISSUE_RESOLU;
+
+fin:
+    ArreterEquipe(&equipe);
+    for (int t = 0; t < nbFils; t++) {
+        LibererEvaluateurFF(fils[t].ev);
+        free(fils[t].etat);
+        free(fils[t].suivant);
+        free(fils[t].applicables);
+        free(fils[t].marche);
+        free(fils[t].meilleure);
+    }
+    LibererSuccesseursMarches(&successeurs);
+    free(courant);
+    free(chemin);
+    return solution;
+}
+
+// 4.6 - Priorités des règles apprises (bandit à plusieurs bras)
+// Chaque règle est un bras : on compte les fois où elle a été tirée
+// (essais) et ses récompenses (succès). Une règle est récompensée quand
+// son application rapproche du but (plus de faits du but vrais) et quand
+// elle fait partie du plan trouvé. Son poids est la moyenne a posteriori
+// (succès + 1) / (essais + 2) : une règle jamais essayée vaut 1/2, une
+// règle jamais utile tend vers 0 sans jamais l'atteindre (exploration).
+// Les compteurs sont gardés par domaine dans
+// REPERTOIRE_PRIORITES/gps_priorites_<hachage des noms des règles>.txt,
+// et le mode PRIORITE s'améliore ainsi d'une exécution à l'autre. Les
+// compteurs d'avant la dernière recherche restent dans le même fichier
+// suivi de ".prec", pour la rejouer (partie 4.3). Un répertoire vide ("",
+// défaut de la bibliothèque) n'écrit ni ne lit aucun fichier : les
+// priorités ne sont apprises que pendant la recherche.
+// Pour tirer une règle applicable, on range leurs poids dans un arbre de
+// Fenwick (construit en O(k) pour k règles applicables) : chaque tirage
+// coûte O(log k), et une règle tirée en est retirée en O(log k), ce qui
+// permet de retirer au sort quand le fils obtenu est déjà connu.
+
+#define ENTETE_PRIORITES "GPSPRIO1"
+
+typedef struct {
+    int nbRegles;
+    double* essais;
+    double* succes;
+    uint64_t cle;               // hachage des noms des règles
+    const char* repertoire;     // répertoire du fichier du domaine
+    unsigned long long graine;  // graine de la recherche qui a écrit le fichier (0 si inconnue)
+    double* arbre;              // arbre de Fenwick des poids des candidates (indices 1..nbCandidates)
+    double* poids;              // poids de chaque candidate (0 une fois tirée)
+    int* candidates;            // règles applicables du noeud en cours
+    int nbCandidates;
+} PrioritesApprises;
+
+static double PoidsRegle(const PrioritesApprises* p, int a) {
+    return (p->succes[a] + 1.0) / (p->essais[a] + 2.0);
+}
+
+// Hachage des noms des règles, indépendant de leur ordre dans le fichier
+static uint64_t HacherRegles(const Probleme* pb) {
+    uint64_t h = 0x5052494FULL;
+    for (int a = 0; a < pb->actionCount; a++) h += Melanger64(HacherTranche(pb->actions[a].name) + 0x9E3779B97F4A7C15ULL);
+    return Melanger64(h ^ (uint64_t)pb->actionCount);
+}
+
+static void CheminPriorites(const PrioritesApprises* p, bool precedentes, char* chemin, size_t taille) {
+    snprintf(chemin, taille, "%s/gps_priorites_%016llx.txt%s", p->repertoire, (unsigned long long)p->cle,
+             precedentes ? ".prec" : "");
+}
+
+static void LibererPriorites(PrioritesApprises* p) {
+    free(p->essais);
+    free(p->succes);
+    free(p->arbre);
+    free(p->poids);
+    free(p->candidates);
+    memset(p, 0, sizeof(*p));
+}
+
+// Compteurs à zéro, puis ceux du fichier du domaine s'il existe dans
+// 'repertoire' (ou de son fichier ".prec"). L'en-tête porte la graine de la recherche qui
+// l'a écrit ; le fichier range ensuite une règle par ligne : "essais
+// succès nom" (le nom court jusqu'à la fin de la ligne) ; les règles
+// inconnues sont ignorées.
+static bool ChargerPriorites(const Probleme* pb, PrioritesApprises* p, const char* repertoire, bool precedentes) {
+    memset(p, 0, sizeof(*p));
+    int n = pb->actionCount > 0 ? pb->actionCount : 1;
+    p->nbRegles = pb->actionCount;
+    p->cle = HacherRegles(pb);
+    p->repertoire = repertoire;
+    p->essais = calloc(n, sizeof(double));
+    p->succes = calloc(n, sizeof(double));
+    p->arbre = malloc(sizeof(double) * (n + 1));
+    p->poids = malloc(sizeof(double) * n);
+    p->candidates = malloc(sizeof(int) * n);
+    if (!p->essais || !p->succes || !p->arbre || !p->poids || !p->candidates) {
+        LibererPriorites(p);
+        return false;
+    }
+
+    if (repertoire[0] == '\0') return true;     // sans fichier
+    char chemin[MAX_LEN * 2];
+    CheminPriorites(p, precedentes, chemin, sizeof(chemin));
+    FILE* fp = fopen(chemin, "r");
+    if (!fp) return true;                       // domaine jamais vu
+
+    // Table des règles par nom (adressage ouvert)
+    int nbAlveoles = 1;
+    while (nbAlveoles < 2 * n) nbAlveoles *= 2;
+    int* alveoles = malloc(sizeof(int) * nbAlveoles);
+    char* ligne = malloc(MAX_LEN * 16);
+    bool* lue = calloc(n, sizeof(bool));
+    if (alveoles && ligne && lue) {
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int a = 0; a < pb->actionCount; a++) {
+            uint32_t i = HacherTranche(pb->actions[a].name) & (nbAlveoles - 1);
+            while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = a;
+        }
+        bool entete = fgets(ligne, MAX_LEN * 16, fp) && strncmp(ligne, ENTETE_PRIORITES, strlen(ENTETE_PRIORITES)) == 0;
+        if (entete && sscanf(ligne + strlen(ENTETE_PRIORITES), "%llu", &p->graine) != 1) p->graine = 0;
+        while (entete && fgets(ligne, MAX_LEN * 16, fp)) {
+            double essais, succes;
+            int lus = 0;
+            if (sscanf(ligne, "%lf %lf %n", &essais, &succes, &lus) != 2 || lus == 0) continue;
+            Tranche nom = { ligne + lus, (int)strcspn(ligne + lus, "\r\n") };
+            for (uint32_t i = HacherTranche(nom) & (nbAlveoles - 1); alveoles[i] != -1; i = (i + 1) & (nbAlveoles - 1)) {
+                int a = alveoles[i];
+                if (!lue[a] && TranchesEgales(pb->actions[a].name, nom)) {
+                    // Règles homonymes : la k-ième ligne va à la k-ième règle
+                    lue[a] = true;
+                    if (essais >= 0 && succes >= 0 && succes <= essais) {
+                        p->essais[a] = essais;
+                        p->succes[a] = succes;
+                    }
+                    break;
+                }
+            }
+        }
+    }
+    free(alveoles);
+    free(ligne);
+    free(lue);
+    fclose(fp);
+    return true;
+}
+
+// Nom de fichier temporaire propre à l'écrivain : numéro du processus et
+// compteur d'appels, pour que deux recherches simultanées sur le même
+// domaine, dans le même processus ou non, n'écrivent pas dans le même fichier
+static void NomTemporaire(char* tampon, size_t taille, const char* chemin) {
+    static atomic_uint appels;
+#ifdef _WIN32
+    unsigned long processus = (unsigned long)GetCurrentProcessId();
+#else
+    unsigned long processus = (unsigned long)getpid();
+#endif
+    snprintf(tampon, taille, "%s.%lu.%u.tmp", chemin, processus, atomic_fetch_add(&appels, 1));
+}
+
+// Écrit les compteurs (fichier temporaire renommé, comme les bases de motifs)
+// L'ancien fichier devient le fichier ".prec" (compteurs du début de la
+// recherche 'graine') ; s'il n'existait pas, le ".prec" est retiré.
+static bool EnregistrerPriorites(const Probleme* pb, const PrioritesApprises* p, unsigned long long graine) {
+    char chemin[MAX_LEN * 2];
+    char precedent[MAX_LEN * 2];
+    char temporaire[MAX_LEN * 2 + 48];
+    if (p->repertoire[0] == '\0') return true;  // sans fichier
+    CheminPriorites(p, false, chemin, sizeof(chemin));
+    CheminPriorites(p, true, precedent, sizeof(precedent));
+    NomTemporaire(temporaire, sizeof(temporaire), chemin);
+    FILE* fp = fopen(temporaire, "w");
+    if (!fp) return false;
+    bool ok = fprintf(fp, "%s %llu\n", ENTETE_PRIORITES, graine) > 0;
+    for (int a = 0; a < p->nbRegles && ok; a++) {
+        ok = fprintf(fp, "%.0f %.0f %.*s\n", p->essais[a], p->succes[a],
+                     pb->actions[a].name.longueur, pb->actions[a].name.debut) > 0;
+    }
+    ok = fclose(fp) == 0 && ok;
+    if (ok) {
+        remove(precedent);
+        rename(chemin, precedent);
+        ok = rename(temporaire, chemin) == 0;
+    }
+    if (!ok) remove(temporaire);
+    return ok;
+}
+
+static void RecompenserRegle(PrioritesApprises* p, int a, double recompense) {
+    p->essais[a] += 1;
+    p->succes[a] += recompense;
+}
+
+// Range les candidates (p->candidates) dans l'arbre de Fenwick, en O(k)
+static void RangerCandidates(PrioritesApprises* p) {
+    for (int k = 0; k < p->nbCandidates; k++) {
+        p->poids[k] = PoidsRegle(p, p->candidates[k]);
+        p->arbre[k + 1] = p->poids[k];
+    }
+    for (int i = 1; i <= p->nbCandidates; i++) {
+        int parent = i + (i & -i);
+        if (parent <= p->nbCandidates) p->arbre[parent] += p->arbre[i];
+    }
+}
+
+// Les candidates sont les règles applicables à 'etat'
+static void PreparerTirage(PrioritesApprises* p, const Probleme* pb, const Mot* etat) {
+    p->nbCandidates = 0;
+    for (int a = 0; a < pb->actionCount; a++) {
+        if (CanApply(etat, &pb->actions[a])) p->candidates[p->nbCandidates++] = a;
+    }
+    RangerCandidates(p);
+}
+
+// Tire une candidate avec une probabilité proportionnelle à son poids et
+// la retire de l'arbre ; -1 s'il n'en reste plus
+static int TirerRegle(PrioritesApprises* p, GenerateurAlea* alea) {
+    if (p->nbCandidates == 0) return -1;
+    double total = 0;
+    for (int i = p->nbCandidates; i > 0; i -= i & -i) total += p->arbre[i];
+    if (total <= 1e-12) return -1;
+    double cible = total * ((TirageRecherche(alea) >> 11) * (1.0 / 9007199254740992.0));
+
+    // Descente : plus petit i dont la somme des poids 1..i dépasse la cible
+    int i = 0;
+    int pas = 1;
+    while (pas * 2 <= p->nbCandidates) pas *= 2;
+    for (; pas > 0; pas /= 2) {
+        if (i + pas <= p->nbCandidates && p->arbre[i + pas] <= cible) {
+            i += pas;
+            cible -= p->arbre[i];
+        }
+    }
+    // Les arrondis peuvent désigner une candidate déjà retirée : on prend
+    // alors la dernière qui reste
+    int k = i < p->nbCandidates ? i : p->nbCandidates - 1;
+    while (k >= 0 && p->poids[k] <= 0) k--;
+    if (k < 0) return -1;
+    for (int j = k + 1; j <= p->nbCandidates; j += j & -j) p->arbre[j] -= p->poids[k];
+    p->poids[k] = 0;
+    return p->candidates[k];
+}
+
+// Tirages en cours des noeuds remis dans la file par MODE_PRIORITE : le
+// noeud n n'a pas encore tiré les règles restantes[debut[n] .. + nb[n][
+// (nb[n] = -1 tant qu'il n'a pas été développé). Une règle n'est donc
+// tirée, et récompensée, qu'une fois par noeud, et un noeud repris ne
+// reteste pas toutes les règles.
+typedef struct {
+    int* debut;
+    int* nb;
+    int capacite;               // places de debut et nb
+    int* restantes;
+    int taille;
+    int capaciteRestantes;
+} TiragesEnCours;
+
+// Place pour les noeuds 0 .. nbNoeuds - 1 (les nouveaux sont à développer)
+static bool SuivreTirages(TiragesEnCours* t, int nbNoeuds) {
+    if (nbNoeuds <= t->capacite) return true;
+    int capacite = t->capacite ? t->capacite : 1024;
+    while (capacite < nbNoeuds) capacite *= 2;
+    int* debut = realloc(t->debut, sizeof(int) * capacite);
+    if (debut) t->debut = debut;
+    int* nb = realloc(t->nb, sizeof(int) * capacite);
+    if (nb) t->nb = nb;
+    if (!debut || !nb) return false;
+    for (int n = t->capacite; n < capacite; n++) t->nb[n] = -1;
+    t->capacite = capacite;
+    return true;
+}
+
+// Garde les candidates pas encore tirées du noeud n : à la suite du
+// tableau la première fois, ensuite à la même place (la liste ne fait que
+// raccourcir). Renvoie leur nombre, -1 si la mémoire manque.
+static int GarderRestantes(TiragesEnCours* t, int n, const PrioritesApprises* p) {
+    int nb = 0;
+    for (int k = 0; k < p->nbCandidates; k++) nb += p->poids[k] > 0;
+    if (t->nb[n] < 0) {
+        if (t->taille + nb > t->capaciteRestantes) {
+            int capacite = t->capaciteRestantes * 2 + nb;
+            int* restantes = realloc(t->restantes, sizeof(int) * capacite);
+            if (!restantes) return -1;
+            t->restantes = restantes;
+            t->capaciteRestantes = capacite;
+        }
+        t->debut[n] = t->taille;
+        t->taille += nb;
+    }
+    int* liste = t->restantes + t->debut[n];
+    for (int k = 0, j = 0; k < p->nbCandidates; k++) {
+        if (p->poids[k] > 0) liste[j++] = p->candidates[k];
+    }
+    t->nb[n] = nb;
+    return nb;
+}
+
+// Reprend le tirage du noeud n : ses règles restantes, avec les poids actuels
+static void ReprendreTirage(PrioritesApprises* p, const TiragesEnCours* t, int n) {
+    memcpy(p->candidates, t->restantes + t->debut[n], sizeof(int) * t->nb[n]);
+    p->nbCandidates = t->nb[n];
+    RangerCandidates(p);
+}
+
+static void LibererTirages(TiragesEnCours* t) {
+    free(t->debut);
+    free(t->nb);
+    free(t->restantes);
+}
+
+int BfsAmeliore(ContexteRecherche* ctx, const Probleme* pb, int mode) {
+    Action* actions = pb->actions;
+    int actionCount = pb->actionCount;
+    const Goal* goal = &pb->goal;
+
+    // Reinit
+    ctx->visitedCount = 0;
+    ctx->front = 0;
+    ctx->rear = 0;
+    ctx->reglesAppliquees = 0;
+    ctx->noeuds = 0;
+    ctx->successeursEcartes = 0;
+    ctx->octetsMax = 0;
+    ctx->nbSymetries = 0;
+    ctx->canoniques = false;
+    ctx->limiteEtatsAtteinte = false;
+    ctx->issue = ISSUE_BUDGET_MEMOIRE;   // issue des sorties sur erreur d'allocation
+
+    // Les états visités sont rangés les uns à la suite des autres
+    bool symetries = ctx->reductionSymetries && mode != MODE_ALEATOIRE && mode != MODE_MEANS_END;
+    // Le fils en construction, puis une copie de l'état développé : les
+    // tableaux des noeuds peuvent être déplacés quand ils grandissent
+    Mot* newState = calloc(2 * (size_t)pb->nbMots, sizeof(Mot));
+    // Mémoire d'un état visité (noeud, file, deux alvéoles et état, plus sa
+    // forme canonique si les symétries sont utilisées, voir plus bas)
+    ctx->octetsParEtat = sizeof(Node) + 3 * sizeof(int) + sizeof(Mot) * pb->nbMots;
+    if (!PreparerContexte(ctx, pb, symetries) || !newState) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la recherche\n");
+        free(newState);
+        return -1;
+    }
+
+    // Délai, budget de noeuds et annulation (partie 4.0) ; en mode debug,
+    // l'avancement est affiché chaque seconde
+    ControleRecherche controle;
+    DemarrerControle(&controle, &ctx->limites);
+    if (ctx->debug && !controle.limites.progression) controle.limites.progression = AfficherProgression;
+
+    // Tous les tirages de la recherche viennent de sa graine (partie 4.3)
+    SemerRecherche(ctx);
+    if (ctx->debug && (mode == MODE_MELANGE || mode == MODE_ALEATOIRE || mode == MODE_PRIORITE)) {
+        printf("DEBUG: Graine %llu\n", ctx->graineUtilisee);
+    }
+
+    // Choix aléatoire : marches de Monte-Carlo (partie 4.5)
+    if (mode == MODE_ALEATOIRE) {
+        EtatDepuisListe(pb, &pb->initial, ETAT_VISITE(ctx, pb, 0));
+        ctx->visited[0].parent = -1;
+        ctx->visited[0].actionFromParent = -1;
+        ctx->visitedCount = 1;
+        int solution = MarchesAleatoires(ctx, pb, &controle);
+        ctx->noeuds = controle.noeuds;
+        ctx->octetsMax = ctx->octetsParEtat * ctx->visitedCount;
+        ctx->reglesAppliquees = ctx->pasMarches > INT_MAX ? INT_MAX : (int)ctx->pasMarches;
+        if (ctx->debug) {
+            printf("DEBUG: Marches aléatoires : %s (%d paliers, %d reprises, %ld pas, %.2f ms)\n", NomIssue(ctx->issue),
+                   ctx->paliersMarches, ctx->reprisesMarches, ctx->pasMarches, DureeControleMs(&controle));
+        }
+        free(newState);
+        return solution;
+    }
+
+    // Analyse fin-moyens : montée forcée (partie 4.4)
+    if (mode == MODE_MEANS_END) {
+        EtatDepuisListe(pb, &pb->initial, ETAT_VISITE(ctx, pb, 0));
+        ctx->visited[0].parent = -1;
+        ctx->visited[0].actionFromParent = -1;
+        ctx->visitedCount = 1;
+        int solution = MonteeForcee(ctx, pb, &controle);
+        ctx->noeuds = controle.noeuds;
+        ctx->octetsMax = ctx->octetsParEtat * ctx->visitedCount;
+        if (ctx->debug) {
+            printf("DEBUG: Montée forcée : %s (%d paliers%s, %.2f ms)\n", NomIssue(ctx->issue),
+                   ctx->paliersMontee, ctx->repliMontee ? ", puis recherche gloutonne" : "", DureeControleMs(&controle));
+        }
+        free(newState);
+        return solution;
+    }
+
+    // Mélanger les règles au début si demandé
+    if (mode == MODE_MELANGE) {
+        if (ctx->debug) printf("DEBUG: Mode MELANGE activé - mélange des %d règles...\n", actionCount);
+        if (ctx->capaciteOrdre < actionCount) {
+            free(ctx->ordre);
+            free(ctx->rang);
+            ctx->ordre = malloc(sizeof(int) * actionCount);
+            ctx->rang = malloc(sizeof(int) * actionCount);
+            ctx->capaciteOrdre = ctx->ordre && ctx->rang ? actionCount : 0;
+        }
+        if (ctx->capaciteOrdre < actionCount) {
+            SIGNALER_ERREUR("Erreur: mémoire insuffisante pour le mélange des règles\n");
+            free(newState);
+            return -1;
+        }
+        MelangerRegles(ctx->ordre, actionCount, &ctx->alea);
+        for (int k = 0; k < actionCount; k++) ctx->rang[ctx->ordre[k]] = k;
+    }
+
+    // Réduction d'ordre partiel pour les modes qui développent tous les successeurs
+    EnsemblesTetus ensembles;
+    int* applicablesTetus = NULL;
+    if (ctx->reductionOrdrePartiel && (mode == MODE_NORMAL || mode == MODE_MELANGE)) {
+        applicablesTetus = malloc(sizeof(int) * (actionCount + 1));
+        if (!applicablesTetus || !PreparerEnsemblesTetus(pb, &ensembles)) {
+            SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la réduction d'ordre partiel\n");
+            free(applicablesTetus);
+            free(newState);
+            return -1;
+        }
+    }
+
+    // Fusion des états symétriques
+    if (symetries && ctx->etatsCanoniques && DetecterSymetries(pb, &ctx->symetries)) {
+        ctx->nbSymetries = ctx->symetries.nbGenerateurs;
+        ctx->canoniques = ctx->nbSymetries > 0;
+        if (!ctx->canoniques) {
+            LibererSymetries(&ctx->symetries);
+        }
+    }
+    if (ctx->canoniques) ctx->octetsParEtat += sizeof(Mot) * pb->nbMots;
+
+    // Priorités apprises lors des recherches précédentes (partie 4.6).
+    // Rejouer la dernière recherche du domaine (même graine) demande les
+    // compteurs de son début : ceux du fichier ".prec", qu'on ne réécrit pas
+    PrioritesApprises priorites;
+    TiragesEnCours tirages;
+    memset(&tirages, 0, sizeof(tirages));
+    if (mode == MODE_PRIORITE) {
+        bool charge = ChargerPriorites(pb, &priorites, ctx->repertoirePriorites, false);
+        if (charge && priorites.graine != 0 && priorites.graine == ctx->graineUtilisee) {
+            LibererPriorites(&priorites);
+            charge = ChargerPriorites(pb, &priorites, ctx->repertoirePriorites, true);
+            ctx->rejeu = true;
+            if (ctx->debug) printf("DEBUG: Rejeu avec les priorités du début de la recherche\n");
+        }
+        if (!charge) {
+            SIGNALER_ERREUR("Erreur: mémoire insuffisante pour les priorités des règles\n");
+            mode = MODE_NORMAL;
+        }
+    }
+    if (mode == MODE_PRIORITE) ctx->octetsParEtat += 2 * sizeof(int);   // tirages en cours
+
+    // L'etat initial -> visited[0]
+    EtatDepuisListe(pb, &pb->initial, ETAT_VISITE(ctx, pb, 0));
+    if (ctx->canoniques) {
+        CanoniserEtat(pb, &ctx->symetries, ETAT_VISITE(ctx, pb, 0), ETAT_CANONIQUE(ctx, pb, 0));
+    }
+
+    ctx->visited[0].parent = -1;
+    ctx->visited[0].actionFromParent = -1;
+    ctx->alveoles[ChercherEtat(ctx, pb, CLE_ETAT(ctx, pb, 0))] = 0;
+    ctx->visitedCount = 1;
+
+    // On push 0 dans la file
+    ctx->queueArray[ctx->rear++] = 0;
+    
+    int solution = -1;
+    bool arrete = false;
+
+    // Avancement : la file passe d'un niveau au suivant à l'indice finNiveau
+    int finNiveau = ctx->front;
+
+    // Parcours
+    while(ctx->front < ctx->rear) {
+        controle.generes = ctx->reglesAppliquees;
+        controle.octets = ctx->octetsParEtat * ctx->visitedCount;
+        if (ctx->front >= finNiveau) {
+            controle.profondeur++;
+            finNiveau = ctx->rear;
+        }
+        if (ControleArret(&controle)) {
+            arrete = true;
+            break;
+        }
+        int currentIndex = ctx->queueArray[ctx->front++];
+        Mot* currentState = newState + pb->nbMots;
+        memcpy(currentState, ETAT_VISITE(ctx, pb, currentIndex), sizeof(Mot) * pb->nbMots);
+
+        // Test objectif
+        if(IsGoalReached(currentState, goal)) {
+            solution = currentIndex; // On a trouve
+            break;
+        }
+
+        // Selon le mode, on choisit différemment la prochaine règle à appliquer
+        switch(mode) {
+            case MODE_NORMAL: 
+            case MODE_MELANGE: {
+                if (applicablesTetus) {
+                    // Seulement les actions applicables de l'ensemble têtu
+                    // (dans l'ordre mélangé en MODE_MELANGE ; l'ensemble est petit)
+                    int nbTetus = CalculerEnsembleTetu(pb, &ensembles, currentState, applicablesTetus);
+                    // Taux d'élagage, seulement si on l'affiche : il faut
+                    // retester toutes les actions
+                    if (ctx->compterEcartes || ctx->debug) {
+                        for (int a = 0; a < actionCount; a++) {
+                            if (CanApply(currentState, &actions[a])) ctx->successeursEcartes++;
+                        }
+                        ctx->successeursEcartes -= nbTetus;
+                    }
+                    for (int i = 1; mode == MODE_MELANGE && i < nbTetus; i++) {
+                        int a = applicablesTetus[i], j = i;
+                        for (; j > 0 && ctx->rang[applicablesTetus[j - 1]] > ctx->rang[a]; j--) {
+                            applicablesTetus[j] = applicablesTetus[j - 1];
+                        }
+                        applicablesTetus[j] = a;
+                    }
+                    for(int i = 0; i < nbTetus; i++) {
+                        int a = applicablesTetus[i];
+                        if (ctx->debug) {
+                            printf("DEBUG: Applique règle %d: ", a);
+                            AfficherTranche(actions[a].name);
+                            printf("\n");
+                        }
+                        ApplyAction(pb, currentState, &actions[a], newState);
+                        AjouterSiNouveau(ctx, pb, newState, currentIndex, a);
+                    }
+                    break;
+                }
+
+                // Mode normal : on essaie toutes les actions en ordre
+                for(int k = 0; k < actionCount; k++) {
+                    int a = mode == MODE_MELANGE ? ctx->ordre[k] : k;
+                    if(CanApply(currentState, &actions[a])) {
+                        if (ctx->debug) {
+                            printf("DEBUG: Applique règle %d: ", a);
+                            AfficherTranche(actions[a].name);
+                            printf("\n");
+                        }
+                        
+                        // generer un nouvel etat
+                        ApplyAction(pb, currentState, &actions[a], newState);
+                        AjouterSiNouveau(ctx, pb, newState, currentIndex, a);
+                    }
+                }
+                break;
+            }
+            
+            case MODE_PRIORITE: {
+                // Mode priorité : une règle tirée selon les priorités apprises ;
+                // si son fils est déjà connu, on en tire une autre. Le noeud
+                // revient dans la file derrière son fils tant qu'il lui reste
+                // des règles, qu'il reprendra là où il s'est arrêté
+                if (!SuivreTirages(&tirages, ctx->visitedCount)) {
+                    ctx->limiteEtatsAtteinte = true;
+                    break;
+                }
+                if (tirages.nb[currentIndex] < 0) PreparerTirage(&priorites, pb, currentState);
+                else ReprendreTirage(&priorites, &tirages, currentIndex);
+                int faitsAvant = CalculerDistanceAuBut(currentState, goal);
+                int a;
+                while ((a = TirerRegle(&priorites, &ctx->alea)) != -1) {
+                    ApplyAction(pb, currentState, &actions[a], newState);
+                    RecompenserRegle(&priorites, a, CalculerDistanceAuBut(newState, goal) > faitsAvant ? 1 : 0);
+                    int avant = ctx->visitedCount;
+                    AjouterSiNouveau(ctx, pb, newState, currentIndex, a);
+                    if (ctx->visitedCount > avant) {
+                        if (ctx->debug) {
+                            printf("DEBUG: Applique règle par priorité %d: ", a);
+                            AfficherTranche(actions[a].name);
+                            printf(" (poids %.2f)\n", PoidsRegle(&priorites, a));
+                        }
+                        int restantes = GarderRestantes(&tirages, currentIndex, &priorites);
+                        if (restantes < 0 || (restantes > 0 && !EnfilerNoeud(ctx, currentIndex))) {
+                            ctx->limiteEtatsAtteinte = true;
+                        }
+                        break;
+                    }
+                }
+                break;
+            }
+            
+        }
+    }
+
+    ctx->noeuds = controle.noeuds;
+    ctx->octetsMax = ctx->octetsParEtat * ctx->visitedCount;
+
+    // Seuls les modes qui développent tous les successeurs prouvent
+    // l'absence de solution en vidant la file, et seulement si aucun état
+    // n'a été perdu faute de place
+    if (solution >= 0) {
+        ctx->issue = ISSUE_RESOLU;
+    } else if (arrete) {
+        ctx->issue = controle.issue;
+    } else if (ctx->limiteEtatsAtteinte) {
+        ctx->issue = ISSUE_BUDGET_MEMOIRE;
+    } else if (mode == MODE_NORMAL || mode == MODE_MELANGE || mode == MODE_PRIORITE) {
+        ctx->issue = ISSUE_SANS_SOLUTION;
+    } else {
+        ctx->issue = ISSUE_INCOMPLET;
+    }
+    if (ctx->debug) {
+        if (solution >= 0) {
+            printf("DEBUG: Solution trouvée ! (%ld états explorés, %.2f ms)\n",
+                   controle.noeuds, DureeControleMs(&controle));
+        } else {
+            printf("DEBUG: Aucune solution trouvée : %s. (%ld états explorés, %.2f ms)\n",
+                   NomIssue(ctx->issue), controle.noeuds, DureeControleMs(&controle));
+        }
+    }
+    if (applicablesTetus) {
+        LibererEnsemblesTetus(&ensembles);
+        free(applicablesTetus);
+    }
+    if (ctx->canoniques) {
+        LibererSymetries(&ctx->symetries);
+        ctx->canoniques = false;
+    }
+    if (mode == MODE_PRIORITE) {
+        // Les règles du plan trouvé sont récompensées, puis tout est gardé
+        // (sauf en rejeu : le fichier a déjà appris de cette recherche)
+        for (int n = solution; n > 0; n = ctx->visited[n].parent) {
+            RecompenserRegle(&priorites, ctx->visited[n].actionFromParent, 1);
+        }
+        if (!ctx->rejeu && !EnregistrerPriorites(pb, &priorites, ctx->graineUtilisee) && ctx->debug) {
+            printf("DEBUG: impossible d'écrire les priorités dans %s\n", ctx->repertoirePriorites);
+        }
+        LibererPriorites(&priorites);
+    }
+    LibererTirages(&tirages);
+    free(newState);
+    return solution;
+}
+
+// ---------------------------------------------------------------------
+// 4.7 - BFS en mémoire externe (détection différée des doublons)
+// ---------------------------------------------------------------------
+// Sur les très grandes instances, les états visités ne tiennent plus en
+// mémoire. Chaque couche de la BFS est alors rangée dans un fichier trié :
+//  1. on lit la couche d d'un bout à l'autre et on range ses successeurs
+//     dans un tampon ; quand il est plein, on le trie, on retire ses
+//     doublons et on l'écrit dans un fichier "run" ;
+//  2. on fusionne les runs (tas des têtes de fichiers) en éliminant au
+//     passage les états déjà présents dans les couches précédentes, lues
+//     elles aussi en continu puisqu'elles sont triées ;
+//  3. les états restants forment la couche d + 1.
+// Si chaque action a une action inverse (blocs, Hanoï, gripper...), un
+// successeur de la couche d est forcément dans la couche d - 1, d ou
+// d + 1 : il suffit de comparer aux deux dernières couches. Sinon on
+// compare à toutes les couches.
+// Le plan est retrouvé en remontant les couches : dans la couche k, on
+// cherche un état dont un successeur est l'état retenu dans la couche k + 1.
+// Toutes les lectures et écritures sont séquentielles, avec de gros tampons.
+
+#define TAILLE_RUN_EXTERNE  (64 << 20)  // octets du tampon des successeurs (sauf budget mémoire)
+#define TAILLE_TAMPON_ES    (1 << 20)   // tampon stdio de chaque fichier ouvert
+
+static int motsExterne;     // taille d'un état pour les comparaisons (qsort n'a pas de contexte)
+
+static int ComparerEtatsExterne(const void* a, const void* b) {
+    const Mot* x = a;
+    const Mot* y = b;
+    for (int i = 0; i < motsExterne; i++) {
+        if (x[i] != y[i]) return x[i] < y[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Lecture séquentielle d'un fichier d'états trié
+typedef struct {
+    FILE* fp;
+    char* tampon;
+    Mot* etat;          // état courant
+    bool fini;
+} LecteurEtats;
+
+static void AvancerLecteur(LecteurEtats* l) {
+    if (!l->fini && fread(l->etat, sizeof(Mot), motsExterne, l->fp) != (size_t)motsExterne) {
+        l->fini = true;
+    }
+}
+
+static bool OuvrirLecteur(LecteurEtats* l, const char* chemin) {
+    l->fp = fopen(chemin, "rb");
+    l->tampon = malloc(TAILLE_TAMPON_ES);
+    l->etat = malloc(sizeof(Mot) * motsExterne);
+    l->fini = false;
+    if (!l->fp || !l->tampon || !l->etat) {
+        if (l->fp) fclose(l->fp);
+        free(l->tampon);
+        free(l->etat);
+        l->fp = NULL;
+        l->tampon = NULL;
+        l->etat = NULL;
+        return false;
+    }
+    setvbuf(l->fp, l->tampon, _IOFBF, TAILLE_TAMPON_ES);
+    AvancerLecteur(l);
+    return true;
+}
+
+static void FermerLecteur(LecteurEtats* l) {
+    if (l->fp) fclose(l->fp);
+    free(l->tampon);
+    free(l->etat);
+    l->fp = NULL;
+    l->tampon = NULL;
+    l->etat = NULL;
+}
+
+static FILE* OuvrirEcriture(const char* chemin, char** tampon) {
+    FILE* fp = fopen(chemin, "wb");
+    *tampon = malloc(TAILLE_TAMPON_ES);
+    if (!fp || !*tampon) {
+        if (fp) fclose(fp);
+        free(*tampon);
+        *tampon = NULL;
+        return NULL;
+    }
+    setvbuf(fp, *tampon, _IOFBF, TAILLE_TAMPON_ES);
+    return fp;
+}
+
+// Ferme un fichier écrit ; faux si une écriture a échoué (disque plein...)
+static bool FermerEcriture(FILE* fp, char* tampon) {
+    bool ok = !ferror(fp);
+    if (fclose(fp) != 0) ok = false;
+    free(tampon);
+    return ok;
+}
+
+static void CheminExterne(char* chemin, size_t taille, const char* type, int numero) {
+    snprintf(chemin, taille, "%s/gps_ext_%s_%d.bin", REPERTOIRE_EXTERNE, type, numero);
+}
+
+// Cherche pour chaque action a une inverse b : b est applicable après a et
+// défait exactement ses effets. Les faits statiques (jamais ajoutés ni
+// supprimés) vrais au départ restent vrais partout : on les ignore dans
+// les préconditions de b. Remplit inverse[a] (-1 si aucune, tableau
+// facultatif) et renvoie vrai si toutes les actions en ont une.
+static bool CalculerInverses(const Probleme* pb, int* inverse) {
+    int nbMots = pb->nbMots;
+    Mot* bits = calloc((size_t)pb->actionCount * 4 + 3, sizeof(Mot) * nbMots);
+    if (!bits) return false;
+    Mot* modifiables = bits + (size_t)pb->actionCount * 4 * nbMots;
+    Mot* statiques = modifiables + nbMots;
+    Mot* apres = statiques + nbMots;
+    for (int a = 0; a < pb->actionCount; a++) {
+        Mot* pre = bits + (size_t)(4 * a) * nbMots;
+        EtatDepuisListe(pb, &pb->actions[a].preconds, pre);
+        EtatDepuisListe(pb, &pb->actions[a].neg_preconds, pre + nbMots);
+        EtatDepuisListe(pb, &pb->actions[a].addList, pre + 2 * nbMots);
+        EtatDepuisListe(pb, &pb->actions[a].delList, pre + 3 * nbMots);
+        for (int i = 0; i < nbMots; i++) modifiables[i] |= pre[2 * nbMots + i] | pre[3 * nbMots + i];
+    }
+    EtatDepuisListe(pb, &pb->initial, statiques);
+    for (int i = 0; i < nbMots; i++) statiques[i] &= ~modifiables[i];
+
+    bool reversible = true;
+    for (int a = 0; a < pb->actionCount && (reversible || inverse); a++) {
+        const Mot* preA = bits + (size_t)(4 * a) * nbMots;
+        const Mot* ajoutA = preA + 2 * nbMots;
+        const Mot* supprA = preA + 3 * nbMots;
+        for (int i = 0; i < nbMots; i++) apres[i] = (preA[i] & ~supprA[i]) | ajoutA[i] | statiques[i];
+
+        int trouvee = -1;
+        for (int b = 0; b < pb->actionCount && trouvee < 0; b++) {
+            const Mot* preB = bits + (size_t)(4 * b) * nbMots;
+            const Mot* negB = preB + nbMots;
+            const Mot* ajoutB = preB + 2 * nbMots;
+            const Mot* supprB = preB + 3 * nbMots;
+            bool ok = true;
+            for (int i = 0; i < nbMots && ok; i++) {
+                ok = (preB[i] & ~apres[i]) == 0                // b applicable après a
+                       && (negB[i] & apres[i]) == 0
+                       && ajoutB[i] == supprA[i]               // b remet ce que a a supprimé
+                       && (supprA[i] & ~preA[i]) == 0
+                       && supprB[i] == (ajoutA[i] & ~preA[i]); // et retire ce que a a ajouté
+            }
+            if (ok) trouvee = b;
+        }
+        if (inverse) inverse[a] = trouvee;
+        if (trouvee < 0) reversible = false;
+    }
+    free(bits);
+    return reversible;
+}
+
+// Trie le tampon, retire les doublons et l'écrit dans un nouveau run
+static bool EcrireRun(Mot* tampon, long nb, int numero, long long* octetsEcrits) {
+    size_t tailleEtat = sizeof(Mot) * motsExterne;
+    qsort(tampon, nb, tailleEtat, ComparerEtatsExterne);
+    long distincts = 0;
+    for (long i = 0; i < nb; i++) {
+        if (distincts > 0 && ComparerEtatsExterne(tampon + (size_t)(distincts - 1) * motsExterne,
+                                                  tampon + (size_t)i * motsExterne) == 0) {
+            continue;
+        }
+        if (distincts != i) {
+            memcpy(tampon + (size_t)distincts * motsExterne, tampon + (size_t)i * motsExterne, tailleEtat);
+        }
+        distincts++;
+    }
+
+    char chemin[MAX_LEN * 2];
+    CheminExterne(chemin, sizeof(chemin), "run", numero);
+    FILE* fp = fopen(chemin, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(tampon, tailleEtat, distincts, fp) == (size_t)distincts;
+    if (fclose(fp) != 0) ok = false;
+    *octetsEcrits += (long long)(tailleEtat * distincts);
+    return ok;
+}
+
+// Tas (minimum) des lecteurs de runs, rangé par état courant
+static void TamiserRuns(LecteurEtats* runs, int* tas, int taille, int i) {
+    for (;;) {
+        int plusPetit = i;
+        int g = 2 * i + 1, d = 2 * i + 2;
+        if (g < taille && ComparerEtatsExterne(runs[tas[g]].etat, runs[tas[plusPetit]].etat) < 0) plusPetit = g;
+        if (d < taille && ComparerEtatsExterne(runs[tas[d]].etat, runs[tas[plusPetit]].etat) < 0) plusPetit = d;
+        if (plusPetit == i) return;
+        int t = tas[i];
+        tas[i] = tas[plusPetit];
+        tas[plusPetit] = t;
+        i = plusPetit;
+    }
+}
+
+// Fusionne les runs en retirant les états des couches [premiereCouche, d].
+// Écrit la couche d + 1 ; renvoie son nombre d'états, -1 en cas d'erreur.
+// S'arrête au premier état but, copié dans 'but'.
+static long long FusionnerRuns(const Probleme* pb, int nbRuns, int premiereCouche, int d,
+                               Mot* but, bool* butTrouve, long long* octetsEcrits) {
+    size_t tailleEtat = sizeof(Mot) * motsExterne;
+    int nbCouches = d - premiereCouche + 1;
+    LecteurEtats* runs = calloc(nbRuns > 0 ? nbRuns : 1, sizeof(LecteurEtats));
+    LecteurEtats* couches = calloc(nbCouches, sizeof(LecteurEtats));
+    int* tas = malloc(sizeof(int) * (nbRuns > 0 ? nbRuns : 1));
+    Mot* dernier = malloc(tailleEtat);
+    char chemin[MAX_LEN * 2];
+    char* tampon = NULL;
+    FILE* sortie = NULL;
+    long long nbEtats = -1;
+    bool ok = runs && couches && tas && dernier;
+
+    int taille = 0;
+    for (int r = 0; ok && r < nbRuns; r++) {
+        CheminExterne(chemin, sizeof(chemin), "run", r);
+        ok = OuvrirLecteur(&runs[r], chemin);
+        if (ok && !runs[r].fini) tas[taille++] = r;
+    }
+    for (int k = 0; ok && k < nbCouches; k++) {
+        CheminExterne(chemin, sizeof(chemin), "couche", premiereCouche + k);
+        ok = OuvrirLecteur(&couches[k], chemin);
+    }
+    if (ok) {
+        CheminExterne(chemin, sizeof(chemin), "couche", d + 1);
+        sortie = OuvrirEcriture(chemin, &tampon);
+        ok = sortie != NULL;
+    }
+
+    if (ok) {
+        nbEtats = 0;
+        bool premier = true;
+        for (int i = taille / 2 - 1; i >= 0; i--) TamiserRuns(runs, tas, taille, i);
+        while (taille > 0) {
+            LecteurEtats* tete = &runs[tas[0]];
+            bool doublon = !premier && ComparerEtatsExterne(tete->etat, dernier) == 0;
+            if (!doublon) {
+                memcpy(dernier, tete->etat, tailleEtat);
+                premier = false;
+                for (int k = 0; k < nbCouches && !doublon; k++) {
+                    int c = 1;
+                    while (!couches[k].fini && (c = ComparerEtatsExterne(couches[k].etat, dernier)) < 0) {
+                        AvancerLecteur(&couches[k]);
+                    }
+                    doublon = !couches[k].fini && c == 0;
+                }
+                if (!doublon) {
+                    fwrite(dernier, tailleEtat, 1, sortie);
+                    nbEtats++;
+                    *octetsEcrits += (long long)tailleEtat;
+                    if (IsGoalReached(dernier, &pb->goal)) {
+                        memcpy(but, dernier, tailleEtat);
+                        *butTrouve = true;
+                        break;
+                    }
+                }
+            }
+            AvancerLecteur(tete);
+            if (tete->fini) tas[0] = tas[--taille];
+            TamiserRuns(runs, tas, taille, 0);
+        }
+    }
+
+    if (sortie && !FermerEcriture(sortie, tampon)) nbEtats = -1;
+    for (int r = 0; runs && r < nbRuns; r++) {
+        FermerLecteur(&runs[r]);
+        CheminExterne(chemin, sizeof(chemin), "run", r);
+        remove(chemin);
+    }
+    for (int k = 0; couches && k < nbCouches; k++) FermerLecteur(&couches[k]);
+    free(runs);
+    free(couches);
+    free(tas);
+    free(dernier);
+    return nbEtats;
+}
+
+// Remonte les couches depuis l'état but (couche d) pour retrouver le plan
+static bool RemonterCouches(const Probleme* pb, int d, const Mot* but, int* plan) {
+    size_t tailleEtat = sizeof(Mot) * motsExterne;
+    Mot* cible = malloc(tailleEtat);
+    Mot* fils = malloc(tailleEtat);
+    char chemin[MAX_LEN * 2];
+    bool ok = cible && fils;
+    if (ok) memcpy(cible, but, tailleEtat);
+
+    for (int k = d - 1; ok && k >= 0; k--) {
+        LecteurEtats couche;
+        CheminExterne(chemin, sizeof(chemin), "couche", k);
+        if (!OuvrirLecteur(&couche, chemin)) {
+            ok = false;
+            break;
+        }
+        bool trouve = false;
+        for (; !couche.fini && !trouve; AvancerLecteur(&couche)) {
+            for (int a = 0; a < pb->actionCount; a++) {
+                if (!CanApply(couche.etat, &pb->actions[a])) continue;
+                ApplyAction(pb, couche.etat, &pb->actions[a], fils);
+                if (ComparerEtatsExterne(fils, cible) == 0) {
+                    plan[k] = a;
+                    memcpy(cible, couche.etat, tailleEtat);
+                    trouve = true;
+                    break;
+                }
+            }
+        }
+        FermerLecteur(&couche);
+        ok = trouve;
+    }
+    free(cible);
+    free(fils);
+    return ok;
+}
+
+// BFS couche par couche sur disque. Renvoie la longueur du plan (le plus
+// court) et le place dans *plan (à libérer), ou -1 (voir resultat->issue).
+int BfsExterne(const Probleme* pb, int** plan, ResultatExterne* resultat) {
+    size_t tailleEtat = sizeof(Mot) * pb->nbMots;
+    memset(resultat, 0, sizeof(*resultat));
+    resultat->longueur = -1;
+    resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    *plan = NULL;
+    motsExterne = pb->nbMots;
+
+    ControleRecherche controle;
+    DemarrerControle(&controle, &limitesRecherche);
+
+    size_t octetsRun = limitesRecherche.maxOctets > 0 ? limitesRecherche.maxOctets : TAILLE_RUN_EXTERNE;
+    long capacite = (long)(octetsRun / tailleEtat);
+    if (capacite < pb->actionCount) capacite = pb->actionCount;
+    Mot* tampon = malloc(tailleEtat * capacite);
+    Mot* but = malloc(tailleEtat);
+    if (!tampon || !but) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la recherche externe\n");
+        free(tampon);
+        free(but);
+        return -1;
+    }
+
+    bool reversible = CalculerInverses(pb, NULL);
+    if (DEBUG_MODE) {
+        printf("DEBUG: BFS externe dans '%s', doublons cherchés dans %s\n",
+               REPERTOIRE_EXTERNE, reversible ? "les deux dernières couches" : "toutes les couches");
+    }
+
+    // Couche 0 : l'état initial
+    char chemin[MAX_LEN * 2];
+    char* tamponSortie;
+    CheminExterne(chemin, sizeof(chemin), "couche", 0);
+    FILE* sortie = OuvrirEcriture(chemin, &tamponSortie);
+    EtatDepuisListe(pb, &pb->initial, but);
+    bool butTrouve = IsGoalReached(but, &pb->goal);
+    if (!sortie) {
+        SIGNALER_ERREUR("Erreur: impossible de créer %s\n", chemin);
+        free(tampon);
+        free(but);
+        return -1;
+    }
+    fwrite(but, tailleEtat, 1, sortie);
+    bool ok = FermerEcriture(sortie, tamponSortie);
+    resultat->etatsStockes = 1;
+    resultat->octetsEcrits = (long long)tailleEtat;
+
+    int d = 0;
+    bool arrete = false;
+    while (ok && !butTrouve) {
+        // 1. Successeurs de la couche d, par runs triés
+        LecteurEtats couche;
+        CheminExterne(chemin, sizeof(chemin), "couche", d);
+        if (!OuvrirLecteur(&couche, chemin)) {
+            ok = false;
+            break;
+        }
+        int nbRuns = 0;
+        long nb = 0;
+        for (; !couche.fini && ok; AvancerLecteur(&couche)) {
+            if (ControleArret(&controle)) {
+                arrete = true;
+                break;
+            }
+            for (int a = 0; a < pb->actionCount; a++) {
+                if (!CanApply(couche.etat, &pb->actions[a])) continue;
+                if (nb == capacite) {
+                    ok = EcrireRun(tampon, nb, nbRuns++, &resultat->octetsEcrits);
+                    nb = 0;
+                }
+                ApplyAction(pb, couche.etat, &pb->actions[a], tampon + (size_t)nb * pb->nbMots);
+                nb++;
+                resultat->successeurs++;
+            }
+        }
+        FermerLecteur(&couche);
+        if (ok && !arrete && nb > 0) ok = EcrireRun(tampon, nb, nbRuns++, &resultat->octetsEcrits);
+        if (!ok || arrete) {
+            for (int r = 0; r < nbRuns; r++) {
+                CheminExterne(chemin, sizeof(chemin), "run", r);
+                remove(chemin);
+            }
+            break;
+        }
+
+        // 2. Fusion et élimination des états déjà vus
+        int premiereCouche = reversible ? (d > 0 ? d - 1 : 0) : 0;
+        long long nouveaux = FusionnerRuns(pb, nbRuns, premiereCouche, d, but, &butTrouve,
+                                           &resultat->octetsEcrits);
+        if (nouveaux < 0) {
+            ok = false;
+            break;
+        }
+        d++;
+        resultat->etatsStockes += nouveaux;
+        if (DEBUG_MODE) printf("DEBUG: couche %d : %lld nouveaux états\n", d, nouveaux);
+        if (nouveaux == 0) break;
+    }
+    resultat->couches = d + 1;
+
+    if (butTrouve) {
+        *plan = malloc(sizeof(int) * (d > 0 ? d : 1));
+        if (*plan && RemonterCouches(pb, d, but, *plan)) {
+            resultat->longueur = d;
+            resultat->issue = ISSUE_RESOLU;
+        } else {
+            free(*plan);
+            *plan = NULL;
+            ok = false;
+        }
+    } else if (arrete) {
+        resultat->issue = controle.issue;
+    } else if (ok) {
+        resultat->issue = ISSUE_SANS_SOLUTION;
+    }
+    if (!ok) SIGNALER_ERREUR("Erreur: lecture ou écriture impossible dans '%s' (disque plein ?)\n", REPERTOIRE_EXTERNE);
+
+    for (int k = 0; k <= d + 1; k++) {
+        CheminExterne(chemin, sizeof(chemin), "couche", k);
+        remove(chemin);
+    }
+    resultat->noeudsDeveloppes = controle.noeuds;
+    resultat->tempsMs = DureeControleMs(&controle);
+    free(tampon);
+    free(but);
+    return resultat->longueur;
+}
+
+// ---------------------------------------------------------------------
+// 4.8 - Recherche de frontière (reconstruction du plan par dichotomie)
+// ---------------------------------------------------------------------
+// La BFS garde tous ses noeuds uniquement pour pouvoir remonter les
+// parents à la fin. Ici on ne garde que trois couches : la précédente,
+// celle qu'on développe et la suivante. Si chaque action a une inverse,
+// un successeur de la couche k est forcément dans la couche k - 1, k ou
+// k + 1, ce qui suffit pour éliminer les doublons. Chaque état retient
+// aussi les "opérateurs utilisés" : les inverses des actions qui l'ont
+// produit, qu'il est inutile d'appliquer puisqu'elles ramènent à un
+// parent. Sans inverses, on garde en plus l'ensemble de tous les états
+// déjà vus (sans parents).
+// Sans parents, le plan est retrouvé par dichotomie : une première
+// recherche donne la longueur d du plus court plan, une deuxième retient
+// pour chaque état son ancêtre dans la couche d / 2 (l'état "relais"), et
+// on recommence sur les deux moitiés (départ -> relais, relais -> but).
+// La mémoire est proportionnelle à la couche la plus large, et le plan
+// reste le plus court.
+
+// Une couche : états, opérateurs utilisés, relais, et table de hachage
+typedef struct {
+    Mot* etats;
+    Mot* utilises;      // motsActions mots par état (bit a = action a inutile)
+    int* relais;        // index de l'ancêtre dans la couche relais (-1 si aucune)
+    int nb;
+    int capacite;
+    int* alveoles;
+    int nbAlveoles;
+} CoucheFrontiere;
+
+typedef struct {
+    const Probleme* pb;
+    int* inverse;               // inverse[a], -1 si aucune
+    bool reversible;
+    int motsActions;            // taille des bits d'opérateurs utilisés
+    ControleRecherche controle;
+    IssueRecherche issue;       // raison de l'échec de la dernière recherche
+    int largeurMax;             // couche la plus large
+    int passes;                 // recherches lancées (dichotomie comprise)
+    long long etatsGeneres;
+} Frontiere;
+
+static void ViderCouche(CoucheFrontiere* c) {
+    c->nb = 0;
+    if (c->alveoles) memset(c->alveoles, -1, sizeof(int) * c->nbAlveoles);
+}
+
+static void LibererCouche(Frontiere* fs, CoucheFrontiere* c) {
+    RendreMemoire(&fs->controle, (size_t)c->capacite * (sizeof(Mot) * (fs->pb->nbMots + fs->motsActions) + sizeof(int))
+                                 + sizeof(int) * (size_t)c->nbAlveoles);
+    free(c->etats);
+    free(c->utilises);
+    free(c->relais);
+    free(c->alveoles);
+    memset(c, 0, sizeof(*c));
+}
+
+static int ChercherDansCouche(const Frontiere* fs, const CoucheFrontiere* c, const Mot* etat) {
+    if (c->nb == 0) return -1;
+    const Probleme* pb = fs->pb;
+    uint64_t i = HacherEtat(pb, etat) & (c->nbAlveoles - 1);
+    while (c->alveoles[i] != -1) {
+        if (SameState(pb, c->etats + (size_t)c->alveoles[i] * pb->nbMots, etat)) return c->alveoles[i];
+        i = (i + 1) & (c->nbAlveoles - 1);
+    }
+    return -1;
+}
+
+// Ajoute un état (absent) à la couche ; renvoie son index, -1 si plus de mémoire
+static int AjouterDansCouche(Frontiere* fs, CoucheFrontiere* c, const Mot* etat) {
+    const Probleme* pb = fs->pb;
+    if ((c->nb + 1) * 2 > c->nbAlveoles) {
+        int nbAlveoles = c->nbAlveoles ? c->nbAlveoles * 2 : 1024;
+        if (!ReserverMemoire(&fs->controle, sizeof(int) * (nbAlveoles - c->nbAlveoles))) return -1;
+        int* alveoles = malloc(sizeof(int) * nbAlveoles);
+        if (!alveoles) return -1;
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int n = 0; n < c->nb; n++) {
+            uint64_t i = HacherEtat(pb, c->etats + (size_t)n * pb->nbMots) & (nbAlveoles - 1);
+            while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = n;
+        }
+        free(c->alveoles);
+        c->alveoles = alveoles;
+        c->nbAlveoles = nbAlveoles;
+    }
+    if (c->nb == c->capacite) {
+        int capacite = c->capacite ? c->capacite * 2 : 512;
+        size_t parEtat = sizeof(Mot) * (pb->nbMots + fs->motsActions) + sizeof(int);
+        if (!ReserverMemoire(&fs->controle, parEtat * (capacite - c->capacite))) return -1;
+        Mot* etats = realloc(c->etats, sizeof(Mot) * pb->nbMots * (size_t)capacite);
+        if (etats) c->etats = etats;
+        Mot* utilises = realloc(c->utilises, sizeof(Mot) * fs->motsActions * (size_t)capacite);
+        if (utilises) c->utilises = utilises;
+        int* relais = realloc(c->relais, sizeof(int) * capacite);
+        if (relais) c->relais = relais;
+        if (!etats || !utilises || !relais) return -1;
+        c->capacite = capacite;
+    }
+
+    int n = c->nb++;
+    memcpy(c->etats + (size_t)n * pb->nbMots, etat, sizeof(Mot) * pb->nbMots);
+    memset(c->utilises + (size_t)n * fs->motsActions, 0, sizeof(Mot) * fs->motsActions);
+    c->relais[n] = -1;
+    uint64_t i = HacherEtat(pb, etat) & (c->nbAlveoles - 1);
+    while (c->alveoles[i] != -1) i = (i + 1) & (c->nbAlveoles - 1);
+    c->alveoles[i] = n;
+    return n;
+}
+
+static bool EstCible(const Probleme* pb, const Mot* etat, const Mot* cible) {
+    return cible ? SameState(pb, etat, cible) : IsGoalReached(etat, &pb->goal) != 0;
+}
+
+// BFS de frontière depuis 'depart' vers 'cible' (le but si cible == NULL),
+// sur au plus profMax étapes (-1 = sans limite). Si coucheRelais > 0,
+// copie dans 'relais' l'ancêtre de la cible situé à cette profondeur.
+// Renvoie la longueur du plus court chemin, -1 sinon (voir fs->issue).
+static int RechercheFrontiere(Frontiere* fs, const Mot* depart, const Mot* cible,
+                              int profMax, int coucheRelais, Mot* relais) {
+    const Probleme* pb = fs->pb;
+    CoucheFrontiere couches[3];
+    CoucheFrontiere vus;            // tous les états vus (seulement sans inverses)
+    CoucheFrontiere etatsRelais;    // copie de la couche relais
+    memset(couches, 0, sizeof(couches));
+    memset(&vus, 0, sizeof(vus));
+    memset(&etatsRelais, 0, sizeof(etatsRelais));
+    CoucheFrontiere* precedente = &couches[0];
+    CoucheFrontiere* courante = &couches[1];
+    CoucheFrontiere* suivante = &couches[2];
+    Mot* fils = NouvelEtat(pb);
+    int trouve = -1;
+    fs->passes++;
+    fs->issue = ISSUE_BUDGET_MEMOIRE;
+
+    if (!fils || AjouterDansCouche(fs, courante, depart) < 0
+        || (!fs->reversible && AjouterDansCouche(fs, &vus, depart) < 0)) {
+        goto fin;
+    }
+    if (EstCible(pb, depart, cible)) {
+        trouve = 0;
+        goto fin;
+    }
+
+    for (int k = 0; profMax < 0 || k < profMax; k++) {
+        ViderCouche(suivante);
+        for (int n = 0; n < courante->nb && trouve < 0; n++) {
+            if (ControleArret(&fs->controle)) {
+                fs->issue = fs->controle.issue;
+                goto fin;
+            }
+            for (int a = 0; a < pb->actionCount; a++) {
+                const Mot* etat = courante->etats + (size_t)n * pb->nbMots;
+                if (TEST_BIT(courante->utilises + (size_t)n * fs->motsActions, a)) continue;
+                if (!CanApply(etat, &pb->actions[a])) continue;
+                ApplyAction(pb, etat, &pb->actions[a], fils);
+                fs->etatsGeneres++;
+
+                int m = ChercherDansCouche(fs, suivante, fils);
+                if (m < 0) {
+                    bool dejaVu = fs->reversible
+                        ? ChercherDansCouche(fs, courante, fils) >= 0 || ChercherDansCouche(fs, precedente, fils) >= 0
+                        : ChercherDansCouche(fs, &vus, fils) >= 0;
+                    if (dejaVu) continue;
+                    m = AjouterDansCouche(fs, suivante, fils);
+                    if (m < 0 || (!fs->reversible && AjouterDansCouche(fs, &vus, fils) < 0)) goto fin;
+                    // Ancêtre dans la couche relais
+                    if (k + 1 == coucheRelais) suivante->relais[m] = m;
+                    else if (k + 1 > coucheRelais) suivante->relais[m] = courante->relais[n];
+                }
+                if (fs->inverse[a] >= 0) {
+                    METTRE_BIT(suivante->utilises + (size_t)m * fs->motsActions, fs->inverse[a]);
+                }
+                if (EstCible(pb, fils, cible)) {
+                    trouve = k + 1;
+                    if (coucheRelais > 0 && relais) {
+                        const Mot* source = k + 1 == coucheRelais
+                            ? fils
+                            : etatsRelais.etats + (size_t)suivante->relais[m] * pb->nbMots;
+                        memcpy(relais, source, sizeof(Mot) * pb->nbMots);
+                    }
+                    break;
+                }
+            }
+        }
+        if (trouve >= 0) break;
+        if (suivante->nb > fs->largeurMax) fs->largeurMax = suivante->nb;
+        if (suivante->nb == 0) {
+            fs->issue = ISSUE_SANS_SOLUTION;
+            break;
+        }
+        if (k + 1 == coucheRelais) {
+            // On garde une copie des états relais (les couches sont recyclées)
+            for (int n = 0; n < suivante->nb; n++) {
+                if (AjouterDansCouche(fs, &etatsRelais, suivante->etats + (size_t)n * pb->nbMots) < 0) goto fin;
+            }
+        }
+        CoucheFrontiere* t = precedente;
+        precedente = courante;
+        courante = suivante;
+        suivante = t;
+    }
+    if (trouve < 0 && fs->issue == ISSUE_BUDGET_MEMOIRE && profMax >= 0) fs->issue = ISSUE_SANS_SOLUTION;
+
+fin:
+    for (int i = 0; i < 3; i++) LibererCouche(fs, &couches[i]);
+    LibererCouche(fs, &vus);
+    LibererCouche(fs, &etatsRelais);
+    free(fils);
+    return trouve;
+}
+
+// Plan de longueur d de 'depart' à 'cible' (le but si NULL), par dichotomie
+static bool ResoudreSegment(Frontiere* fs, const Mot* depart, const Mot* cible, int d, int* plan) {
+    const Probleme* pb = fs->pb;
+    if (d == 0) return true;
+    if (d == 1) {
+        Mot* fils = NouvelEtat(pb);
+        if (!fils) return false;
+        bool ok = false;
+        for (int a = 0; a < pb->actionCount && !ok; a++) {
+            if (!CanApply(depart, &pb->actions[a])) continue;
+            ApplyAction(pb, depart, &pb->actions[a], fils);
+            if (EstCible(pb, fils, cible)) {
+                plan[0] = a;
+                ok = true;
+            }
+        }
+        free(fils);
+        return ok;
+    }
+
+    int milieu = d / 2;
+    Mot* relais = NouvelEtat(pb);
+    if (!relais) return false;
+    bool ok = RechercheFrontiere(fs, depart, cible, d, milieu, relais) == d
+           && ResoudreSegment(fs, depart, relais, milieu, plan)
+           && ResoudreSegment(fs, relais, cible, d - milieu, plan + milieu);
+    free(relais);
+    return ok;
+}
+
+// Recherche complète : longueur, puis plan par dichotomie. Renvoie la
+// longueur du plan (placé dans *plan, à libérer) ou -1.
+int BfsFrontiere(const Probleme* pb, int** plan, ResultatFrontiere* resultat) {
+    Frontiere fs;
+    memset(&fs, 0, sizeof(fs));
+    memset(resultat, 0, sizeof(*resultat));
+    resultat->longueur = -1;
+    resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    *plan = NULL;
+    fs.pb = pb;
+    fs.motsActions = (pb->actionCount + BITS_PAR_MOT - 1) / BITS_PAR_MOT;
+    if (fs.motsActions == 0) fs.motsActions = 1;
+    fs.inverse = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    Mot* depart = NouvelEtat(pb);
+    if (!fs.inverse || !depart) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour la recherche de frontière\n");
+        free(fs.inverse);
+        free(depart);
+        return -1;
+    }
+    fs.reversible = CalculerInverses(pb, fs.inverse);
+    if (!fs.reversible && DEBUG_MODE) {
+        printf("DEBUG: certaines actions n'ont pas d'inverse, on garde tous les états vus\n");
+    }
+    DemarrerControle(&fs.controle, &limitesRecherche);
+    EtatDepuisListe(pb, &pb->initial, depart);
+
+    int d = RechercheFrontiere(&fs, depart, NULL, -1, 0, NULL);
+    if (d >= 0) {
+        if (DEBUG_MODE) printf("DEBUG: plus court plan de %d étapes, reconstruction par dichotomie\n", d);
+        *plan = malloc(sizeof(int) * (d > 0 ? d : 1));
+        if (*plan && ResoudreSegment(&fs, depart, NULL, d, *plan)) {
+            resultat->longueur = d;
+            resultat->issue = ISSUE_RESOLU;
+        } else {
+            free(*plan);
+            *plan = NULL;
+            resultat->issue = fs.issue;
+        }
+    } else {
+        resultat->issue = fs.issue;
+    }
+
+    resultat->reversible = fs.reversible;
+    resultat->largeurMax = fs.largeurMax;
+    resultat->passes = fs.passes;
+    resultat->etatsGeneres = fs.etatsGeneres;
+    resultat->octetsMax = fs.controle.octetsMax;
+    resultat->tempsMs = DureeControleMs(&fs.controle);
+    free(fs.inverse);
+    free(depart);
+    return resultat->longueur;
+}
+
+// ---------------------------------------------------------------------
+// 5) Reconstruction du plan (liste d'actions) a partir de l'index solution
+// ---------------------------------------------------------------------
+// Remonte les parents depuis solutionIndex : range dans *plan (à libérer)
+// les actions dans l'ordre d'exécution et renvoie le nombre d'étapes, -1
+// si la mémoire manque
+int ExtrairePlan(const ContexteRecherche* ctx, int solutionIndex, int** plan) {
+    const Node* visited = ctx->visited;
+    int length = 0;
+    for(int current = solutionIndex; current > 0; current = visited[current].parent) {
+        length++;
+    }
+    *plan = malloc(sizeof(int) * (length > 0 ? length : 1));
+    if (!*plan) return -1;
+    int step = length;
+    for(int current = solutionIndex; current > 0; current = visited[current].parent) {
+        (*plan)[--step] = visited[current].actionFromParent;
+    }
+    return length;
+}
+
+void AfficherPlan(const Probleme* pb, const int* plan, int longueur) {
+    printf("\n+------------------PLAN TROUVE------------------+\n|\n");
+    for(int i = 0; i < longueur; i++) {
+        printf("|  Etape %d: ", i + 1);
+        AfficherTranche(pb->actions[plan[i]].name);
+        printf(" \n");
+    }
+    printf("|\n+------------------FIN DU PLAN------------------+\n\n");
+}
+
+void ReconstructPlan(const ContexteRecherche* ctx, int solutionIndex, const Probleme* pb) {
+    int* plan = NULL;
+    int longueur = ExtrairePlan(ctx, solutionIndex, &plan);
+    if (longueur >= 0) AfficherPlan(pb, plan, longueur);
+    else printf("Erreur: mémoire insuffisante pour le plan\n");
+    free(plan);
+}
+
+// ---------------------------------------------------------------------
+// 6) Fonctions pour creation d'un fichier via l'utilisateur
+// ---------------------------------------------------------------------
+
+// Pose une question et recupere la reponse dans 'buffer'
+void DemanderTexte(const char* question, char* buffer, int bufferSize) {
+    printf("%s", question);
+    fgets(buffer, bufferSize, stdin);
+    // enlever \n
+    buffer[strcspn(buffer, "\r\n")] = '\0';
+}
+
+// Cree un fichier en format correct
+// start:...
+// finish:...
+// puis un certain nombre d'actions, chacune separee par ****
+int CreerFichier(char* nomFichier) {
+
+    printf("Entrez le nom du fichier à créer (ex: monFichier.txt) : ");
+    fgets(nomFichier, 255, stdin);
+
+    size_t len = strlen(nomFichier);
+    if (len > 0 && nomFichier[len - 1] == '\n') {
+        nomFichier[len - 1] = '\0';
+    }
+
+    char cheminComplet[512];
+    snprintf(cheminComplet, sizeof(cheminComplet), "assets/%s", nomFichier);
+
+    FILE* fp = fopen(cheminComplet, "w");
+    if (!fp) {
+        printf("Impossible de créer le fichier '%s'.\n", cheminComplet);
+        return 0;
+    }
+
+    char buf[MAX_LEN];
+    DemanderTexte("Entrez les conditions initiales (séparées par des virgules):\n> ", buf, MAX_LEN);
+    fprintf(fp, "start:%s\n", buf);
+
+    DemanderTexte("Entrez les conditions d'arrivée (finish), séparées par des virgules:\n> ", buf, MAX_LEN);
+    fprintf(fp, "finish:%s\n", buf);
+
+    int nbActions = 0;
+    printf("Combien d'actions voulez-vous saisir ? ");
+    scanf("%d", &nbActions);
+    getchar();
+
+    for (int i = 0; i < nbActions; i++) {
+        fprintf(fp, "****\n");
+        // Action (nom)
+        DemanderTexte("\nNom de l'action : ", buf, MAX_LEN);
+        fprintf(fp, "action:%s\n", buf);
+
+        // Préconditions
+        DemanderTexte("Préconditions (séparées par des virgules) : ", buf, MAX_LEN);
+        fprintf(fp, "preconds:%s\n", buf);
+
+        // Préconditions négatives
+        DemanderTexte("Préconditions négatives (séparées par des virgules) : ", buf, MAX_LEN);
+        fprintf(fp, "neg_preconds:%s\n", buf);
+
+        // Faits ajoutés
+        DemanderTexte("Faits ajoutés (séparés par des virgules) : ", buf, MAX_LEN);
+        fprintf(fp, "add:%s\n", buf);
+
+        // Faits supprimés
+        DemanderTexte("Faits supprimés (séparés par des virgules) : ", buf, MAX_LEN);
+        fprintf(fp, "delete:%s\n", buf);
+    }
+
+    fclose(fp);
+    printf("\nFichier '%s' créé avec succès dans le dossier 'assets'.\n", cheminComplet);
+    return 1;
+}
+
+// Initialiser les priorités des règles (pour la partie 5.5) : elles
+// viennent des recherches précédentes sur le même domaine (partie 4.6),
+// ramenées entre 1 et MAX_PRIORITY pour l'affichage
+void InitialiserPriorites(Probleme* pb) {
+    PrioritesApprises priorites;
+    bool apprises = ChargerPriorites(pb, &priorites, REPERTOIRE_PRIORITES, false);
+    for (int i = 0; i < pb->actionCount; i++) {
+        double poids = apprises ? PoidsRegle(&priorites, i) : 0.5;
+        pb->actions[i].priority = 1 + (int)(poids * (MAX_PRIORITY - 1) + 0.5);
+        if (DEBUG_MODE && apprises && priorites.essais[i] > 0) {
+            printf("DEBUG: Priorité %d pour règle %d (%.0f essais, %.0f succès): ", pb->actions[i].priority, i,
+                   priorites.essais[i], priorites.succes[i]);
+            AfficherTranche(pb->actions[i].name);
+            printf("\n");
+        }
+    }
+    if (apprises) LibererPriorites(&priorites);
+}
+
+// Version améliorée pour la partie 5
+void AnalyseFichierAvecStrategie(const char *nomfile, int mode) {
+    Probleme pb;
+    
+    if (DEBUG_MODE) printf("DEBUG: Analyse du fichier '%s' avec mode %d\n", nomfile, mode);
+
+    if(!ParseFile(nomfile, &pb)) {
+        printf("Erreur lors du chargement du fichier.\n");
+        return;
+    }
+
+    AnalyseProblemeAvecStrategie(&pb, mode);
+    LibererProbleme(&pb);
+}
+
+// Chaque plan amélioré de la recherche anytime est affiché dès qu'il est trouvé
+static void AfficherPlanAmeliore(const Probleme* pb, const int* plan, int longueur, double tempsMs, void* contexte) {
+    (void)contexte;
+    printf("\n| Plan amélioré : %d étapes après %.2f ms\n", longueur, tempsMs);
+    AfficherPlan(pb, plan, longueur);
+}
+
+static void AnalyseAnytime(const Probleme* pb) {
+    ResultatAnytime resultat;
+    RechercheAnytime(pb, DELAI_ANYTIME_MS, AfficherPlanAmeliore, NULL, &resultat);
+
+    if (resultat.meilleureLongueur < 0) {
+        printf("\n+===========================================================+\n");
+        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
+        printf("+===========================================================+\n");
+    }
+    printf("\n+----------STATISTIQUES----------+\n");
+    if (resultat.meilleureLongueur >= 0) {
+        printf("| Meilleur plan: %d étapes (%s)\n", resultat.meilleureLongueur,
+               resultat.optimal ? "optimal prouvé" : "optimalité non prouvée");
+    }
+    printf("| Issue de la recherche: %s\n", NomIssue(resultat.issue));
+    printf("| Recherches pondérées: %d\n", resultat.iterations);
+    printf("| Noeuds développés: %ld\n", resultat.noeudsDeveloppes);
+    printf("| Mémoire maximale: %.1f Ko\n", resultat.octetsMax / 1024.0);
+    printf("| Temps d'exécution: %.2f ms\n", resultat.tempsMs);
+    printf("+--------------------------------+\n");
+}
+
+static void AnalyseExterne(const Probleme* pb) {
+    int* plan;
+    ResultatExterne resultat;
+    BfsExterne(pb, &plan, &resultat);
+
+    if (resultat.longueur < 0) {
+        printf("\n+===========================================================+\n");
+        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
+        printf("+===========================================================+\n");
+    } else {
+        AfficherPlan(pb, plan, resultat.longueur);
+    }
+    printf("\n+----------STATISTIQUES----------+\n");
+    if (resultat.longueur >= 0) {
+        printf("| Longueur du plan: %d étapes (optimal)\n", resultat.longueur);
+    }
+    printf("| Issue de la recherche: %s\n", NomIssue(resultat.issue));
+    printf("| Couches: %d\n", resultat.couches);
+    printf("| États distincts: %lld\n", resultat.etatsStockes);
+    printf("| Successeurs calculés: %lld\n", resultat.successeurs);
+    printf("| Octets écrits sur disque: %lld\n", resultat.octetsEcrits);
+    printf("| Temps d'exécution: %.2f ms\n", resultat.tempsMs);
+    printf("+--------------------------------+\n");
+    free(plan);
+}
+
+static void AnalyseFrontiere(const Probleme* pb) {
+    int* plan;
+    ResultatFrontiere resultat;
+    BfsFrontiere(pb, &plan, &resultat);
+
+    if (resultat.longueur < 0) {
+        printf("\n+===========================================================+\n");
+        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
+        printf("+===========================================================+\n");
+    } else {
+        AfficherPlan(pb, plan, resultat.longueur);
+    }
+    printf("\n+----------STATISTIQUES----------+\n");
+    if (resultat.longueur >= 0) {
+        printf("| Longueur du plan: %d étapes (optimal)\n", resultat.longueur);
+    }
+    printf("| Issue de la recherche: %s\n", NomIssue(resultat.issue));
+    printf("| Couches gardées: %s\n", resultat.reversible ? "3 (actions inversibles)" : "3 + tous les états vus");
+    printf("| Couche la plus large: %d états\n", resultat.largeurMax);
+    printf("| Recherches (dichotomie comprise): %d\n", resultat.passes);
+    printf("| Successeurs calculés: %lld\n", resultat.etatsGeneres);
+    printf("| Mémoire maximale: %.1f Ko\n", resultat.octetsMax / 1024.0);
+    printf("| Temps d'exécution: %.2f ms\n", resultat.tempsMs);
+    printf("+--------------------------------+\n");
+    free(plan);
+}
+
+// Recherche gloutonne guidée par FF (partie 5.12) : le plan n'est pas
+// forcément le plus court, on le passe donc à l'optimiseur de la partie 5.7
+static void AnalyseGlouton(const Probleme* pb) {
+    int* plan = NULL;
+    ResultatGlouton resultat;
+    RechercheGloutonne(pb, &plan, &resultat);
+
+    int longueurOptimisee = resultat.longueur;
+    if (resultat.longueur < 0) {
+        printf("\n+===========================================================+\n");
+        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
+        printf("+===========================================================+\n");
+    } else {
+        longueurOptimisee = OptimiserPlan(pb, plan, resultat.longueur, RECHERCHE_LOCALE_PLAN);
+        AfficherPlan(pb, plan, longueurOptimisee);
+    }
+    printf("\n+----------STATISTIQUES----------+\n");
+    if (resultat.longueur >= 0) {
+        printf("| Longueur du plan: %d étapes (%d avant optimisation)\n", longueurOptimisee, resultat.longueur);
+    }
+    printf("| Issue de la recherche: %s\n", NomIssue(resultat.issue));
+    printf("| Évaluations FF: %ld\n", resultat.evaluations);
+    printf("| Noeuds développés: %ld (dont %ld par actions utiles)\n", resultat.developpes, resultat.preferes);
+    printf("| États distincts: %d\n", resultat.noeuds);
+    printf("| Mémoire maximale: %.1f Ko\n", resultat.octetsMax / 1024.0);
+    printf("| Temps d'exécution: %.2f ms\n", resultat.tempsMs);
+    printf("+--------------------------------+\n");
+    free(plan);
+}
+
+// Affiche le problème, lance la recherche et affiche le plan et les statistiques
+void AnalyseProblemeAvecStrategie(Probleme* pb, int mode) {
+    Action* actions = pb->actions;
+    int actionCount = pb->actionCount;
+    
+    // Initialiser les priorités pour le mode priorité
+    if (mode == MODE_PRIORITE) {
+        InitialiserPriorites(pb);
+    }
+
+    // Affichage simple
+    printf("\n+----------ETAT INITIAL (START)----------+\n|\n");
+    printf("| Nombre de faits: %d\n", pb->initial.factCount);
+    for(int i=0; i<pb->initial.factCount; i++){
+        printf("| - ");
+        AfficherTranche(pb->faits.noms[pb->initial.facts[i]]);
+        printf("\n");
+    }
+    printf("|\n+----------------------------------------+\n");
+
+
+    printf("\n+----------OBJECTIF (FINISH)----------+\n|\n");
+    printf("| Nombre de faits: %d\n", pb->goal.factCount);
+    for(int i=0; i<pb->goal.factCount; i++){
+        printf("| - ");
+        AfficherTranche(pb->faits.noms[pb->goal.facts[i]]);
+        printf("\n");
+    }
+    printf("|\n+-------------------------------------+\n");
+
+
+    printf("\n+----------ACTIONS DISPONIBLES (%d)----------+\n|\n", actionCount);
+    for(int i=0; i<actionCount; i++){
+        printf("| - ");
+        AfficherTranche(actions[i].name);
+        if (mode == MODE_PRIORITE) {
+            printf(" (priorité: %d)", actions[i].priority);
+        }
+        printf("\n");
+    }
+    printf("|\n+-------------------------------------------+\n");
+    
+    // Affichage du mode de recherche
+    printf("\n+----------STRATEGIE DE RECHERCHE----------+\n|\n");
+    switch(mode) {
+        case MODE_NORMAL:
+            printf("| Mode: NORMAL (BFS standard)\n");
+            break;
+        case MODE_MELANGE:
+            printf("| Mode: MELANGE DES REGLES\n");
+            break;
+        case MODE_ALEATOIRE:
+            printf("| Mode: MARCHES ALEATOIRES (%d fils)\n", NB_FILS_MARCHES);
+            break;
+        case MODE_PRIORITE:
+            printf("| Mode: PRIORITES APPRISES (%s)\n", REPERTOIRE_PRIORITES);
+            break;
+        case MODE_MEANS_END:
+            printf("| Mode: ANALYSE FIN-MOYENS (montée forcée)\n");
+            break;
+        case MODE_ANYTIME:
+            printf("| Mode: ANYTIME (délai %.0f ms)\n", DELAI_ANYTIME_MS);
+            break;
+        case MODE_EXTERNE:
+            printf("| Mode: BFS EN MEMOIRE EXTERNE (%s)\n", REPERTOIRE_EXTERNE);
+            break;
+        case MODE_FRONTIERE:
+            printf("| Mode: RECHERCHE DE FRONTIERE\n");
+            break;
+        case MODE_GLOUTON:
+            printf("| Mode: GLOUTONNE FF (actions utiles)\n");
+            break;
+    }
+    printf("|\n+------------------------------------------+\n");
+    printf("(Ctrl+C pour interrompre la recherche)\n");
+
+    ArmerInterruption();
+    if (mode == MODE_ANYTIME) {
+        AnalyseAnytime(pb);
+        DesarmerInterruption();
+        return;
+    }
+    if (mode == MODE_EXTERNE) {
+        AnalyseExterne(pb);
+        DesarmerInterruption();
+        return;
+    }
+    if (mode == MODE_FRONTIERE) {
+        AnalyseFrontiere(pb);
+        DesarmerInterruption();
+        return;
+    }
+    if (mode == MODE_GLOUTON) {
+        AnalyseGlouton(pb);
+        DesarmerInterruption();
+        return;
+    }
+
+    // Mesure du temps d'exécution
+    struct timeval debut, fin;
+    gettimeofday(&debut, NULL);
+    
+    // Lancement BFS amélioré
+    ContexteRecherche ctx;
+    InitialiserContexteRecherche(&ctx);
+    ctx.compterEcartes = true;   // taux d'élagage affiché dans les statistiques
+    int solIndex = BfsAmeliore(&ctx, pb, mode);
+    
+    gettimeofday(&fin, NULL);
+    double temps_ms = (fin.tv_sec - debut.tv_sec) * 1000.0 + (fin.tv_usec - debut.tv_usec) / 1000.0;
+    
+    int* plan = NULL;
+    int longueurBrute = 0, longueurOptimisee = 0;
+    if(solIndex == -1) {
+        printf("\n+===========================================================+\n");
+        printf("|                  AUCUNE SOLUTION TROUVÉE                  |\n");
+        printf("+===========================================================+\n");
+    } else if ((longueurBrute = ExtrairePlan(&ctx, solIndex, &plan)) < 0) {
+        printf("Erreur: mémoire insuffisante pour le plan\n");
+        longueurBrute = 0;
+    } else {
+        // Optimisation du plan (partie 5.7)
+        longueurOptimisee = OptimiserPlan(pb, plan, longueurBrute, RECHERCHE_LOCALE_PLAN);
+        AfficherPlan(pb, plan, longueurOptimisee);
+    }
+    free(plan);
+    DesarmerInterruption();
+    
+    printf("\n+----------STATISTIQUES----------+\n");
+    if (solIndex != -1) {
+        printf("| Longueur du plan: %d étapes (%d avant optimisation)\n", longueurOptimisee, longueurBrute);
+    }
+    printf("| Issue de la recherche: %s\n", NomIssue(ctx.issue));
+    printf("| Nombre d'états générés: %d\n", ctx.visitedCount);
+    printf("| Successeurs calculés: %d\n", ctx.reglesAppliquees);
+    printf("| Mémoire des états: %.1f Ko\n", ctx.octetsMax / 1024.0);
+    if (REDUCTION_ORDRE_PARTIEL && (mode == MODE_NORMAL || mode == MODE_MELANGE)) {
+        long applicables = ctx.successeursEcartes + ctx.reglesAppliquees;
+        printf("| Réduction d'ordre partiel: %ld successeurs écartés (%.1f %%)\n", ctx.successeursEcartes,
+               applicables > 0 ? 100.0 * ctx.successeursEcartes / applicables : 0.0);
+    } else {
+        printf("| Réduction d'ordre partiel: %s\n", REDUCTION_ORDRE_PARTIEL ? "sans effet dans ce mode" : "désactivée");
+    }
+    printf("| Symétries utilisées: %d\n", ctx.nbSymetries);
+    if (mode == MODE_MEANS_END) {
+        printf("| Montée forcée: %d paliers%s\n", ctx.paliersMontee, ctx.repliMontee ? ", puis recherche gloutonne" : "");
+    }
+    if (mode == MODE_ALEATOIRE) {
+        printf("| Marches aléatoires: %d paliers, %d reprises, %d fils\n", ctx.paliersMarches, ctx.reprisesMarches, ctx.nbFilsMarches);
+    }
+    if (mode == MODE_MELANGE || mode == MODE_ALEATOIRE || mode == MODE_PRIORITE) {
+        printf("| Graine: %llu%s\n", ctx.graineUtilisee, ctx.rejeu ? " (rejeu, priorités non enregistrées)" : "");
+    }
+    printf("| Temps d'exécution: %.2f ms\n", temps_ms);
+    printf("+--------------------------------+\n");
+    FermerContexteRecherche(&ctx);
+}
+
+void ChoixFichierParDefaut(){
+    // Fichier par defaut : monkey.txt
+    const char* defaultFile = "assets/monkey.txt";
+
+    // Appele de fonction
+    AnalyseFichierAvecStrategie(defaultFile, MODE_NORMAL);
+}
+
+void viderbuffer()
+{
+    int c;
+    while ((c=getchar())!=EOF && c!='\n');
+}
+
+void ChoixFichierUtilisateur(){
+    char * nomFichier = malloc (sizeof(char)*255);
+    if (nomFichier==NULL){
+        fprintf(stderr, "Erreur  d'initialisation du nom de ficher\n" );
+        return;
+    }
+
+    char chemin[512];
+
+    printf("Entrez le nom du fichier a utiliser : ");
+    viderbuffer();
+    scanf("%254s", nomFichier);
+
+    strcpy(chemin, "assets/");
+    strcat(chemin, nomFichier);
+
+
+    printf("Nom du fichier saisi : %s\n", chemin);
+
+    FILE *file = fopen(chemin, "r");
+    if (file == NULL) {
+        printf("Erreur : Le fichier %s n'existe pas ou n'est pas accessible.\n", chemin);
+        free(nomFichier);
+        return;
+    }
+    fclose(file);
+
+    AnalyseFichierAvecStrategie(chemin, MODE_NORMAL);
+
+    free(nomFichier);
+}
+
+
+void ChoixCréationFichierUtilisateur(){
+    // Creer un nouveau fichier
+    char *nomFichier = malloc(sizeof(char) * 255);
+
+    // Demander le nom du fichier
+    printf("Nom du fichier à créer : ");
+    fgets(nomFichier, 255, stdin);
+
+    // Supprimer le \n de la fin de la chaîne si présent
+    size_t len = strlen(nomFichier);
+    if (len > 0 && nomFichier[len - 1] == '\n') {
+        nomFichier[len - 1] = '\0';
+    }
+
+    // Créer le fichier
+    CreerFichier(nomFichier);
+
+    // Proposition de vérification immédiate
+    printf("Voulez-vous tester la résolution sur ce fichier ? (o/n) ");
+    char rep[10];
+    fgets(rep, 10, stdin);
+
+    if (rep[0] == 'o' || rep[0] == 'O') {
+        // On parse & BFS
+        Probleme pb;
+
+        if (!ParseFile(nomFichier, &pb)) {
+            printf("Erreur lors du parsing. Abandon.\n");
+        } else {
+            // Même affichage
+            printf("\n=== ETAT INITIAL (START) ===\n");
+            printf("Nombre de faits: %d\n", pb.initial.factCount);
+            for (int i = 0; i < pb.initial.factCount; i++) {
+                printf(" - ");
+                AfficherTranche(pb.faits.noms[pb.initial.facts[i]]);
+                printf("\n");
+            }
+
+            printf("\n=== OBJECTIF (FINISH) ===\n");
+            printf("Nombre de faits: %d\n", pb.goal.factCount);
+            for (int i = 0; i < pb.goal.factCount; i++) {
+                printf(" - ");
+                AfficherTranche(pb.faits.noms[pb.goal.facts[i]]);
+                printf("\n");
+            }
+
+            printf("\n=== ACTIONS DISPONIBLES (%d) ===\n", pb.actionCount);
+            for (int i = 0; i < pb.actionCount; i++) {
+                printf(" - ");
+                AfficherTranche(pb.actions[i].name);
+                printf("\n");
+            }
+
+            ContexteRecherche ctx;
+            InitialiserContexteRecherche(&ctx);
+            int solIndex = BfsAmeliore(&ctx, &pb, MODE_NORMAL);
+            if (solIndex == -1) {
+                printf("\nAucune solution trouvée pour ce fichier.\n\n");
+            } else {
+                ReconstructPlan(&ctx, solIndex, &pb);
+            }
+            FermerContexteRecherche(&ctx);
+            LibererProbleme(&pb);
+        }
+    } else {
+        printf("Ok, fichier créé, pas de vérification. Retour au menu.\n");
+    }
+
+    free(nomFichier);  // Ne pas oublier de libérer la mémoire allouée
+}
+
+// ---------------------------------------------------------------------
+// Fonctions pour la partie 5
+// ---------------------------------------------------------------------
+
+// 5.1 - Générateurs de problèmes en mémoire
+// Chaque famille construit directement un Probleme (sans passer par un
+// fichier) à partir d'une taille et d'une graine. La même graine donne
+// toujours le même problème ; la graine 0 donne l'instance "classique".
+
+// État de la construction d'un problème généré
+typedef struct {
+    Probleme* pb;
+    uint64_t alea;      // état du générateur pseudo-aléatoire
+    int* liste;         // liste de faits en cours de construction
+    int nb;
+    int capacite;
+    bool erreur;        // mémoire insuffisante
+} Generateur;
+
+// Générateur pseudo-aléatoire (splitmix64), indépendant de rand() pour que
+// la même graine donne le même problème sur toutes les plateformes
+static uint64_t TirageGeneration(Generateur* g) {
+    uint64_t z = (g->alea += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Entier uniforme dans [0, n[
+static int TirageEntier(Generateur* g, int n) {
+    return (int)(TirageGeneration(g) % (uint64_t)n);
+}
+
+// Copie un texte formaté dans l'arène du problème
+static Tranche GenTexteV(Generateur* g, const char* format, va_list args) {
+    char tampon[MAX_LEN];
+    int n = vsnprintf(tampon, sizeof(tampon), format, args);
+    if (n >= MAX_LEN) n = MAX_LEN - 1;
+    Tranche t = { "", 0 };
+    char* copie = AreneAllouer(g->pb, n);
+    if (!copie) {
+        g->erreur = true;
+        return t;
+    }
+    memcpy(copie, tampon, n);
+    t.debut = copie;
+    t.longueur = n;
+    return t;
+}
+
+// Renvoie le numéro du fait dont le nom est donné au format printf
+static int GenFait(Generateur* g, const char* format, ...) {
+    char tampon[MAX_LEN];
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(tampon, sizeof(tampon), format, args);
+    va_end(args);
+    if (n >= MAX_LEN) n = MAX_LEN - 1;
+
+    Tranche nom = { tampon, n };
+    int f = ChercherFait(&g->pb->faits, nom);
+    if (f >= 0) return f;
+
+    // Nouveau fait : son nom est recopié dans l'arène du problème
+    char* copie = AreneAllouer(g->pb, n);
+    if (copie) {
+        memcpy(copie, tampon, n);
+        nom.debut = copie;
+        f = TrouverOuAjouterFait(&g->pb->faits, nom);
+    }
+    if (f < 0) {
+        g->erreur = true;
+        return 0;
+    }
+    return f;
+}
+
+// Ajoute une action dont le nom est donné au format printf
+static Action* GenAction(Generateur* g, const char* format, ...) {
+    Action* action = AjouterAction(g->pb);
+    if (!action) {
+        g->erreur = true;
+        static Action poubelle;
+        memset(&poubelle, 0, sizeof(Action));
+        return &poubelle;
+    }
+    va_list args;
+    va_start(args, format);
+    action->name = GenTexteV(g, format, args);
+    va_end(args);
+    return action;
+}
+
+static void GenDebutListe(Generateur* g) {
+    g->nb = 0;
+}
+
+static void GenAjouter(Generateur* g, int fait) {
+    if (g->nb == g->capacite) {
+        int capacite = g->capacite ? g->capacite * 2 : 64;
+        int* liste = realloc(g->liste, sizeof(int) * capacite);
+        if (!liste) {
+            g->erreur = true;
+            return;
+        }
+        g->liste = liste;
+        g->capacite = capacite;
+    }
+    g->liste[g->nb++] = fait;
+}
+
+// Range la liste en cours de construction dans 'dest'
+static void GenFinListe(Generateur* g, ListeFaits* dest) {
+    dest->factCount = 0;
+    dest->facts = NULL;
+    if (g->nb == 0) return;
+    dest->facts = AreneAllouer(g->pb, sizeof(int) * g->nb);
+    if (!dest->facts) {
+        g->erreur = true;
+        return;
+    }
+    memcpy(dest->facts, g->liste, sizeof(int) * g->nb);
+    dest->factCount = g->nb;
+}
+
+// Construit directement une liste de 'nb' faits
+static void GenListe(Generateur* g, ListeFaits* dest, int nb, ...) {
+    va_list args;
+    va_start(args, nb);
+    GenDebutListe(g);
+    for (int i = 0; i < nb; i++) GenAjouter(g, va_arg(args, int));
+    va_end(args);
+    GenFinListe(g, dest);
+}
+
+// Tire une configuration de blocs : dessous[b] = bloc qui supporte b (n = la table)
+static void TirerConfigurationBlocs(Generateur* g, int n, int* dessous) {
+    int* ordre = malloc(sizeof(int) * n);
+    int* sommets = malloc(sizeof(int) * n);
+    if (!ordre || !sommets) {
+        g->erreur = true;
+        free(ordre);
+        free(sommets);
+        return;
+    }
+    for (int i = 0; i < n; i++) ordre[i] = i;
+    for (int i = n - 1; i > 0; i--) {
+        int j = TirageEntier(g, i + 1);
+        int tmp = ordre[i]; ordre[i] = ordre[j]; ordre[j] = tmp;
+    }
+    // Chaque bloc commence une nouvelle tour ou se pose sur le sommet d'une tour existante
+    int nbTours = 0;
+    for (int i = 0; i < n; i++) {
+        int b = ordre[i];
+        if (nbTours == 0 || TirageEntier(g, 2) == 0) {
+            dessous[b] = n;
+            sommets[nbTours++] = b;
+        } else {
+            int t = TirageEntier(g, nbTours);
+            dessous[b] = sommets[t];
+            sommets[t] = b;
+        }
+    }
+    free(ordre);
+    free(sommets);
+}
+
+// Monde des blocs : n blocs, configurations de départ et d'arrivée aléatoires.
+// Graine 0 : une seule tour (bloc_1 au sommet) à mettre entièrement sur la table.
+static void GenererBlocs(Generateur* g, int n, bool classique) {
+    int* sur = malloc(sizeof(int) * n * (n + 1));   // sur[i * (n + 1) + j], j == n : la table
+    int* libre = malloc(sizeof(int) * n);
+    int* dessous = malloc(sizeof(int) * n);
+    bool* occupe = calloc(n, sizeof(bool));
+    if (!sur || !libre || !dessous || !occupe) {
+        g->erreur = true;
+        free(sur); free(libre); free(dessous); free(occupe);
+        return;
+    }
+    Probleme* pb = g->pb;
+
+    for (int i = 0; i < n; i++) {
+        libre[i] = GenFait(g, "libre(bloc_%d)", i + 1);
+        for (int j = 0; j <= n; j++) {
+            if (j == n) sur[i * (n + 1) + j] = GenFait(g, "sur(bloc_%d,table)", i + 1);
+            else if (j != i) sur[i * (n + 1) + j] = GenFait(g, "sur(bloc_%d,bloc_%d)", i + 1, j + 1);
+        }
+    }
+
+    // État initial
+    if (classique) {
+        for (int i = 0; i < n; i++) dessous[i] = i + 1;   // le dernier bloc est sur la table
+    } else {
+        TirerConfigurationBlocs(g, n, dessous);
+    }
+    GenDebutListe(g);
+    for (int i = 0; i < n && !g->erreur; i++) {
+        GenAjouter(g, sur[i * (n + 1) + dessous[i]]);
+        if (dessous[i] < n) occupe[dessous[i]] = true;
+    }
+    for (int i = 0; i < n; i++) {
+        if (!occupe[i]) GenAjouter(g, libre[i]);
+    }
+    GenFinListe(g, &pb->initial);
+
+    // But
+    if (classique) {
+        for (int i = 0; i < n; i++) dessous[i] = n;
+    } else {
+        TirerConfigurationBlocs(g, n, dessous);
+    }
+    GenDebutListe(g);
+    for (int i = 0; i < n && !g->erreur; i++) GenAjouter(g, sur[i * (n + 1) + dessous[i]]);
+    GenFinListe(g, &pb->goal);
+
+    // Règles
+    for (int i = 0; i < n && !g->erreur; i++) {
+        for (int j = 0; j < n; j++) {
+            if (j == i) continue;
+            Action* a = GenAction(g, "Poser bloc_%d de bloc_%d sur la table", i + 1, j + 1);
+            GenListe(g, &a->preconds, 2, libre[i], sur[i * (n + 1) + j]);
+            GenListe(g, &a->addList, 2, sur[i * (n + 1) + n], libre[j]);
+            GenListe(g, &a->delList, 1, sur[i * (n + 1) + j]);
+
+            a = GenAction(g, "Empiler bloc_%d de la table sur bloc_%d", i + 1, j + 1);
+            GenListe(g, &a->preconds, 3, libre[i], libre[j], sur[i * (n + 1) + n]);
+            GenListe(g, &a->addList, 1, sur[i * (n + 1) + j]);
+            GenListe(g, &a->delList, 2, sur[i * (n + 1) + n], libre[j]);
+
+            for (int k = 0; k < n; k++) {
+                if (k == i || k == j) continue;
+                a = GenAction(g, "Déplacer bloc_%d de bloc_%d sur bloc_%d", i + 1, j + 1, k + 1);
+                GenListe(g, &a->preconds, 3, libre[i], libre[k], sur[i * (n + 1) + j]);
+                GenListe(g, &a->addList, 2, sur[i * (n + 1) + k], libre[j]);
+                GenListe(g, &a->delList, 2, sur[i * (n + 1) + j], libre[k]);
+            }
+        }
+    }
+
+    free(sur); free(libre); free(dessous); free(occupe);
+}
+
+// Tours de Hanoï : n disques (disque_1 le plus petit), p piquets.
+// Les disques sont répartis au hasard sur les piquets et doivent finir sur le dernier.
+// Graine 0 : tous les disques sur le premier piquet.
+static void GenererHanoi(Generateur* g, int n, int p, bool classique) {
+    int nbObjets = n + p;   // objets 0..n-1 : disques, n..n+p-1 : piquets
+    int* sur = malloc(sizeof(int) * n * nbObjets);
+    int* libre = malloc(sizeof(int) * nbObjets);
+    int* piquet = malloc(sizeof(int) * n);
+    int* sommet = malloc(sizeof(int) * p);
+    char (*noms)[32] = malloc(sizeof(*noms) * nbObjets);
+    if (!sur || !libre || !piquet || !sommet || !noms) {
+        g->erreur = true;
+        free(sur); free(libre); free(piquet); free(sommet); free(noms);
+        return;
+    }
+    Probleme* pb = g->pb;
+
+    for (int x = 0; x < nbObjets; x++) {
+        if (x < n) snprintf(noms[x], sizeof(noms[x]), "disque_%d", x + 1);
+        else snprintf(noms[x], sizeof(noms[x]), "piquet_%d", x - n + 1);
+        libre[x] = GenFait(g, "libre(%s)", noms[x]);
+    }
+    // Un disque ne peut être que sur un disque plus grand ou sur un piquet
+    for (int d = 0; d < n; d++) {
+        for (int x = d + 1; x < nbObjets; x++) {
+            sur[d * nbObjets + x] = GenFait(g, "sur(%s,%s)", noms[d], noms[x]);
+        }
+    }
+
+    // Etat initial : on empile du plus grand au plus petit sur chaque piquet
+    for (int d = 0; d < n; d++) piquet[d] = classique ? 0 : TirageEntier(g, p);
+    for (int q = 0; q < p; q++) sommet[q] = n + q;
+    GenDebutListe(g);
+    for (int d = n - 1; d >= 0; d--) {
+        GenAjouter(g, sur[d * nbObjets + sommet[piquet[d]]]);
+        sommet[piquet[d]] = d;
+    }
+    for (int q = 0; q < p; q++) GenAjouter(g, libre[sommet[q]]);
+    GenFinListe(g, &pb->initial);
+
+    // But : tous les disques sur le dernier piquet
+    GenDebutListe(g);
+    for (int d = 0; d < n; d++) {
+        GenAjouter(g, sur[d * nbObjets + (d + 1 < n ? d + 1 : n + p - 1)]);
+    }
+    GenFinListe(g, &pb->goal);
+
+    for (int d = 0; d < n && !g->erreur; d++) {
+        for (int x = d + 1; x < nbObjets; x++) {
+            for (int y = d + 1; y < nbObjets; y++) {
+                if (x == y) continue;
+                Action* a = GenAction(g, "Déplacer %s de %s sur %s", noms[d], noms[x], noms[y]);
+                GenListe(g, &a->preconds, 3, libre[d], sur[d * nbObjets + x], libre[y]);
+                GenListe(g, &a->addList, 2, sur[d * nbObjets + y], libre[x]);
+                GenListe(g, &a->delList, 2, sur[d * nbObjets + x], libre[y]);
+            }
+        }
+    }
+
+    free(sur); free(libre); free(piquet); free(sommet); free(noms);
+}
+
+// Gripper : un robot à deux pinces transporte n balles entre s salles.
+// Graine 0 : toutes les balles de salle_1 vers salle_2.
+static void GenererGripper(Generateur* g, int n, int s, bool classique) {
+    static const char* pinces[2] = { "gauche", "droite" };
+    int* robot = malloc(sizeof(int) * s);
+    int* balle = malloc(sizeof(int) * n * s);
+    int* tient = malloc(sizeof(int) * 2 * n);
+    if (!robot || !balle || !tient) {
+        g->erreur = true;
+        free(robot); free(balle); free(tient);
+        return;
+    }
+    Probleme* pb = g->pb;
+    int libre[2];
+
+    for (int r = 0; r < s; r++) robot[r] = GenFait(g, "robot_dans(salle_%d)", r + 1);
+    for (int b = 0; b < n; b++) {
+        for (int r = 0; r < s; r++) balle[b * s + r] = GenFait(g, "dans(balle_%d,salle_%d)", b + 1, r + 1);
+    }
+    for (int m = 0; m < 2; m++) {
+        libre[m] = GenFait(g, "libre(pince_%s)", pinces[m]);
+        for (int b = 0; b < n; b++) tient[m * n + b] = GenFait(g, "tient(pince_%s,balle_%d)", pinces[m], b + 1);
+    }
+
+    GenDebutListe(g);
+    GenAjouter(g, robot[classique ? 0 : TirageEntier(g, s)]);
+    GenAjouter(g, libre[0]);
+    GenAjouter(g, libre[1]);
+    for (int b = 0; b < n; b++) GenAjouter(g, balle[b * s + (classique ? 0 : TirageEntier(g, s))]);
+    GenFinListe(g, &pb->initial);
+
+    GenDebutListe(g);
+    for (int b = 0; b < n; b++) GenAjouter(g, balle[b * s + (classique ? 1 : TirageEntier(g, s))]);
+    GenFinListe(g, &pb->goal);
+
+    for (int r1 = 0; r1 < s && !g->erreur; r1++) {
+        for (int r2 = 0; r2 < s; r2++) {
+            if (r1 == r2) continue;
+            Action* a = GenAction(g, "Aller de salle_%d à salle_%d", r1 + 1, r2 + 1);
+            GenListe(g, &a->preconds, 1, robot[r1]);
+            GenListe(g, &a->addList, 1, robot[r2]);
+            GenListe(g, &a->delList, 1, robot[r1]);
+        }
+    }
+    for (int b = 0; b < n && !g->erreur; b++) {
+        for (int r = 0; r < s; r++) {
+            for (int m = 0; m < 2; m++) {
+                Action* a = GenAction(g, "Prendre balle_%d dans salle_%d avec pince_%s", b + 1, r + 1, pinces[m]);
+                GenListe(g, &a->preconds, 3, balle[b * s + r], robot[r], libre[m]);
+                GenListe(g, &a->addList, 1, tient[m * n + b]);
+                GenListe(g, &a->delList, 2, balle[b * s + r], libre[m]);
+
+                a = GenAction(g, "Lâcher balle_%d dans salle_%d avec pince_%s", b + 1, r + 1, pinces[m]);
+                GenListe(g, &a->preconds, 2, tient[m * n + b], robot[r]);
+                GenListe(g, &a->addList, 2, balle[b * s + r], libre[m]);
+                GenListe(g, &a->delList, 1, tient[m * n + b]);
+            }
+        }
+    }
+
+    free(robot); free(balle); free(tient);
+}
+
+// Logistique : n colis à livrer entre v villes. Chaque ville a une poste, un
+// aéroport et un camion ; un avion pour 4 villes relie les aéroports.
+// Graine 0 : le colis i part de la poste de la ville i et va à celle de la ville i+1.
+static void GenererLogistique(Generateur* g, int n, int v, bool classique) {
+    int nbLieux = 2 * v;                // lieu 2c : poste_c, lieu 2c+1 : aeroport_c
+    int nbAvions = (v + 3) / 4;
+    int nbVehicules = v + nbAvions;     // véhicules 0..v-1 : camions, puis avions
+    int* colisA = malloc(sizeof(int) * n * nbLieux);
+    int* colisDans = malloc(sizeof(int) * n * nbVehicules);
+    int* vehiculeA = malloc(sizeof(int) * nbVehicules * nbLieux);
+    char (*lieux)[32] = malloc(sizeof(*lieux) * nbLieux);
+    char (*vehicules)[32] = malloc(sizeof(*vehicules) * nbVehicules);
+    if (!colisA || !colisDans || !vehiculeA || !lieux || !vehicules) {
+        g->erreur = true;
+        free(colisA); free(colisDans); free(vehiculeA); free(lieux); free(vehicules);
+        return;
+    }
+    Probleme* pb = g->pb;
+
+    for (int l = 0; l < nbLieux; l++) {
+        snprintf(lieux[l], sizeof(lieux[l]), l % 2 == 0 ? "poste_%d" : "aeroport_%d", l / 2 + 1);
+    }
+    for (int k = 0; k < nbVehicules; k++) {
+        if (k < v) snprintf(vehicules[k], sizeof(vehicules[k]), "camion_%d", k + 1);
+        else snprintf(vehicules[k], sizeof(vehicules[k]), "avion_%d", k - v + 1);
+    }
+    for (int c = 0; c < n; c++) {
+        for (int l = 0; l < nbLieux; l++) colisA[c * nbLieux + l] = GenFait(g, "a(colis_%d,%s)", c + 1, lieux[l]);
+        for (int k = 0; k < nbVehicules; k++) colisDans[c * nbVehicules + k] = GenFait(g, "dans(colis_%d,%s)", c + 1, vehicules[k]);
+    }
+    // Un camion reste dans sa ville, un avion ne va que dans les aéroports
+    for (int k = 0; k < nbVehicules; k++) {
+        for (int l = 0; l < nbLieux; l++) {
+            bool possible = k < v ? l / 2 == k : l % 2 == 1;
+            vehiculeA[k * nbLieux + l] = possible ? GenFait(g, "a(%s,%s)", vehicules[k], lieux[l]) : -1;
+        }
+    }
+
+    GenDebutListe(g);
+    for (int k = 0; k < v; k++) {
+        GenAjouter(g, vehiculeA[k * nbLieux + 2 * k + (classique ? 0 : TirageEntier(g, 2))]);
+    }
+    for (int a = 0; a < nbAvions; a++) {
+        int ville = classique ? a % v : TirageEntier(g, v);
+        GenAjouter(g, vehiculeA[(v + a) * nbLieux + 2 * ville + 1]);
+    }
+    for (int c = 0; c < n; c++) {
+        GenAjouter(g, colisA[c * nbLieux + (classique ? 2 * (c % v) : TirageEntier(g, nbLieux))]);
+    }
+    GenFinListe(g, &pb->initial);
+
+    GenDebutListe(g);
+    for (int c = 0; c < n; c++) {
+        GenAjouter(g, colisA[c * nbLieux + (classique ? 2 * ((c + 1) % v) : TirageEntier(g, nbLieux))]);
+    }
+    GenFinListe(g, &pb->goal);
+
+    for (int k = 0; k < nbVehicules && !g->erreur; k++) {
+        for (int l = 0; l < nbLieux; l++) {
+            if (vehiculeA[k * nbLieux + l] < 0) continue;
+            for (int c = 0; c < n; c++) {
+                Action* a = GenAction(g, "Charger colis_%d dans %s à %s", c + 1, vehicules[k], lieux[l]);
+                GenListe(g, &a->preconds, 2, vehiculeA[k * nbLieux + l], colisA[c * nbLieux + l]);
+                GenListe(g, &a->addList, 1, colisDans[c * nbVehicules + k]);
+                GenListe(g, &a->delList, 1, colisA[c * nbLieux + l]);
+
+                a = GenAction(g, "Décharger colis_%d de %s à %s", c + 1, vehicules[k], lieux[l]);
+                GenListe(g, &a->preconds, 2, vehiculeA[k * nbLieux + l], colisDans[c * nbVehicules + k]);
+                GenListe(g, &a->addList, 1, colisA[c * nbLieux + l]);
+                GenListe(g, &a->delList, 1, colisDans[c * nbVehicules + k]);
+            }
+            for (int l2 = 0; l2 < nbLieux; l2++) {
+                if (l2 == l || vehiculeA[k * nbLieux + l2] < 0) continue;
+                Action* a = GenAction(g, "%s %s de %s à %s", k < v ? "Conduire" : "Voler",
+                                      vehicules[k], lieux[l], lieux[l2]);
+                GenListe(g, &a->preconds, 1, vehiculeA[k * nbLieux + l]);
+                GenListe(g, &a->addList, 1, vehiculeA[k * nbLieux + l2]);
+                GenListe(g, &a->delList, 1, vehiculeA[k * nbLieux + l]);
+            }
+        }
+    }
+
+    free(colisA); free(colisDans); free(vehiculeA); free(lieux); free(vehicules);
+}
+
+// Traversée de rivière : généralisation du loup, de la chèvre et du chou.
+// Les n passagers forment des groupes de 2 ou 3 (chèvre + loup + chou) : la
+// chèvre d'un groupe ne peut pas rester sans le berger avec le loup ou le chou
+// de son groupe. La barque emporte le berger et jusqu'à 'places' passagers.
+// Avec au moins autant de places que de groupes, le problème a une solution.
+//
+// Pour exprimer "pas de groupe en danger sur la rive quittée" avec des
+// préconditions (positives et négatives) simples, chaque groupe a un fait par
+// configuration (qui est à gauche, qui est à droite) : groupe_1_GDG, etc.
+typedef struct {
+    int nbMembres;          // 1 à 3, le membre 0 est la chèvre
+    int premier;            // indice du premier passager du groupe
+    int configs[8];         // fait de chaque configuration (bit i à 1 : membre i à droite)
+} GroupeRiviere;
+
+// Vrai si la configuration laisse la chèvre avec un autre membre sur la rive 'cote' sans berger
+static bool ConfigurationEnDanger(const GroupeRiviere* groupe, int config, int cote) {
+    if (groupe->nbMembres < 2 || ((config & 1) != cote)) return false;
+    for (int m = 1; m < groupe->nbMembres; m++) {
+        if (((config >> m) & 1) == cote) return true;
+    }
+    return false;
+}
+
+// Ajoute toutes les variantes de la traversée des passagers 'choisis' de la rive 'cote'
+static void GenererTraversees(Generateur* g, GroupeRiviere* groupes, int nbGroupes, const int* groupeDe,
+                              const int* choisis, int nbChoisis, int cote, const int* rive, const int* berger,
+                              char (*noms)[32]) {
+    static const char* cotes[2] = { "gauche", "droite" };
+    // Groupes concernés par la traversée, et membres qui montent dans la barque
+    int touches[8], nbTouches = 0, montent[8] = {0};
+    for (int i = 0; i < nbChoisis; i++) {
+        int gr = groupeDe[choisis[i]];
+        int t = 0;
+        while (t < nbTouches && touches[t] != gr) t++;
+        if (t == nbTouches) touches[nbTouches++] = gr;
+        montent[t] |= 1 << (choisis[i] - groupes[gr].premier);
+    }
+
+    // On énumère les configurations de départ des groupes touchés (compteur en base 8)
+    int config[8] = {0};
+    for (;;) {
+        bool valide = true;
+        for (int t = 0; t < nbTouches && valide; t++) {
+            const GroupeRiviere* gr = &groupes[touches[t]];
+            int membresA = cote ? config[t] : ~config[t] & ((1 << gr->nbMembres) - 1);
+            int apres = config[t] ^ montent[t];
+            valide = (membresA & montent[t]) == montent[t] && !ConfigurationEnDanger(gr, apres, cote);
+        }
+
+        if (valide) {
+            char nom[MAX_LEN];
+            int pos = 0;
+            if (nbChoisis == 0) {
+                pos = snprintf(nom, sizeof(nom), "Traverser seul");
+            } else {
+                pos = snprintf(nom, sizeof(nom), "Traverser avec ");
+                for (int i = 0; i < nbChoisis && pos < MAX_LEN; i++) {
+                    pos += snprintf(nom + pos, sizeof(nom) - pos, "%s%s", i ? ", " : "", noms[choisis[i]]);
+                }
+            }
+            Action* a = GenAction(g, "%s vers la %s", nom, cotes[1 - cote]);
+
+            GenDebutListe(g);
+            GenAjouter(g, berger[cote]);
+            for (int i = 0; i < nbChoisis; i++) GenAjouter(g, rive[2 * choisis[i] + cote]);
+            for (int t = 0; t < nbTouches; t++) GenAjouter(g, groupes[touches[t]].configs[config[t]]);
+            GenFinListe(g, &a->preconds);
+
+            // Les groupes qui ne traversent pas ne doivent pas être en danger sur la rive quittée
+            GenDebutListe(g);
+            for (int gr = 0; gr < nbGroupes; gr++) {
+                bool touche = false;
+                for (int t = 0; t < nbTouches; t++) touche |= touches[t] == gr;
+                if (touche) continue;
+                for (int c = 0; c < (1 << groupes[gr].nbMembres); c++) {
+                    if (ConfigurationEnDanger(&groupes[gr], c, cote)) GenAjouter(g, groupes[gr].configs[c]);
+                }
+            }
+            GenFinListe(g, &a->neg_preconds);
+
+            GenDebutListe(g);
+            GenAjouter(g, berger[1 - cote]);
+            for (int i = 0; i < nbChoisis; i++) GenAjouter(g, rive[2 * choisis[i] + 1 - cote]);
+            for (int t = 0; t < nbTouches; t++) GenAjouter(g, groupes[touches[t]].configs[config[t] ^ montent[t]]);
+            GenFinListe(g, &a->addList);
+
+            GenDebutListe(g);
+            GenAjouter(g, berger[cote]);
+            for (int i = 0; i < nbChoisis; i++) GenAjouter(g, rive[2 * choisis[i] + cote]);
+            for (int t = 0; t < nbTouches; t++) GenAjouter(g, groupes[touches[t]].configs[config[t]]);
+            GenFinListe(g, &a->delList);
+        }
+
+        // Configuration suivante
+        int t = 0;
+        while (t < nbTouches && ++config[t] == (1 << groupes[touches[t]].nbMembres)) {
+            config[t] = 0;
+            t++;
+        }
+        if (t == nbTouches) break;
+    }
+}
+
+static void GenererRiviere(Generateur* g, int n, int places, bool classique) {
+    static const char* roles[3] = { "chevre", "loup", "chou" };
+    static const char* cotes[2] = { "gauche", "droite" };
+    static const char* lettres = "GD";
+    GroupeRiviere* groupes = malloc(sizeof(GroupeRiviere) * n);
+    int* groupeDe = malloc(sizeof(int) * n);
+    int* rive = malloc(sizeof(int) * 2 * n);        // rive[2p + cote]
+    char (*noms)[32] = malloc(sizeof(*noms) * n);
+    int* choisis = malloc(sizeof(int) * (n + 1));
+    if (!groupes || !groupeDe || !rive || !noms || !choisis) {
+        g->erreur = true;
+        free(groupes); free(groupeDe); free(rive); free(noms); free(choisis);
+        return;
+    }
+    Probleme* pb = g->pb;
+
+    // Découpage en groupes de 2 ou 3 passagers
+    int nbGroupes = 0;
+    for (int reste = n; reste > 0; ) {
+        int taille;
+        if (reste <= 3) taille = reste;
+        else if (reste == 4) taille = 2;
+        else taille = classique ? 3 : 2 + TirageEntier(g, 2);
+        groupes[nbGroupes].nbMembres = taille;
+        groupes[nbGroupes].premier = n - reste;
+        nbGroupes++;
+        reste -= taille;
+    }
+    if (places <= 0) places = nbGroupes;
+    if (places > n) places = n;
+
+    int berger[2];
+    for (int c = 0; c < 2; c++) berger[c] = GenFait(g, "berger_%s", cotes[c]);
+    for (int gr = 0; gr < nbGroupes; gr++) {
+        GroupeRiviere* groupe = &groupes[gr];
+        for (int m = 0; m < groupe->nbMembres; m++) {
+            int p = groupe->premier + m;
+            groupeDe[p] = gr;
+            snprintf(noms[p], sizeof(noms[p]), "%s_%d", roles[m], gr + 1);
+            for (int c = 0; c < 2; c++) rive[2 * p + c] = GenFait(g, "%s_%s", noms[p], cotes[c]);
+        }
+        for (int config = 0; config < (1 << groupe->nbMembres); config++) {
+            char code[4];
+            for (int m = 0; m < groupe->nbMembres; m++) code[m] = lettres[(config >> m) & 1];
+            code[groupe->nbMembres] = '\0';
+            groupe->configs[config] = GenFait(g, "groupe_%d_%s", gr + 1, code);
+        }
+    }
+
+    // Tout le monde commence à gauche et doit finir à droite
+    GenDebutListe(g);
+    GenAjouter(g, berger[0]);
+    for (int p = 0; p < n; p++) GenAjouter(g, rive[2 * p]);
+    for (int gr = 0; gr < nbGroupes; gr++) GenAjouter(g, groupes[gr].configs[0]);
+    GenFinListe(g, &pb->initial);
+
+    GenDebutListe(g);
+    GenAjouter(g, berger[1]);
+    for (int p = 0; p < n; p++) GenAjouter(g, rive[2 * p + 1]);
+    GenFinListe(g, &pb->goal);
+
+    // Toutes les combinaisons de 0 à 'places' passagers, dans les deux sens
+    for (int k = 0; k <= places && !g->erreur; k++) {
+        for (int i = 0; i < k; i++) choisis[i] = i;
+        for (;;) {
+            for (int cote = 0; cote < 2; cote++) {
+                GenererTraversees(g, groupes, nbGroupes, groupeDe, choisis, k, cote, rive, berger, noms);
+            }
+            // Combinaison suivante
+            int i = k - 1;
+            while (i >= 0 && choisis[i] == n - k + i) i--;
+            if (i < 0) break;
+            choisis[i]++;
+            for (int j = i + 1; j < k; j++) choisis[j] = choisis[j - 1] + 1;
+        }
+    }
+
+    free(groupes); free(groupeDe); free(rive); free(noms); free(choisis);
+}
+
+// Construit en mémoire un problème de la famille demandée. Renvoie 0 si les
+// paramètres sont invalides ou si la mémoire manque.
+int GenererProbleme(const ParametresGeneration* params, Probleme* pb) {
+    InitialiserProbleme(pb);
+    if (params->taille < 1) return 0;
+
+    Generateur g = { pb, params->graine, NULL, 0, 0, false };
+    bool classique = params->graine == 0;
+    int n = params->taille;
+    switch (params->famille) {
+        case GEN_BLOCS:
+            GenererBlocs(&g, n, classique);
+            break;
+        case GEN_HANOI:
+            GenererHanoi(&g, n, params->taille2 >= 3 ? params->taille2 : 3, classique);
+            break;
+        case GEN_GRIPPER:
+            GenererGripper(&g, n, params->taille2 >= 2 ? params->taille2 : 2, classique);
+            break;
+        case GEN_LOGISTIQUE:
+            GenererLogistique(&g, n, params->taille2 >= 2 ? params->taille2 : 3, classique);
+            break;
+        case GEN_RIVIERE:
+            // Au-delà de 8 passagers par traversée, le nombre de règles explose
+            if (params->taille2 > 8) g.erreur = true;
+            else GenererRiviere(&g, n, params->taille2, classique);
+            break;
+        default:
+            g.erreur = true;
+    }
+    free(g.liste);
+    CalculerTailleEtat(pb);
+
+    if (g.erreur) {
+        LibererProbleme(pb);
+        return 0;
+    }
+    return 1;
+}
+
+// Ecrit un problème au format des fichiers de problèmes
+static void EcrireListe(FILE* fp, const char* cle, const Probleme* pb, const ListeFaits* liste) {
+    fprintf(fp, "%s:", cle);
+    for (int i = 0; i < liste->factCount; i++) {
+        Tranche nom = pb->faits.noms[liste->facts[i]];
+        fprintf(fp, "%s%.*s", i ? "," : "", nom.longueur, nom.debut);
+    }
+    fprintf(fp, "\n");
+}
+
+int EcrireProbleme(const Probleme* pb, const char* nomFichier) {
+    FILE* fp = fopen(nomFichier, "w");
+    if (!fp) {
+        printf("Erreur: impossible de créer le fichier %s\n", nomFichier);
+        return 0;
+    }
+    EcrireListe(fp, "start", pb, &pb->initial);
+    EcrireListe(fp, "finish", pb, &pb->goal);
+    for (int a = 0; a < pb->actionCount; a++) {
+        const Action* action = &pb->actions[a];
+        fprintf(fp, "****\naction:%.*s\n", action->name.longueur, action->name.debut);
+        EcrireListe(fp, "preconds", pb, &action->preconds);
+        if (action->neg_preconds.factCount > 0) EcrireListe(fp, "neg_preconds", pb, &action->neg_preconds);
+        EcrireListe(fp, "add", pb, &action->addList);
+        EcrireListe(fp, "delete", pb, &action->delList);
+    }
+    fclose(fp);
+    return 1;
+}
+
+// 5.3 - Mélange l'ordre des règles (pour augmenter les chances de trouver une solution rapidement)
+// Le tirage vient du générateur de la recherche (ContexteRecherche). On
+// mélange les numéros des règles (ordre[]), pas le problème lui-même : le
+// plan garde les numéros d'origine et le problème peut servir à d'autres
+// recherches en même temps.
+void MelangerRegles(int* ordre, int actionCount, GenerateurAlea* alea) {
+    for (int i = 0; i < actionCount; i++) ordre[i] = i;
+    for (int i = 0; i < actionCount; i++) {
+        int j = i + (int)(TirageRecherche(alea) % (uint64_t)(actionCount - i));
+        // Échange les règles i et j
+        int temp = ordre[i];
+        ordre[i] = ordre[j];
+        ordre[j] = temp;
+    }
+}
+
+// 5.4 - Choix aléatoire parmi les règles applicables
+// Le tableau renvoyé est le tampon du contexte, valable jusqu'à l'appel suivant
+int* TrouverReglesApplicables(ContexteRecherche* ctx, const Mot* state, Action* actions, int actionCount, int* nbApplicables) {
+    if (ctx->capaciteApplicables < actionCount) {
+        free(ctx->applicables);
+        ctx->applicables = malloc(sizeof(int) * actionCount);
+        ctx->capaciteApplicables = ctx->applicables ? actionCount : 0;
+    }
+    int* applicables = ctx->applicables;
+    *nbApplicables = 0;
+    if (!applicables) return NULL;
+    
+    for (int i = 0; i < actionCount; i++) {
+        if (CanApply(state, &actions[i])) {
+            applicables[(*nbApplicables)++] = i;
+        }
+    }
+    
+    return applicables;
+}
+
+// 5.5 - Construction d'un tableau de règles applicables pondéré par les priorités
+// (tampon du contexte, comme TrouverReglesApplicables)
+int* ConstuireTableauPriorite(ContexteRecherche* ctx, const Mot* state, Action* actions, int actionCount, int* tailleTableau) {
+    if (ctx->capacitePondere < actionCount * MAX_PRIORITY) {
+        free(ctx->tableauPondere);
+        ctx->tableauPondere = malloc(sizeof(int) * actionCount * MAX_PRIORITY);
+        ctx->capacitePondere = ctx->tableauPondere ? actionCount * MAX_PRIORITY : 0;
+    }
+    int* tableauPonderé = ctx->tableauPondere;
+    *tailleTableau = 0;
+    if (!tableauPonderé) return NULL;
+    
+    for (int i = 0; i < actionCount; i++) {
+        if (CanApply(state, &actions[i])) {
+            for (int p = 0; p < actions[i].priority; p++) {
+                tableauPonderé[(*tailleTableau)++] = i;
+            }
+        }
+    }
+    
+    return tableauPonderé;
+}
+
+// 5.6 - Calcul de la distance par rapport au but (nombre de faits communs)
+int CalculerDistanceAuBut(const Mot* state, const Goal* goal) {
+    int nbFaitsCommuns = 0;
+    
+    for (int i = 0; i < goal->factCount; i++) {
+        nbFaitsCommuns += (int)TEST_BIT(state, goal->facts[i]);
+    }
+    
+    return nbFaitsCommuns;
+}
+
+// Choisit la meilleure règle selon l'analyse fin-moyens
+int ChoisirMeilleureRegle(const Probleme* pb, const Mot* state, const Goal* goal) {
+    int meilleureRegle = -1;
+    int meilleurScore = -1;
+    Mot* newState = NouvelEtat(pb);
+    if (!newState) return -1;
+    
+    for (int i = 0; i < pb->actionCount; i++) {
+        if (CanApply(state, &pb->actions[i])) {
+            // Calcul de l'état résultant
+            ApplyAction(pb, state, &pb->actions[i], newState);
+            
+            // Calcul du score (nombre de faits communs avec le but)
+            int score = CalculerDistanceAuBut(newState, goal);
+            
+            if (score > meilleurScore) {
+                meilleurScore = score;
+                meilleureRegle = i;
+            }
+        }
+    }
+    
+    free(newState);
+    return meilleureRegle;
+}
+
+// 5.7 - Optimisation du plan trouvé
+// Les stratégies aléatoires trouvent vite un plan, mais souvent beaucoup
+// trop long. On le raccourcit après coup, sans refaire une recherche
+// complète :
+//  - raccourcis : si le plan repasse par un état déjà vu, on saute la boucle ;
+//  - élimination : on retire une étape (et celles qui ne sont plus
+//    applicables ensuite) si le but reste atteint ;
+//  - recherche locale (optionnelle) : petite BFS bornée depuis chaque état
+//    du plan, à la recherche d'un chemin plus court vers un état plus loin.
+
+#define PROFONDEUR_LOCALE   6      // longueur max d'un chemin de remplacement
+#define MAX_NOEUDS_LOCAUX   2000   // états max par recherche locale
+
+// États successifs du plan : etats[k] = état avant l'étape k (etats[longueur] = état final)
+static Mot* SimulerPlan(const Probleme* pb, const int* plan, int longueur) {
+    Mot* etats = malloc(sizeof(Mot) * pb->nbMots * (size_t)(longueur + 1));
+    if (!etats) return NULL;
+    EtatDepuisListe(pb, &pb->initial, etats);
+    for (int k = 0; k < longueur; k++) {
+        ApplyAction(pb, etats + (size_t)k * pb->nbMots, &pb->actions[plan[k]],
+                    etats + (size_t)(k + 1) * pb->nbMots);
+    }
+    return etats;
+}
+
+// Saute les boucles : pour chaque état, on repart de sa dernière occurrence
+static int SupprimerBoucles(const Probleme* pb, int* plan, int longueur) {
+    Mot* etats = SimulerPlan(pb, plan, longueur);
+    uint64_t* haches = malloc(sizeof(uint64_t) * (longueur + 1));
+    if (!etats || !haches) {
+        free(etats);
+        free(haches);
+        return longueur;
+    }
+    for (int k = 0; k <= longueur; k++) haches[k] = HacherEtat(pb, etats + (size_t)k * pb->nbMots);
+
+    int nouvelle = 0;
+    int k = 0;
+    while (k < longueur) {
+        // Dernière occurrence de l'état k dans la suite du plan
+        for (int j = longueur; j > k; j--) {
+            if (haches[j] == haches[k]
+                && SameState(pb, etats + (size_t)j * pb->nbMots, etats + (size_t)k * pb->nbMots)) {
+                k = j;
+                break;
+            }
+        }
+        if (k < longueur) plan[nouvelle++] = plan[k++];
+    }
+    free(etats);
+    free(haches);
+    return nouvelle;
+}
+
+// Élimination d'actions : on essaie de retirer chaque étape
+static int EliminerActions(const Probleme* pb, int* plan, int longueur) {
+    Mot* etat = NouvelEtat(pb);
+    Mot* essai = NouvelEtat(pb);
+    Mot* suivant = NouvelEtat(pb);
+    bool* retire = malloc(sizeof(bool) * (longueur + 1));
+    if (!etat || !essai || !suivant || !retire) {
+        free(etat); free(essai); free(suivant); free(retire);
+        return longueur;
+    }
+    EtatDepuisListe(pb, &pb->initial, etat);
+
+    int i = 0;
+    while (i < longueur) {
+        // On rejoue la fin du plan sans l'étape i, en sautant ce qui ne s'applique plus
+        memcpy(essai, etat, sizeof(Mot) * pb->nbMots);
+        memset(retire, 0, sizeof(bool) * longueur);
+        retire[i] = true;
+        for (int k = i + 1; k < longueur; k++) {
+            if (CanApply(essai, &pb->actions[plan[k]])) {
+                ApplyAction(pb, essai, &pb->actions[plan[k]], suivant);
+                memcpy(essai, suivant, sizeof(Mot) * pb->nbMots);
+            } else {
+                retire[k] = true;
+            }
+        }
+
+        if (IsGoalReached(essai, &pb->goal)) {
+            int nouvelle = i;
+            for (int k = i; k < longueur; k++) {
+                if (!retire[k]) plan[nouvelle++] = plan[k];
+            }
+            longueur = nouvelle;
+        } else {
+            ApplyAction(pb, etat, &pb->actions[plan[i]], suivant);
+            memcpy(etat, suivant, sizeof(Mot) * pb->nbMots);
+            i++;
+        }
+    }
+    free(etat); free(essai); free(suivant); free(retire);
+    return longueur;
+}
+
+// BFS bornée depuis l'état 'depart' = etats[i] : cherche un chemin plus
+// court vers un état etats[j] du plan (j > i). Renvoie le gain obtenu et
+// remplit 'chemin' (longueur *longueurChemin) et *cible = j.
+static int RechercheLocale(const Probleme* pb, const Mot* etats, const int* indexEtats, int nbAlveoles,
+                           int i, int* chemin, int* longueurChemin, int* cible) {
+    int nbMots = pb->nbMots;
+    Mot* noeuds = malloc(sizeof(Mot) * nbMots * MAX_NOEUDS_LOCAUX);
+    int* parent = malloc(sizeof(int) * MAX_NOEUDS_LOCAUX);
+    int* action = malloc(sizeof(int) * MAX_NOEUDS_LOCAUX);
+    int* profondeur = malloc(sizeof(int) * MAX_NOEUDS_LOCAUX);
+    int* vus = malloc(sizeof(int) * MAX_NOEUDS_LOCAUX * 2);
+    int meilleurGain = 0;
+    if (!noeuds || !parent || !action || !profondeur || !vus) {
+        free(noeuds); free(parent); free(action); free(profondeur); free(vus);
+        return 0;
+    }
+    for (int k = 0; k < MAX_NOEUDS_LOCAUX * 2; k++) vus[k] = -1;
+
+    memcpy(noeuds, etats + (size_t)i * nbMots, sizeof(Mot) * nbMots);
+    parent[0] = -1;
+    profondeur[0] = 0;
+    vus[HacherEtat(pb, noeuds) % (MAX_NOEUDS_LOCAUX * 2)] = 0;
+    int nbNoeuds = 1;
+
+    for (int tete = 0; tete < nbNoeuds; tete++) {
+        const Mot* courant = noeuds + (size_t)tete * nbMots;
+        if (profondeur[tete] >= PROFONDEUR_LOCALE) break;
+
+        for (int a = 0; a < pb->actionCount && nbNoeuds < MAX_NOEUDS_LOCAUX; a++) {
+            if (!CanApply(courant, &pb->actions[a])) continue;
+            Mot* nouveau = noeuds + (size_t)nbNoeuds * nbMots;
+            ApplyAction(pb, courant, &pb->actions[a], nouveau);
+            uint64_t h = HacherEtat(pb, nouveau);
+
+            // Déjà atteint dans cette recherche locale ?
+            int alveole = (int)(h % (MAX_NOEUDS_LOCAUX * 2));
+            bool dejaVu = false;
+            while (vus[alveole] != -1) {
+                if (SameState(pb, noeuds + (size_t)vus[alveole] * nbMots, nouveau)) {
+                    dejaVu = true;
+                    break;
+                }
+                alveole = (alveole + 1) % (MAX_NOEUDS_LOCAUX * 2);
+            }
+            if (dejaVu) continue;
+            vus[alveole] = nbNoeuds;
+            parent[nbNoeuds] = tete;
+            action[nbNoeuds] = a;
+            profondeur[nbNoeuds] = profondeur[tete] + 1;
+
+            // Est-ce un état du plan, plus loin que ce que coûte le chemin trouvé ?
+            int p = (int)(h % (uint64_t)nbAlveoles);
+            while (indexEtats[p] != -1) {
+                int j = indexEtats[p];
+                if (j > i && SameState(pb, etats + (size_t)j * nbMots, nouveau)) {
+                    int gain = (j - i) - profondeur[nbNoeuds];
+                    if (gain > meilleurGain) {
+                        meilleurGain = gain;
+                        *cible = j;
+                        *longueurChemin = profondeur[nbNoeuds];
+                        for (int n = nbNoeuds, k = profondeur[nbNoeuds] - 1; k >= 0; n = parent[n], k--) {
+                            chemin[k] = action[n];
+                        }
+                    }
+                    break;
+                }
+                p = (p + 1) % nbAlveoles;
+            }
+            nbNoeuds++;
+        }
+    }
+    free(noeuds); free(parent); free(action); free(profondeur); free(vus);
+    return meilleurGain;
+}
+
+// S'arrête dès que le jeton d'annulation est levé : le plan reste valide
+static int AmeliorerParRechercheLocale(const Probleme* pb, int* plan, int longueur, atomic_int* jeton) {
+    int chemin[PROFONDEUR_LOCALE];
+    int i = 0;
+    while (i < longueur && !(jeton && atomic_load(jeton))) {
+        // Table "état -> position dans le plan" (les boucles ont été retirées,
+        // chaque état n'apparaît qu'une fois)
+        Mot* etats = SimulerPlan(pb, plan, longueur);
+        int nbAlveoles = 2 * (longueur + 1);
+        int* indexEtats = malloc(sizeof(int) * nbAlveoles);
+        if (!etats || !indexEtats) {
+            free(etats);
+            free(indexEtats);
+            break;
+        }
+        for (int p = 0; p < nbAlveoles; p++) indexEtats[p] = -1;
+        for (int k = 0; k <= longueur; k++) {
+            int p = (int)(HacherEtat(pb, etats + (size_t)k * pb->nbMots) % (uint64_t)nbAlveoles);
+            while (indexEtats[p] != -1) p = (p + 1) % nbAlveoles;
+            indexEtats[p] = k;
+        }
+
+        // On avance jusqu'au premier état d'où un raccourci existe
+        int longueurChemin = 0, cible = -1;
+        while (i < longueur && !(jeton && atomic_load(jeton))
+               && RechercheLocale(pb, etats, indexEtats, nbAlveoles, i, chemin, &longueurChemin, &cible) == 0) {
+            i++;
+        }
+        free(etats);
+        free(indexEtats);
+        if (i >= longueur) break;
+
+        if (DEBUG_MODE) {
+            printf("DEBUG: raccourci étapes %d-%d remplacées par %d étape(s)\n", i + 1, cible, longueurChemin);
+        }
+        memmove(plan + i + longueurChemin, plan + cible, sizeof(int) * (longueur - cible));
+        memcpy(plan + i, chemin, sizeof(int) * longueurChemin);
+        longueur -= (cible - i) - longueurChemin;
+        i += longueurChemin;
+    }
+    return longueur;
+}
+
+// Raccourcit un plan valide (modifié sur place) et renvoie sa nouvelle longueur
+int OptimiserPlan(const Probleme* pb, int* plan, int longueur, bool rechercheLocale) {
+    return OptimiserPlanLimite(pb, &limitesRecherche, plan, longueur, rechercheLocale);
+}
+
+// Même optimisation, la recherche locale suivant le jeton d'annulation de 'limites'
+int OptimiserPlanLimite(const Probleme* pb, const LimitesRecherche* limites, int* plan, int longueur, bool rechercheLocale) {
+    longueur = SupprimerBoucles(pb, plan, longueur);
+    longueur = EliminerActions(pb, plan, longueur);
+    if (rechercheLocale) {
+        longueur = AmeliorerParRechercheLocale(pb, plan, longueur, limites->annulation);
+        longueur = EliminerActions(pb, plan, longueur);
+    }
+    return longueur;
+}
+
+// 5.8 - Recherche anytime (A* pondéré à poids décroissants)
+// On veut vite un premier plan, puis de meilleurs tant qu'il reste du
+// temps. On commence par une recherche gloutonne (f = h), puis on enchaîne
+// des recherches A* pondérées (f = g + w.h) avec des poids de plus en plus
+// faibles, en repartant de zéro à chaque plan amélioré. Chaque recherche
+// élague tout noeud qui ne peut pas battre le meilleur plan connu
+// (g + h >= longueur du meilleur plan). Chaque plan strictement meilleur
+// est transmis à l'appelant dès qu'il est trouvé.
+// h = nombre de faits du but encore faux, divisé par le nombre maximal de
+// faits du but qu'une action peut ajouter : h ne surestime jamais. Dès
+// qu'une recherche va jusqu'au bout (file vide), le meilleur plan connu est
+// donc prouvé optimal.
+// Avec HEURISTIQUE_REPERES et HEURISTIQUE_PDB, h est le plus grand de ce
+// minorant, du compte de repères (5.10) et des bases de motifs (5.11),
+// tous admissibles.
+// Le délai, le budget de noeuds, le budget mémoire et le jeton
+// d'annulation sont ceux de la partie 4.0.
+
+// Entrée de la file de priorité (tas binaire)
+typedef struct {
+    int f;                      // g * 10 + poids * 10 * h (poids au dixième), h seul en glouton
+    int h;
+    int g;
+    int noeud;
+} EntreeTas;
+
+typedef struct {
+    const Probleme* pb;
+    int diviseurH;              // nombre max de faits du but ajoutés par une action
+    Reperes reperes;            // repères du problème (partie 5.10), si avecReperes
+    bool avecReperes;
+    Mot* acceptes;              // repères acceptés de chaque noeud, le long de son meilleur chemin
+    BasesPdb pdb;               // bases de motifs (partie 5.11), si avecPdb
+    bool avecPdb;
+
+    // Noeuds : état, coût, parent, action
+    Mot* etats;
+    int* g;
+    int* h;
+    int* parent;
+    int* action;
+    int nbNoeuds;
+    int capacite;
+
+    // Table de hachage état -> noeud
+    int* alveoles;
+    int nbAlveoles;
+
+    EntreeTas* tas;
+    int tailleTas;
+    int capaciteTas;
+
+    // Meilleur plan connu
+    int* plan;
+    int capacitePlan;
+    int meilleureLongueur;
+
+    ControleRecherche controle;
+    bool arrete;                // délai, budget de noeuds ou annulation
+    bool memoireEpuisee;
+    RappelPlan rappel;
+    void* contexte;
+    ResultatAnytime* resultat;
+} Anytime;
+
+// Nombre max de faits du but qu'une action peut ajouter : les faits du but
+// manquants divisés par ce nombre minorent la longueur restante du plan
+static int DiviseurHeuristique(const Probleme* pb) {
+    int diviseur = 1;
+    for (int a = 0; a < pb->actionCount; a++) {
+        int utiles = 0;
+        for (int i = 0; i < pb->actions[a].addList.factCount; i++) {
+            for (int j = 0; j < pb->goal.factCount; j++) {
+                if (pb->actions[a].addList.facts[i] == pb->goal.facts[j]) {
+                    utiles++;
+                    break;
+                }
+            }
+        }
+        if (utiles > diviseur) diviseur = utiles;
+    }
+    return diviseur;
+}
+
+// Les minorants (faits du but, repères, bases de motifs) sont tous
+// admissibles : on garde le plus grand. H_IMPASSE : but inatteignable.
+static int HeuristiqueAnytime(const Anytime* at, int noeud) {
+    const Mot* etat = at->etats + (size_t)noeud * at->pb->nbMots;
+    int manquants = at->pb->goal.factCount - CalculerDistanceAuBut(etat, &at->pb->goal);
+    int h = (manquants + at->diviseurH - 1) / at->diviseurH;
+    if (at->avecReperes) {
+        int hReperes = HeuristiqueReperes(&at->reperes, etat, at->acceptes + (size_t)noeud * at->reperes.nbMots);
+        if (hReperes > h) h = hReperes;
+    }
+    if (at->avecPdb) {
+        int hPdb = HeuristiquePdb(&at->pdb, etat);
+        if (hPdb > h) h = hPdb;
+    }
+    return h;
+}
+
+// Repères acceptés et heuristique du noeud m atteint depuis n (parent -1 : racine)
+static void EvaluerNoeud(Anytime* at, int m, int n) {
+    if (at->avecReperes) {
+        const Mot* etat = at->etats + (size_t)m * at->pb->nbMots;
+        Mot* acceptes = at->acceptes + (size_t)m * at->reperes.nbMots;
+        if (n < 0) ReperesInitiaux(&at->reperes, etat, acceptes);
+        else AccepterReperes(&at->reperes, at->acceptes + (size_t)n * at->reperes.nbMots, etat, acceptes);
+    }
+    at->h[m] = HeuristiqueAnytime(at, m);
+}
+
+static bool EmpilerTas(Anytime* at, EntreeTas e) {
+    if (at->tailleTas == at->capaciteTas) {
+        int capacite = at->capaciteTas ? at->capaciteTas * 2 : 1024;
+        if (!ReserverMemoire(&at->controle, sizeof(EntreeTas) * (capacite - at->capaciteTas))) return false;
+        EntreeTas* tas = realloc(at->tas, sizeof(EntreeTas) * capacite);
+        if (!tas) return false;
+        at->tas = tas;
+        at->capaciteTas = capacite;
+    }
+    // À f égal, on préfère le noeud le plus proche du but
+    int i = at->tailleTas++;
+    while (i > 0) {
+        int p = (i - 1) / 2;
+        if (at->tas[p].f < e.f || (at->tas[p].f == e.f && at->tas[p].h <= e.h)) break;
+        at->tas[i] = at->tas[p];
+        i = p;
+    }
+    at->tas[i] = e;
+    return true;
+}
+
+static EntreeTas DepilerTas(Anytime* at) {
+    EntreeTas sommet = at->tas[0];
+    EntreeTas dernier = at->tas[--at->tailleTas];
+    int i = 0;
+    for (;;) {
+        int fils = 2 * i + 1;
+        if (fils >= at->tailleTas) break;
+        if (fils + 1 < at->tailleTas
+            && (at->tas[fils + 1].f < at->tas[fils].f
+                || (at->tas[fils + 1].f == at->tas[fils].f && at->tas[fils + 1].h < at->tas[fils].h))) {
+            fils++;
+        }
+        if (dernier.f < at->tas[fils].f || (dernier.f == at->tas[fils].f && dernier.h <= at->tas[fils].h)) break;
+        at->tas[i] = at->tas[fils];
+        i = fils;
+    }
+    if (at->tailleTas > 0) at->tas[i] = dernier;
+    return sommet;
+}
+
+// Cherche l'état dans la table ; s'il est absent, l'ajoute comme nouveau noeud.
+// Renvoie le numéro du noeud (*nouveau indique s'il vient d'être créé), -1 si plus de mémoire.
+static int TrouverOuAjouterNoeud(Anytime* at, const Mot* etat, bool* nouveau) {
+    const Probleme* pb = at->pb;
+    if ((at->nbNoeuds + 1) * 2 > at->nbAlveoles) {
+        int nbAlveoles = at->nbAlveoles ? at->nbAlveoles * 2 : 4096;
+        if (!ReserverMemoire(&at->controle, sizeof(int) * (nbAlveoles - at->nbAlveoles))) return -1;
+        int* alveoles = malloc(sizeof(int) * nbAlveoles);
+        if (!alveoles) return -1;
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int n = 0; n < at->nbNoeuds; n++) {
+            uint64_t i = HacherEtat(pb, at->etats + (size_t)n * pb->nbMots) & (nbAlveoles - 1);
+            while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = n;
+        }
+        free(at->alveoles);
+        at->alveoles = alveoles;
+        at->nbAlveoles = nbAlveoles;
+    }
+
+    uint64_t i = HacherEtat(pb, etat) & (at->nbAlveoles - 1);
+    while (at->alveoles[i] != -1) {
+        int n = at->alveoles[i];
+        if (SameState(pb, at->etats + (size_t)n * pb->nbMots, etat)) {
+            *nouveau = false;
+            return n;
+        }
+        i = (i + 1) & (at->nbAlveoles - 1);
+    }
+
+    if (at->nbNoeuds == at->capacite) {
+        int capacite = at->capacite ? at->capacite * 2 : 4096;
+        size_t parNoeud = sizeof(Mot) * (pb->nbMots + (at->avecReperes ? at->reperes.nbMots : 0)) + 4 * sizeof(int);
+        if (!ReserverMemoire(&at->controle, parNoeud * (size_t)(capacite - at->capacite))) {
+            return -1;
+        }
+        Mot* etats = realloc(at->etats, sizeof(Mot) * pb->nbMots * (size_t)capacite);
+        if (etats) at->etats = etats;
+        int* g = realloc(at->g, sizeof(int) * capacite);
+        if (g) at->g = g;
+        int* h = realloc(at->h, sizeof(int) * capacite);
+        if (h) at->h = h;
+        int* parent = realloc(at->parent, sizeof(int) * capacite);
+        if (parent) at->parent = parent;
+        int* action = realloc(at->action, sizeof(int) * capacite);
+        if (action) at->action = action;
+        if (!etats || !g || !h || !parent || !action) return -1;
+        if (at->avecReperes) {
+            Mot* acceptes = realloc(at->acceptes, sizeof(Mot) * at->reperes.nbMots * (size_t)capacite);
+            if (!acceptes) return -1;
+            at->acceptes = acceptes;
+        }
+        at->capacite = capacite;
+    }
+
+    int n = at->nbNoeuds++;
+    memcpy(at->etats + (size_t)n * pb->nbMots, etat, sizeof(Mot) * pb->nbMots);
+    at->alveoles[i] = n;
+    *nouveau = true;
+    return n;
+}
+
+// Nouveau meilleur plan : on le garde et on le transmet à l'appelant
+static void EnregistrerPlan(Anytime* at, int noeud, int derniereAction, int longueur) {
+    if (longueur > at->capacitePlan) {
+        int* plan = realloc(at->plan, sizeof(int) * longueur);
+        if (!plan) {
+            at->memoireEpuisee = true;
+            return;
+        }
+        at->plan = plan;
+        at->capacitePlan = longueur;
+    }
+    int k = longueur;
+    if (derniereAction >= 0) at->plan[--k] = derniereAction;
+    for (int n = noeud; at->parent[n] != -1; n = at->parent[n]) {
+        at->plan[--k] = at->action[n];
+    }
+    at->meilleureLongueur = longueur;
+    if (at->rappel) at->rappel(at->pb, at->plan, longueur, DureeControleMs(&at->controle), at->contexte);
+}
+
+// Priorité d'un noeud ; un poids nul désigne la recherche gloutonne (h seul)
+static int PrioriteAnytime(int g, int h, int poidsDixiemes) {
+    return poidsDixiemes == 0 ? h : g * 10 + poidsDixiemes * h;
+}
+
+// Une recherche A* pondérée ; renvoie vrai si elle est allée au bout (file
+// vide). Sauf pour le dernier poids, elle s'arrête au premier plan amélioré.
+static bool RechercheAnytimePonderee(Anytime* at, int poidsDixiemes, bool arretAuPremierPlan) {
+    const Probleme* pb = at->pb;
+    Mot* fils = NouvelEtat(pb);
+    if (!fils) {
+        at->memoireEpuisee = true;
+        return false;
+    }
+    at->nbNoeuds = 0;
+    at->tailleTas = 0;
+    if (at->alveoles) memset(at->alveoles, -1, sizeof(int) * at->nbAlveoles);
+
+    bool nouveau;
+    EtatDepuisListe(pb, &pb->initial, fils);
+    int racine = TrouverOuAjouterNoeud(at, fils, &nouveau);
+    if (racine < 0) {
+        at->memoireEpuisee = true;
+        free(fils);
+        return false;
+    }
+    at->g[racine] = 0;
+    at->parent[racine] = -1;
+    at->action[racine] = -1;
+    EvaluerNoeud(at, racine, -1);
+    if (IsGoalReached(fils, &pb->goal)) {
+        if (at->meilleureLongueur != 0) EnregistrerPlan(at, racine, -1, 0);
+        free(fils);
+        return true;
+    }
+    if (at->h[racine] >= H_IMPASSE) {
+        free(fils);
+        return true;                        // prouvé sans solution
+    }
+    EmpilerTas(at, (EntreeTas){ PrioriteAnytime(0, at->h[racine], poidsDixiemes), at->h[racine], 0, racine });
+
+    bool ameliore = false;
+    while (at->tailleTas > 0 && !ameliore) {
+        if (ControleArret(&at->controle)) {
+            at->arrete = true;
+            break;
+        }
+        EntreeTas e = DepilerTas(at);
+        int n = e.noeud;
+        if (e.g != at->g[n]) continue;      // entrée périmée (noeud réouvert depuis)
+        if (at->meilleureLongueur >= 0 && at->g[n] + at->h[n] >= at->meilleureLongueur) continue;
+        at->resultat->noeudsDeveloppes++;
+        at->controle.generes = at->nbNoeuds;
+        at->controle.profondeur = at->g[n] + at->h[n];
+        if (at->controle.meilleurH < 0 || at->h[n] < at->controle.meilleurH) at->controle.meilleurH = at->h[n];
+
+        for (int a = 0; a < pb->actionCount; a++) {
+            // Le tableau des états peut être déplacé par un ajout : on relit le parent à chaque fois
+            const Mot* etat = at->etats + (size_t)n * pb->nbMots;
+            if (!CanApply(etat, &pb->actions[a])) continue;
+            ApplyAction(pb, etat, &pb->actions[a], fils);
+            int gFils = at->g[n] + 1;
+
+            if (IsGoalReached(fils, &pb->goal)) {
+                if (at->meilleureLongueur < 0 || gFils < at->meilleureLongueur) {
+                    EnregistrerPlan(at, n, a, gFils);
+                    ameliore = arretAuPremierPlan;
+                    if (at->memoireEpuisee) break;
+                }
+                continue;
+            }
+
+            int m = TrouverOuAjouterNoeud(at, fils, &nouveau);
+            if (m < 0) {
+                at->memoireEpuisee = true;
+                break;
+            }
+            if (!nouveau && at->g[m] <= gFils) continue;
+            // Nouveau noeud, ou meilleur chemin vers un noeud connu (réouverture)
+            at->g[m] = gFils;
+            at->parent[m] = n;
+            at->action[m] = a;
+            EvaluerNoeud(at, m, n);     // les repères acceptés dépendent du chemin
+            if (at->h[m] >= H_IMPASSE) continue;
+            if (at->meilleureLongueur >= 0 && gFils + at->h[m] >= at->meilleureLongueur) continue;
+            if (!EmpilerTas(at, (EntreeTas){ PrioriteAnytime(gFils, at->h[m], poidsDixiemes), at->h[m], gFils, m })) {
+                at->memoireEpuisee = true;
+                break;
+            }
+        }
+        if (at->memoireEpuisee) break;
+    }
+    free(fils);
+    return !ameliore && !at->arrete && !at->memoireEpuisee;
+}
+
+// Lance les recherches à poids décroissants jusqu'à la preuve d'optimalité
+// ou jusqu'au délai (le plus court entre delaiMs et celui des limites
+// globales). Renvoie la longueur du meilleur plan (-1 si aucun).
+int RechercheAnytime(const Probleme* pb, double delaiMs, RappelPlan rappel, void* contexte, ResultatAnytime* resultat) {
+    return RechercheAnytimeLimitee(pb, &limitesRecherche, delaiMs, rappel, contexte, resultat);
+}
+
+// Même recherche avec d'autres limites que limitesRecherche (bibliothèque, partie 8)
+int RechercheAnytimeLimitee(const Probleme* pb, const LimitesRecherche* limitesAppel, double delaiMs, RappelPlan rappel,
+                            void* contexte, ResultatAnytime* resultat) {
+    static const int poids[] = { 0, 50, 30, 20, 15, 10 };   // en dixièmes, 0 = glouton
+    int nbPoids = (int)(sizeof(poids) / sizeof(poids[0]));
+
+    Anytime at;
+    memset(&at, 0, sizeof(at));
+    memset(resultat, 0, sizeof(*resultat));
+    at.pb = pb;
+    at.meilleureLongueur = -1;
+    at.rappel = rappel;
+    at.contexte = contexte;
+    at.resultat = resultat;
+    LimitesRecherche limites = *limitesAppel;
+    if (limites.delaiMs <= 0 || (delaiMs > 0 && delaiMs < limites.delaiMs)) limites.delaiMs = delaiMs;
+    DemarrerControle(&at.controle, &limites);
+
+    at.diviseurH = DiviseurHeuristique(pb);
+    at.avecReperes = HEURISTIQUE_REPERES && CalculerReperes(pb, &at.reperes);
+    at.avecPdb = HEURISTIQUE_PDB && PreparerBasesPdb(pb, &at.pdb);
+
+    bool prouve = false;
+    for (int k = 0; k < nbPoids && !prouve; k++) {
+        resultat->iterations++;
+        if (DEBUG_MODE) {
+            if (poids[k] == 0) printf("DEBUG: recherche anytime gloutonne\n");
+            else printf("DEBUG: recherche anytime, poids %.1f\n", poids[k] / 10.0);
+        }
+        prouve = RechercheAnytimePonderee(&at, poids[k], k < nbPoids - 1);
+        if (at.arrete || at.memoireEpuisee) break;
+    }
+
+    resultat->meilleureLongueur = at.meilleureLongueur;
+    resultat->optimal = prouve && at.meilleureLongueur >= 0;
+    resultat->sansSolution = prouve && at.meilleureLongueur < 0;
+    resultat->tempsMs = DureeControleMs(&at.controle);
+    resultat->octetsMax = at.controle.octetsMax;
+    if (prouve) {
+        resultat->issue = at.meilleureLongueur >= 0 ? ISSUE_RESOLU : ISSUE_SANS_SOLUTION;
+    } else if (at.arrete) {
+        resultat->issue = at.controle.issue;
+    } else {
+        resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    }
+
+    free(at.etats);
+    free(at.g);
+    free(at.h);
+    free(at.parent);
+    free(at.action);
+    free(at.alveoles);
+    free(at.tas);
+    free(at.plan);
+    free(at.acceptes);
+    if (at.avecReperes) LibererReperes(&at.reperes);
+    if (at.avecPdb) LibererBasesPdb(&at.pdb);
+    return resultat->meilleureLongueur;
+}
+
+// 5.9 - Replanification incrémentale (LPA*)
+// Les clients renvoient souvent le même problème avec un petit changement
+// (un fait de départ en plus ou en moins, une règle modifiée). Au lieu de
+// tout recommencer, on garde le graphe de recherche d'une requête à
+// l'autre, avec pour chaque état g (coût retenu) et rhs (coût recalculé
+// à partir des prédécesseurs). Un changement ne touche que quelques arcs :
+// on recalcule rhs aux extrémités de ces arcs, et seuls les états devenus
+// incohérents (g != rhs) repassent dans la file de priorité.
+// Le départ a toujours rhs = 0 (il est relié à une racine virtuelle) et
+// tous les états buts sont reliés par un arc de coût nul au noeud virtuel
+// NOEUD_BUT : changer de départ revient à déplacer l'arc de la racine.
+// L'heuristique (faits du but manquants, comme en 5.8) ne diminue jamais
+// de plus de 1 par action : elle est cohérente, comme LPA* le demande.
+// Si le but, le nombre de règles ou les noms des faits changent, on
+// repart de zéro.
+
+#define INFINI_LPA (INT_MAX / 4)
+#define NOEUD_BUT  0            // noeud virtuel relié à tous les états buts
+#define ARC_BUT    -1           // action d'un arc état but -> NOEUD_BUT (coût nul)
+#define ARC_RETIRE -2           // arc supprimé par la modification d'une règle
+
+typedef struct {
+    int source;
+    int cible;
+    int action;                 // numéro de l'action, ARC_BUT ou ARC_RETIRE
+    int suivantSucc;            // arc suivant parmi les successeurs de 'source'
+    int suivantPred;            // arc suivant parmi les prédécesseurs de 'cible'
+} ArcLpa;
+
+struct SessionIncrementale {
+    Probleme pb;                // problème de référence (sa numérotation des faits fait foi)
+    bool ouverte;
+    int diviseurH;
+    int depart;
+
+    // Noeuds (le noeud 0 est NOEUD_BUT)
+    Mot* etats;
+    int* g;
+    int* rhs;
+    int* h;
+    int* cle1;                  // clé dans la file : min(g, rhs) + h, puis min(g, rhs)
+    int* cle2;
+    int* position;              // position dans le tas, -1 si absent
+    int* premierSucc;
+    int* premierPred;
+    bool* developpe;            // successeurs déjà générés
+    int nbNoeuds;
+    int capacite;
+
+    int* alveoles;              // table de hachage état -> noeud
+    int nbAlveoles;
+
+    ArcLpa* arcs;
+    int nbArcs;
+    int capaciteArcs;
+
+    int* tas;
+    int tailleTas;
+    int capaciteTas;
+
+    ControleRecherche controle; // sa mémoire compte le graphe entier, gardé d'une requête à l'autre
+};
+
+static void LibererGrapheLpa(SessionIncrementale* s) {
+    free(s->etats); free(s->g); free(s->rhs); free(s->h); free(s->cle1); free(s->cle2);
+    free(s->position); free(s->premierSucc); free(s->premierPred); free(s->developpe);
+    free(s->alveoles); free(s->arcs); free(s->tas);
+    Probleme pb = s->pb;
+    bool ouverte = s->ouverte;
+    ControleRecherche controle = s->controle;
+    memset(s, 0, sizeof(*s));
+    s->pb = pb;
+    s->ouverte = ouverte;
+    s->controle = controle;
+}
+
+void InitialiserSessionIncrementale(SessionIncrementale* s) {
+    memset(s, 0, sizeof(*s));
+}
+
+void FermerSessionIncrementale(SessionIncrementale* s) {
+    LibererGrapheLpa(s);
+    if (s->ouverte) LibererProbleme(&s->pb);
+    s->ouverte = false;
+}
+
+static int HeuristiqueLpa(const SessionIncrementale* s, const Mot* etat) {
+    int manquants = s->pb.goal.factCount - CalculerDistanceAuBut(etat, &s->pb.goal);
+    return (manquants + s->diviseurH - 1) / s->diviseurH;
+}
+
+// --- File de priorité (tas binaire avec positions, pour retirer un noeud) ---
+
+static bool CleAvant(const SessionIncrementale* s, int u, int v) {
+    return s->cle1[u] < s->cle1[v] || (s->cle1[u] == s->cle1[v] && s->cle2[u] < s->cle2[v]);
+}
+
+static void PlacerTasLpa(SessionIncrementale* s, int i, int u) {
+    s->tas[i] = u;
+    s->position[u] = i;
+}
+
+static void MonterTasLpa(SessionIncrementale* s, int i) {
+    int u = s->tas[i];
+    while (i > 0 && CleAvant(s, u, s->tas[(i - 1) / 2])) {
+        PlacerTasLpa(s, i, s->tas[(i - 1) / 2]);
+        i = (i - 1) / 2;
+    }
+    PlacerTasLpa(s, i, u);
+}
+
+static void DescendreTasLpa(SessionIncrementale* s, int i) {
+    int u = s->tas[i];
+    for (;;) {
+        int fils = 2 * i + 1;
+        if (fils >= s->tailleTas) break;
+        if (fils + 1 < s->tailleTas && CleAvant(s, s->tas[fils + 1], s->tas[fils])) fils++;
+        if (!CleAvant(s, s->tas[fils], u)) break;
+        PlacerTasLpa(s, i, s->tas[fils]);
+        i = fils;
+    }
+    PlacerTasLpa(s, i, u);
+}
+
+static void RetirerTasLpa(SessionIncrementale* s, int u) {
+    int i = s->position[u];
+    s->position[u] = -1;
+    int dernier = s->tas[--s->tailleTas];
+    if (i == s->tailleTas) return;
+    PlacerTasLpa(s, i, dernier);
+    MonterTasLpa(s, s->position[dernier]);
+    DescendreTasLpa(s, s->position[dernier]);
+}
+
+static void CalculerCleLpa(SessionIncrementale* s, int u) {
+    int m = s->g[u] < s->rhs[u] ? s->g[u] : s->rhs[u];
+    s->cle1[u] = m >= INFINI_LPA ? INFINI_LPA : m + s->h[u];
+    s->cle2[u] = m;
+}
+
+static bool InsererTasLpa(SessionIncrementale* s, int u) {
+    if (s->tailleTas == s->capaciteTas) {
+        int capacite = s->capaciteTas ? s->capaciteTas * 2 : 1024;
+        if (!ReserverMemoire(&s->controle, sizeof(int) * (capacite - s->capaciteTas))) return false;
+        int* tas = realloc(s->tas, sizeof(int) * capacite);
+        if (!tas) return false;
+        s->tas = tas;
+        s->capaciteTas = capacite;
+    }
+    CalculerCleLpa(s, u);
+    s->tas[s->tailleTas] = u;
+    s->position[u] = s->tailleTas++;
+    MonterTasLpa(s, s->position[u]);
+    return true;
+}
+
+// --- Graphe ---
+
+static bool AjouterArcLpa(SessionIncrementale* s, int source, int cible, int action) {
+    if (s->nbArcs == s->capaciteArcs) {
+        int capacite = s->capaciteArcs ? s->capaciteArcs * 2 : 4096;
+        if (!ReserverMemoire(&s->controle, sizeof(ArcLpa) * (capacite - s->capaciteArcs))) return false;
+        ArcLpa* arcs = realloc(s->arcs, sizeof(ArcLpa) * capacite);
+        if (!arcs) return false;
+        s->arcs = arcs;
+        s->capaciteArcs = capacite;
+    }
+    ArcLpa* arc = &s->arcs[s->nbArcs];
+    arc->source = source;
+    arc->cible = cible;
+    arc->action = action;
+    arc->suivantSucc = s->premierSucc[source];
+    arc->suivantPred = s->premierPred[cible];
+    s->premierSucc[source] = s->nbArcs;
+    s->premierPred[cible] = s->nbArcs;
+    s->nbArcs++;
+    return true;
+}
+
+static bool AgrandirNoeudsLpa(SessionIncrementale* s) {
+    const Probleme* pb = &s->pb;
+    int capacite = s->capacite ? s->capacite * 2 : 4096;
+    size_t parNoeud = sizeof(Mot) * pb->nbMots + 9 * sizeof(int) + sizeof(bool);
+    if (!ReserverMemoire(&s->controle, parNoeud * (size_t)(capacite - s->capacite))) return false;
+    Mot* etats = realloc(s->etats, sizeof(Mot) * pb->nbMots * (size_t)capacite);
+    if (etats) s->etats = etats;
+    int** tableaux[] = { &s->g, &s->rhs, &s->h, &s->cle1, &s->cle2, &s->position, &s->premierSucc, &s->premierPred };
+    bool ok = etats != NULL;
+    for (size_t t = 0; t < sizeof(tableaux) / sizeof(tableaux[0]); t++) {
+        int* tableau = realloc(*tableaux[t], sizeof(int) * capacite);
+        if (tableau) *tableaux[t] = tableau;
+        else ok = false;
+    }
+    bool* developpe = realloc(s->developpe, sizeof(bool) * capacite);
+    if (developpe) s->developpe = developpe;
+    if (!ok || !developpe) return false;
+    s->capacite = capacite;
+    return true;
+}
+
+// Noeud de l'état (créé s'il est nouveau, relié à NOEUD_BUT si c'est un but) ; -1 si plus de mémoire
+static int NoeudLpa(SessionIncrementale* s, const Mot* etat) {
+    const Probleme* pb = &s->pb;
+    if ((s->nbNoeuds + 1) * 2 > s->nbAlveoles) {
+        int nbAlveoles = s->nbAlveoles ? s->nbAlveoles * 2 : 8192;
+        if (!ReserverMemoire(&s->controle, sizeof(int) * (nbAlveoles - s->nbAlveoles))) return -1;
+        int* alveoles = malloc(sizeof(int) * nbAlveoles);
+        if (!alveoles) return -1;
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int n = 1; n < s->nbNoeuds; n++) {
+            uint64_t i = HacherEtat(pb, s->etats + (size_t)n * pb->nbMots) & (nbAlveoles - 1);
+            while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = n;
+        }
+        free(s->alveoles);
+        s->alveoles = alveoles;
+        s->nbAlveoles = nbAlveoles;
+    }
+    uint64_t i = HacherEtat(pb, etat) & (s->nbAlveoles - 1);
+    while (s->alveoles[i] != -1) {
+        int n = s->alveoles[i];
+        if (SameState(pb, s->etats + (size_t)n * pb->nbMots, etat)) return n;
+        i = (i + 1) & (s->nbAlveoles - 1);
+    }
+
+    if (s->nbNoeuds == s->capacite && !AgrandirNoeudsLpa(s)) return -1;
+    int n = s->nbNoeuds++;
+    memcpy(s->etats + (size_t)n * pb->nbMots, etat, sizeof(Mot) * pb->nbMots);
+    s->g[n] = INFINI_LPA;
+    s->rhs[n] = INFINI_LPA;
+    s->h[n] = HeuristiqueLpa(s, etat);
+    s->position[n] = -1;
+    s->premierSucc[n] = -1;
+    s->premierPred[n] = -1;
+    s->developpe[n] = false;
+    s->alveoles[i] = n;
+    if (IsGoalReached(etat, &pb->goal) && !AjouterArcLpa(s, n, NOEUD_BUT, ARC_BUT)) return -1;
+    return n;
+}
+
+static int CoutArcLpa(const ArcLpa* arc) {
+    return arc->action == ARC_BUT ? 0 : 1;
+}
+
+// Met à jour rhs(u) à partir des prédécesseurs et replace u dans la file s'il est incohérent
+static bool MettreAJourNoeudLpa(SessionIncrementale* s, int u) {
+    if (u == s->depart) {
+        s->rhs[u] = 0;
+    } else {
+        int meilleur = INFINI_LPA;
+        for (int e = s->premierPred[u]; e != -1; e = s->arcs[e].suivantPred) {
+            const ArcLpa* arc = &s->arcs[e];
+            if (arc->action == ARC_RETIRE || s->g[arc->source] >= INFINI_LPA) continue;
+            int cout = s->g[arc->source] + CoutArcLpa(arc);
+            if (cout < meilleur) meilleur = cout;
+        }
+        s->rhs[u] = meilleur;
+    }
+    if (s->position[u] >= 0) RetirerTasLpa(s, u);
+    if (s->g[u] != s->rhs[u]) return InsererTasLpa(s, u);
+    return true;
+}
+
+// Génère une fois pour toutes les successeurs de u
+static bool DevelopperLpa(SessionIncrementale* s, int u) {
+    const Probleme* pb = &s->pb;
+    if (s->developpe[u] || u == NOEUD_BUT) return true;
+    Mot* fils = NouvelEtat(pb);
+    if (!fils) return false;
+    bool ok = true;
+    for (int a = 0; a < pb->actionCount && ok; a++) {
+        // Le tableau des états peut être déplacé par un ajout : on relit u à chaque fois
+        const Mot* etat = s->etats + (size_t)u * pb->nbMots;
+        if (!CanApply(etat, &pb->actions[a])) continue;
+        ApplyAction(pb, etat, &pb->actions[a], fils);
+        int v = NoeudLpa(s, fils);
+        ok = v >= 0 && AjouterArcLpa(s, u, v, a);
+    }
+    free(fils);
+    s->developpe[u] = ok;
+    return ok;
+}
+
+static bool MettreAJourSuccesseursLpa(SessionIncrementale* s, int u) {
+    for (int e = s->premierSucc[u]; e != -1; e = s->arcs[e].suivantSucc) {
+        if (s->arcs[e].action != ARC_RETIRE && !MettreAJourNoeudLpa(s, s->arcs[e].cible)) return false;
+    }
+    return true;
+}
+
+// Boucle principale de LPA* : développe tant que le but n'est pas cohérent
+// ou qu'un noeud de la file a une clé inférieure ou égale à la sienne
+// (égale aussi, car l'arc vers NOEUD_BUT est de coût nul : un état but
+// incohérent a la même clé que lui)
+static IssueRecherche CalculerPlusCourtChemin(SessionIncrementale* s) {
+    CalculerCleLpa(s, NOEUD_BUT);
+    while (s->tailleTas > 0
+           && (!CleAvant(s, NOEUD_BUT, s->tas[0]) || s->rhs[NOEUD_BUT] != s->g[NOEUD_BUT])) {
+        if (ControleArret(&s->controle)) return s->controle.issue;
+        int u = s->tas[0];
+        RetirerTasLpa(s, u);
+        if (!DevelopperLpa(s, u)) return ISSUE_BUDGET_MEMOIRE;
+        if (s->g[u] > s->rhs[u]) {
+            s->g[u] = s->rhs[u];            // sur-cohérent : on accepte le nouveau coût
+        } else {
+            s->g[u] = INFINI_LPA;           // sous-cohérent : le coût a augmenté, on le recalcule
+            if (!MettreAJourNoeudLpa(s, u)) return ISSUE_BUDGET_MEMOIRE;
+        }
+        if (!MettreAJourSuccesseursLpa(s, u)) return ISSUE_BUDGET_MEMOIRE;
+        CalculerCleLpa(s, NOEUD_BUT);
+    }
+    return s->g[NOEUD_BUT] < INFINI_LPA ? ISSUE_RESOLU : ISSUE_SANS_SOLUTION;
+}
+
+// Remonte de NOEUD_BUT au départ en suivant les prédécesseurs qui réalisent g
+static int ExtrairePlanLpa(const SessionIncrementale* s, int** plan) {
+    int longueur = s->g[NOEUD_BUT];
+    *plan = malloc(sizeof(int) * (longueur > 0 ? longueur : 1));
+    if (!*plan) return -1;
+    int u = NOEUD_BUT, k = longueur;
+    while (u != s->depart) {
+        int suivant = -1;
+        for (int e = s->premierPred[u]; e != -1 && suivant < 0; e = s->arcs[e].suivantPred) {
+            const ArcLpa* arc = &s->arcs[e];
+            if (arc->action == ARC_RETIRE) continue;
+            if (s->g[arc->source] + CoutArcLpa(arc) == s->g[u]) {
+                if (arc->action != ARC_BUT) {
+                    if (k == 0) break;
+                    (*plan)[--k] = arc->action;
+                }
+                suivant = arc->source;
+            }
+        }
+        if (suivant < 0) {
+            free(*plan);
+            *plan = NULL;
+            return -1;
+        }
+        u = suivant;
+    }
+    return longueur;
+}
+
+// Repart de zéro sur le problème de référence
+static bool InitialiserGrapheLpa(SessionIncrementale* s) {
+    LibererGrapheLpa(s);
+    s->controle.octets = 0;
+    s->diviseurH = DiviseurHeuristique(&s->pb);
+    if (!AgrandirNoeudsLpa(s)) return false;
+    // Noeud but virtuel
+    s->nbNoeuds = 1;
+    s->g[NOEUD_BUT] = INFINI_LPA;
+    s->rhs[NOEUD_BUT] = INFINI_LPA;
+    s->h[NOEUD_BUT] = 0;
+    s->position[NOEUD_BUT] = -1;
+    s->premierSucc[NOEUD_BUT] = -1;
+    s->premierPred[NOEUD_BUT] = -1;
+    s->developpe[NOEUD_BUT] = true;
+
+    Mot* depart = NouvelEtat(&s->pb);
+    if (!depart) return false;
+    EtatDepuisListe(&s->pb, &s->pb.initial, depart);
+    s->depart = NoeudLpa(s, depart);
+    free(depart);
+    return s->depart >= 0 && MettreAJourNoeudLpa(s, s->depart);
+}
+
+// Traduit une liste du nouveau problème dans la numérotation de référence ;
+// faux si un fait est inconnu
+static bool TraduireListe(Probleme* reference, const int* traduction, const ListeFaits* liste,
+                          ListeFaits* dest, Mot* bits) {
+    memset(bits, 0, sizeof(Mot) * reference->nbMots);
+    dest->factCount = liste->factCount;
+    dest->facts = liste->factCount > 0 ? AreneAllouer(reference, sizeof(int) * liste->factCount) : NULL;
+    if (liste->factCount > 0 && !dest->facts) return false;
+    for (int i = 0; i < liste->factCount; i++) {
+        int f = traduction[liste->facts[i]];
+        if (f < 0) return false;
+        dest->facts[i] = f;
+        METTRE_BIT(bits, f);
+    }
+    return true;
+}
+
+static bool MemesFaits(const Probleme* pb, const ListeFaits* liste, const Mot* bits, Mot* tampon) {
+    EtatDepuisListe(pb, liste, tampon);
+    return SameState(pb, tampon, bits);
+}
+
+// Compare le nouveau problème à la référence et reporte les différences
+// dans la référence : départ (*departChange) et règles modifiées
+// (changees[], leur nombre est renvoyé). Renvoie -1 s'il faut repartir
+// de zéro (but, nombre de règles ou faits différents).
+static int SynchroniserProbleme(SessionIncrementale* s, const Probleme* nouveau, int* changees, bool* departChange) {
+    Probleme* ref = &s->pb;
+    if (nouveau->actionCount != ref->actionCount) return -1;
+    int* traduction = malloc(sizeof(int) * (nouveau->faits.nbFaits > 0 ? nouveau->faits.nbFaits : 1));
+    Mot* bits = NouvelEtat(ref);
+    Mot* tampon = NouvelEtat(ref);
+    int nbChangees = -1;
+    ListeFaits liste;
+    if (!traduction || !bits || !tampon) goto fin;
+    for (int f = 0; f < nouveau->faits.nbFaits; f++) {
+        traduction[f] = ChercherFait(&ref->faits, nouveau->faits.noms[f]);
+    }
+
+    if (!TraduireListe(ref, traduction, &nouveau->goal, &liste, bits) || !MemesFaits(ref, &ref->goal, bits, tampon)) {
+        goto fin;
+    }
+    if (!TraduireListe(ref, traduction, &nouveau->initial, &liste, bits)) goto fin;
+    *departChange = !MemesFaits(ref, &ref->initial, bits, tampon);
+    if (*departChange) ref->initial = liste;
+
+    nbChangees = 0;
+    for (int a = 0; a < ref->actionCount && nbChangees >= 0; a++) {
+        const Action* an = &nouveau->actions[a];
+        Action* ar = &ref->actions[a];
+        if (!TranchesEgales(an->name, ar->name)) {
+            nbChangees = -1;
+            break;
+        }
+        ListeFaits listes[4];
+        const ListeFaits* sources[4] = { &an->preconds, &an->neg_preconds, &an->addList, &an->delList };
+        ListeFaits* cibles[4] = { &ar->preconds, &ar->neg_preconds, &ar->addList, &ar->delList };
+        bool change = false;
+        for (int l = 0; l < 4; l++) {
+            if (!TraduireListe(ref, traduction, sources[l], &listes[l], bits)) {
+                nbChangees = -1;
+                break;
+            }
+            if (!MemesFaits(ref, cibles[l], bits, tampon)) change = true;
+        }
+        if (nbChangees >= 0 && change) {
+            for (int l = 0; l < 4; l++) *cibles[l] = listes[l];
+            changees[nbChangees++] = a;
+        }
+    }
+
+fin:
+    free(traduction);
+    free(bits);
+    free(tampon);
+    return nbChangees;
+}
+
+// Répercute dans le graphe la modification de la règle a : les anciens
+// arcs de a sont retirés, les nouveaux ajoutés, pour chaque état développé
+static bool AppliquerRegleModifiee(SessionIncrementale* s, int a) {
+    const Probleme* pb = &s->pb;
+    Mot* fils = NouvelEtat(pb);
+    if (!fils) return false;
+    bool ok = true;
+    int nbNoeuds = s->nbNoeuds;         // les états créés ici ne sont pas encore développés
+    for (int u = 1; u < nbNoeuds && ok; u++) {
+        if (!s->developpe[u]) continue;
+        for (int e = s->premierSucc[u]; e != -1 && ok; e = s->arcs[e].suivantSucc) {
+            if (s->arcs[e].action != a) continue;
+            s->arcs[e].action = ARC_RETIRE;
+            ok = MettreAJourNoeudLpa(s, s->arcs[e].cible);
+        }
+        const Mot* etat = s->etats + (size_t)u * pb->nbMots;
+        if (ok && CanApply(etat, &pb->actions[a])) {
+            ApplyAction(pb, etat, &pb->actions[a], fils);
+            int v = NoeudLpa(s, fils);
+            ok = v >= 0 && AjouterArcLpa(s, u, v, a) && MettreAJourNoeudLpa(s, v);
+        }
+    }
+    free(fils);
+    return ok;
+}
+
+// Nouvelle heuristique (les règles ont changé) : on recalcule h et les clés
+static bool RecalculerHeuristiqueLpa(SessionIncrementale* s) {
+    int diviseur = DiviseurHeuristique(&s->pb);
+    if (diviseur == s->diviseurH) return true;
+    s->diviseurH = diviseur;
+    for (int u = 1; u < s->nbNoeuds; u++) s->h[u] = HeuristiqueLpa(s, s->etats + (size_t)u * s->pb.nbMots);
+    int taille = s->tailleTas;
+    s->tailleTas = 0;
+    for (int i = 0; i < taille; i++) {
+        int u = s->tas[i];
+        s->position[u] = -1;
+    }
+    for (int u = 1; u < s->nbNoeuds; u++) {
+        if (s->g[u] != s->rhs[u] && !InsererTasLpa(s, u)) return false;
+    }
+    return true;
+}
+
+// Une requête : le premier problème est résolu entièrement, les suivants
+// réparent le graphe gardé. 'nouveau' appartient ensuite à la session
+// (gardé comme référence ou libéré). Renvoie la longueur du plan le plus
+// court (plan dans *plan, à libérer) ou -1.
+int RequeteIncrementale(SessionIncrementale* s, Probleme* nouveau, int** plan, ResultatIncremental* resultat) {
+    memset(resultat, 0, sizeof(*resultat));
+    resultat->longueur = -1;
+    resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    *plan = NULL;
+
+    size_t octets = s->controle.octets;
+    DemarrerControle(&s->controle, &limitesRecherche);
+    s->controle.octets = octets;
+
+    int* changees = malloc(sizeof(int) * (nouveau->actionCount > 0 ? nouveau->actionCount : 1));
+    int nbChangees = -1;
+    bool departChange = false;
+    if (changees && s->ouverte && s->nbNoeuds > 0) {
+        nbChangees = SynchroniserProbleme(s, nouveau, changees, &departChange);
+    }
+
+    bool ok = true;
+    if (nbChangees < 0) {
+        // Première requête ou changement trop profond : on repart de zéro
+        if (s->ouverte) LibererProbleme(&s->pb);
+        s->pb = *nouveau;
+        s->ouverte = true;
+        resultat->reconstruit = true;
+        ok = InitialiserGrapheLpa(s);
+    } else {
+        LibererProbleme(nouveau);
+        resultat->departChange = departChange;
+        resultat->reglesChangees = nbChangees;
+        for (int i = 0; i < nbChangees && ok; i++) ok = AppliquerRegleModifiee(s, changees[i]);
+        if (ok && nbChangees > 0) ok = RecalculerHeuristiqueLpa(s);
+        if (ok && departChange) {
+            Mot* depart = NouvelEtat(&s->pb);
+            int ancien = s->depart;
+            if (depart) {
+                EtatDepuisListe(&s->pb, &s->pb.initial, depart);
+                s->depart = NoeudLpa(s, depart);
+            }
+            free(depart);
+            ok = depart && s->depart >= 0 && MettreAJourNoeudLpa(s, ancien) && MettreAJourNoeudLpa(s, s->depart);
+        }
+    }
+    free(changees);
+
+    if (ok) resultat->issue = CalculerPlusCourtChemin(s);
+    if (resultat->issue == ISSUE_RESOLU) {
+        resultat->longueur = ExtrairePlanLpa(s, plan);
+        if (resultat->longueur < 0) resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    }
+    if (!ok) {
+        // Graphe incomplet : la prochaine requête repartira de zéro
+        LibererGrapheLpa(s);
+    }
+    resultat->developpes = s->controle.noeuds;
+    resultat->noeudsGraphe = s->nbNoeuds > 0 ? s->nbNoeuds - 1 : 0;
+    resultat->tempsMs = DureeControleMs(&s->controle);
+    return resultat->longueur;
+}
+
+// 5.10 - Repères (landmarks) et heuristique du compte de repères
+// Un repère est un fait vrai à un moment de tout plan (les faits du but
+// en sont). On les trouve en remontant depuis le but dans le problème
+// relâché (sans suppressions ni préconditions négatives) :
+//  - les "premiers producteurs" d'un repère L sont les actions qui
+//    l'ajoutent et qui sont applicables sans que L ait jamais été vrai.
+//    L'un d'eux rend L vrai la première fois : ensemble, ils forment un
+//    repère d'actions disjonctif ;
+//  - une précondition commune à tous ces producteurs est vraie juste
+//    avant L : c'est aussi un repère, ordonné avant L.
+// Pendant la recherche, chaque noeud garde l'ensemble de ses repères
+// "acceptés" (atteints le long du chemin, après tous ceux qui les
+// précèdent). Il reste à atteindre les repères non acceptés, plus les
+// repères acceptés mais redevenus faux qui sont dans le but ou qui
+// précèdent un repère non accepté. Une action ajoute au plus 'diviseur'
+// repères : le compte divisé par 'diviseur' ne surestime donc jamais la
+// longueur du reste du plan.
+
+// Index des actions par fait (préconditions ou ajouts) :
+// actions de f = liste[debut[f] .. debut[f + 1][
+typedef struct {
+    int* debut;
+    int* liste;
+} IndexActions;
+
+static bool IndexerActions(const Probleme* pb, bool parAjouts, IndexActions* index) {
+    int nbFaits = pb->faits.nbFaits;
+    int total = 0;
+    for (int a = 0; a < pb->actionCount; a++) {
+        total += parAjouts ? pb->actions[a].addList.factCount : pb->actions[a].preconds.factCount;
+    }
+    index->debut = calloc(nbFaits + 1, sizeof(int));
+    index->liste = malloc(sizeof(int) * (total > 0 ? total : 1));
+    int* position = malloc(sizeof(int) * (nbFaits + 1));
+    if (!index->debut || !index->liste || !position) {
+        free(position);
+        return false;
+    }
+    for (int a = 0; a < pb->actionCount; a++) {
+        const ListeFaits* l = parAjouts ? &pb->actions[a].addList : &pb->actions[a].preconds;
+        for (int i = 0; i < l->factCount; i++) index->debut[l->facts[i] + 1]++;
+    }
+    for (int f = 0; f < nbFaits; f++) index->debut[f + 1] += index->debut[f];
+    memcpy(position, index->debut, sizeof(int) * (nbFaits + 1));
+    for (int a = 0; a < pb->actionCount; a++) {
+        const ListeFaits* l = parAjouts ? &pb->actions[a].addList : &pb->actions[a].preconds;
+        for (int i = 0; i < l->factCount; i++) index->liste[position[l->facts[i]]++] = a;
+    }
+    free(position);
+    return true;
+}
+
+static void LibererIndexActions(IndexActions* index) {
+    free(index->debut);
+    free(index->liste);
+}
+
+// Recherche des repères : tampons de l'analyse relâchée
+typedef struct {
+    const Probleme* pb;
+    IndexActions utilisateurs;  // actions par précondition
+    IndexActions producteurs;   // actions par fait ajouté
+    bool* atteint;
+    int* restants;              // préconditions pas encore atteintes, par action
+    int* file;
+} AnalyseRelachee;
+
+// Action devenue applicable : ses ajouts sont atteints, sauf si elle produit 'exclu'
+static void DeclencherAction(AnalyseRelachee* ar, int a, int exclu, int* fin) {
+    const ListeFaits* ajouts = &ar->pb->actions[a].addList;
+    for (int i = 0; i < ajouts->factCount; i++) {
+        if (ajouts->facts[i] == exclu) return;
+    }
+    for (int i = 0; i < ajouts->factCount; i++) {
+        int f = ajouts->facts[i];
+        if (!ar->atteint[f]) {
+            ar->atteint[f] = true;
+            ar->file[(*fin)++] = f;
+        }
+    }
+}
+
+// Faits atteignables dans le problème relâché sans jamais utiliser une
+// action qui ajoute 'exclu'. Ensuite, restants[a] == 0 si a est applicable.
+static void AtteindreRelache(AnalyseRelachee* ar, int exclu) {
+    const Probleme* pb = ar->pb;
+    int debut = 0, fin = 0;
+    memset(ar->atteint, 0, sizeof(bool) * pb->faits.nbFaits);
+    for (int i = 0; i < pb->initial.factCount; i++) {
+        int f = pb->initial.facts[i];
+        if (f != exclu && !ar->atteint[f]) {
+            ar->atteint[f] = true;
+            ar->file[fin++] = f;
+        }
+    }
+    for (int a = 0; a < pb->actionCount; a++) {
+        ar->restants[a] = pb->actions[a].preconds.factCount;
+        if (ar->restants[a] == 0) DeclencherAction(ar, a, exclu, &fin);
+    }
+    while (debut < fin) {
+        int f = ar->file[debut++];
+        for (int k = ar->utilisateurs.debut[f]; k < ar->utilisateurs.debut[f + 1]; k++) {
+            int a = ar->utilisateurs.liste[k];
+            if (--ar->restants[a] == 0) DeclencherAction(ar, a, exclu, &fin);
+        }
+    }
+}
+
+// Ajoute un entier à un tableau extensible
+static bool AjouterEntier(int** tableau, int* nb, int* capacite, int valeur) {
+    if (*nb == *capacite) {
+        int nouvelle = *capacite ? *capacite * 2 : 64;
+        int* t = realloc(*tableau, sizeof(int) * nouvelle);
+        if (!t) return false;
+        *tableau = t;
+        *capacite = nouvelle;
+    }
+    (*tableau)[(*nb)++] = valeur;
+    return true;
+}
+
+// Range les couples (de[k], vers[k]) en listes par repère : debut[i] .. debut[i + 1][
+static bool RangerParRepere(int nbReperes, const int* de, const int* vers, int nb, int** debut, int** liste) {
+    *debut = calloc(nbReperes + 1, sizeof(int));
+    *liste = malloc(sizeof(int) * (nb > 0 ? nb : 1));
+    if (!*debut || !*liste) return false;
+    for (int k = 0; k < nb; k++) (*debut)[de[k] + 1]++;
+    for (int i = 0; i < nbReperes; i++) (*debut)[i + 1] += (*debut)[i];
+    int* position = malloc(sizeof(int) * (nbReperes + 1));
+    if (!position) return false;
+    memcpy(position, *debut, sizeof(int) * (nbReperes + 1));
+    for (int k = 0; k < nb; k++) (*liste)[position[de[k]]++] = vers[k];
+    free(position);
+    return true;
+}
+
+void LibererReperes(Reperes* r) {
+    free(r->fait);
+    free(r->repereDuFait);
+    free(r->debutAvant);
+    free(r->avant);
+    free(r->debutApres);
+    free(r->apres);
+    free(r->debutProducteurs);
+    free(r->producteurs);
+    free(r->but);
+    memset(r, 0, sizeof(*r));
+}
+
+// Découvre les repères du problème et leurs ordres ; faux si plus de mémoire
+bool CalculerReperes(const Probleme* pb, Reperes* r) {
+    memset(r, 0, sizeof(*r));
+    int nbFaits = pb->faits.nbFaits;
+    AnalyseRelachee ar;
+    memset(&ar, 0, sizeof(ar));
+    ar.pb = pb;
+    ar.atteint = malloc(sizeof(bool) * (nbFaits > 0 ? nbFaits : 1));
+    ar.restants = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    ar.file = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+    int* compte = calloc(nbFaits > 0 ? nbFaits : 1, sizeof(int));
+    int* marque = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+    Mot* initial = NouvelEtat(pb);
+    r->repereDuFait = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+
+    // Couples collectés avant d'être rangés par repère
+    int *ordreAvant = NULL, *ordreApres = NULL, nbOrdres = 0, capOrdresAvant = 0, capOrdresApres = 0, nbOrdresApres = 0;
+    int *prodRepere = NULL, *prodAction = NULL, nbProd = 0, capProdRepere = 0, capProdAction = 0, nbProdAction = 0;
+    int capReperes = 0;
+    bool ok = ar.atteint && ar.restants && ar.file && compte && marque && initial && r->repereDuFait
+              && IndexerActions(pb, false, &ar.utilisateurs) && IndexerActions(pb, true, &ar.producteurs);
+    if (ok) {
+        memset(r->repereDuFait, -1, sizeof(int) * nbFaits);
+        memset(marque, -1, sizeof(int) * nbFaits);
+        EtatDepuisListe(pb, &pb->initial, initial);
+        for (int i = 0; i < pb->goal.factCount && ok; i++) {
+            int f = pb->goal.facts[i];
+            if (r->repereDuFait[f] >= 0) continue;
+            r->repereDuFait[f] = r->nbReperes;
+            ok = AjouterEntier(&r->fait, &r->nbReperes, &capReperes, f);
+        }
+    }
+
+    // Les repères forment eux-mêmes la file de la remontée
+    for (int l = 0; ok && l < r->nbReperes; l++) {
+        int f = r->fait[l];
+        if (TEST_BIT(initial, f)) continue;     // déjà vrai au départ : rien à remonter
+        AtteindreRelache(&ar, f);
+        int nbPremiers = 0;
+        for (int k = ar.producteurs.debut[f]; k < ar.producteurs.debut[f + 1] && ok; k++) {
+            int a = ar.producteurs.liste[k];
+            if (ar.restants[a] != 0) continue;
+            nbPremiers++;
+            ok = AjouterEntier(&prodRepere, &nbProd, &capProdRepere, l)
+                 && AjouterEntier(&prodAction, &nbProdAction, &capProdAction, a);
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            for (int i = 0; i < pre->factCount; i++) {
+                int p = pre->facts[i];
+                if (marque[p] == a) continue;   // précondition en double
+                marque[p] = a;
+                compte[p]++;
+            }
+        }
+        // Préconditions communes à tous les premiers producteurs
+        for (int k = ar.producteurs.debut[f]; k < ar.producteurs.debut[f + 1] && ok; k++) {
+            int a = ar.producteurs.liste[k];
+            if (ar.restants[a] != 0) continue;
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            for (int i = 0; i < pre->factCount && ok; i++) {
+                int p = pre->facts[i];
+                if (compte[p] == nbPremiers && p != f) {
+                    if (r->repereDuFait[p] < 0) {
+                        r->repereDuFait[p] = r->nbReperes;
+                        ok = AjouterEntier(&r->fait, &r->nbReperes, &capReperes, p);
+                    }
+                    ok = ok && AjouterEntier(&ordreAvant, &nbOrdres, &capOrdresAvant, r->repereDuFait[p])
+                            && AjouterEntier(&ordreApres, &nbOrdresApres, &capOrdresApres, l);
+                }
+                compte[p] = 0;
+            }
+        }
+        for (int k = ar.producteurs.debut[f]; k < ar.producteurs.debut[f + 1]; k++) {
+            int a = ar.producteurs.liste[k];
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            for (int i = 0; i < pre->factCount; i++) {
+                compte[pre->facts[i]] = 0;
+                marque[pre->facts[i]] = -1;
+            }
+        }
+    }
+
+    if (ok) {
+        r->nbMots = (r->nbReperes + BITS_PAR_MOT - 1) / BITS_PAR_MOT;
+        if (r->nbMots == 0) r->nbMots = 1;
+        r->but = calloc(r->nbMots, sizeof(Mot));
+        ok = r->but
+             && RangerParRepere(r->nbReperes, ordreApres, ordreAvant, nbOrdres, &r->debutAvant, &r->avant)
+             && RangerParRepere(r->nbReperes, ordreAvant, ordreApres, nbOrdres, &r->debutApres, &r->apres)
+             && RangerParRepere(r->nbReperes, prodRepere, prodAction, nbProd, &r->debutProducteurs, &r->producteurs);
+    }
+    if (ok) {
+        r->nbOrdres = nbOrdres;
+        for (int i = 0; i < pb->goal.factCount; i++) METTRE_BIT(r->but, r->repereDuFait[pb->goal.facts[i]]);
+        r->diviseur = 1;
+        for (int a = 0; a < pb->actionCount; a++) {
+            int utiles = 0;
+            const ListeFaits* ajouts = &pb->actions[a].addList;
+            for (int i = 0; i < ajouts->factCount; i++) {
+                int l = r->repereDuFait[ajouts->facts[i]];
+                if (l < 0 || marque[ajouts->facts[i]] == a) continue;
+                marque[ajouts->facts[i]] = a;
+                utiles++;
+            }
+            if (utiles > r->diviseur) r->diviseur = utiles;
+        }
+    }
+
+    free(ordreAvant);
+    free(ordreApres);
+    free(prodRepere);
+    free(prodAction);
+    free(ar.atteint);
+    free(ar.restants);
+    free(ar.file);
+    LibererIndexActions(&ar.utilisateurs);
+    LibererIndexActions(&ar.producteurs);
+    free(compte);
+    free(marque);
+    free(initial);
+    if (!ok) LibererReperes(r);
+    return ok;
+}
+
+// Repères acceptés dans l'état initial : ceux qui y sont vrais
+void ReperesInitiaux(const Reperes* r, const Mot* etat, Mot* acceptes) {
+    memset(acceptes, 0, sizeof(Mot) * r->nbMots);
+    for (int l = 0; l < r->nbReperes; l++) {
+        if (TEST_BIT(etat, r->fait[l])) METTRE_BIT(acceptes, l);
+    }
+}
+
+// Repères acceptés d'un fils : ceux du parent, plus ceux devenus vrais
+// dont tous les prédécesseurs étaient déjà acceptés
+void AccepterReperes(const Reperes* r, const Mot* acceptesParent, const Mot* etat, Mot* acceptes) {
+    memcpy(acceptes, acceptesParent, sizeof(Mot) * r->nbMots);
+    for (int l = 0; l < r->nbReperes; l++) {
+        if (TEST_BIT(acceptesParent, l) || !TEST_BIT(etat, r->fait[l])) continue;
+        bool pret = true;
+        for (int k = r->debutAvant[l]; k < r->debutAvant[l + 1] && pret; k++) {
+            pret = TEST_BIT(acceptesParent, r->avant[k]);
+        }
+        if (pret) METTRE_BIT(acceptes, l);
+    }
+}
+
+// Nombre de repères encore à atteindre
+int CompterReperes(const Reperes* r, const Mot* etat, const Mot* acceptes) {
+    int nb = 0;
+    for (int l = 0; l < r->nbReperes; l++) {
+        if (!TEST_BIT(acceptes, l)) {
+            nb++;
+        } else if (!TEST_BIT(etat, r->fait[l])) {
+            // Accepté mais redevenu faux : à refaire s'il est dans le but
+            // ou s'il doit précéder un repère pas encore accepté
+            bool requis = TEST_BIT(r->but, l);
+            for (int k = r->debutApres[l]; k < r->debutApres[l + 1] && !requis; k++) {
+                requis = !TEST_BIT(acceptes, r->apres[k]);
+            }
+            nb += requis;
+        }
+    }
+    return nb;
+}
+
+// Minorant de la longueur du reste du plan
+int HeuristiqueReperes(const Reperes* r, const Mot* etat, const Mot* acceptes) {
+    return (CompterReperes(r, etat, acceptes) + r->diviseur - 1) / r->diviseur;
+}
+
+// 5.11 - Bases de motifs (pattern databases) avec cache sur disque
+// Un motif est un petit ensemble de faits (au plus TAILLE_MOTIF_PDB). En
+// ne regardant que ces faits, le problème devient assez petit pour
+// calculer une fois pour toutes la distance exacte au but de chacun de
+// ses 2^k états abstraits (recherche arrière exhaustive). Cette distance
+// minore la vraie distance : c'est une heuristique admissible.
+// Les motifs sont construits autour des faits du but : on ajoute les
+// faits dont dépendent les actions qui produisent ceux déjà pris.
+// Pour pouvoir additionner les bases, chaque action ne coûte 1 que dans
+// le premier motif qu'elle modifie, 0 dans les suivants : la somme
+// reste admissible (et cohérente).
+// Les tables ne dépendent pas du départ : elles sont rangées dans un
+// fichier nommé d'après un hachage du domaine (faits, règles, but) et
+// projetées en mémoire (mmap) aux recherches suivantes.
+
+#define TAILLE_MOTIF_PDB 16
+#define PDB_INFINI 255          // état abstrait sans chemin vers le but
+
+typedef struct {
+    char magie[8];              // "GPSPDB1"
+    uint64_t cle;               // hachage du domaine
+    int32_t nbMotifs;
+    int32_t nbFaits;            // faits de tous les motifs
+} EnTetePdb;
+
+static size_t AlignerPdb(size_t taille) {
+    return (taille + 7) & ~(size_t)7;
+}
+
+// Hachage du domaine : noms des faits, règles et but (pas le départ)
+uint64_t HacherDomaine(const Probleme* pb) {
+    uint64_t h = Melanger64(0x5044424756ULL ^ TAILLE_MOTIF_PDB);
+    for (int f = 0; f < pb->faits.nbFaits; f++) {
+        h = Melanger64(h ^ HacherTranche(pb->faits.noms[f]));
+    }
+    for (int a = 0; a < pb->actionCount; a++) {
+        const ListeFaits* listes[4] = { &pb->actions[a].preconds, &pb->actions[a].neg_preconds,
+                                        &pb->actions[a].addList, &pb->actions[a].delList };
+        for (int l = 0; l < 4; l++) {
+            h = Melanger64(h ^ (0xA000000ULL + (uint64_t)l));
+            for (int i = 0; i < listes[l]->factCount; i++) h = Melanger64(h ^ (uint64_t)listes[l]->facts[i]);
+        }
+    }
+    h = Melanger64(h ^ 0xB000000ULL);
+    for (int i = 0; i < pb->goal.factCount; i++) h = Melanger64(h ^ (uint64_t)pb->goal.facts[i]);
+    return h;
+}
+
+// Relie les pointeurs de 'bases' au bloc donnees (construit ou projeté).
+// Le bloc peut venir d'un fichier tronqué ou abîmé : les compteurs de
+// l'en-tête sont confrontés à sa taille avant toute lecture des tableaux,
+// et chaque fait des motifs doit être un fait du problème (nbFaitsProbleme)
+static bool DecouperBasesPdb(BasesPdb* bases, int nbFaitsProbleme) {
+    const EnTetePdb* entete = (const EnTetePdb*)bases->donnees;
+    if (bases->taille < sizeof(EnTetePdb) || memcmp(entete->magie, "GPSPDB1", 8) != 0) return false;
+    if (entete->nbMotifs < 0 || entete->nbFaits < 0) return false;
+    size_t nbEntiers = (size_t)entete->nbMotifs + (size_t)entete->nbFaits;
+    if (nbEntiers > (bases->taille - sizeof(EnTetePdb)) / sizeof(int32_t)) return false;
+    bases->cle = entete->cle;
+    bases->nbMotifs = entete->nbMotifs;
+    bases->tailles = (const int32_t*)(bases->donnees + sizeof(EnTetePdb));
+    bases->faits = bases->tailles + bases->nbMotifs;
+    size_t position = AlignerPdb(sizeof(EnTetePdb) + sizeof(int32_t) * nbEntiers);
+    long faitsMotifs = 0;
+    for (int m = 0; m < bases->nbMotifs; m++) {
+        if (bases->tailles[m] < 0 || bases->tailles[m] > TAILLE_MOTIF_PDB) return false;
+        faitsMotifs += bases->tailles[m];
+    }
+    if (faitsMotifs != entete->nbFaits) return false;
+    for (int i = 0; i < entete->nbFaits; i++) {
+        if (bases->faits[i] < 0 || bases->faits[i] >= nbFaitsProbleme) return false;
+    }
+    bases->tables = malloc(sizeof(uint8_t*) * (bases->nbMotifs > 0 ? bases->nbMotifs : 1));
+    if (!bases->tables) return false;
+    for (int m = 0; m < bases->nbMotifs; m++) {
+        bases->tables[m] = bases->donnees + position;
+        position += (size_t)1 << bases->tailles[m];
+    }
+    return position <= bases->taille;
+}
+
+// Choix des motifs : chacun part d'un fait du but pas encore couvert.
+// On y ajoute d'abord ses "voisins" (faits qu'une action échange avec
+// lui : supprimés quand il est ajouté, ou ajoutés quand il est supprimé,
+// souvent les autres valeurs d'une même variable), puis les préconditions
+// des actions qui le produisent, dans l'ordre où on les rencontre
+static int ChoisirMotifs(const Probleme* pb, int* tailles, int* faits) {
+    int nbFaits = pb->faits.nbFaits;
+    int* marque = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+    int* attente = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+    bool* couvert = calloc(nbFaits > 0 ? nbFaits : 1, sizeof(bool));
+    if (!marque || !attente || !couvert) {
+        free(marque);
+        free(attente);
+        free(couvert);
+        return -1;
+    }
+    memset(marque, -1, sizeof(int) * nbFaits);
+    int nbMotifs = 0, total = 0;
+    for (int i = 0; i < pb->goal.factCount; i++) {
+        int depart = pb->goal.facts[i];
+        if (couvert[depart]) continue;
+        int* motif = faits + total;
+        int k = 0, lu = 0, nbAttente = 0, attenteLue = 0;
+        motif[k++] = depart;
+        marque[depart] = nbMotifs;
+        while (k < TAILLE_MOTIF_PDB) {
+            if (lu == k) {
+                // Plus de voisins : on prend la prochaine précondition en attente
+                while (attenteLue < nbAttente && marque[attente[attenteLue]] == nbMotifs) attenteLue++;
+                if (attenteLue == nbAttente) break;
+                marque[attente[attenteLue]] = nbMotifs;
+                motif[k++] = attente[attenteLue++];
+                continue;
+            }
+            int f = motif[lu++];
+            for (int a = 0; a < pb->actionCount && k < TAILLE_MOTIF_PDB; a++) {
+                const Action* action = &pb->actions[a];
+                bool ajoute = false, supprime = false;
+                for (int j = 0; j < action->addList.factCount; j++) ajoute |= action->addList.facts[j] == f;
+                for (int j = 0; j < action->delList.factCount; j++) supprime |= action->delList.facts[j] == f;
+                const ListeFaits* voisins = ajoute ? &action->delList : supprime ? &action->addList : NULL;
+                for (int j = 0; voisins && j < voisins->factCount && k < TAILLE_MOTIF_PDB; j++) {
+                    int v = voisins->facts[j];
+                    if (marque[v] == nbMotifs) continue;
+                    marque[v] = nbMotifs;
+                    motif[k++] = v;
+                }
+                for (int j = 0; ajoute && j < action->preconds.factCount; j++) {
+                    int p = action->preconds.facts[j];
+                    if (marque[p] != nbMotifs && nbAttente < nbFaits) attente[nbAttente++] = p;
+                }
+            }
+        }
+        for (int j = 0; j < k; j++) couvert[motif[j]] = true;
+        tailles[nbMotifs++] = k;
+        total += k;
+    }
+    free(marque);
+    free(attente);
+    free(couvert);
+    return nbMotifs;
+}
+
+// Numéro de l'état abstrait : bit j = fait motif[j]
+static uint32_t IndexMotif(const Mot* etat, const int32_t* motif, int k) {
+    uint32_t index = 0;
+    for (int j = 0; j < k; j++) index |= (uint32_t)TEST_BIT(etat, motif[j]) << j;
+    return index;
+}
+
+static uint32_t MasqueMotif(const ListeFaits* liste, const int* position) {
+    uint32_t masque = 0;
+    for (int i = 0; i < liste->factCount; i++) {
+        if (position[liste->facts[i]] >= 0) masque |= (uint32_t)1 << position[liste->facts[i]];
+    }
+    return masque;
+}
+
+// Action projetée sur un motif
+typedef struct {
+    uint32_t pre, neg, ajout, retrait;
+    int cout;                   // 1 dans le premier motif que l'action modifie, 0 ensuite
+} ActionMotif;
+
+// Distances au but de tous les états abstraits d'un motif, par un
+// parcours arrière couche par couche : un arc de coût nul reste dans la
+// couche courante, un arc de coût 1 va dans la suivante
+static bool RemplirTableMotif(const Probleme* pb, const int32_t* motif, int k, bool* actionPayee, uint8_t* table) {
+    int nbFaits = pb->faits.nbFaits;
+    uint32_t nbEtats = (uint32_t)1 << k;
+    int* position = malloc(sizeof(int) * (nbFaits > 0 ? nbFaits : 1));
+    ActionMotif* actions = malloc(sizeof(ActionMotif) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    uint32_t* debut = calloc((size_t)nbEtats + 1, sizeof(uint32_t));
+    uint32_t* courante = malloc(sizeof(uint32_t) * nbEtats);
+    uint32_t* suivante = malloc(sizeof(uint32_t) * nbEtats);
+    int* distance = malloc(sizeof(int) * nbEtats);
+    uint32_t* arcs = NULL;
+    bool ok = position && actions && debut && courante && suivante && distance;
+    if (!ok) goto fin;
+
+    memset(position, -1, sizeof(int) * nbFaits);
+    for (int j = 0; j < k; j++) position[motif[j]] = j;
+    int nbActions = 0;
+    for (int a = 0; a < pb->actionCount; a++) {
+        const Action* action = &pb->actions[a];
+        ActionMotif am = { MasqueMotif(&action->preconds, position), MasqueMotif(&action->neg_preconds, position),
+                           MasqueMotif(&action->addList, position), MasqueMotif(&action->delList, position), 0 };
+        if (am.ajout == 0 && am.retrait == 0) continue;     // sans effet sur ce motif
+        am.cout = actionPayee[a] ? 0 : 1;
+        actionPayee[a] = true;
+        actions[nbActions++] = am;
+    }
+
+    // Arcs inversés, rangés par état d'arrivée : on compte, puis on range
+    // (source << 1 | coût)
+    for (int passe = 0; passe < 2 && ok; passe++) {
+        for (uint32_t s = 0; s < nbEtats; s++) {
+            for (int i = 0; i < nbActions; i++) {
+                const ActionMotif* am = &actions[i];
+                if ((s & am->pre) != am->pre || (s & am->neg) != 0) continue;
+                uint32_t t = (s & ~am->retrait) | am->ajout;
+                if (t == s) continue;
+                if (passe == 0) debut[t + 1]++;
+                else arcs[debut[t]++] = s << 1 | (uint32_t)am->cout;
+            }
+        }
+        if (passe == 0) {
+            for (uint32_t s = 0; s < nbEtats; s++) debut[s + 1] += debut[s];
+            arcs = malloc(sizeof(uint32_t) * (debut[nbEtats] > 0 ? debut[nbEtats] : 1));
+            ok = arcs != NULL;
+        }
+    }
+    if (!ok) goto fin;
+    // La seconde passe a avancé chaque debut[t] jusqu'au debut[t + 1] d'origine
+    for (uint32_t s = nbEtats; s > 0; s--) debut[s] = debut[s - 1];
+    debut[0] = 0;
+
+    // Couche 0 : les états abstraits qui contiennent le but projeté
+    uint32_t but = MasqueMotif(&pb->goal, position);
+    uint32_t nbCourante = 0;
+    for (uint32_t s = 0; s < nbEtats; s++) {
+        distance[s] = (s & but) == but ? 0 : INT_MAX;
+        if (distance[s] == 0) courante[nbCourante++] = s;
+    }
+    for (int d = 0; nbCourante > 0; d++) {
+        uint32_t nbSuivante = 0;
+        for (uint32_t i = 0; i < nbCourante; i++) {
+            uint32_t t = courante[i];
+            if (distance[t] != d) continue;     // entrée périmée
+            for (uint32_t e = debut[t]; e < debut[t + 1]; e++) {
+                uint32_t s = arcs[e] >> 1;
+                int cout = (int)(arcs[e] & 1);
+                if (d + cout >= distance[s]) continue;
+                distance[s] = d + cout;
+                if (cout == 0) courante[nbCourante++] = s;
+                else suivante[nbSuivante++] = s;
+            }
+        }
+        uint32_t* echange = courante;
+        courante = suivante;
+        suivante = echange;
+        nbCourante = nbSuivante;
+    }
+    // Au-delà de 254, on garde 254 : la table reste un minorant
+    for (uint32_t s = 0; s < nbEtats; s++) {
+        if (distance[s] == INT_MAX) table[s] = PDB_INFINI;
+        else table[s] = (uint8_t)(distance[s] < PDB_INFINI - 1 ? distance[s] : PDB_INFINI - 1);
+    }
+
+fin:
+    free(position);
+    free(actions);
+    free(debut);
+    free(courante);
+    free(suivante);
+    free(distance);
+    free(arcs);
+    return ok;
+}
+
+// Construit toutes les tables en mémoire, au format du fichier
+static bool ConstruireBasesPdb(const Probleme* pb, BasesPdb* bases) {
+    int* tailles = malloc(sizeof(int) * (pb->goal.factCount > 0 ? pb->goal.factCount : 1));
+    int* faits = malloc(sizeof(int) * ((size_t)pb->goal.factCount * TAILLE_MOTIF_PDB + 1));
+    bool* actionPayee = calloc(pb->actionCount > 0 ? pb->actionCount : 1, sizeof(bool));
+    bool ok = tailles && faits && actionPayee;
+    int nbMotifs = ok ? ChoisirMotifs(pb, tailles, faits) : -1;
+    ok = nbMotifs >= 0;
+
+    if (ok) {
+        int nbFaits = 0;
+        for (int m = 0; m < nbMotifs; m++) nbFaits += tailles[m];
+        size_t taille = AlignerPdb(sizeof(EnTetePdb) + sizeof(int32_t) * ((size_t)nbMotifs + nbFaits));
+        for (int m = 0; m < nbMotifs; m++) taille += (size_t)1 << tailles[m];
+        bases->donnees = calloc(taille, 1);
+        bases->taille = taille;
+        ok = bases->donnees != NULL;
+        if (ok) {
+            EnTetePdb entete;
+            memset(&entete, 0, sizeof(entete));
+            memcpy(entete.magie, "GPSPDB1", 8);
+            entete.cle = HacherDomaine(pb);
+            entete.nbMotifs = nbMotifs;
+            entete.nbFaits = nbFaits;
+            memcpy(bases->donnees, &entete, sizeof(entete));
+            int32_t* ecrits = (int32_t*)(bases->donnees + sizeof(EnTetePdb));
+            for (int m = 0; m < nbMotifs; m++) ecrits[m] = tailles[m];
+            for (int i = 0; i < nbFaits; i++) ecrits[nbMotifs + i] = faits[i];
+            ok = DecouperBasesPdb(bases, pb->faits.nbFaits);
+        }
+        const int32_t* motif = bases->faits;
+        for (int m = 0; m < nbMotifs && ok; m++) {
+            ok = RemplirTableMotif(pb, motif, bases->tailles[m], actionPayee, (uint8_t*)bases->tables[m]);
+            motif += bases->tailles[m];
+        }
+    }
+    if (!ok) LibererBasesPdb(bases);
+    free(tailles);
+    free(faits);
+    free(actionPayee);
+    return ok;
+}
+
+void LibererBasesPdb(BasesPdb* bases) {
+    if (bases->projete) {
+#ifdef _WIN32
+        free(bases->donnees);
+#else
+        munmap(bases->donnees, bases->taille);
+#endif
+    } else {
+        free(bases->donnees);
+    }
+    free(bases->tables);
+    memset(bases, 0, sizeof(*bases));
+}
+
+static bool EnregistrerBasesPdb(const BasesPdb* bases, const char* chemin) {
+    // Écriture dans un fichier temporaire renommé à la fin : une recherche
+    // concurrente ne projette jamais un fichier à moitié écrit
+    char temporaire[MAX_LEN * 2 + 48];
+    NomTemporaire(temporaire, sizeof(temporaire), chemin);
+    FILE* fp = fopen(temporaire, "wb");
+    if (!fp) return false;
+    bool ok = fwrite(bases->donnees, 1, bases->taille, fp) == bases->taille;
+    ok = fclose(fp) == 0 && ok;
+    if (ok) ok = rename(temporaire, chemin) == 0;
+    if (!ok) remove(temporaire);
+    return ok;
+}
+
+// Projette en mémoire (lecture seule) le fichier de bases d'un domaine
+static bool ChargerBasesPdb(BasesPdb* bases, const char* chemin, uint64_t cle, int nbFaitsProbleme) {
+    memset(bases, 0, sizeof(*bases));
+#ifdef _WIN32
+    // Pas de mmap : on lit le fichier
+    FILE* fp = fopen(chemin, "rb");
+    if (!fp) return false;
+    fseek(fp, 0, SEEK_END);
+    long taille = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    bases->donnees = taille > 0 ? malloc((size_t)taille) : NULL;
+    bool lu = bases->donnees && fread(bases->donnees, 1, (size_t)taille, fp) == (size_t)taille;
+    fclose(fp);
+    bases->taille = (size_t)taille;
+    bases->projete = true;
+    if (!lu) {
+        LibererBasesPdb(bases);
+        return false;
+    }
+#else
+    int fd = open(chemin, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat infos;
+    if (fstat(fd, &infos) != 0 || infos.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* projection = mmap(NULL, (size_t)infos.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (projection == MAP_FAILED) return false;
+    bases->donnees = projection;
+    bases->taille = (size_t)infos.st_size;
+    bases->projete = true;
+#endif
+    if (!DecouperBasesPdb(bases, nbFaitsProbleme) || bases->cle != cle) {
+        LibererBasesPdb(bases);
+        return false;
+    }
+    return true;
+}
+
+// Bases du domaine de pb : lues dans le cache si possible, sinon
+// construites puis enregistrées. Faux si la construction échoue.
+bool PreparerBasesPdb(const Probleme* pb, BasesPdb* bases) {
+    uint64_t cle = HacherDomaine(pb);
+    char chemin[MAX_LEN * 2];
+    snprintf(chemin, sizeof(chemin), "%s/gps_pdb_%016llx.bin", REPERTOIRE_PDB, (unsigned long long)cle);
+    if (ChargerBasesPdb(bases, chemin, cle, pb->faits.nbFaits)) {
+        if (DEBUG_MODE) printf("DEBUG: bases de motifs lues dans %s\n", chemin);
+        return true;
+    }
+    double debut = HorlogeMs();
+    if (!ConstruireBasesPdb(pb, bases)) {
+        SIGNALER_ERREUR("Erreur: mémoire insuffisante pour les bases de motifs\n");
+        return false;
+    }
+    if (DEBUG_MODE) {
+        printf("DEBUG: %d bases de motifs construites en %.1f ms (%zu octets)\n",
+               bases->nbMotifs, HorlogeMs() - debut, bases->taille);
+    }
+    if (!EnregistrerBasesPdb(bases, chemin) && DEBUG_MODE) {
+        printf("DEBUG: impossible d'écrire %s, les bases ne seront pas gardées\n", chemin);
+    }
+    return true;
+}
+
+// Somme des distances abstraites ; H_IMPASSE si un motif ne peut plus atteindre le but
+int HeuristiquePdb(const BasesPdb* bases, const Mot* etat) {
+    int h = 0;
+    const int32_t* motif = bases->faits;
+    for (int m = 0; m < bases->nbMotifs; m++) {
+        uint8_t d = bases->tables[m][IndexMotif(etat, motif, bases->tailles[m])];
+        if (d == PDB_INFINI) return H_IMPASSE;
+        h += d;
+        motif += bases->tailles[m];
+    }
+    return h;
+}
+
+// 5.12 - Heuristique FF, actions utiles et recherche gloutonne à deux files
+// L'heuristique FF construit, depuis l'état, le graphe de planification
+// relâché (couches de faits et d'actions, sans suppressions ni
+// préconditions négatives), puis en extrait un plan relâché en remontant
+// depuis le but : h = nombre d'actions de ce plan. Les "actions utiles"
+// sont les actions applicables qui produisent un sous-but de la première
+// couche : ce sont presque toujours elles qui mènent au but.
+// La recherche gloutonne évalue un état seulement quand on le sort de la
+// file (évaluation différée : ses fils héritent de son h), et tient deux
+// files : une pour les fils obtenus par une action utile, une pour tous.
+// On les sert à tour de rôle, et la file des actions utiles reçoit 1000
+// tours d'avance à chaque amélioration du meilleur h.
+
+#define BONUS_PREFERES 1000
+
+struct EvaluateurFF {
+    const Probleme* pb;
+    IndexActions utilisateurs;  // actions par précondition
+    IndexActions producteurs;   // actions par fait ajouté
+    int* niveauFait;            // première couche du fait, -1 si inatteignable
+    int* niveauAction;          // première couche où l'action est applicable
+    int* restants;              // préconditions pas encore atteintes, par action
+    int* ordre;                 // faits dans l'ordre de leur couche
+    int* sousBut;               // marque : sous-but du plan relâché
+    int* choisie;               // marque : action du plan relâché
+    int* produit;               // marque : fait produit par une action choisie...
+    int* coucheProduit;          // ... de cette couche d'actions
+    int* utile;                 // marque : action utile déjà rangée
+    int marque;
+};
+
+EvaluateurFF* CreerEvaluateurFF(const Probleme* pb) {
+    EvaluateurFF* ev = calloc(1, sizeof(EvaluateurFF));
+    if (!ev) return NULL;
+    int nbFaits = pb->faits.nbFaits > 0 ? pb->faits.nbFaits : 1;
+    int nbActions = pb->actionCount > 0 ? pb->actionCount : 1;
+    ev->pb = pb;
+    ev->niveauFait = malloc(sizeof(int) * nbFaits);
+    ev->niveauAction = malloc(sizeof(int) * nbActions);
+    ev->restants = malloc(sizeof(int) * nbActions);
+    ev->ordre = malloc(sizeof(int) * nbFaits);
+    ev->sousBut = calloc(nbFaits, sizeof(int));
+    ev->choisie = calloc(nbActions, sizeof(int));
+    ev->produit = calloc(nbFaits, sizeof(int));
+    ev->coucheProduit = malloc(sizeof(int) * nbFaits);
+    ev->utile = calloc(nbActions, sizeof(int));
+    if (!ev->niveauFait || !ev->niveauAction || !ev->restants || !ev->ordre || !ev->sousBut
+        || !ev->choisie || !ev->produit || !ev->coucheProduit || !ev->utile
+        || !IndexerActions(pb, false, &ev->utilisateurs) || !IndexerActions(pb, true, &ev->producteurs)) {
+        LibererEvaluateurFF(ev);
+        return NULL;
+    }
+    return ev;
+}
+
+void LibererEvaluateurFF(EvaluateurFF* ev) {
+    if (!ev) return;
+    LibererIndexActions(&ev->utilisateurs);
+    LibererIndexActions(&ev->producteurs);
+    free(ev->niveauFait);
+    free(ev->niveauAction);
+    free(ev->restants);
+    free(ev->ordre);
+    free(ev->sousBut);
+    free(ev->choisie);
+    free(ev->produit);
+    free(ev->coucheProduit);
+    free(ev->utile);
+    free(ev);
+}
+
+// Une action atteinte à la couche 'niveau' : ses ajouts sont à la suivante
+static void AtteindreAjoutsFF(EvaluateurFF* ev, int a, int niveau, int* fin) {
+    ev->niveauAction[a] = niveau;
+    const ListeFaits* ajouts = &ev->pb->actions[a].addList;
+    for (int i = 0; i < ajouts->factCount; i++) {
+        int f = ajouts->facts[i];
+        if (ev->niveauFait[f] < 0) {
+            ev->niveauFait[f] = niveau + 1;
+            ev->ordre[(*fin)++] = f;
         }
     }
-    fprintf(fp, ",sur(bloc_%d,table)", nblocs);
-    for (int i = 1; i <= nblocs; i++) {
-        fprintf(fp, ",libre(bloc_%d)", i==1 ? i : 0);  // seul le bloc du dessus est libre
+}
+
+// Heuristique FF de l'état (H_IMPASSE si le but est inatteignable même
+// relâché). Si 'utiles' n'est pas NULL, on y range les actions utiles
+// (applicables dans l'état) et leur nombre dans *nbUtiles.
+int EvaluerFF(EvaluateurFF* ev, const Mot* etat, int* utiles, int* nbUtiles) {
+    const Probleme* pb = ev->pb;
+    if (nbUtiles) *nbUtiles = 0;
+
+    // 1) Couches : parcours en largeur des faits, chaque action devient
+    //    applicable à la couche de sa dernière précondition atteinte
+    int debut = 0, fin = 0;
+    for (int f = 0; f < pb->faits.nbFaits; f++) {
+        ev->niveauFait[f] = TEST_BIT(etat, f) ? 0 : -1;
+        if (ev->niveauFait[f] == 0) ev->ordre[fin++] = f;
     }
-    fprintf(fp, "\n");
-    
-    // État final : tous les blocs sont sur la table
-    fprintf(fp, "finish:");
-    for (int i = 1; i <= nblocs; i++) {
-        fprintf(fp, "sur(bloc_%d,table)", i);
-        if (i < nblocs) fprintf(fp, ",");
+    for (int a = 0; a < pb->actionCount; a++) {
+        ev->niveauAction[a] = -1;
+        ev->restants[a] = pb->actions[a].preconds.factCount;
+        if (ev->restants[a] == 0) AtteindreAjoutsFF(ev, a, 0, &fin);
     }
-    for (int i = 1; i <= nblocs; i++) {
-        fprintf(fp, ",libre(bloc_%d)", i);  // tous les blocs sont libres
+    while (debut < fin) {
+        int f = ev->ordre[debut++];
+        for (int k = ev->utilisateurs.debut[f]; k < ev->utilisateurs.debut[f + 1]; k++) {
+            int a = ev->utilisateurs.liste[k];
+            if (--ev->restants[a] == 0) AtteindreAjoutsFF(ev, a, ev->niveauFait[f], &fin);
+        }
     }
-    fprintf(fp, "\n");
-    
-    // Règles pour déplacer un bloc du sommet vers la table
-    for (int i = 1; i <= nblocs; i++) {
-        fprintf(fp, "****\n");
-        fprintf(fp, "action:Poser bloc_%d sur la table\n", i);
-        fprintf(fp, "preconds:libre(bloc_%d),sur(bloc_%d,bloc_X)\n", i, i);
-        fprintf(fp, "add:sur(bloc_%d,table),libre(bloc_X)\n", i);
-        fprintf(fp, "delete:sur(bloc_%d,bloc_X)\n", i);
+    for (int i = 0; i < pb->goal.factCount; i++) {
+        if (ev->niveauFait[pb->goal.facts[i]] < 0) return H_IMPASSE;
     }
-    
-    // Règles pour déplacer un bloc du sommet vers un autre bloc
-    for (int i = 1; i <= nblocs; i++) {
-        for (int j = 1; j <= nblocs; j++) {
-            if (i != j) {
-                fprintf(fp, "****\n");
-                fprintf(fp, "action:Déplacer bloc_%d sur bloc_%d\n", i, j);
-                fprintf(fp, "preconds:libre(bloc_%d),libre(bloc_%d),sur(bloc_%d,bloc_X)\n", i, j, i);
-                fprintf(fp, "add:sur(bloc_%d,bloc_%d),libre(bloc_X)\n", i, j);
-                fprintf(fp, "delete:sur(bloc_%d,bloc_X),libre(bloc_%d)\n", i, j);
+
+    // 2) Plan relâché : on parcourt les faits de la dernière couche vers
+    //    la première ; chaque sous-but est produit par l'action de la
+    //    couche précédente la plus facile (somme des couches de ses
+    //    préconditions), dont les préconditions deviennent des sous-buts
+    ev->marque++;
+    int m = ev->marque;
+    for (int i = 0; i < pb->goal.factCount; i++) ev->sousBut[pb->goal.facts[i]] = m;
+    int h = 0;
+    for (int j = fin - 1; j >= 0; j--) {
+        int f = ev->ordre[j];
+        int niveau = ev->niveauFait[f];
+        if (niveau == 0) break;                 // les faits de la couche 0 sont déjà vrais
+        if (ev->sousBut[f] != m) continue;
+        if (ev->produit[f] == m && ev->coucheProduit[f] == niveau - 1) continue;   // déjà vrai à cette couche
+        int meilleure = -1, meilleureDifficulte = INT_MAX;
+        for (int k = ev->producteurs.debut[f]; k < ev->producteurs.debut[f + 1]; k++) {
+            int a = ev->producteurs.liste[k];
+            if (ev->niveauAction[a] != niveau - 1) continue;
+            int difficulte = 0;
+            const ListeFaits* pre = &pb->actions[a].preconds;
+            for (int i = 0; i < pre->factCount; i++) difficulte += ev->niveauFait[pre->facts[i]];
+            if (difficulte < meilleureDifficulte) {
+                meilleureDifficulte = difficulte;
+                meilleure = a;
+            }
+        }
+        if (meilleure < 0) continue;            // impossible : f a bien un producteur de la couche niveau - 1
+        if (ev->choisie[meilleure] != m) {
+            ev->choisie[meilleure] = m;
+            h++;
+        }
+        const ListeFaits* ajouts = &pb->actions[meilleure].addList;
+        for (int i = 0; i < ajouts->factCount; i++) {
+            ev->produit[ajouts->facts[i]] = m;
+            ev->coucheProduit[ajouts->facts[i]] = niveau - 1;
+        }
+        const ListeFaits* pre = &pb->actions[meilleure].preconds;
+        for (int i = 0; i < pre->factCount; i++) ev->sousBut[pre->facts[i]] = m;
+
+        // Sous-but de la première couche : ses producteurs applicables sont utiles
+        if (utiles && niveau == 1) {
+            for (int k = ev->producteurs.debut[f]; k < ev->producteurs.debut[f + 1]; k++) {
+                int a = ev->producteurs.liste[k];
+                if (ev->niveauAction[a] != 0 || ev->utile[a] == m) continue;
+                if (!CanApply(etat, &pb->actions[a])) continue;     // préconditions négatives
+                ev->utile[a] = m;
+                utiles[(*nbUtiles)++] = a;
             }
         }
     }
-    
-    fclose(fp);
-    printf("Fichier '%s' créé avec succès.\n", filename);
+    return h;
 }
 
-// 5.3 - Mélange l'ordre des règles (pour augmenter les chances de trouver une solution rapidement)
-void MelangerRegles(Action* actions, int actionCount) {
-    if (DEBUG_MODE) printf("DEBUG: Mélange de %d règles...\n", actionCount);
-    
-    srand(time(NULL));
-    for (int i = 0; i < actionCount; i++) {
-        int j = i + rand() % (actionCount - i);
-        // Échange les règles i et j
-        Action temp = actions[i];
-        actions[i] = actions[j];
-        actions[j] = temp;
+// Entrée d'une file : le fils de 'parent' par 'action', pas encore
+// généré ; h est celui du parent (évaluation différée)
+typedef struct {
+    int h;
+    long ordre;                 // à h égal, premier entré, premier sorti
+    int parent;
+    int action;
+} EntreeGlouton;
+
+typedef struct {
+    EntreeGlouton* entrees;
+    int taille;
+    int capacite;
+    int priorite;               // la file de plus petite priorité est servie
+} FileGlouton;
+
+typedef struct {
+    const Probleme* pb;
+    EvaluateurFF* ev;
+    Mot* etats;
+    int* parent;
+    int* action;
+    int nbNoeuds;
+    int capacite;
+    int* alveoles;
+    int nbAlveoles;
+    FileGlouton files[2];       // 0 : actions utiles, 1 : toutes les actions
+    long ordre;
+    ControleRecherche controle;
+} Glouton;
+
+static bool AvantGlouton(const EntreeGlouton* a, const EntreeGlouton* b) {
+    return a->h < b->h || (a->h == b->h && a->ordre < b->ordre);
+}
+
+static bool EmpilerGlouton(Glouton* gl, FileGlouton* file, EntreeGlouton e) {
+    if (file->taille == file->capacite) {
+        int capacite = file->capacite ? file->capacite * 2 : 1024;
+        if (!ReserverMemoire(&gl->controle, sizeof(EntreeGlouton) * (capacite - file->capacite))) return false;
+        EntreeGlouton* entrees = realloc(file->entrees, sizeof(EntreeGlouton) * capacite);
+        if (!entrees) return false;
+        file->entrees = entrees;
+        file->capacite = capacite;
+    }
+    int i = file->taille++;
+    while (i > 0 && AvantGlouton(&e, &file->entrees[(i - 1) / 2])) {
+        file->entrees[i] = file->entrees[(i - 1) / 2];
+        i = (i - 1) / 2;
     }
+    file->entrees[i] = e;
+    return true;
 }
 
-// 5.4 - Choix aléatoire parmi les règles applicables
-int* TrouverReglesApplicables(const State* state, Action* actions, int actionCount, int* nbApplicables) {
-    static int applicables[MAX_ACTIONS];
-    *nbApplicables = 0;
-    
-    for (int i = 0; i < actionCount; i++) {
-        if (CanApply(state, &actions[i])) {
-            applicables[(*nbApplicables)++] = i;
-        }
+static EntreeGlouton DepilerGlouton(FileGlouton* file) {
+    EntreeGlouton tete = file->entrees[0];
+    EntreeGlouton dernier = file->entrees[--file->taille];
+    int i = 0;
+    for (;;) {
+        int fils = 2 * i + 1;
+        if (fils >= file->taille) break;
+        if (fils + 1 < file->taille && AvantGlouton(&file->entrees[fils + 1], &file->entrees[fils])) fils++;
+        if (!AvantGlouton(&file->entrees[fils], &dernier)) break;
+        file->entrees[i] = file->entrees[fils];
+        i = fils;
     }
-    
-    return applicables;
+    if (file->taille > 0) file->entrees[i] = dernier;
+    return tete;
 }
 
-// 5.5 - Construction d'un tableau de règles applicables pondéré par les priorités
-int* ConstuireTableauPriorite(const State* state, Action* actions, int actionCount, int* tailleTableau) {
-    static int tableauPonderé[MAX_ACTIONS * MAX_PRIORITY];
-    *tailleTableau = 0;
-    
-    for (int i = 0; i < actionCount; i++) {
-        if (CanApply(state, &actions[i])) {
-            for (int p = 0; p < actions[i].priority; p++) {
-                tableauPonderé[(*tailleTableau)++] = i;
-            }
+// Range un nouvel état ; -1 s'il est déjà connu, -2 si plus de mémoire
+static int AjouterNoeudGlouton(Glouton* gl, const Mot* etat, int parent, int action) {
+    const Probleme* pb = gl->pb;
+    if ((gl->nbNoeuds + 1) * 2 > gl->nbAlveoles) {
+        int nbAlveoles = gl->nbAlveoles ? gl->nbAlveoles * 2 : 4096;
+        if (!ReserverMemoire(&gl->controle, sizeof(int) * (nbAlveoles - gl->nbAlveoles))) return -2;
+        int* alveoles = malloc(sizeof(int) * nbAlveoles);
+        if (!alveoles) return -2;
+        memset(alveoles, -1, sizeof(int) * nbAlveoles);
+        for (int n = 0; n < gl->nbNoeuds; n++) {
+            uint64_t i = HacherEtat(pb, gl->etats + (size_t)n * pb->nbMots) & (nbAlveoles - 1);
+            while (alveoles[i] != -1) i = (i + 1) & (nbAlveoles - 1);
+            alveoles[i] = n;
         }
+        free(gl->alveoles);
+        gl->alveoles = alveoles;
+        gl->nbAlveoles = nbAlveoles;
     }
-    
-    return tableauPonderé;
+    uint64_t i = HacherEtat(pb, etat) & (gl->nbAlveoles - 1);
+    while (gl->alveoles[i] != -1) {
+        if (SameState(pb, gl->etats + (size_t)gl->alveoles[i] * pb->nbMots, etat)) return -1;
+        i = (i + 1) & (gl->nbAlveoles - 1);
+    }
+    if (gl->nbNoeuds == gl->capacite) {
+        int capacite = gl->capacite ? gl->capacite * 2 : 4096;
+        if (!ReserverMemoire(&gl->controle, (sizeof(Mot) * pb->nbMots + 2 * sizeof(int)) * (size_t)(capacite - gl->capacite))) {
+            return -2;
+        }
+        Mot* etats = realloc(gl->etats, sizeof(Mot) * pb->nbMots * (size_t)capacite);
+        if (etats) gl->etats = etats;
+        int* parents = realloc(gl->parent, sizeof(int) * capacite);
+        if (parents) gl->parent = parents;
+        int* actions = realloc(gl->action, sizeof(int) * capacite);
+        if (actions) gl->action = actions;
+        if (!etats || !parents || !actions) return -2;
+        gl->capacite = capacite;
+    }
+    int n = gl->nbNoeuds++;
+    memcpy(gl->etats + (size_t)n * pb->nbMots, etat, sizeof(Mot) * pb->nbMots);
+    gl->parent[n] = parent;
+    gl->action[n] = action;
+    gl->alveoles[i] = n;
+    return n;
 }
 
-// 5.6 - Calcul de la distance par rapport au but (nombre de faits communs)
-int CalculerDistanceAuBut(const State* state, const Goal* goal) {
-    int nbFaitsCommuns = 0;
-    
-    for (int i = 0; i < goal->factCount; i++) {
-        for (int j = 0; j < state->factCount; j++) {
-            if (strcmp(goal->facts[i], state->facts[j]) == 0) {
-                nbFaitsCommuns++;
+// Plan de la racine au noeud n (à libérer)
+static int PlanGlouton(const Glouton* gl, int n, int** plan) {
+    int longueur = 0;
+    for (int k = n; gl->parent[k] != -1; k = gl->parent[k]) longueur++;
+    *plan = malloc(sizeof(int) * (longueur > 0 ? longueur : 1));
+    if (!*plan) return -1;
+    int k = longueur;
+    for (int m = n; gl->parent[m] != -1; m = gl->parent[m]) (*plan)[--k] = gl->action[m];
+    return longueur;
+}
+
+// Recherche gloutonne à deux files guidée par FF. Renvoie la longueur du
+// plan trouvé (dans *plan, à libérer ; pas forcément le plus court) ou -1.
+int RechercheGloutonne(const Probleme* pb, int** plan, ResultatGlouton* resultat) {
+    return RechercheGloutonneLimitee(pb, &limitesRecherche, plan, resultat);
+}
+
+// Même recherche avec d'autres limites que limitesRecherche (repli de la
+// montée forcée, recherches lancées en parallèle)
+int RechercheGloutonneLimitee(const Probleme* pb, const LimitesRecherche* limites, int** plan, ResultatGlouton* resultat) {
+    memset(resultat, 0, sizeof(*resultat));
+    resultat->longueur = -1;
+    resultat->issue = ISSUE_BUDGET_MEMOIRE;
+    *plan = NULL;
+
+    Glouton gl;
+    memset(&gl, 0, sizeof(gl));
+    gl.pb = pb;
+    DemarrerControle(&gl.controle, limites);
+    gl.ev = CreerEvaluateurFF(pb);
+    Mot* fils = NouvelEtat(pb);
+    int* utiles = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    bool* estUtile = calloc(pb->actionCount > 0 ? pb->actionCount : 1, sizeof(bool));
+    if (!gl.ev || !fils || !utiles || !estUtile) goto fin;
+
+    // La racine est évaluée tout de suite ; les autres à leur sortie de file
+    EtatDepuisListe(pb, &pb->initial, fils);
+    EntreeGlouton depart = { 0, 0, -1, -1 };
+    if (!EmpilerGlouton(&gl, &gl.files[1], depart)) goto fin;
+    int meilleurH = INT_MAX;
+    int solution = -1;
+    resultat->issue = ISSUE_SANS_SOLUTION;
+
+    while (gl.files[0].taille > 0 || gl.files[1].taille > 0) {
+        if (ControleArret(&gl.controle)) {
+            resultat->issue = gl.controle.issue;
+            break;
+        }
+        // File non vide de plus petite priorité (à égalité, celle des actions utiles)
+        int f = gl.files[0].taille == 0 ? 1
+              : gl.files[1].taille == 0 ? 0
+              : gl.files[1].priorite < gl.files[0].priorite ? 1 : 0;
+        gl.files[f].priorite++;
+        EntreeGlouton e = DepilerGlouton(&gl.files[f]);
+
+        const Mot* etatParent = e.parent >= 0 ? gl.etats + (size_t)e.parent * pb->nbMots : NULL;
+        if (etatParent) ApplyAction(pb, etatParent, &pb->actions[e.action], fils);
+        int n = AjouterNoeudGlouton(&gl, fils, e.parent, e.action);
+        if (n == -1) continue;                          // déjà développé
+        if (n == -2) {
+            resultat->issue = ISSUE_BUDGET_MEMOIRE;
+            break;
+        }
+        if (f == 0) resultat->preferes++;
+        const Mot* etat = gl.etats + (size_t)n * pb->nbMots;
+        if (IsGoalReached(etat, &pb->goal)) {
+            solution = n;
+            break;
+        }
+        int nbUtiles = 0;
+        int h = EvaluerFF(gl.ev, etat, utiles, &nbUtiles);
+        resultat->evaluations++;
+        if (h >= H_IMPASSE) continue;                   // impasse prouvée
+        if (h < meilleurH) {
+            // Progrès : les actions utiles prennent de l'avance
+            meilleurH = h;
+            gl.files[0].priorite -= BONUS_PREFERES;
+            gl.controle.meilleurH = h;
+        }
+        resultat->developpes++;
+        gl.controle.generes = gl.ordre;
+
+        for (int i = 0; i < nbUtiles; i++) estUtile[utiles[i]] = true;
+        for (int a = 0; a < pb->actionCount; a++) {
+            // On relit l'état : gl.etats peut avoir été déplacé
+            if (!CanApply(gl.etats + (size_t)n * pb->nbMots, &pb->actions[a])) continue;
+            EntreeGlouton s = { h, gl.ordre++, n, a };
+            bool ok = EmpilerGlouton(&gl, &gl.files[1], s);
+            if (ok && estUtile[a]) ok = EmpilerGlouton(&gl, &gl.files[0], s);
+            if (!ok) {
+                resultat->issue = ISSUE_BUDGET_MEMOIRE;
+                gl.files[0].taille = gl.files[1].taille = 0;
                 break;
             }
         }
+        for (int i = 0; i < nbUtiles; i++) estUtile[utiles[i]] = false;
     }
-    
-    return nbFaitsCommuns;
-}
 
-// Choisit la meilleure règle selon l'analyse fin-moyens
-int ChoisirMeilleureRegle(const State* state, const Goal* goal, Action* actions, int actionCount) {
-    int meilleureRegle = -1;
-    int meilleurScore = -1;
-    
-    for (int i = 0; i < actionCount; i++) {
-        if (CanApply(state, &actions[i])) {
-            // Calcul de l'état résultant
-            State newState;
-            ApplyAction(state, &actions[i], &newState);
-            
-            // Calcul du score (nombre de faits communs avec le but)
-            int score = CalculerDistanceAuBut(&newState, goal);
-            
-            if (score > meilleurScore) {
-                meilleurScore = score;
-                meilleureRegle = i;
-            }
-        }
+    if (solution >= 0) {
+        resultat->longueur = PlanGlouton(&gl, solution, plan);
+        resultat->issue = resultat->longueur >= 0 ? ISSUE_RESOLU : ISSUE_BUDGET_MEMOIRE;
     }
-    
-    return meilleureRegle;
+
+fin:
+    resultat->noeuds = gl.nbNoeuds;
+    resultat->tempsMs = DureeControleMs(&gl.controle);
+    resultat->octetsMax = gl.controle.octetsMax;
+    LibererEvaluateurFF(gl.ev);
+    free(fils);
+    free(utiles);
+    free(estUtile);
+    free(gl.etats);
+    free(gl.parent);
+    free(gl.action);
+    free(gl.alveoles);
+    free(gl.files[0].entrees);
+    free(gl.files[1].entrees);
+    return resultat->longueur;
 }
 
 // ---------------------------------------------------------------------
 // Gestion des menus pour la partie 5
 // ---------------------------------------------------------------------
 
-void MenuGenerationBlocs() {
-    int nblocs;
-    printf("Entrez le nombre de blocs à générer (4-10 recommandé) : ");
-    scanf("%d", &nblocs);
-    
-    if (nblocs < 2 || nblocs > 20) {
-        printf("Nombre de blocs invalide. Doit être entre 2 et 20.\n");
+void MenuGenerationProblemes() {
+    static const char* familles[] = { "", "blocs", "hanoi", "gripper", "logistique", "riviere" };
+    ParametresGeneration params = { 0, 0, 0, 0 };
+
+    printf("Familles de problèmes :\n");
+    printf("  1) Blocs (configurations aléatoires)\n");
+    printf("  2) Tours de Hanoï\n");
+    printf("  3) Gripper (robot à deux pinces)\n");
+    printf("  4) Logistique (camions et avions)\n");
+    printf("  5) Traversée de rivière (loup/chèvre/chou à n passagers)\n");
+    printf("Votre choix : ");
+    scanf("%d", &params.famille);
+    if (params.famille < GEN_BLOCS || params.famille > GEN_RIVIERE) {
+        printf("Famille invalide.\n");
         return;
     }
-    
-    GenererProblemeBlocs(nblocs);
+
+    printf("Taille (blocs, disques, balles, colis ou passagers) : ");
+    scanf("%d", &params.taille);
+    printf("Paramètre secondaire (piquets, salles, villes ou places, 0 = défaut) : ");
+    scanf("%d", &params.taille2);
+    unsigned long long graine = 0;
+    printf("Graine (0 = instance classique) : ");
+    scanf("%llu", &graine);
+    params.graine = graine;
+
+    struct timeval debut, fin;
+    gettimeofday(&debut, NULL);
+    Probleme pb;
+    if (!GenererProbleme(&params, &pb)) {
+        printf("Paramètres invalides ou mémoire insuffisante.\n");
+        return;
+    }
+    gettimeofday(&fin, NULL);
+    double temps_ms = (fin.tv_sec - debut.tv_sec) * 1000.0 + (fin.tv_usec - debut.tv_usec) / 1000.0;
+    printf("Problème généré : %d faits, %d actions (%.2f ms)\n",
+           pb.faits.nbFaits, pb.actionCount, temps_ms);
+
+    char rep[10];
+    printf("Enregistrer le problème dans assets/ ? (o/n) ");
+    scanf("%9s", rep);
+    if (rep[0] == 'o' || rep[0] == 'O') {
+        char chemin[MAX_LEN];
+        snprintf(chemin, sizeof(chemin), "assets/%s_%d_%llu.txt", familles[params.famille], params.taille, graine);
+        if (EcrireProbleme(&pb, chemin)) printf("Fichier '%s' créé avec succès.\n", chemin);
+    }
+
+    printf("Lancer une recherche sur ce problème ? (o/n) ");
+    scanf("%9s", rep);
+    if (rep[0] == 'o' || rep[0] == 'O') {
+        int strategie = AfficherMenuStrategies();
+        if (strategie >= 1 && strategie <= NB_STRATEGIES) {
+            AnalyseProblemeAvecStrategie(&pb, strategie - 1);
+        } else {
+            printf("Stratégie invalide.\n");
+        }
+    }
+
+    LibererProbleme(&pb);
 }
 
 void MenuRechercheProbleme() {
@@ -1112,7 +7942,7 @@ void MenuRechercheProbleme() {
     fclose(file);
     
     int strategie = AfficherMenuStrategies();
-    if (strategie < 1 || strategie > 5) {
+    if (strategie < 1 || strategie > NB_STRATEGIES) {
         printf("Stratégie invalide.\n");
         return;
     }
@@ -1125,6 +7955,10 @@ void MenuRechercheProbleme() {
         case 3: mode = MODE_ALEATOIRE; break;
         case 4: mode = MODE_PRIORITE; break;
         case 5: mode = MODE_MEANS_END; break;
+        case 6: mode = MODE_ANYTIME; break;
+        case 7: mode = MODE_EXTERNE; break;
+        case 8: mode = MODE_FRONTIERE; break;
+        case 9: mode = MODE_GLOUTON; break;
         default: mode = MODE_NORMAL;
     }
     
@@ -1155,49 +7989,114 @@ void MenuComparaison() {
     
     const char* nomModes[] = {"NORMAL", "MELANGE", "ALEATOIRE", "PRIORITE", "MEANS-END"};
     
+    // Un seul contexte pour toutes les stratégies : ses tableaux servent à chacune
+    ContexteRecherche ctx;
+    InitialiserContexteRecherche(&ctx);
+    ArmerInterruption();
     for (int mode = MODE_NORMAL; mode <= MODE_MEANS_END; mode++) {
         printf("\nStratégie: %s\n", nomModes[mode]);
         
         struct timeval debut, fin;
         gettimeofday(&debut, NULL);
         
-        State initial;
-        Goal goal;
-        Action actions[MAX_ACTIONS];
-        int actionCount = 0;
+        Probleme pb;
         
-        if (ParseFile(chemin, &initial, &goal, actions, &actionCount)) {
+        if (ParseFile(chemin, &pb)) {
             if (mode == MODE_PRIORITE) {
-                InitialiserPriorites(actions, actionCount);
+                InitialiserPriorites(&pb);
             }
             
-            int solIndex = BfsAmeliore(&initial, &goal, actions, actionCount, mode);
+            int solIndex = BfsAmeliore(&ctx, &pb, mode);
             
             gettimeofday(&fin, NULL);
             double temps_ms = (fin.tv_sec - debut.tv_sec) * 1000.0 + (fin.tv_usec - debut.tv_usec) / 1000.0;
             
-            printf("  Résultat: %s\n", solIndex >= 0 ? "Solution trouvée" : "Échec");
-            printf("  États générés: %d\n", visitedCount);
+            printf("  Résultat: %s\n", solIndex >= 0 ? "Solution trouvée" : NomIssue(ctx.issue));
+            printf("  États générés: %d\n", ctx.visitedCount);
+            printf("  Successeurs calculés: %d\n", ctx.reglesAppliquees);
+            if (mode == MODE_MELANGE || mode == MODE_ALEATOIRE || mode == MODE_PRIORITE) {
+                printf("  Graine: %llu\n", ctx.graineUtilisee);
+            }
             printf("  Temps: %.2f ms\n", temps_ms);
             
-            if (solIndex >= 0) {
-                // Calculer la longueur du plan
-                int longueur = 0;
-                int current = solIndex;
-                while (current > 0) {
-                    longueur++;
-                    current = visited[current].parent;
-                }
+            int* plan = NULL;
+            int longueur = solIndex >= 0 ? ExtrairePlan(&ctx, solIndex, &plan) : -1;
+            if (longueur >= 0) {
                 printf("  Longueur du plan: %d étapes\n", longueur);
+                printf("  Après optimisation: %d étapes\n",
+                       OptimiserPlan(&pb, plan, longueur, RECHERCHE_LOCALE_PLAN));
             }
+            free(plan);
+            LibererProbleme(&pb);
         } else {
             printf("  Erreur lors du chargement du fichier.\n");
         }
+        if (atomic_load(&annulationRecherche)) break;
     }
+    DesarmerInterruption();
+    FermerContexteRecherche(&ctx);
     
     DEBUG_MODE = modeDebugOrig;  // Restaurer le mode debug original
 }
 
+// Limites appliquées à toutes les recherches (partie 4.0) ; 0 = pas de limite
+void MenuLimitesRecherche() {
+    long megaOctets = 0;
+    printf("Délai maximal en millisecondes (0 = aucun) : ");
+    if (scanf("%lf", &limitesRecherche.delaiMs) != 1 || limitesRecherche.delaiMs < 0) limitesRecherche.delaiMs = 0;
+    printf("Nombre maximal de noeuds développés (0 = aucun) : ");
+    if (scanf("%ld", &limitesRecherche.maxNoeuds) != 1 || limitesRecherche.maxNoeuds < 0) limitesRecherche.maxNoeuds = 0;
+    printf("Mémoire maximale en Mo par recherche, hors BFS (0 = aucune) : ");
+    if (scanf("%ld", &megaOctets) != 1 || megaOctets < 0) megaOctets = 0;
+    limitesRecherche.maxOctets = (size_t)megaOctets * 1024 * 1024;
+    printf("Limites : délai %.0f ms, %ld noeuds, %ld Mo (0 = aucune limite).\n",
+           limitesRecherche.delaiMs, limitesRecherche.maxNoeuds, megaOctets);
+}
+
+// Plusieurs variantes d'un même problème à la suite (partie 5.9) : chaque
+// fichier réutilise le graphe de recherche du précédent
+void MenuReplanification() {
+    SessionIncrementale session;
+    InitialiserSessionIncrementale(&session);
+    char nomFichier[MAX_LEN];
+
+    ArmerInterruption();
+    for (;;) {
+        printf("Fichier du problème (fin pour arrêter) : ");
+        if (scanf("%s", nomFichier) != 1 || strcmp(nomFichier, "fin") == 0) break;
+
+        char chemin[MAX_LEN * 2];
+        snprintf(chemin, sizeof(chemin), "assets/%s", nomFichier);
+        Probleme pb;
+        if (!ParseFile(chemin, &pb)) {
+            printf("Erreur : impossible de charger %s.\n", chemin);
+            continue;
+        }
+
+        int* plan = NULL;
+        ResultatIncremental resultat;
+        int longueur = RequeteIncrementale(&session, &pb, &plan, &resultat);
+        if (longueur >= 0) {
+            printf("Plan de %d étapes :\n", longueur);
+            AfficherPlan(&session.pb, plan, longueur);
+        } else {
+            printf("Aucun plan : %s\n", NomIssue(resultat.issue));
+        }
+        if (resultat.reconstruit) {
+            printf("| Graphe reconstruit\n");
+        } else {
+            printf("| Départ %s, %d règle(s) modifiée(s)\n",
+                   resultat.departChange ? "modifié" : "inchangé", resultat.reglesChangees);
+        }
+        printf("| Noeuds développés: %ld (graphe: %d états)\n", resultat.developpes, resultat.noeudsGraphe);
+        printf("| Temps: %.2f ms\n", resultat.tempsMs);
+        free(plan);
+        if (atomic_load(&annulationRecherche)) break;
+    }
+    DesarmerInterruption();
+    FermerSessionIncrementale(&session);
+}
+
 void GestionPartie5() {
     int choix = -1;
     
@@ -1209,7 +8108,7 @@ void GestionPartie5() {
                 printf("Retour au menu principal.\n");
                 break;
             case 1:
-                MenuGenerationBlocs();
+                MenuGenerationProblemes();
                 break;
             case 2:
                 MenuRechercheProbleme();
@@ -1217,6 +8116,36 @@ void GestionPartie5() {
             case 3:
                 MenuComparaison();
                 break;
+            case 4:
+                REDUCTION_ORDRE_PARTIEL = !REDUCTION_ORDRE_PARTIEL;
+                printf("Réduction d'ordre partiel %s.\n", REDUCTION_ORDRE_PARTIEL ? "activée" : "désactivée");
+                break;
+            case 5:
+                REDUCTION_SYMETRIES = !REDUCTION_SYMETRIES;
+                printf("Fusion des états symétriques %s.\n", REDUCTION_SYMETRIES ? "activée" : "désactivée");
+                break;
+            case 6:
+                RECHERCHE_LOCALE_PLAN = !RECHERCHE_LOCALE_PLAN;
+                printf("Recherche locale sur les plans %s.\n", RECHERCHE_LOCALE_PLAN ? "activée" : "désactivée");
+                break;
+            case 7:
+                MenuLimitesRecherche();
+                break;
+            case 8:
+                MenuReplanification();
+                break;
+            case 9:
+                HEURISTIQUE_REPERES = !HEURISTIQUE_REPERES;
+                printf("Heuristique des repères %s.\n", HEURISTIQUE_REPERES ? "activée" : "désactivée");
+                break;
+            case 10:
+                HEURISTIQUE_PDB = !HEURISTIQUE_PDB;
+                if (HEURISTIQUE_PDB) {
+                    printf("Répertoire du cache des bases de motifs (actuel : %s) : ", REPERTOIRE_PDB);
+                    if (scanf("%255s", REPERTOIRE_PDB) != 1) strcpy(REPERTOIRE_PDB, ".");
+                }
+                printf("Bases de motifs %s.\n", HEURISTIQUE_PDB ? "activées" : "désactivées");
+                break;
             default:
                 printf("Choix invalide.\n");
         }
@@ -1382,10 +8311,9 @@ void GestionPartie6() {
 // ---------------------------------------------------------------------
 // 7) Programme principal
 // ---------------------------------------------------------------------
+// Absent de la bibliothèque (partie 8), qui n'a que l'API de gps.h
+#ifndef GPS_BIBLIOTHEQUE
 int main() {
-    // Initialisation du générateur de nombres aléatoires
-    srand(time(NULL));
-    
     int choix = -1;
 
     AfficherEnteteASCII();
@@ -1424,4 +8352,463 @@ int main() {
     }
 
     return 0;
-}
\ No newline at end of file
+}
+#endif
+
+// ---------------------------------------------------------------------
+// 8) Bibliothèque libgps : l'API stable de gps.h
+// ---------------------------------------------------------------------
+// Le même fichier, compilé avec -DGPS_BIBLIOTHEQUE, donne la bibliothèque :
+// pas de main(), DEBUG_MODE à 0 et erreurs des moteurs tues. Chaque
+// GpsRecherche garde un ContexteRecherche (ses tableaux servent d'une
+// recherche à l'autre) et son propre jeton d'annulation. Les options sont
+// recopiées dans le contexte et dans des limites locales : les réglages
+// globaux du programme ne sont jamais modifiés, des recherches simultanées
+// ne se gênent donc pas. Les stratégies sur disque (BFS externe,
+// frontière) restent propres au programme.
+
+struct GpsProbleme {
+    Probleme pb;
+    int* alveoles;                  // index des actions par nom normalisé : première action, -1 si vide
+    int nbAlveoles;                 // puissance de 2
+    int* suivantMemeNom;            // action suivante portant le même nom, -1 sinon
+};
+
+struct GpsRecherche {
+    ContexteRecherche ctx;
+    atomic_int annulation;          // jeton levé par GpsAnnuler
+    int* plan;                      // plan de la dernière recherche (NULL si aucun)
+    int longueur;
+    GpsStatistiques stats;
+    GpsRappelPlan rappelPlan;       // options de la recherche en cours
+    void* contexteRappel;
+    GpsRappelProgression rappelProgression;
+    void* contexteProgression;
+};
+
+GPS_API int GpsVersion(void) {
+    return GPS_VERSION;
+}
+
+// Tailles des structures de la version 6, la première qui les range :
+// en dessous, le programme n'a pas été compilé avec le champ taille
+#define TAILLE_OPTIONS_V6 (offsetof(GpsOptions, periodeProgressionMs) + sizeof(double))
+#define TAILLE_STATISTIQUES_V6 (offsetof(GpsStatistiques, octetsMax) + sizeof(unsigned long long))
+
+static size_t TailleConnue(size_t taille, size_t tailleBibliotheque) {
+    return taille < tailleBibliotheque ? taille : tailleBibliotheque;
+}
+
+GPS_API void GpsInitialiserOptions(GpsOptions* options) {
+    GpsOptions defaut;
+    memset(&defaut, 0, sizeof(defaut));
+    defaut.taille = options->taille;
+    defaut.strategie = GPS_NORMAL;
+    defaut.nbFils = NB_FILS_MARCHES;
+    defaut.ordrePartiel = REDUCTION_ORDRE_PARTIEL;
+    defaut.symetries = REDUCTION_SYMETRIES;
+    memcpy(options, &defaut, TailleConnue(options->taille, sizeof(defaut)));
+}
+
+GPS_API const char* GpsNomIssue(int issue) {
+    if (issue < ISSUE_RESOLU || issue > ISSUE_ANNULE) return "erreur";
+    return NomIssue((IssueRecherche)issue);
+}
+
+static void CopierErreur(GpsErreur* erreur, int ligne, int colonne, const char* message) {
+    if (!erreur) return;
+    erreur->ligne = ligne;
+    erreur->colonne = colonne;
+    snprintf(erreur->message, sizeof(erreur->message), "%s", message);
+}
+
+// Nom d'une étape de plan, comme le validateur (app/backend/src/scripts/verify.c) :
+// blancs aux extrémités et virgule finale retirés
+static Tranche NormaliserNomEtape(Tranche t) {
+    while (t.longueur > 0 && EstBlanc(*t.debut)) { t.debut++; t.longueur--; }
+    while (t.longueur > 0 && EstBlanc(t.debut[t.longueur - 1])) t.longueur--;
+    if (t.longueur > 0 && t.debut[t.longueur - 1] == ',') t.longueur--;
+    while (t.longueur > 0 && EstBlanc(t.debut[t.longueur - 1])) t.longueur--;
+    return t;
+}
+
+// Ligne affichée par le programme ("|  Etape 3: grasp bananas,") -> nom
+// de l'action ; vide pour les lignes d'encadrement
+static Tranche ExtraireNomEtape(Tranche ligne) {
+    ligne = NormaliserNomEtape(ligne);
+    if (ligne.longueur > 0 && ligne.debut[0] == '+') return (Tranche){ ligne.debut, 0 };
+    while (ligne.longueur > 0 && (ligne.debut[0] == '|' || EstBlanc(ligne.debut[0]))) {
+        ligne.debut++;
+        ligne.longueur--;
+    }
+    if (ligne.longueur > 5 && memcmp(ligne.debut, "Etape", 5) == 0) {
+        const char* deuxPoints = memchr(ligne.debut, ':', ligne.longueur);
+        if (deuxPoints) {
+            ligne.longueur -= (int)(deuxPoints + 1 - ligne.debut);
+            ligne.debut = deuxPoints + 1;
+        }
+    }
+    return NormaliserNomEtape(ligne);
+}
+
+// Première action portant le nom 'nom', -1 si aucune
+static int ChercherActionParNom(const GpsProbleme* gp, Tranche nom) {
+    uint32_t masque = (uint32_t)gp->nbAlveoles - 1;
+    for (uint32_t i = HacherTranche(nom) & masque; gp->alveoles[i] != -1; i = (i + 1) & masque) {
+        if (TranchesEgales(NormaliserNomEtape(gp->pb.actions[gp->alveoles[i]].name), nom)) return gp->alveoles[i];
+    }
+    return -1;
+}
+
+// Index des actions par nom : les homonymes sont chaînés dans l'ordre du fichier
+static bool IndexerNomsActions(GpsProbleme* gp) {
+    const Probleme* pb = &gp->pb;
+    gp->nbAlveoles = 1;
+    while (gp->nbAlveoles < 2 * pb->actionCount) gp->nbAlveoles *= 2;
+    gp->alveoles = malloc(sizeof(int) * gp->nbAlveoles);
+    gp->suivantMemeNom = malloc(sizeof(int) * (pb->actionCount > 0 ? pb->actionCount : 1));
+    if (!gp->alveoles || !gp->suivantMemeNom) return false;
+    memset(gp->alveoles, -1, sizeof(int) * gp->nbAlveoles);
+    uint32_t masque = (uint32_t)gp->nbAlveoles - 1;
+    for (int a = pb->actionCount - 1; a >= 0; a--) {
+        Tranche nom = NormaliserNomEtape(pb->actions[a].name);
+        uint32_t i = HacherTranche(nom) & masque;
+        while (gp->alveoles[i] != -1 && !TranchesEgales(NormaliserNomEtape(pb->actions[gp->alveoles[i]].name), nom)) {
+            i = (i + 1) & masque;
+        }
+        gp->suivantMemeNom[a] = gp->alveoles[i];
+        gp->alveoles[i] = a;
+    }
+    return true;
+}
+
+// Le problème devient propriétaire de 'texte' (alloué par malloc)
+static GpsProbleme* AnalyserTexte(char* texte, size_t taille, GpsErreur* erreur) {
+    GpsProbleme* gp = calloc(1, sizeof(GpsProbleme));
+    if (!gp) {
+        free(texte);
+        CopierErreur(erreur, 0, 0, "Mémoire insuffisante");
+        return NULL;
+    }
+    ErreurChargement e;
+    if (!ParseTexte(texte, taille, &gp->pb, &e)) {
+        CopierErreur(erreur, e.ligne, e.colonne, e.message);
+        GpsLibererProbleme(gp);
+        return NULL;
+    }
+    if (!IndexerNomsActions(gp)) {
+        CopierErreur(erreur, 0, 0, "Mémoire insuffisante");
+        GpsLibererProbleme(gp);
+        return NULL;
+    }
+    return gp;
+}
+
+GPS_API GpsProbleme* GpsChargerFichier(const char* chemin, GpsErreur* erreur) {
+    FILE* fp = chemin ? fopen(chemin, "rb") : NULL;
+    if (!fp) {
+        CopierErreur(erreur, 0, 0, "Impossible d'ouvrir le fichier");
+        return NULL;
+    }
+    size_t taille = 0;
+    char* texte = LireFichierComplet(fp, &taille);
+    fclose(fp);
+    if (!texte) {
+        CopierErreur(erreur, 0, 0, "Mémoire insuffisante");
+        return NULL;
+    }
+    return AnalyserTexte(texte, taille, erreur);
+}
+
+GPS_API GpsProbleme* GpsChargerTexte(const char* texte, size_t taille, GpsErreur* erreur) {
+    char* copie = malloc(taille + 1);
+    if (!copie || (!texte && taille > 0)) {
+        free(copie);
+        CopierErreur(erreur, 0, 0, copie ? "Texte absent" : "Mémoire insuffisante");
+        return NULL;
+    }
+    if (taille > 0) memcpy(copie, texte, taille);
+    copie[taille] = '\0';
+    return AnalyserTexte(copie, taille, erreur);
+}
+
+GPS_API void GpsLibererProbleme(GpsProbleme* pb) {
+    if (!pb) return;
+    LibererProbleme(&pb->pb);
+    free(pb->alveoles);
+    free(pb->suivantMemeNom);
+    free(pb);
+}
+
+GPS_API int GpsNombreActions(const GpsProbleme* pb) {
+    return pb ? pb->pb.actionCount : 0;
+}
+
+GPS_API const char* GpsNomAction(const GpsProbleme* pb, int action, int* longueur) {
+    if (!pb || action < 0 || action >= pb->pb.actionCount) {
+        if (longueur) *longueur = 0;
+        return NULL;
+    }
+    if (longueur) *longueur = pb->pb.actions[action].name.longueur;
+    return pb->pb.actions[action].name.debut;
+}
+
+GPS_API int GpsVerifierPlan(const GpsProbleme* pb, const int* plan, int longueur, int* etapeFautive) {
+    if (etapeFautive) *etapeFautive = 0;
+    if (!pb || (!plan && longueur > 0) || longueur < 0) return 0;
+    const Probleme* p = &pb->pb;
+    Mot* etat = NouvelEtat(p);
+    Mot* suivant = NouvelEtat(p);
+    int etape = etat && suivant ? 0 : -1;
+    if (etat && suivant) {
+        EtatDepuisListe(p, &p->initial, etat);
+        for (; etape < longueur; etape++) {
+            int a = plan[etape];
+            if (a < 0 || a >= p->actionCount || !CanApply(etat, &p->actions[a])) break;
+            ApplyAction(p, etat, &p->actions[a], suivant);
+            Mot* t = etat; etat = suivant; suivant = t;
+        }
+    }
+    bool correct = etape == longueur && IsGoalReached(etat, &p->goal);
+    if (etapeFautive) *etapeFautive = etape < 0 ? 0 : etape;
+    free(etat);
+    free(suivant);
+    return correct;
+}
+
+// Rejoue un plan donné par noms d'actions (validateur verify.c, addon /verify)
+GPS_API int GpsVerifierPlanNoms(const GpsProbleme* gp, const char* const* etapes, int nbEtapes, GpsVerification* v) {
+    memset(v, 0, sizeof(*v));
+    if (!gp || (!etapes && nbEtapes > 0) || nbEtapes < 0) {
+        snprintf(v->message, sizeof(v->message), "plan invalide");
+        return 0;
+    }
+    const Probleme* pb = &gp->pb;
+    Mot* etat = NouvelEtat(pb);
+    Mot* suivant = NouvelEtat(pb);
+    if (!etat || !suivant) {
+        free(etat);
+        free(suivant);
+        snprintf(v->message, sizeof(v->message), "mémoire insuffisante");
+        return 0;
+    }
+    EtatDepuisListe(pb, &pb->initial, etat);
+
+    bool echec = false;
+    for (int k = 0; k < nbEtapes && !echec; k++) {
+        Tranche nom = ExtraireNomEtape((Tranche){ etapes[k] ? etapes[k] : "", etapes[k] ? (int)strlen(etapes[k]) : 0 });
+        if (nom.longueur == 0) continue;
+        v->etapes++;
+        int a = ChercherActionParNom(gp, nom);
+        if (a < 0) {
+            snprintf(v->message, sizeof(v->message), "étape %d: action inconnue '%.*s'", v->etapes, nom.longueur, nom.debut);
+            echec = true;
+            break;
+        }
+        // Parmi les actions de ce nom, la première applicable
+        int bloquee = a;
+        for (; a != -1 && !CanApply(etat, &pb->actions[a]); a = gp->suivantMemeNom[a]) {}
+        if (a != -1) {
+            ApplyAction(pb, etat, &pb->actions[a], suivant);
+            Mot* t = etat; etat = suivant; suivant = t;
+            continue;
+        }
+        // Condition fausse de la première action de ce nom
+        const Action* action = &pb->actions[bloquee];
+        int fait = -1;
+        bool negatif = false;
+        for (int i = 0; i < action->preconds.factCount && fait < 0; i++) {
+            if (!TEST_BIT(etat, action->preconds.facts[i])) fait = action->preconds.facts[i];
+        }
+        for (int i = 0; i < action->neg_preconds.factCount && fait < 0; i++) {
+            if (TEST_BIT(etat, action->neg_preconds.facts[i])) { fait = action->neg_preconds.facts[i]; negatif = true; }
+        }
+        Tranche nomFait = fait >= 0 ? pb->faits.noms[fait] : (Tranche){ "", 0 };
+        snprintf(v->message, sizeof(v->message), "étape %d: '%.*s' non applicable, précondition %s'%.*s' %s",
+                 v->etapes, nom.longueur, nom.debut, negatif ? "négative " : "",
+                 nomFait.longueur, nomFait.debut, negatif ? "présente" : "absente");
+        echec = true;
+    }
+    for (int i = 0; i < pb->goal.factCount && !echec; i++) {
+        if (!TEST_BIT(etat, pb->goal.facts[i])) {
+            Tranche nomFait = pb->faits.noms[pb->goal.facts[i]];
+            snprintf(v->message, sizeof(v->message), "but non atteint après %d étape(s), fait '%.*s' absent",
+                     v->etapes, nomFait.longueur, nomFait.debut);
+            echec = true;
+        }
+    }
+    free(etat);
+    free(suivant);
+    v->correct = !echec;
+    return v->correct;
+}
+
+GPS_API GpsRecherche* GpsCreerRecherche(void) {
+    GpsRecherche* r = calloc(1, sizeof(GpsRecherche));
+    if (!r) return NULL;
+    InitialiserContexteRecherche(&r->ctx);
+    atomic_init(&r->annulation, 0);
+    r->longueur = -1;
+    r->stats.taille = sizeof(r->stats);
+    r->stats.issue = GPS_ERREUR;
+    r->stats.longueur = -1;
+    r->stats.longueurBrute = -1;
+    return r;
+}
+
+GPS_API void GpsLibererRecherche(GpsRecherche* r) {
+    if (!r) return;
+    FermerContexteRecherche(&r->ctx);
+    free(r->plan);
+    free(r);
+}
+
+GPS_API void GpsAnnuler(GpsRecherche* r) {
+    if (r) atomic_store(&r->annulation, 1);
+}
+
+// Rappel de la recherche anytime : garde le dernier plan amélioré et le
+// transmet au rappel des options
+static void GarderPlanAmeliore(const Probleme* pb, const int* plan, int longueur, double tempsMs, void* contexte) {
+    (void)pb;
+    GpsRecherche* r = contexte;
+    int* copie = malloc(sizeof(int) * (longueur > 0 ? longueur : 1));
+    if (!copie) return;                     // on garde le plan précédent
+    memcpy(copie, plan, sizeof(int) * longueur);
+    free(r->plan);
+    r->plan = copie;
+    r->longueur = longueur;
+    if (r->rappelPlan) r->rappelPlan(r->plan, longueur, tempsMs, r->contexteRappel);
+}
+
+// Avancement des moteurs -> GpsProgression de l'appelant
+static void TransmettreProgression(const ProgressionRecherche* p, void* contexte) {
+    GpsRecherche* r = contexte;
+    GpsProgression g = { p->tempsMs, p->developpes, p->generes, p->profondeur, p->meilleurH,
+                         p->noeudsParSeconde, p->octets };
+    r->rappelProgression(&g, r->contexteProgression);
+}
+
+GPS_API int GpsResoudre(GpsRecherche* r, const GpsProbleme* gp, const GpsOptions* options) {
+    if (!r || !gp) return GPS_ERREUR;
+    free(r->plan);
+    r->plan = NULL;
+    r->longueur = -1;
+    memset(&r->stats, 0, sizeof(r->stats));
+    r->stats.taille = sizeof(r->stats);
+    r->stats.issue = GPS_ERREUR;
+    r->stats.longueur = -1;
+    r->stats.longueurBrute = -1;
+
+    // Options du programme, complétées par les valeurs par défaut des
+    // champs qu'il ne connaît pas (voir gps.h)
+    GpsOptions lues;
+    GpsOptionsParDefaut(&lues);
+    if (options) {
+        if (options->taille < TAILLE_OPTIONS_V6) return GPS_ERREUR;
+        memcpy(&lues, options, TailleConnue(options->taille, sizeof(lues)));
+        lues.taille = sizeof(lues);
+    }
+    options = &lues;
+
+    // Réglages de cette recherche seulement
+    const Probleme* pb = &gp->pb;
+    ContexteRecherche* ctx = &r->ctx;
+    LimitesRecherche limites = { options->delaiMs > 0 ? options->delaiMs : 0,
+                                 options->maxNoeuds > 0 ? options->maxNoeuds : 0,
+                                 options->maxOctets, &r->annulation,
+                                 options->rappelProgression ? TransmettreProgression : NULL, r,
+                                 options->periodeProgressionMs };
+    ctx->debug = 0;
+    ctx->limites = limites;
+    ctx->graine = options->graine;
+    ctx->reductionOrdrePartiel = options->ordrePartiel != 0;
+    ctx->reductionSymetries = options->symetries != 0;
+    ctx->nbFilsMarches = options->nbFils;
+    snprintf(ctx->repertoirePriorites, sizeof(ctx->repertoirePriorites), "%s",
+             options->repertoirePriorites ? options->repertoirePriorites : "");
+    r->rappelPlan = options->rappelPlan;
+    r->contexteRappel = options->contexteRappel;
+    r->rappelProgression = options->rappelProgression;
+    r->contexteProgression = options->contexteProgression;
+
+    double debut = HorlogeMs();
+    switch (options->strategie) {
+        case GPS_NORMAL:
+        case GPS_MELANGE:
+        case GPS_ALEATOIRE:
+        case GPS_PRIORITE:
+        case GPS_FIN_MOYENS: {
+            int solution = BfsAmeliore(ctx, pb, options->strategie);
+            r->stats.issue = ctx->issue;
+            r->stats.noeuds = ctx->noeuds;
+            r->stats.successeurs = ctx->reglesAppliquees;
+            r->stats.graine = ctx->graineUtilisee;
+            r->stats.octetsMax = ctx->octetsMax;
+            if (solution >= 0) {
+                r->longueur = ExtrairePlan(ctx, solution, &r->plan);
+                if (r->longueur < 0) r->stats.issue = ISSUE_BUDGET_MEMOIRE;
+            }
+            break;
+        }
+        case GPS_ANYTIME: {
+            ResultatAnytime resultat;
+            double delai = options->delaiMs > 0 ? options->delaiMs : DELAI_ANYTIME_MS;
+            RechercheAnytimeLimitee(pb, &limites, delai, GarderPlanAmeliore, r, &resultat);
+            r->stats.issue = resultat.issue;
+            r->stats.noeuds = resultat.noeudsDeveloppes;
+            r->stats.octetsMax = resultat.octetsMax;
+            break;
+        }
+        case GPS_GLOUTON: {
+            ResultatGlouton resultat;
+            r->longueur = RechercheGloutonneLimitee(pb, &limites, &r->plan, &resultat);
+            r->stats.issue = resultat.issue;
+            r->stats.noeuds = resultat.developpes;
+            r->stats.octetsMax = resultat.octetsMax;
+            break;
+        }
+        default:
+            atomic_store(&r->annulation, 0);
+            return GPS_ERREUR;
+    }
+    if (r->longueur < 0) {
+        free(r->plan);
+        r->plan = NULL;
+        r->longueur = -1;
+    }
+
+    // Optimisation du plan (partie 5.7), arrêtée elle aussi par GpsAnnuler
+    r->stats.longueurBrute = r->longueur;
+    if (r->longueur > 0 && options->optimiserPlan > 0) {
+        r->longueur = OptimiserPlanLimite(pb, &limites, r->plan, r->longueur, options->optimiserPlan > 1);
+    }
+    r->stats.longueur = r->longueur;
+    r->stats.tempsMs = HorlogeMs() - debut;
+    atomic_store(&r->annulation, 0);
+    return r->stats.issue;
+}
+
+GPS_API int GpsLongueurPlan(const GpsRecherche* r) {
+    return r ? r->longueur : -1;
+}
+
+GPS_API int GpsEtapePlan(const GpsRecherche* r, int etape) {
+    if (!r || etape < 0 || etape >= r->longueur) return -1;
+    return r->plan[etape];
+}
+
+GPS_API void GpsLireStatistiques(const GpsRecherche* r, GpsStatistiques* stats) {
+    if (!stats || stats->taille < TAILLE_STATISTIQUES_V6) return;
+    GpsStatistiques lues;
+    if (r) {
+        lues = r->stats;
+    } else {
+        memset(&lues, 0, sizeof(lues));
+        lues.issue = GPS_ERREUR;
+        lues.longueur = -1;
+        lues.longueurBrute = -1;
+    }
+    lues.taille = stats->taille;
+    memcpy(stats, &lues, TailleConnue(stats->taille, sizeof(lues)));
+}